@@ -0,0 +1,77 @@
+#ifndef JUICED_BCENCODER_H_
+#define JUICED_BCENCODER_H_
+
+/*───────────────────────────────────────────────────────────────
+   BCEncoder.h  –  native block encoder for .d8t texture slots
+   BGRA8 → DXT1 / DXT3 / DXT5 / ATI2, or raw ARGB8888 (type 0x15)
+   SSE2 palette search where available, block rows spread over
+   all cores.  Mip levels come from MipGen.
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <vector>
+
+#include "ImageIO.h"
+#include "MipGen.h"
+
+namespace juiced
+{
+namespace bc
+{
+
+enum Quality
+{
+    kFast   = 0,        /* bounding-box endpoints                    */
+    kNormal = 1,        /* principal-axis endpoints                  */
+    kHigh   = 2         /* principal axis + least-squares refinement */
+};
+
+/* TextureHdr.type values this encoder can produce */
+enum
+{
+    kTypeDXT1 = 0x31545844,
+    kTypeDXT3 = 0x33545844,
+    kTypeDXT5 = 0x35545844,
+    kTypeATI2 = 0x32495441,
+    kTypeARGB = 0x00000015
+};
+
+bool     isEncodable (uint32_t type);
+uint32_t blockBytes  (uint32_t type);                 /* 0 for ARGB          */
+uint32_t levelBytes  (uint32_t type, uint32_t w, uint32_t h);
+uint32_t fullMipCount(uint32_t w, uint32_t h);
+
+/* "DXT1" … "ARGB8888", "unknown" for anything else */
+const char* typeName(uint32_t type);
+
+/* "fast" / "normal" / "high" (or 0/1/2) → Quality */
+bool parseQuality(const char* s, Quality& q);
+
+/* one 4x4 block – px is 16 BGRA pixels, row-major */
+void encodeBlockDXT1(const uint8_t* px, uint8_t* out, Quality q, bool punchAlpha);
+void encodeBlockDXT3(const uint8_t* px, uint8_t* out, Quality q);
+void encodeBlockDXT5(const uint8_t* px, uint8_t* out, Quality q);
+void encodeBlockATI2(const uint8_t* px, uint8_t* out, Quality q);
+
+/* one surface; out must hold levelBytes(type,w,h) */
+void encodeSurface(const uint8_t* bgra, uint32_t w, uint32_t h,
+                   uint32_t type, Quality q, uint8_t* out);
+
+/* whole texture body: top level + (mips-1) down-sampled levels */
+bool encodeTexture(const RawImage& top, uint32_t type, uint32_t mips,
+                   Quality q, std::vector<uint8_t>& body,
+                   MipFilter filter = kMipBox);
+
+/* ─── lossless DXT3 / DXT5 → DXT1 (bank shrink) ───────────────
+   A body qualifies when every alpha block decodes to 255 in every
+   decoder: DXT3 nibbles all 0xF, DXT5 indices that only pick a 255
+   endpoint (or the 6-alpha mode's constant 255).  The colour half
+   is kept as is – only blocks that would hit DXT1's 3-colour mode
+   (c0 <= c1) get their endpoints swapped / indices remapped.      */
+bool alphaOpaque(uint32_t type, const uint8_t* body, size_t size);
+
+/* size must be a whole number of 16-byte blocks; out gets size / 2 */
+void transcodeToDXT1(const uint8_t* body, size_t size, uint8_t* out);
+
+}
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef JUICED_BLOCKDECODE_H_
+#define JUICED_BLOCKDECODE_H_
+
+/*───────────────────────────────────────────────────────────────
+   BlockDecode.h  –  wx-free DXT / ATI2 decode kernels
+   Shared by DDSImage (preview) and the import / mip paths.
+   Output is BGRA8; every kernel writes one 4x4 block at dst
+   with the given row pitch in bytes.
+  ──────────────────────────────────────────────────────────────*/
+#include <cstddef>
+#include <stdint.h>
+
+namespace juiced
+{
+namespace dxt
+{
+
+void decodeDXT1Block(const uint8_t* s, uint8_t* dst, size_t pitch);
+void decodeDXT3Block(const uint8_t* s, uint8_t* dst, size_t pitch);
+void decodeDXT5Block(const uint8_t* s, uint8_t* dst, size_t pitch);
+void decodeATI2Block(const uint8_t* s, uint8_t* dst, size_t pitch);
+
+/* type = TextureHdr.type / DDS fourCC.  True for the four above
+   plus raw ARGB8888 (0x15, through PixelSwizzle). */
+bool canDecode(uint32_t type);
+
+/* one surface (mip level) → w*h*4 BGRA.  Partial edge blocks are
+   clipped.  srcSize is checked against the level size.  Block rows
+   are spread over threads workers (0 → all cores; 1 for callers
+   that already run one decode per core).                        */
+bool decodeSurface(uint32_t type, const uint8_t* src, size_t srcSize,
+                   uint32_t w, uint32_t h, uint8_t* bgra, unsigned threads = 0);
+
+}
+}
+#endif
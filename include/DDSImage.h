@@ -44,13 +44,7 @@ public:
 private:
     /* helpers */
     bool        readHeader(wxInputStream&, DDSHeader&);
-    bool        decode(wxInputStream&, const DDSHeader&);
-    void        DecodeDXT1 (const unsigned char*, int bx,int by);
-    void        DecodeDXT3 (const unsigned char*, int bx,int by);
-    void        DecodeDXT5 (const unsigned char*, int bx,int by);
-    void        DecodeATI2(const unsigned char*, int bx,int by);
-    void        decodePlain32(const unsigned char*, int y, int bpp);
-    static void expand565(uint16_t, unsigned char&, unsigned char&, unsigned char&);
+    bool        decode(wxInputStream&, const DDSHeader&);   /* → BlockDecode / PixelSwizzle */
 
     void        freePixels();
 
@@ -58,5 +52,6 @@ private:
     int            m_w, m_h, m_pitch;
     int            m_mipCount;
     uint32_t       m_fourCC;
+    const char*    m_layout;        /* uncompressed: "RGB565", … */
 };
 #endif
@@ -0,0 +1,52 @@
+#ifndef JUICED_IMAGEIO_H_
+#define JUICED_IMAGEIO_H_
+
+/*───────────────────────────────────────────────────────────────
+   ImageIO.h  –  uncompressed source images for import
+   PNG (all colour types, 1…16 bit, Adam7) and TGA (types 1/2/3
+   and their RLE variants) → tightly packed BGRA8, top-down, and
+   back out to 8-bit RGBA PNG / 32-bit TGA (contact sheets,
+   convertTexture).
+   No wx, no external libs – usable from the parser/CLI.
+  ──────────────────────────────────────────────────────────────*/
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+struct RawImage
+{
+    uint32_t             width, height;
+    std::vector<uint8_t> bgra;          /* width*height*4, B G R A */
+
+    RawImage() : width(0), height(0) {}
+    uint8_t*       row(uint32_t y)       { return &bgra[size_t(y) * width * 4]; }
+    const uint8_t* row(uint32_t y) const { return &bgra[size_t(y) * width * 4]; }
+};
+
+bool isPNG(const uint8_t* p, size_t n);
+
+bool decodePNG(const uint8_t* p, size_t n, RawImage& out, std::string& err);
+bool decodeTGA(const uint8_t* p, size_t n, RawImage& out, std::string& err);
+
+/* BGRA8 → RGBA PNG, APPENDED to out; level as zlib::deflate
+   (0 stores unfiltered, 1 uses the Up filter on every row,
+   higher levels search the best filter per row)              */
+void encodePNG(const RawImage& img, std::vector<uint8_t>& out, int level = 6);
+
+/* BGRA8 → uncompressed 32-bit TGA, top-left origin, APPENDED;
+   width / height must fit 16 bits                            */
+void encodeTGA(const RawImage& img, std::vector<uint8_t>& out);
+
+/* picks the decoder from the signature / file extension */
+bool decodeImage(const uint8_t* p, size_t n, const std::string& nameHint,
+                 RawImage& out, std::string& err);
+
+/* true for *.png / *.tga (case-insensitive) */
+bool isImageExt(const std::string& path);
+
+}
+#endif
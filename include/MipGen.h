@@ -0,0 +1,35 @@
+#ifndef JUICED_MIPGEN_H_
+#define JUICED_MIPGEN_H_
+
+/*───────────────────────────────────────────────────────────────
+   MipGen.h  –  mip-chain down-sampling kernels (BGRA8)
+   Box    : 2x2 average (SSE2 fast path for even sizes)
+   Kaiser : separable Kaiser-windowed sinc, sharper minification
+   Each level is split into row bands that run on all cores.
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <vector>
+
+#include "ImageIO.h"
+
+namespace juiced
+{
+
+enum MipFilter
+{
+    kMipBox    = 0,
+    kMipKaiser = 1
+};
+
+/* "box" / "kaiser" → MipFilter */
+bool parseMipFilter(const char* s, MipFilter& f);
+
+/* dst = next level of src:  max(1,w/2) x max(1,h/2) */
+void downsample(const RawImage& src, RawImage& dst, MipFilter f);
+
+/* levels 1 … count-1 of top (level 0 is NOT copied into chain) */
+void buildMipChain(const RawImage& top, uint32_t count, MipFilter f,
+                   std::vector<RawImage>& chain);
+
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef JUICED_PIXELSWIZZLE_H_
+#define JUICED_PIXELSWIZZLE_H_
+
+/*───────────────────────────────────────────────────────────────
+   PixelSwizzle.h  –  uncompressed DDS layouts → BGRA8
+   A layout is the DDS pixel format: bit count plus channel masks.
+   The usual ones (ARGB8888, XRGB8888, ABGR8888, RGB888, RGB565,
+   ARGB4444, A8L8) take SSE2 / word-wide fast paths; any other
+   mask combination goes through one shift + LUT per channel.
+   Rows are spread over the workers like decodeSurface.
+  ──────────────────────────────────────────────────────────────*/
+#include <cstddef>
+#include <stdint.h>
+
+namespace juiced
+{
+namespace pix
+{
+
+struct PixelLayout
+{
+    uint32_t bits;                      /* 8, 16, 24 or 32                    */
+    uint32_t rMask, gMask, bMask, aMask;
+    bool     luminance;                 /* rMask holds L, copied to R, G, B   */
+};
+
+enum Kind
+{
+    kBGRA8888,                          /* A8R8G8B8 – Juiced type 0x15 as is  */
+    kBGRX8888,                          /* X8R8G8B8                           */
+    kRGBA8888,                          /* A8B8G8R8                           */
+    kBGR888,                            /* R8G8B8                             */
+    kRGB565,                            /* R5G6B5                             */
+    kARGB4444,                          /* A4R4G4B4                           */
+    kA8L8,
+    kGeneric
+};
+
+/* the layout behind .d8t type 0x15 (and every .dds this tool writes for it) */
+extern const PixelLayout kJuicedARGB;
+
+/* DDS_PIXELFORMAT flags / bit count / masks → layout; false for FourCC
+   formats, unsupported bit counts or a layout without any channel     */
+bool fromDDS(uint32_t flags, uint32_t bits, uint32_t r, uint32_t g, uint32_t b,
+             uint32_t a, PixelLayout& out);
+
+Kind        classify(const PixelLayout& l);
+const char* layoutName(const PixelLayout& l);      /* "RGB565", … "RGB" */
+
+inline size_t rowBytes (const PixelLayout& l, uint32_t w) { return (size_t(w) * l.bits + 7) / 8; }
+inline size_t levelSize(const PixelLayout& l, uint32_t w, uint32_t h) { return rowBytes(l, w) * h; }
+
+/* one surface → w*h*4 BGRA; srcSize is checked against levelSize.
+   threads as in decodeSurface (0 → all cores).                    */
+bool toBGRA(const PixelLayout& l, const uint8_t* src, size_t srcSize,
+            uint32_t w, uint32_t h, uint8_t* bgra, unsigned threads = 0);
+
+}
+}
+#endif
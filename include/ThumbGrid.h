@@ -0,0 +1,67 @@
+#ifndef THUMBGRID_H
+#define THUMBGRID_H
+
+/*──────────────────────────────────────────────────────────────
+    ThumbGrid – virtual thumbnail grid for one texture pack
+    Only the rows on screen are painted; their thumbnails come
+    from a juiced::ThumbCache (smallest covering mip, decoded on
+    background workers), so a 2,000-texture pack scrolls without
+    decoding anything it never shows.
+──────────────────────────────────────────────────────────────*/
+#include <wx/wx.h>
+#include <wx/vscroll.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "d8w_parser.h"
+#include "d8w_thumbs.h"
+
+class ThumbGrid : public wxVScrolledWindow
+{
+public:
+    typedef std::function<void(int tex)> PickFn;   /* double-click / Enter */
+
+    explicit ThumbGrid(wxWindow* parent, wxWindowID id = wxID_ANY);
+    ~ThumbGrid() override;
+
+    /* banks the keys refer to – call after every open (clears) */
+    void setBanks(const std::vector<const juiced::D8WBank*>& banks);
+    void showPack(int bank, int pack);
+
+    /* bodies changed or are about to (import, open) */
+    void invalidate();
+
+    void setOnPick(const PickFn& f) { onPick_ = f; }
+
+    enum { kEdge = 96, kPad = 8, kLabel = 16 };
+
+private:
+    wxCoord OnGetRowHeight(size_t row) const override;
+
+    void OnPaint     (wxPaintEvent&);
+    void OnSize      (wxSizeEvent&);
+    void OnLeftDown  (wxMouseEvent&);
+    void OnLeftDClick(wxMouseEvent&);
+    void OnKey       (wxKeyEvent&);
+
+    bool decode(uint64_t key, juiced::RawImage& out) const;
+    void thumbReady();                          /* any worker thread */
+    void relayout();
+    int  cellAt(const wxPoint& p) const;
+    int  columns() const;
+    uint64_t keyOf(int tex) const;
+
+    std::vector<const juiced::D8WBank*> banks_;
+    int                                 bank_, pack_, count_, sel_;
+    std::map<uint64_t, wxBitmap>        bmps_;  /* converted, visible cells only */
+    std::atomic<bool>                   repaint_;
+    PickFn                              onPick_;
+    std::unique_ptr<juiced::ThumbCache> cache_; /* last: workers stop first */
+
+    wxDECLARE_EVENT_TABLE();
+};
+#endif
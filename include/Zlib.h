@@ -0,0 +1,38 @@
+#ifndef JUICED_ZLIB_H_
+#define JUICED_ZLIB_H_
+
+/*───────────────────────────────────────────────────────────────
+   Zlib.h  –  self-contained zlib/deflate stream support
+   (no external libs – used by the PNG reader and .d8p patches)
+  ──────────────────────────────────────────────────────────────*/
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace juiced
+{
+namespace zlib
+{
+
+/* RFC-1950 stream (2-byte header, deflate body, adler32 trailer).
+   Decompressed bytes are APPENDED to out.  sizeHint pre-reserves. */
+bool inflate(const uint8_t* src, size_t n,
+             std::vector<uint8_t>& out, size_t sizeHint = 0);
+
+/* raw RFC-1951 deflate body – no header / trailer */
+bool inflateRaw(const uint8_t* src, size_t n,
+                std::vector<uint8_t>& out, size_t sizeHint = 0);
+
+/* compressors matching the two above; output is APPENDED.
+   level 0 stores, 1 … 9 trade speed for size (6 ≈ zlib default) */
+void deflate   (const uint8_t* src, size_t n,
+                std::vector<uint8_t>& out, int level = 6);
+void deflateRaw(const uint8_t* src, size_t n,
+                std::vector<uint8_t>& out, int level = 6);
+
+uint32_t crc32  (const uint8_t* p, size_t n, uint32_t crc = 0);
+uint32_t adler32(const uint8_t* p, size_t n, uint32_t adler = 1);
+
+}
+}
+#endif
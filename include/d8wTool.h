@@ -8,7 +8,10 @@
 
 #include <memory>          // ← NEW
 #include "d8w_parser.h"
+#include "d8w_history.h"
+#include "d8w_journal.h"
 #include "DDSImage.h"
+#include "ThumbGrid.h"
 
 /* Tree payload ─────────────────────────────────────────────── */
 struct TexItemData : public wxTreeItemData
@@ -31,6 +34,7 @@ class MainFrame : public wxFrame
 {
 public:
     explicit MainFrame(const wxString& title);
+    ~MainFrame() override;
 
 private:                     /* widgets */
     wxSplitterWindow* splitter_;
@@ -38,6 +42,7 @@ private:                     /* widgets */
     wxPanel*          preview_;
     wxStaticBitmap*   thumb_;
     wxStaticText*     infoText_;
+    ThumbGrid*        grid_;       // pack view: thumbnails of every texture
 
                              /* data */
     //std::vector<juiced::D8WBank> banks_;   // one per discovered .d8w
@@ -48,6 +53,8 @@ std::vector<BankPtr> banks_;
     std::vector<wxString>        wNames_;  // filenames (for tree label)
     std::vector<BYTE>            bigT_;    // shared .d8t buffer
     wxString                     bigTPath_;
+    std::unique_ptr<juiced::EditHistory> history_;  // undo / redo of imports
+    std::unique_ptr<juiced::SessionJournal> journal_; // <stem>.d8j crash journal
 
                              /* preview */
     wxBitmap rawBmp_;
@@ -67,6 +74,9 @@ std::vector<BankPtr> banks_;
     void OnExport      (wxCommandEvent&);
     void OnConvert     (wxCommandEvent&);
     void OnImport      (wxCommandEvent&);
+    void OnUndo        (wxCommandEvent&);
+    void OnRedo        (wxCommandEvent&);
+    void OnUpdateUndo  (wxUpdateUIEvent&);
 
     void OnZoomIn      (wxCommandEvent&);
     void OnZoomOut     (wxCommandEvent&);
@@ -86,9 +96,15 @@ std::vector<BankPtr> banks_;
     void showWInfo (int bank);
     void showPackInfo (int bank,int pack);
     void showTexInfo  (int bank,int pack,int tex);
+    void showGrid     (bool on);
+    void selectTexNode(int bank,int pack,int tex);
+    void gridBanks    ();
 
     void applyZoom();
     void updateTitle();
+    void refreshAfterEdit();
+    void syncJournal();
+    void closeSession();
 
     /* command IDs */
     enum { ID_Tree = wxID_HIGHEST+1,
@@ -0,0 +1,102 @@
+#ifndef JUICED_D8W_ARCHIVE_H_
+#define JUICED_D8W_ARCHIVE_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_archive.h  –  one .d8t plus every .d8w that points into it
+   The same grouping MainFrame builds on File → Open, usable
+   without the GUI (daemon, batch runs).
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_io.h"
+#include "d8w_parser.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+/* <dir>\<stem>*.d8w next to a .d8t, sorted by name */
+void findCompanionBanks(const std::string& d8tPath, std::vector<std::string>& out);
+
+/* ─── export straight off disk ─────────────────────────────────
+   For a bank loaded against an empty .d8t buffer: bodies are read
+   from d8tPath through ReadScheduler (offset order, coalesced),
+   so only the textures asked for ever leave the disk.            */
+struct ExportJob
+{
+    size_t      pack, idx;
+    std::string out;
+    bool        dds;                /* convertTexture (DDS / PNG / TGA by the
+                                           extension) instead of exportTexture */
+};
+
+/* one job per texture of <pack>, named like exportTextureSet / convertTextureSet
+   (conv.format picks the converted files' extension)                          */
+bool addSetJobs(const D8WBank& bank, size_t pack, const std::string& dir, bool dds,
+                std::vector<ExportJob>& jobs, const ConvertOptions& conv = ConvertOptions());
+
+/* PNG / TGA jobs are decoded and encoded on the read workers, one
+   texture per core, at conv.level                                 */
+bool exportFromDisk(const D8WBank& bank, const std::string& d8tPath,
+                    const std::vector<ExportJob>& jobs, IoStats* stats = 0,
+                    const ConvertOptions& conv = ConvertOptions());
+
+/* temp files of one rewrite, "<final><suffix>": removed unless
+   commit() moved every one of them over its final path          */
+class PartFiles
+{
+public:
+    explicit PartFiles(const char* suffix) : suffix_(suffix) {}
+    ~PartFiles();
+
+    std::string add(const std::string& finalPath);      /* → temp path */
+    bool        commit();                               /* Status set  */
+
+private:
+    PartFiles(const PartFiles&);
+    PartFiles& operator=(const PartFiles&);
+
+    const char*              suffix_;
+    std::vector<std::string> parts_, finals_;
+};
+
+class Archive
+{
+public:
+    Archive() : useIndex_(false), fromIndex_(false) {}
+
+    /* read / refresh the .d8idx sidecar on open and save (d8w_index) */
+    void  setUseIndex(bool on) { useIndex_ = on; }
+    bool  fromIndex() const    { return fromIndex_; }   /* last open skipped parsing */
+
+    /* load the .d8t; with no d8w list the companions are picked up */
+    bool open(const std::string& d8tPath,
+              const std::vector<std::string>& d8wPaths = std::vector<std::string>());
+
+    /* bank by path (loaded on first use) or NULL */
+    D8WBank*       bank(const std::string& d8wPath);
+    D8WBank*       findBank(const std::string& d8wPath) const;
+    D8WBank*       bankAt(size_t i) const { return i < banks_.size() ? banks_[i].get() : 0; }
+    size_t         bankCount()      const { return banks_.size(); }
+    const std::string& bankPath(size_t i) const { return paths_[i]; }
+
+    const std::string& path() const { return big_.path(); }
+    bool  isDirty() const;
+
+    /* every dirty .d8w, the shared .d8t once */
+    bool  save();
+
+private:
+    D8WContext                             ctx_;       /* before banks_: outlives them */
+    D8TFile                                big_;
+    std::vector< std::unique_ptr<D8WBank> > banks_;
+    std::vector<std::string>               paths_;
+    bool                                   useIndex_;
+    bool                                   fromIndex_;
+
+    void  refreshIndex() const;
+};
+
+}
+#endif
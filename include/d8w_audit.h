@@ -0,0 +1,100 @@
+#ifndef JUICED_D8W_AUDIT_H_
+#define JUICED_D8W_AUDIT_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_audit.h  –  per-texture cost and problem report (-audit)
+
+   Every header of every bank becomes one row; each distinct body
+   is read once (offset order, ReadScheduler) and looked at on
+   the scheduler's workers, on the compressed blocks themselves:
+
+   ‣ oversized   an edge above AuditOptions::maxDim
+   ‣ mips        mip count differs from the full chain (or exceeds it)
+   ‣ npot        an edge that isn't a power of two
+   ‣ solid       the top level is one colour (colour / alpha block
+                 palettes, no pixel decode)
+   ‣ opaque      DXT3 / DXT5 / ARGB alpha that is 255 everywhere
+   ‣ duplicate   same type, size and XXH64 as a body elsewhere
+   ‣ size        body isn't the size its header's chain needs
+
+   Each row carries the one suggestion that saves the most bytes;
+   report totals count a shared body once.
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+enum AuditFlag
+{
+    kAuditOversized = 1 << 0,
+    kAuditMips      = 1 << 1,
+    kAuditNpot      = 1 << 2,
+    kAuditSolid     = 1 << 3,
+    kAuditOpaque    = 1 << 4,
+    kAuditDuplicate = 1 << 5,
+    kAuditSize      = 1 << 6
+};
+
+enum AuditSort
+{
+    kAuditByCost,                   /* body bytes, largest first          */
+    kAuditBySavings,                /* suggested savings, largest first   */
+    kAuditByName,                   /* bank, pack, index                  */
+    kAuditByOffset                  /* .d8t offset                        */
+};
+
+struct AuditOptions
+{
+    uint32_t  maxDim;               /* edges above this are "oversized"    */
+    AuditSort sort;
+    unsigned  threads;              /* read workers, 0 → all cores         */
+
+    AuditOptions() : maxDim(1024), sort(kAuditByCost), threads(0) {}
+};
+
+struct AuditRow
+{
+    std::string bank;               /* .d8w file name                     */
+    uint32_t    pack, idx;
+    uint32_t    offset, bytes;
+    uint32_t    type, width, height, mips;
+    uint32_t    refs;               /* headers sharing this body          */
+    uint32_t    flags;              /* AuditFlag bits                     */
+    uint32_t    colour;             /* BGRA of a solid texture            */
+    uint64_t    hash;
+    uint64_t    savings;            /* bytes the suggestion would free    */
+    std::string suggestion;         /* empty → nothing to gain            */
+};
+
+struct AuditReport
+{
+    size_t   banks, bodies;
+    uint64_t bytes;                 /* distinct body bytes                */
+    uint64_t savings;               /* per distinct body                  */
+    size_t   flagged;               /* rows with any flag                 */
+    std::vector<AuditRow> rows;
+
+    AuditReport() : banks(0), bodies(0), bytes(0), savings(0), flagged(0) {}
+};
+
+bool parseAuditSort(const char* s, AuditSort& out);   /* cost | savings | name | offset */
+
+/* "oversized|opaque", "" for none */
+std::string auditFlagNames(uint32_t flags);
+
+/* d8wPaths: banks on d8tPath (findCompanionBanks for all of them).
+   Rows come back sorted by opt.sort.  Status set on failure.       */
+bool auditArchive(const std::string& d8tPath, const std::vector<std::string>& d8wPaths,
+                  const AuditOptions& opt, AuditReport& report);
+
+/* the report as CSV (header row + one line per texture) or as one
+   JSON object {"banks":…, "textures":[…]}                          */
+void writeAuditCSV (const AuditReport& r, std::string& out);
+void writeAuditJSON(const AuditReport& r, std::string& out);
+
+}
+#endif
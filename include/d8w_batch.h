@@ -0,0 +1,35 @@
+#ifndef JUICED_D8W_BATCH_H_
+#define JUICED_D8W_BATCH_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_batch.h  –  manifest-driven execution (-batch)
+   The manifest holds the same JSON requests -serve accepts, one
+   per line (blank lines and '#' comments skipped) or as a single
+   JSON array.
+
+   ‣ every referenced .d8t / .d8w is loaded once
+   ‣ runs of reads are sorted by .d8t offset, then spread over
+     the worker pool;  writes keep manifest order
+   ‣ saves are deferred: one per dirty archive, at the end
+   ‣ the result log is JSONL in manifest order plus a summary line
+  ──────────────────────────────────────────────────────────────*/
+#include <string>
+
+namespace juiced
+{
+
+struct BatchOptions
+{
+    std::string logPath;            /* empty → stdout                   */
+    unsigned    threads;            /* worker count, 0 → all cores      */
+    bool        save;               /* false → imports stay unsaved     */
+    bool        index;              /* use / refresh .d8idx sidecars    */
+
+    BatchOptions() : threads(0), save(true), index(false) {}
+};
+
+/* returns the process exit code: 0 all ok, 3 any op failed */
+int runBatch(const std::string& manifestPath, const BatchOptions& opt);
+
+}
+#endif
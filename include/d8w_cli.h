@@ -0,0 +1,19 @@
+#ifndef JUICED_D8W_CLI_H_
+#define JUICED_D8W_CLI_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_cli.h  –  the command-line verbs, wx-free
+   Shared by the headless d8wcli binary and the GUI executable,
+   which hands any "-verb" command line straight to runCLI.
+  ──────────────────────────────────────────────────────────────*/
+
+namespace juiced
+{
+
+void printUsage();
+
+/* argv[1] is the verb; returns the process exit code */
+int runCLI(int argc, char** argv);
+
+}
+#endif
@@ -0,0 +1,94 @@
+#ifndef JUICED_D8W_COMMANDS_H_
+#define JUICED_D8W_COMMANDS_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_commands.h  –  JSON command executor over resident archives
+   Shared by -serve and -batch.  Archives stay loaded between
+   calls; read verbs run side by side, anything that mutates an
+   archive runs alone on it.  Requests on different archives never
+   wait for each other.
+
+   request : {"id":7,"op":"export","d8t":"…","d8w":"…","pack":0,
+              "idx":3,"out":"…"}
+   reply   : {"id":7,"ok":true, …}  /  {"id":7,"ok":false,"error":"…"}
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_archive.h"
+#include "d8w_json.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace juiced
+{
+
+class CommandHost
+{
+public:
+    /* thread-safe; always fills reply, returns reply["ok"] */
+    bool execute(const json::Value& cmd, json::Value& reply);
+
+    /* one request line → one reply line (no trailing '\n') */
+    std::string executeLine(const std::string& line);
+
+    /* default for archives opened without an "index" flag (.d8idx) */
+    void setUseIndex(bool on) { useIndex_ = on; }
+
+    /* set by the "shutdown" op */
+    bool shutdownRequested() const { return shutdown_; }
+
+    /* op classification: unknown ops are neither */
+    static bool isReadOp (const std::string& op);
+    static bool isWriteOp(const std::string& op);
+
+    /* where a read op lands in its .d8t (texture or table start);
+       false if the archive / bank / texture is not resident      */
+    bool extentOf(const json::Value& cmd, uint32_t& fileOff);
+
+private:
+    typedef bool (CommandHost::*Handler)(const json::Value&, json::Value&);
+
+    /* one archive and the reader/writer lock its requests take; the
+       entry stays after "close" (arc null) so a waiter never finds
+       its lock gone                                                 */
+    struct Resident
+    {
+        std::shared_timed_mutex  lock;
+        std::unique_ptr<Archive> arc;
+    };
+    typedef std::shared_ptr<Resident> ResidentPtr;
+
+    ResidentPtr resident(const std::string& d8t, bool create);
+    Archive* findArchive(const std::string& d8t) const;
+    Archive* openArchive(const json::Value& cmd, json::Value& reply);
+    D8WBank* resolveBank(const json::Value& cmd, json::Value& reply, bool load);
+
+    /* readers (archive's shared lock) */
+    bool opPing      (const json::Value&, json::Value&);
+    bool opStatus    (const json::Value&, json::Value&);
+    bool opList      (const json::Value&, json::Value&);
+    bool opInspect   (const json::Value&, json::Value&);
+    bool opExport    (const json::Value&, json::Value&);
+    bool opExportSet (const json::Value&, json::Value&);
+    bool opConvert   (const json::Value&, json::Value&);
+    bool opConvertSet(const json::Value&, json::Value&);
+
+    /* writers (archive's exclusive lock) */
+    bool opOpen      (const json::Value&, json::Value&);
+    bool opClose     (const json::Value&, json::Value&);
+    bool opImport    (const json::Value&, json::Value&);
+    bool opImportSet (const json::Value&, json::Value&);
+    bool opSave      (const json::Value&, json::Value&);
+    bool opShutdown  (const json::Value&, json::Value&);
+
+    mutable std::mutex                   mapM_;      /* archives_ look-ups only */
+    std::map<std::string, ResidentPtr>   archives_;
+    std::atomic<bool>                    shutdown_{false};
+    bool                                 useIndex_ = false;
+};
+
+}
+#endif
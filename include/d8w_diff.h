@@ -0,0 +1,72 @@
+#ifndef JUICED_D8W_DIFF_H_
+#define JUICED_D8W_DIFF_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_diff.h  –  what changed between two versions of an archive
+   (-diff)
+
+   ‣ banks pair up by their name after the .d8t stem (c.d8w ↔
+     d.d8w, c_1.d8w ↔ d_1.d8w), textures by (bank, pack, index)
+   ‣ every distinct body of both .d8t files is hashed once, in
+     offset order, on all cores – that pass is the whole cost of
+     an unchanged texture
+   ‣ only pairs whose hashes differ are opened again, to count
+     the compressed blocks that actually changed
+   ‣ a texture that vanished in one place and shows up with the
+     same body in another is reported as moved
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+struct DiffOptions
+{
+    unsigned threads;               /* hashing workers, 0 → all cores      */
+    bool     blocks;                /* count changed blocks of re-encodes  */
+
+    DiffOptions() : threads(0), blocks(true) {}
+};
+
+struct DiffEntry
+{
+    enum Kind
+    {
+        kAdded,                     /* only in B                          */
+        kRemoved,                   /* only in A                          */
+        kMoved,                     /* same body, other (bank, pack, idx) */
+        kResized,                   /* width / height / mip count         */
+        kReencoded,                 /* same size, other body or format    */
+        kHeader                     /* body equal, unk07 … unk13 differ   */
+    };
+    Kind        kind;
+    std::string where;              /* "c.d8w 0 3" (A side unless added)   */
+    std::string detail;
+};
+
+struct DiffReport
+{
+    size_t   banksA, banksB;
+    size_t   texturesA, texturesB;
+    size_t   same;
+    uint64_t bytesHashed;           /* both sides                         */
+    std::vector<std::string> banksAdded, banksRemoved;
+    std::vector<DiffEntry>   entries;
+
+    DiffReport() : banksA(0), banksB(0), texturesA(0), texturesB(0),
+                   same(0), bytesHashed(0) {}
+    size_t count(DiffEntry::Kind k) const;
+    bool   identical() const { return entries.empty() && banksAdded.empty() && banksRemoved.empty(); }
+};
+
+const char* diffKindName(DiffEntry::Kind k);
+
+/* false when either side can't be read – Status set */
+bool diffArchives(const std::string& d8tA, const std::string& d8tB,
+                  const DiffOptions& opt, DiffReport& report);
+
+}
+#endif
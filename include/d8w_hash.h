@@ -0,0 +1,40 @@
+#ifndef JUICED_D8W_HASH_H_
+#define JUICED_D8W_HASH_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_hash.h  –  64-bit content hash (XXH64)
+   Stable across platforms and builds: values are written into
+   .d8idx sidecars, verify manifests and .d8p patches.  ~10 GB/s
+   per core.
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace juiced
+{
+
+uint64_t hash64(const void* data, size_t n, uint64_t seed = 0);
+
+/* hash64 chained over fixed 1 MB blocks: a stream hashes the same
+   whatever pieces it is fed in, so a file can be checked while it
+   is copied instead of in a second pass                          */
+class StreamHash
+{
+public:
+    StreamHash() : h_(0), total_(0) {}
+
+    void     add(const void* data, size_t n);
+    uint64_t value() const;
+    uint64_t total() const { return total_; }
+
+    /* same as feeding [data, data+n) to a fresh StreamHash */
+    static uint64_t of(const void* data, size_t n);
+
+private:
+    uint64_t             h_, total_;
+    std::vector<uint8_t> part_;         /* < one block, not yet hashed */
+};
+
+}
+#endif
@@ -0,0 +1,107 @@
+#ifndef JUICED_D8W_HISTORY_H_
+#define JUICED_D8W_HISTORY_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_history.h  –  undo / redo of staged imports
+
+   Registered on a context, EditHistory sees every body replacement
+   (SpliceObserver) and keeps its inverse: offset, both headers and
+   the old body – by reference when the .d8t on disk still holds it
+   (header not modified), copied only when it came from an earlier
+   import.  Undo / redo go back through D8WBank::replaceBody, so
+   they cost the bytes of the bodies they swap, never a reload.
+
+   ‣ attach right after loading (banks clean) – file references
+     are offsets into the .d8t as it was then; a .d8t that changed
+     on disk since makes undo fail instead of reading wrong bytes
+   ‣ clear() after a save or reload; banks must outlive the steps
+   ‣ copies are capped at maxBytes, the oldest steps go first
+   ‣ same threading rules as the context (one writer)
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+class EditHistory : public SpliceObserver
+{
+public:
+    /* d8tPath: the file the context's buffer was read from; empty →
+       every old body is copied                                      */
+    EditHistory(D8WContext& ctx, const std::string& d8tPath,
+                size_t maxBytes = size_t(256) << 20);
+    ~EditHistory();
+
+    /* everything replaced in between is one step (importTextureSet);
+       without a group each replacement is its own "Import" step      */
+    void beginGroup(const std::string& label);
+    void endGroup();
+
+    bool canUndo() const { return !done_.empty(); }
+    bool canRedo() const { return !undone_.empty(); }
+    std::string undoLabel() const { return done_.empty()   ? std::string() : done_.back().label; }
+    std::string redoLabel() const { return undone_.empty() ? std::string() : undone_.back().label; }
+
+    /* one step each; Status set on failure, the step is left as it was */
+    bool undo();
+    bool redo();
+
+    /* forget every step, re-stamp the .d8t (it now matches the buffer) */
+    void clear();
+
+    size_t steps() const     { return done_.size() + undone_.size(); }
+    size_t heldBytes() const { return held_; }
+
+    void beforeSplice(D8WBank& bank, const BodySplice& sp, const TextureHdrEx& old, bool modified);
+
+private:
+    struct Edit
+    {
+        D8WBank*          bank;
+        uint32_t          pos, oldSize, newSize;
+        TextureHdr        oldHdr, newHdr;
+        bool              oldModified;
+        int64_t           src;          /* old body's .d8t offset, -1 → oldBody */
+        std::vector<BYTE> oldBody;
+        std::vector<BYTE> newBody;      /* only while undone                    */
+    };
+    struct Step
+    {
+        std::string       label;
+        std::vector<Edit> edits;
+    };
+    /* a replacement currently applied, oldest first – maps a body's
+       offset back to where the file has it                          */
+    struct Shift
+    {
+        uint32_t pos, oldSize, newSize;
+    };
+
+    EditHistory(const EditHistory&);
+    EditHistory& operator=(const EditHistory&);
+
+    int64_t sourceOf(uint32_t pos, uint32_t size) const;
+    bool    revert(Edit& e);
+    bool    reapply(Edit& e);
+    void    trim();
+
+    D8WContext&        ctx_;
+    std::string        path_;
+    plat::FileInfo     stamp_;
+    bool               backed_;         /* file references allowed      */
+    size_t             maxBytes_, held_;
+    bool               replaying_;
+    int                group_;          /* beginGroup depth              */
+    bool               open_;           /* the group's step is pushed    */
+    std::string        label_;
+    std::vector<Step>  done_, undone_;
+    std::vector<Shift> applied_;
+};
+
+}
+#endif
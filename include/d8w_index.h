@@ -0,0 +1,53 @@
+#ifndef JUICED_D8W_INDEX_H_
+#define JUICED_D8W_INDEX_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_index.h  –  .d8idx sidecar: the parsed catalogue of one
+   .d8t and its banks, so a reopen skips every .d8w parse
+
+   Layout (little-endian, sections 8-byte aligned, offsets from
+   the start of the file – mappable as is):
+     IdxHeader
+     IdxBank  × banks      file size / mtime / hash, header, ranges
+     IdxTable × tables     skip, size, absOff, first texture
+     IdxTex   × textures   48-byte TextureHdr + resolved fileOff
+     IdxSet   × sets       name + range into the index column
+     int32    × set cells
+     IdxRef   × refs       (fileOff, bank, pack, tex) by offset –
+                           runs of one offset are the groups the
+                           reference index shares across banks
+     blob                  paths and opaque tails
+
+   Valid only while every file matches: .d8t size, mtime and a
+   sampled hash; each .d8w size, mtime and full hash; the bank
+   list itself.  Anything else → the caller parses as usual.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+/* <dir>/<stem>.d8idx next to the .d8t */
+std::string indexPathFor(const std::string& d8tPath);
+
+/* banks[i] was loaded from d8wPaths[i] against tBuf (the .d8t) */
+bool writeIndex(const std::string& idxPath, const std::string& d8tPath,
+                const std::vector<BYTE>& tBuf,
+                const std::vector<std::string>& d8wPaths,
+                const std::vector<const D8WBank*>& banks);
+
+/* validate, then adopt one bank per path into ctx; false with
+   why filled (missing, stale, damaged) and nothing attached      */
+bool readIndex(const std::string& idxPath, const std::string& d8tPath,
+               const std::vector<BYTE>& tBuf,
+               const std::vector<std::string>& d8wPaths,
+               D8WContext& ctx,
+               std::vector< std::unique_ptr<D8WBank> >& banks,
+               std::string* why = 0);
+
+}
+#endif
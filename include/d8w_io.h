@@ -0,0 +1,78 @@
+#ifndef JUICED_D8W_IO_H_
+#define JUICED_D8W_IO_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_io.h  –  offset-sorted, coalescing read scheduler
+
+   Collect (offset, size) requests against one file, then run():
+   ‣ requests are sorted by offset and merged into runs when they
+     overlap, touch, or sit closer than mergeGap (reading a small
+     hole beats a seek on spinning disks and network shares)
+   ‣ each run is one large sequential read; the next run is read
+     ahead while the current one is handed out, and the OS gets
+     sequential / will-need hints where it takes them
+   ‣ sink(tag, data, size) fires once per request, in offset
+     order per run, spread over worker threads
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace juiced
+{
+
+struct IoStats
+{
+    uint64_t requests;              /* add() calls                       */
+    uint64_t runs;                  /* sequential reads issued           */
+    uint64_t bytesWanted;           /* sum of request sizes              */
+    uint64_t bytesRead;             /* incl. merged holes / overlaps     */
+
+    IoStats() : requests(0), runs(0), bytesWanted(0), bytesRead(0) {}
+};
+
+class ReadScheduler
+{
+public:
+    typedef std::function<void(size_t tag, const uint8_t* data, uint32_t size)> Sink;
+
+    explicit ReadScheduler(uint32_t mergeGap = 256u << 10, uint32_t maxRun = 16u << 20);
+
+    void   add(uint64_t off, uint32_t size, size_t tag);
+    size_t pending() const { return reqs_.size(); }
+
+    /* false if the file can't be opened or any request failed;
+       the sink is still called for every request that was read  */
+    bool run(const std::string& path, const Sink& sink, unsigned threads = 0);
+
+    const IoStats&             stats()      const { return stats_; }
+    const std::string&         error()      const { return err_;   }
+    const std::vector<size_t>& failedTags() const { return failed_; }
+
+private:
+    struct Req { uint64_t off; uint32_t size; size_t tag; };
+    struct Run { uint64_t off; uint64_t len; size_t first, last; };   /* [first,last) */
+
+    void plan(std::vector<Run>& runs) const;
+
+    uint32_t            gap_, maxRun_;
+    std::vector<Req>    reqs_;
+    IoStats             stats_;
+    std::string         err_;
+    std::vector<size_t> failed_;
+};
+
+/* hash64 of every (offset, size) extent of one file: read in offset
+   order through a ReadScheduler and hashed on its workers.  sums[i]
+   belongs to ext[i]; read[i] is 0 where it could not be read (the
+   call then returns false, why names the error)                    */
+typedef std::pair<uint64_t, uint32_t> FileExtent;
+
+bool hashExtents(const std::string& path, const std::vector<FileExtent>& ext,
+                 std::vector<uint64_t>& sums, std::vector<char>& read,
+                 unsigned threads = 0, IoStats* stats = 0, std::string* why = 0);
+
+}
+#endif
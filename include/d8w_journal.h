@@ -0,0 +1,96 @@
+#ifndef JUICED_D8W_JOURNAL_H_
+#define JUICED_D8W_JOURNAL_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_journal.h  –  .d8j session journal: staged edits survive a
+   crash until they are saved
+
+   Registered on a context, SessionJournal appends every body
+   replacement (imports, undo, redo – SpliceObserver) to
+   <stem>.d8j next to the .d8t:
+
+     JHeader                  magic, .d8t size + mtime it applies to
+     JRecord + stored body    × edits, in the order they happened
+
+   Bodies are deflated when that pays.  Records collect in memory
+   and go to disk with one write + fsync per flush() – the caller
+   flushes once per command (a set import is one sync) – or when
+   the batch outgrows JournalOptions::batchBytes.  Each record
+   carries an XXH64 of itself: a crash mid-write leaves a torn
+   tail that reading stops at, never a wrong body.
+
+   replay() folds every record into one net splice per touched
+   body, then applies them in one spliceBatch + one applySplices –
+   each body is inflated and copied once, the banks on disk are
+   left alone.  A save makes the journal obsolete: reset().
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+/* <dir>/<stem>.d8j next to the .d8t */
+std::string journalPathFor(const std::string& d8tPath);
+
+struct JournalOptions
+{
+    size_t batchBytes;              /* flush on its own past this          */
+    int    level;                   /* deflate level of bodies, 0 → stored */
+
+    JournalOptions() : batchBytes(size_t(8) << 20), level(1) {}
+};
+
+class SessionJournal : public SpliceObserver
+{
+public:
+    /* banks already loaded into ctx from d8tPath; reads what an
+       earlier session left but changes nothing yet               */
+    SessionJournal(D8WContext& ctx, const std::string& d8tPath,
+                   const JournalOptions& o = JournalOptions());
+    ~SessionJournal();              /* flushes */
+
+    /* intact records left for this very .d8t (0 → none, stale, other file) */
+    size_t leftover() const { return left_; }
+
+    /* bring the loaded banks to where those records left them and
+       keep appending; Status set on failure (nothing applied)     */
+    bool replay();
+
+    /* drop whatever is there, start an empty journal for the .d8t
+       as it is on disk now – after open (not replaying) and save  */
+    bool reset();
+
+    /* pending records → disk, fsync; false once a write failed   */
+    bool flush();
+
+    /* no journal file any more (clean close) */
+    void remove();
+
+    const std::string& path() const { return path_; }
+    bool ok() const { return !failed_; }
+
+    void beforeSplice(D8WBank& bank, const BodySplice& sp, const TextureHdrEx& old, bool modified);
+
+private:
+    SessionJournal(const SessionJournal&);
+    SessionJournal& operator=(const SessionJournal&);
+
+    bool start(size_t keep);        /* live file = first keep bytes + appends */
+
+    D8WContext&       ctx_;
+    std::string       d8tPath_, path_;
+    JournalOptions    opt_;
+    std::vector<BYTE> old_;         /* the earlier session's file          */
+    size_t            left_, good_; /* its intact records / bytes          */
+    plat::File        file_;
+    std::vector<BYTE> batch_;       /* records not yet written             */
+    bool              failed_;
+};
+
+}
+#endif
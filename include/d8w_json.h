@@ -0,0 +1,88 @@
+#ifndef JUICED_D8W_JSON_H_
+#define JUICED_D8W_JSON_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_json.h  –  tiny JSON value for the command protocol
+   One request / reply per line; objects keep insertion order so
+   replies read the way they were built.
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace juiced
+{
+namespace json
+{
+
+class Value
+{
+public:
+    enum Kind { kNull, kBool, kNumber, kString, kArray, kObject };
+
+    Value()                        : kind_(kNull),   b_(false), n_(0) {}
+    Value(bool b)                  : kind_(kBool),   b_(b),     n_(0) {}
+    Value(int n)                   : kind_(kNumber), b_(false), n_(n) {}
+    Value(unsigned n)              : kind_(kNumber), b_(false), n_(n) {}
+    Value(int64_t n)               : kind_(kNumber), b_(false), n_((double)n) {}
+    Value(uint64_t n)              : kind_(kNumber), b_(false), n_((double)n) {}
+    Value(double n)                : kind_(kNumber), b_(false), n_(n) {}
+    Value(const char* s)           : kind_(kString), b_(false), n_(0), s_(s) {}
+    Value(const std::string& s)    : kind_(kString), b_(false), n_(0), s_(s) {}
+
+    static Value array()  { Value v; v.kind_ = kArray;  return v; }
+    static Value object() { Value v; v.kind_ = kObject; return v; }
+
+    Kind kind() const { return kind_; }
+    bool isNull()   const { return kind_ == kNull;   }
+    bool isString() const { return kind_ == kString; }
+    bool isNumber() const { return kind_ == kNumber; }
+    bool isArray()  const { return kind_ == kArray;  }
+    bool isObject() const { return kind_ == kObject; }
+
+    bool               asBool()   const { return kind_ == kBool ? b_ : n_ != 0; }
+    double             asNumber() const { return n_; }
+    const std::string& asString() const { return s_; }
+
+    /* arrays */
+    size_t       size() const                 { return kind_ == kObject ? obj_.size() : arr_.size(); }
+    const Value& at(size_t i) const           { return arr_[i]; }
+    Value&       push(const Value& v)         { arr_.push_back(v); return arr_.back(); }
+
+    /* objects – find() returns NULL when the key is absent */
+    const Value* find(const std::string& key) const;
+    Value&       set (const std::string& key, const Value& v);
+    const std::string& keyAt(size_t i) const  { return obj_[i].first; }
+    const Value&       valAt(size_t i) const  { return obj_[i].second; }
+
+    /* typed look-ups with a fallback */
+    std::string str (const std::string& key, const std::string& def = "") const;
+    double      num (const std::string& key, double def = 0) const;
+    bool        flag(const std::string& key, bool def = false) const;
+    bool        has (const std::string& key) const { return find(key) != 0; }
+
+    /* compact, single-line serialisation */
+    std::string dump() const;
+    void        dump(std::string& out) const;
+
+private:
+    Kind                                        kind_;
+    bool                                        b_;
+    double                                      n_;
+    std::string                                 s_;
+    std::vector<Value>                          arr_;
+    std::vector< std::pair<std::string,Value> > obj_;
+};
+
+/* full document → Value;  false + err on malformed input */
+bool parse(const char* text, size_t n, Value& out, std::string& err);
+inline bool parse(const std::string& text, Value& out, std::string& err)
+{ return parse(text.data(), text.size(), out, err); }
+
+/* "…" with JSON escapes */
+void quote(const std::string& s, std::string& out);
+
+}
+}
+#endif
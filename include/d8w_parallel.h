@@ -0,0 +1,62 @@
+#ifndef JUICED_D8W_PARALLEL_H_
+#define JUICED_D8W_PARALLEL_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_parallel.h  –  tiny fork/join helper for the batch paths
+
+   parallelFor(n, fn) calls fn(i) for every i in [0,n) on up to
+   hardwareThreads() workers.  Work is handed out in chunks from
+   one atomic counter, so uneven items (big/small textures) still
+   balance.  Runs inline when n is small or only one core exists.
+  ──────────────────────────────────────────────────────────────*/
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace juiced
+{
+
+inline unsigned hardwareThreads()
+{
+    const unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+template<typename Fn>
+void parallelFor(size_t n, Fn fn, unsigned threads = 0, size_t grain = 1)
+{
+    if (n == 0) return;
+    if (threads == 0) threads = hardwareThreads();
+    if (grain   == 0) grain   = 1;
+
+    const size_t chunks = (n + grain - 1) / grain;
+    if (threads > chunks) threads = (unsigned)chunks;
+
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            const size_t beg = next.fetch_add(grain);
+            if (beg >= n) break;
+            const size_t end = (beg + grain < n) ? beg + grain : n;
+            for (size_t i = beg; i < end; ++i) fn(i);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) pool.push_back(std::thread(worker));
+    worker();                                   /* caller works too */
+    for (size_t t = 0; t < pool.size(); ++t) pool[t].join();
+}
+
+}
+#endif
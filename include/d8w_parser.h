@@ -1,17 +1,43 @@
 #ifndef JUICED_D8W_PARSER_H_
 #define JUICED_D8W_PARSER_H_
 
-#include <windows.h>
+#include "d8w_platform.h"
+#include <map>
 #include <string>
 #include <vector>
 #include <stdint.h>
 
-extern std::string gLastErr;
+namespace juiced
+{
+
+/* ─── per-operation status ────────────────────────────────────
+   The outermost StatusScope on a thread starts a fresh Status;
+   SETERR / setError fill it in.  Thread-local, so concurrent
+   calls – same archive or not – never see each other's errors.  */
+struct Status
+{
+    bool        ok;
+    const char* op;                 /* "load", "import", … (literal) */
+    std::string error;
 
+    Status() : ok(true), op("") {}
+};
 
+const Status& lastStatus();         /* calling thread's last operation */
+inline const std::string& lastError() { return lastStatus().error; }
 
-namespace juiced
+/* printf-style; marks the current Status failed, returns false */
+bool setError(const char* fmt, ...);
+
+class StatusScope
 {
+public:
+    explicit StatusScope(const char* op);
+    ~StatusScope();
+private:
+    StatusScope(const StatusScope&);
+    StatusScope& operator=(const StatusScope&);
+};
 
 template<typename T> T LEread (const BYTE*& p);
 template<typename T> void LEwrite(BYTE*& p, T v);
@@ -35,6 +61,7 @@ bool modified;
 };
 
 class D8WBank;
+class D8WContext;
 
 struct Reference
 {
@@ -63,6 +90,80 @@ std::vector<int32_t> indexTable;
 
 typedef std::vector<BYTE> UnknownTailRaw;
 
+/* a bank as the .d8idx reader rebuilds it – see D8WBank::adopt */
+struct BankImage
+{
+uint32_t header[3];                 /* totalTex, tblCnt, totalSz           */
+std::vector<TextureTable> tables;   /* tex + absOff filled, refs left empty */
+std::vector<TextureSet> sets;
+UnknownTailRaw tail;
+};
+
+/* one body replacement at a .d8t offset – see D8WBank::applySplices */
+struct BodySplice
+{
+uint32_t pos;                       /* old body, offsets before any splice */
+uint32_t oldSize;
+uint32_t newSize;
+TextureHdr hdr;                     /* new header, hdr.size == newSize      */
+const BYTE* body;                   /* newSize bytes, for spliceBatch       */
+};
+
+/* sees every body replacement made by importTexture / replaceBody
+   before any byte moves: the old body is still at sp.pos in
+   bank.tBuffer(), old is the header it had, modified the flag the
+   new one gets (EditHistory, SessionJournal)                     */
+class SpliceObserver
+{
+public:
+    virtual ~SpliceObserver() {}
+    virtual void beforeSplice(D8WBank& bank, const BodySplice& sp,
+                              const TextureHdrEx& old, bool modified) = 0;
+};
+
+/* knobs for importTexture */
+struct ImportOptions
+{
+int      quality;       /* bc::Quality – 0 fast, 1 normal, 2 high      */
+int      mipFilter;     /* MipFilter   – 0 box, 1 kaiser                */
+uint32_t maxMips;       /* cap on the imported chain, 0 = slot's count  */
+bool     fitMips;       /* rebuild DDS/DDT chains to the slot's count   */
+
+ImportOptions() : quality(1), mipFilter(0), maxMips(0), fitMips(true) {}
+};
+
+/* what convertTexture writes, picked by the output's extension:
+   DDS keeps the body as it is, PNG / TGA get the top mip decoded  */
+enum ConvertFormat { kConvertDDS, kConvertPNG, kConvertTGA };
+
+bool          parseConvertFormat(const char* s, ConvertFormat& f);  /* dds | png | tga */
+ConvertFormat convertFormatOf(const std::string& path);             /* unknown → DDS   */
+const char*   convertExt(ConvertFormat f);                          /* "dds", …        */
+
+/* one file importTextureSet takes from dir and the slot it goes to */
+struct ImportFile
+{
+size_t      slot;
+std::string name;
+};
+
+/* the .ddt / .dds / .png / .tga files of dir named for a slot of pack
+   the way exportTextureSet / convertTextureSet name them (Tex<pack><slot
+   as %04d>), by slot; other names are left out.  false (Status set) if
+   dir can't be listed or two files name the same slot                  */
+bool listImportFiles(const std::string& dir, size_t pack, std::vector<ImportFile>& files);
+
+/* knobs for convertTexture / convertTextureSet – per call, so
+   concurrent converts off one bank (daemon) can differ          */
+struct ConvertOptions
+{
+int      format;        /* ConvertFormat of convertTextureSet's files    */
+int      level;         /* PNG deflate – 0 store, 1 fast … 9 smallest    */
+unsigned threads;       /* convertTextureSet workers, 0 = all cores      */
+
+ConvertOptions() : format(kConvertDDS), level(1), threads(0) {}
+};
+
 class D8TFile
 {
 public:
@@ -78,16 +179,68 @@ std::string pathT_;
 std::vector<BYTE> buf_;
 };
 
+/* ─── bank registry + reference index ─────────────────────────
+   Banks that share a .d8t must share a context: an import shifts
+   every registered bank and patches every Reference at the old
+   offset.  Contexts share nothing with each other, so separate
+   archives can be worked on from separate threads.  One context
+   is not thread-safe for writers (serialise imports / loads).   */
+class D8WContext
+{
+public:
+    D8WContext() {}
+    ~D8WContext();
+
+    /* for callers that never pick one (GUI, one-shot CLI verbs) */
+    static D8WContext& shared();
+
+    size_t   bankCount() const          { return banks_.size(); }
+    D8WBank* bankAt(size_t i) const     { return i < banks_.size() ? banks_[i] : 0; }
+    size_t   refCount() const;
+
+    void rebuildIndex();
+    /* same, from (offset, ref) pairs already in offset order (.d8idx) */
+    void rebuildIndex(const std::vector< std::pair<uint32_t, Reference*> >& sorted);
+
+    /* not owned; called in registration order */
+    void addObserver   (SpliceObserver* o);
+    void removeObserver(SpliceObserver* o);
+
+private:
+    friend class D8WBank;
+    typedef std::map< uint32_t, std::vector<Reference*> > RefMap;
+
+    D8WContext(const D8WContext&);
+    D8WContext& operator=(const D8WContext&);
+
+    void attach(D8WBank* b);
+    void detach(D8WBank* b);
+    bool isLive(const D8WBank* b) const;
+
+    std::vector<D8WBank*>        banks_;
+    RefMap                       refs_;
+    std::vector<SpliceObserver*> observers_;
+};
+
 class D8WBank
 {
 public:
 D8WBank(); ~D8WBank();
-    /* allow GUI to fetch the last parser error */
-    const std::string& lastError() const { return gLastErr; }
+explicit D8WBank(D8WContext& ctx);
+    /* error of the calling thread's last parser call */
+    const std::string& lastError() const { return juiced::lastError(); }
+    D8WContext& context() const { return *ctx_; }
 
 bool load(const std::string& d8wPath,
 const std::vector<BYTE>& sharedTbuf);
 bool save(const std::string& outW,const std::string& outT);
+/* the .d8w bytes save() writes, without touching disk or state */
+void serialize(std::vector<BYTE>& out) const;
+
+/* take a pre-parsed catalogue instead of reading the .d8w (img is
+   consumed); reindex=false leaves the context index to the caller */
+bool adopt(const std::string& d8wPath,
+const std::vector<BYTE>& sharedTbuf, BankImage& img, bool reindex);
 
 const std::string& d8wPath() const { return pathW_; }
 const std::string& d8tPath() const { return pathT_; }
@@ -101,12 +254,42 @@ bool isDirty() const { return dirty_; }
 
 bool exportTexture (size_t p,size_t i,const std::string& outDdt) const;
 bool exportTextureSet (size_t p,const std::string& outDir) const;
-bool convertTexture (size_t p,size_t i,const std::string& outDds) const;
-bool convertTextureSet(size_t p,const std::string& outDir) const;
+bool convertTexture (size_t p,size_t i,const std::string& out,           /* .dds/.png/.tga */
+                     const ConvertOptions& o = ConvertOptions()) const;
+bool convertTextureSet(size_t p,const std::string& outDir,
+                       const ConvertOptions& o = ConvertOptions()) const;
 bool importTexture (size_t p,size_t i,const std::string& inFile);
+bool importTexture (size_t p,size_t i,const std::string& inFile,        /* o: this call only */
+                    const ImportOptions& o);
+
+/* same, body supplied by the caller (extent read straight off disk) */
+bool exportTexture (size_t p,size_t i,const std::string& outDdt,const BYTE* body) const;
+bool convertTexture (size_t p,size_t i,const std::string& out,const BYTE* body,
+                     const ConvertOptions& o = ConvertOptions()) const;
 bool importTextureSet (size_t p,const std::string& dir);
+bool importTextureSet (size_t p,const std::string& dir,const ImportOptions& o);
+
+/* the bytes exportTexture / convertTexture would write, APPENDED to
+   out – for writers that don't make one file per texture (d8w_tar) */
+bool exportTextureBytes (size_t p,size_t i,const BYTE* body,std::vector<BYTE>& out) const;
+bool convertTextureBytes(size_t p,size_t i,ConvertFormat f,const BYTE* body,
+                         std::vector<BYTE>& out,const ConvertOptions& o = ConvertOptions()) const;
+
+/* header side of body replacements the caller already applied to
+   the .d8t bytes: shifts every bank on the same .d8t, re-points the
+   replaced bodies' references (d8w_patch, importTexture)          */
+bool applySplices(const std::vector<BodySplice>& s);
+
+/* one body swap, bytes and headers: observers, spliceReplace on the
+   .d8t, applySplices; the re-pointed headers get modified (undo)  */
+bool replaceBody(const BodySplice& sp, bool modified = true);
+
+/* what importTexture / importTextureSet use when given no options */
+void setImportOptions(const ImportOptions& o) { importOpt_ = o; }
+const ImportOptions& importOptions() const { return importOpt_; }
 
 const UnknownTailRaw& tailData() const { return tailRaw_; }
+const std::vector<TextureSet>& sets() const { return texSet_; }
 
 std::vector<TextureTable>& tables() { return texBuf_; }
 const std::vector<TextureTable>& tables() const { return texBuf_; }
@@ -114,11 +297,14 @@ const std::vector<TextureTable>& tables() const { return texBuf_; }
 std::vector<BYTE>* tBuffer() const { return tBuf_; }
 
 private:
+friend class D8WContext;
 
 bool loadFileToMem(const std::string& p,std::vector<BYTE>& dst) const;
+void wireRefs();
 bool locateD8T(const std::string& folder,const std::string& stem,
 const std::string& hint,std::string& out) const;
 
+D8WContext* ctx_;
 bool dirty_;
 bool headerFixed;
 
@@ -130,7 +316,20 @@ std::vector<BYTE>* tBuf_;
 std::vector<TextureTable> texBuf_;
 std::vector<TextureSet> texSet_;
 UnknownTailRaw tailRaw_;
+
+ImportOptions importOpt_;
 };
 
+/* parser internals, reachable for tools/bench only */
+namespace detail
+{
+bool spliceReplace(std::vector<BYTE>& big, uint32_t abs, uint32_t oldSz,
+                   const BYTE* newData, uint32_t newSz, int32_t& delta);
+
+/* every splice of s (sorted, non-overlapping) in one copy of src */
+bool spliceBatch(const std::vector<BYTE>& src, const std::vector<BodySplice>& s,
+                 std::vector<BYTE>& out);
+}
+
 }
 #endif
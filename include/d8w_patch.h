@@ -0,0 +1,54 @@
+#ifndef JUICED_D8W_PATCH_H_
+#define JUICED_D8W_PATCH_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_patch.h  –  .d8p delta patches (-mkpatch / -applypatch)
+
+   A patch lists the texture bodies one archive replaced in the
+   other – original offset / size, new header, new body (deflated
+   unless that doesn't pay) – so a mod ships and applies in time
+   and space proportional to the change, not to the .d8t.
+
+   Layout (little-endian, field by field):
+     header   "D8WP", version, .d8t size + StreamHash before and
+              after, bank count, body count
+     bank  ×  name, .d8w size + hash64 before and after, optional
+              deflated .d8w (only when the new one isn't what the
+              header shift reproduces, e.g. another tool saved it)
+     body  ×  pos, old size, new size, flags, hash64 of the old
+              body, 44-byte TextureHdr, payload
+
+   Applying streams the original .d8t once, front to back, into
+   the new one (hashes checked on the fly) and rebuilds each .d8w
+   through D8WBank::applySplices – the same shift importTexture
+   does.  In place, results go through temp files and are only
+   moved over the originals once every hash matched.
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace juiced
+{
+
+struct PatchStats
+{
+    size_t   banks;                 /* .d8w files in the archive          */
+    size_t   bodies;                /* replaced texture bodies            */
+    uint64_t bodyBytes;             /* their size, uncompressed           */
+    uint64_t patchBytes;            /* size of the .d8p                   */
+
+    PatchStats() : banks(0), bodies(0), bodyBytes(0), patchBytes(0) {}
+};
+
+/* diff two versions of one archive (same banks, same texture
+   layout; only bodies / headers may differ) into outPatch       */
+bool makePatch(const std::string& origD8t, const std::string& modD8t,
+               const std::string& outPatch, PatchStats* stats = 0);
+
+/* patch d8tPath and its companion banks; outDir empty → in place */
+bool applyPatch(const std::string& patchPath, const std::string& d8tPath,
+                const std::string& outDir = std::string(), PatchStats* stats = 0);
+
+}
+#endif
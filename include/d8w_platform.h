@@ -0,0 +1,124 @@
+#ifndef JUICED_D8W_PLATFORM_H_
+#define JUICED_D8W_PLATFORM_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_platform.h  –  the only OS surface the core touches
+
+   One implementation per OS in d8w_platform.cpp (Win32 / POSIX).
+   Paths are UTF-8 / ANSI strings; either separator is accepted
+   on every platform ('\\' is mapped to '/' on POSIX, since
+   manifests and CLI lines often come from Windows users), and
+   join() emits the native one.
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* same type <windows.h> declares – repeating the typedef is legal */
+typedef unsigned char BYTE;
+
+namespace juiced
+{
+namespace plat
+{
+
+#ifdef _WIN32
+const char kSep = '\\';
+#else
+const char kSep = '/';
+#endif
+
+class File
+{
+public:
+    enum Mode
+    {
+        kRead,                      /* shared with writers, sequential hint */
+        kWrite,                     /* create or truncate                   */
+        kAppend                     /* create or keep, every write at end   */
+    };
+
+    File();
+    ~File();
+
+    bool     open(const std::string& path, Mode m);
+    bool     openStdout();          /* binary, own handle: close() keeps stdout */
+    void     close();
+    bool     isOpen() const;
+    uint64_t size() const;          /* 0 on error */
+
+    /* all-or-nothing; large counts are split internally */
+    bool read(void* dst, size_t n);
+    bool readAt(uint64_t off, void* dst, size_t n) const;
+    bool write(const void* src, size_t n);
+    bool sync();                    /* written bytes to stable storage      */
+
+    /* prefetch hint, no-op where the OS has none */
+    void willNeed(uint64_t off, uint64_t n) const;
+
+private:
+    File(const File&);
+    File& operator=(const File&);
+
+    intptr_t h_;                    /* HANDLE or fd; -1 when closed */
+};
+
+/* whole file, refused above maxBytes; dst cleared on failure */
+bool readFile(const std::string& path, std::vector<BYTE>& dst, uint64_t maxBytes);
+bool writeFile(const std::string& path, const void* data, size_t n);
+
+/* mtime is in native ticks (100 ns / ns) – compare, don't convert */
+struct FileInfo
+{
+    uint64_t size;
+    int64_t  mtime;
+};
+
+bool fileInfo(const std::string& path, FileInfo& out);
+bool exists(const std::string& path);
+bool isDir(const std::string& path);
+bool makeDir(const std::string& path);              /* true if already there */
+bool removeFile(const std::string& path);
+bool moveFile(const std::string& from, const std::string& to);  /* replaces to */
+
+/* plain files (no directories) directly in dir, unsorted */
+bool listFiles(const std::string& dir, std::vector<std::string>& names);
+
+/* change notification for one directory: inotify on Linux,
+   FindFirstChangeNotification on Win32; elsewhere wait() only
+   sleeps and says "maybe" – callers rescan either way           */
+class DirWatch
+{
+public:
+    DirWatch();
+    ~DirWatch();
+
+    bool open(const std::string& dir);
+    void close();
+    bool native() const;            /* real events, not a timer        */
+
+    /* true once something in dir changed (or, polling, once timeoutMs
+       passed); false on timeout; timeoutMs < 0 waits forever         */
+    bool wait(int timeoutMs);
+
+private:
+    DirWatch(const DirWatch&);
+    DirWatch& operator=(const DirWatch&);
+
+    intptr_t h_;                    /* notification HANDLE / inotify fd */
+};
+
+std::string join(const std::string& dir, const std::string& name);
+
+/* ASCII case-insensitive compare / prefix / extension test */
+int  icmp(const char* a, const char* b);
+int  nicmp(const char* a, const char* b, size_t n);
+bool hasExt(const std::string& name, const char* ext);  /* ext incl. '.' */
+
+/* debug pop-up on Windows, stderr elsewhere */
+void debugBox(const char* caption, const char* text);
+
+}
+}
+#endif
@@ -0,0 +1,69 @@
+#ifndef JUICED_D8W_REPACK_H_
+#define JUICED_D8W_REPACK_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_repack.h  –  rewrite a .d8t without holes or duplicates
+   (-repack)
+
+   The unit of layout is the texture table: a table's bodies sit
+   back to back and set indices name them by position, so only
+   whole tables move.  Tables whose extents overlap travel as one
+   span.
+
+   ‣ gaps (skip bytes, superseded bodies, trailing bytes nothing
+     references) are dropped
+   ‣ byte-identical spans collapse into one extent every bank
+     points at – unless that would make some bank's tables run
+     backwards (skip is unsigned), then they stay apart
+   ‣ spans are laid out by bank, by pack index or by heat, each
+     bank's tables still in their own order; optionally every
+     span starts on an align boundary (zero fill)
+   ‣ the .d8t is written front to back in one pass, every .d8w is
+     rebuilt from the new offsets; in place, results go through
+     temp files and replace the originals at the end
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace juiced
+{
+
+enum RepackOrder
+{
+    kRepackByBank,                  /* bank 0's tables, then bank 1's …   */
+    kRepackByPack,                  /* table 0 of every bank, table 1 …   */
+    kRepackByHeat                   /* hottest first (heatPath or sharing) */
+};
+
+struct RepackOptions
+{
+    RepackOrder order;
+    uint32_t    align;              /* power of two, 0 / 1 → packed        */
+    bool        coalesce;           /* share byte-identical spans          */
+    std::string heatPath;           /* "<bank.d8w> <pack> <hits>" lines    */
+    unsigned    threads;            /* hashing workers, 0 → all cores      */
+
+    RepackOptions() : order(kRepackByBank), align(0), coalesce(true), threads(0) {}
+};
+
+struct RepackStats
+{
+    size_t   banks, tables;
+    size_t   spans;                 /* written                            */
+    size_t   coalesced;             /* spans dropped as duplicates        */
+    uint64_t bytesIn, bytesOut;     /* .d8t before / after                */
+    uint64_t padBytes;              /* alignment fill                     */
+
+    RepackStats() : banks(0), tables(0), spans(0), coalesced(0),
+                    bytesIn(0), bytesOut(0), padBytes(0) {}
+};
+
+bool parseRepackOrder(const char* s, RepackOrder& out);   /* bank | pack | heat */
+
+/* d8tPath and its companion banks; outDir empty → in place */
+bool repackArchive(const std::string& d8tPath, const RepackOptions& opt,
+                   const std::string& outDir = std::string(), RepackStats* stats = 0);
+
+}
+#endif
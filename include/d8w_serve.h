@@ -0,0 +1,32 @@
+#ifndef JUICED_D8W_SERVE_H_
+#define JUICED_D8W_SERVE_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_serve.h  –  long-running daemon front-end (-serve)
+   Newline-delimited JSON in, one reply line per request out.
+   Requests are handed to a worker pool, so replies may arrive
+   out of order – match them by "id".
+
+   stdio  : requests on stdin, replies on stdout
+   socket : Unix domain socket, any number of clients (POSIX)
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_commands.h"
+
+#include <string>
+
+namespace juiced
+{
+
+struct ServeOptions
+{
+    std::string socketPath;         /* empty → stdin / stdout           */
+    unsigned    threads;            /* worker count, 0 → all cores      */
+
+    ServeOptions() : threads(0) {}
+};
+
+/* returns the process exit code */
+int serve(CommandHost& host, const ServeOptions& opt);
+
+}
+#endif
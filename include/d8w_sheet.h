@@ -0,0 +1,52 @@
+#ifndef JUICED_D8W_SHEET_H_
+#define JUICED_D8W_SHEET_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_sheet.h  –  contact sheets: every texture of a pack, bank
+   or archive as labelled tiles on paged PNGs (-contactsheet)
+
+   Headless – no wx.  Pages are built in batches: the bodies a
+   batch needs go through one ReadScheduler run (offset order,
+   merged reads) and each is decoded, at the smallest mip that
+   covers the tile, on the scheduler's workers straight into its
+   cell; then the batch's pages are PNG-encoded in parallel.
+   Memory stays at one batch of pages, whatever the archive size.
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+struct SheetOptions
+{
+    uint32_t tile;                  /* thumb edge in pixels                */
+    uint32_t cols, rows;            /* tiles per page                      */
+    bool     labels;                /* Tex<set><idx> / offset / format     */
+    int      level;                 /* PNG deflate level, 0 = store        */
+    unsigned threads;               /* 0 → all cores                       */
+
+    SheetOptions() : tile(128), cols(8), rows(6), labels(true), level(6), threads(0) {}
+};
+
+struct SheetStats
+{
+    size_t   textures;              /* tiles drawn                        */
+    size_t   failed;                /* … of which couldn't be decoded     */
+    size_t   sheets;                /* PNGs written                       */
+    uint64_t bytesRead, bytesWritten;
+
+    SheetStats() : textures(0), failed(0), sheets(0), bytesRead(0), bytesWritten(0) {}
+};
+
+/* one page series per bank: <bank stem>_NNN.png, or
+   <bank stem>_TexSet<p>_NNN.png when pack >= 0 picks one pack.
+   d8wPaths empty → every companion bank of d8tPath.             */
+bool writeContactSheets(const std::string& d8tPath, const std::vector<std::string>& d8wPaths,
+                        int pack, const std::string& outDir,
+                        const SheetOptions& opt, SheetStats* stats = 0);
+
+}
+#endif
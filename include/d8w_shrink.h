@@ -0,0 +1,50 @@
+#ifndef JUICED_D8W_SHRINK_H_
+#define JUICED_D8W_SHRINK_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_shrink.h  –  drop alpha that carries nothing (-shrink)
+
+   Every DXT3 / DXT5 body whose alpha blocks all decode to 255 is
+   rewritten as DXT1: the colour half of each block is kept (see
+   bc::transcodeToDXT1), so the pixels are unchanged and the body
+   halves – on disk and in the game's texture memory.
+
+   ‣ alpha is scanned on all cores, SSE2 two blocks per compare
+   ‣ a body shared by several headers is only touched when they
+     all agree on it; overlapping extents are left alone
+   ‣ every rewrite goes through one spliceBatch over the .d8t and
+     one applySplices, then each .d8w is rebuilt; in place,
+     results replace the originals only once all are written
+  ──────────────────────────────────────────────────────────────*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace juiced
+{
+
+struct ShrinkOptions
+{
+    bool     dryRun;                /* report only, write nothing          */
+    unsigned threads;               /* scan workers, 0 → all cores         */
+
+    ShrinkOptions() : dryRun(false), threads(0) {}
+};
+
+struct ShrinkStats
+{
+    size_t   banks;
+    size_t   bodies;                /* distinct DXT3 / DXT5 bodies         */
+    size_t   opaque;                /* … rewritten as DXT1                 */
+    size_t   skipped;               /* shared two ways / overlapping / odd */
+    uint64_t bytesIn, bytesOut;     /* .d8t before / after                 */
+
+    ShrinkStats() : banks(0), bodies(0), opaque(0), skipped(0), bytesIn(0), bytesOut(0) {}
+};
+
+/* d8tPath and its companion banks; outDir empty → in place */
+bool shrinkArchive(const std::string& d8tPath, const ShrinkOptions& opt,
+                   const std::string& outDir = std::string(), ShrinkStats* stats = 0);
+
+}
+#endif
@@ -0,0 +1,82 @@
+#ifndef JUICED_D8W_SYNC_H_
+#define JUICED_D8W_SYNC_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_sync.h  –  incremental folder → pack import (-sync)
+
+   Same mapping as importTextureSet (listImportFiles: Tex<pack>NNNN
+   → slot NNNN), but a file is only imported when it changed.  The
+   <dir>/.d8wsync cache remembers, per file, its slot, size, mtime
+   and XXH64, and the XXH64 of the body the import left in the
+   bank:
+
+   ‣ same slot, size, mtime and bank body  → skipped, not even read
+   ‣ touched but same content              → skipped, cache updated
+   ‣ .ddt whose header and body are the slot's already → skipped
+   ‣ anything else                         → importTexture
+
+   A bank body that no longer hashes to the cached value (edited
+   elsewhere) makes its file count as changed.  The cache is only
+   trusted for the bank and pack it was written for.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace juiced
+{
+
+/* <dir>/.d8wsync */
+std::string syncCachePath(const std::string& dir);
+
+struct SyncStats
+{
+    size_t files;                   /* mapped to a slot                    */
+    size_t unchanged;               /* size + mtime match, not read        */
+    size_t identical;               /* read, same content as the bank has  */
+    size_t imported;
+    size_t failed;
+
+    SyncStats() : files(0), unchanged(0), identical(0), imported(0), failed(0) {}
+};
+
+class FolderSync
+{
+public:
+    /* bank loaded with its .d8t in memory; reads the cache if it
+       belongs to this bank (file name) and pack                  */
+    FolderSync(D8WBank& bank, size_t pack, const std::string& dir);
+
+    /* one pass over dir; dryRun counts what would be imported.
+       false (Status set) only when dir or the pack is unusable –
+       files that fail to import are counted and retried next pass */
+    bool run(SyncStats& st, bool dryRun = false);
+
+    /* after the bank was saved: the cache describes it now */
+    bool saveCache();
+
+private:
+    struct Entry
+    {
+        uint32_t slot;
+        uint64_t size;
+        int64_t  mtime;
+        uint64_t fileHash;
+        uint64_t bodyHash;
+    };
+    typedef std::map<std::string, Entry> Cache;     /* by file name */
+
+    uint64_t bodyHash(size_t idx) const;
+
+    D8WBank&    bank_;
+    size_t      pack_;
+    std::string dir_;
+    Cache       cache_;
+    bool        dirty_;                             /* cache_ ≠ file */
+};
+
+}
+#endif
@@ -0,0 +1,85 @@
+#ifndef JUICED_D8W_TAR_H_
+#define JUICED_D8W_TAR_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_tar.h  –  bulk export as one ustar stream (-exporttar)
+
+   A set, a bank or a whole archive goes into a single .tar (or
+   stdout) instead of one file per texture: no per-file create /
+   close on the target share, and the stream pipes straight into
+   a packaging step.  Members follow .d8t offset order; bodies are
+   read a window at a time through ReadScheduler, turned into
+   member bytes on its workers, and written through one large
+   buffer while the next window is read.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+/* POSIX ustar, regular files only; buffered, sequential writes */
+class TarWriter
+{
+public:
+    explicit TarWriter(size_t bufBytes = 8u << 20);
+    ~TarWriter();
+
+    bool open(const std::string& path);                 /* "-" → stdout */
+
+    /* one member, head then body; name ≤ 255 bytes with a '/' split
+       at most 155 in.  Status set on failure                          */
+    bool add(const std::string& name, const void* head, size_t headSize,
+             const void* body = 0, uint64_t bodySize = 0);
+
+    bool     finish();                                  /* end blocks, flush, close */
+    uint64_t bytes() const { return total_; }
+
+private:
+    TarWriter(const TarWriter&);
+    TarWriter& operator=(const TarWriter&);
+
+    bool put(const void* p, size_t n);
+    bool flush();
+
+    plat::File           f_;
+    std::vector<uint8_t> buf_;
+    size_t               used_;
+    uint64_t             total_;
+    int64_t              mtime_;
+};
+
+/* one member: texture (pack, idx) of bank, stored under name */
+struct TarEntry
+{
+    const D8WBank* bank;
+    size_t         pack, idx;
+    std::string    name;
+};
+
+/* every texture of bank (pack < 0) or of one pack, named
+   <prefix>Tex<p><iiii>.<ext> like the *Set exports; ext is "ddt"
+   or convertExt(format)                                           */
+void addTarEntries(const D8WBank& bank, int pack, const std::string& prefix,
+                   const char* ext, std::vector<TarEntry>& out);
+
+struct TarStats
+{
+    size_t   members;
+    uint64_t bytesRead, bytesWritten;
+
+    TarStats() : members(0), bytesRead(0), bytesWritten(0) {}
+};
+
+/* convert: false → .ddt members, true → conv.format (DDS / PNG / TGA);
+   banks may be header-only loads – bodies come off d8tPath           */
+bool exportTar(const std::string& d8tPath, const std::vector<TarEntry>& entries,
+               const std::string& tarPath, bool convert, const ConvertOptions& conv,
+               TarStats* stats = 0);
+
+}
+#endif
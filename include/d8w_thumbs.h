@@ -0,0 +1,98 @@
+#ifndef JUICED_D8W_THUMBS_H_
+#define JUICED_D8W_THUMBS_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_thumbs.h  –  texture thumbnails, wx-free
+
+   ‣ decodeThumb decodes the smallest mip level that still covers
+     the tile edge (a 2048² DXT5 thumbnailed at 96 px decodes its
+     128² level, 1/256 of the work) and box-filters it to fit
+   ‣ ThumbCache runs decodeThumb-style jobs on background workers
+     for whatever a view currently shows – want() replaces the
+     queue, so scrolling past a cell drops its pending decode –
+     and keeps the results in an LRU bounded by bytes
+  ──────────────────────────────────────────────────────────────*/
+#include "ImageIO.h"
+#include "d8w_parser.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace juiced
+{
+
+/* deepest level of h whose larger side is still ≥ edge (0 if none) */
+uint32_t thumbLevel(const TextureHdr& h, uint32_t edge);
+
+/* body = h.size bytes; out fits in edge × edge, aspect kept */
+bool decodeThumb(const TextureHdr& h, const BYTE* body, size_t size,
+                 uint32_t edge, RawImage& out);
+
+/* src → out scaled (area average) to fit edge × edge, never up */
+void fitThumb(const RawImage& src, uint32_t edge, RawImage& out);
+
+class ThumbCache
+{
+public:
+    typedef std::shared_ptr<const RawImage> Thumb;
+
+    /* decode runs on a worker (false → cached as failed, empty);
+       ready runs on that worker once the result is in the cache */
+    typedef std::function<bool(uint64_t key, RawImage& out)> Decoder;
+    typedef std::function<void(uint64_t key)>                 Notify;
+
+    ThumbCache(const Decoder& decode, const Notify& ready,
+               size_t budgetBytes = size_t(64) << 20, unsigned threads = 0);
+    ~ThumbCache();
+
+    /* cached thumb or null; a hit counts as recent use */
+    Thumb lookup(uint64_t key);
+
+    /* decode these next, first key first; anything queued before
+       and not listed again is dropped                            */
+    void want(const std::vector<uint64_t>& keys);
+
+    /* drop queue and cache, wait for decodes in flight – call
+       before the bodies the decoder reads change or go away     */
+    void clear();
+
+    size_t bytes() const;
+
+private:
+    ThumbCache(const ThumbCache&);
+    ThumbCache& operator=(const ThumbCache&);
+
+    struct Entry
+    {
+        Thumb                         img;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    void run();
+    void evict();                   /* m_ held */
+
+    Decoder                   decode_;
+    Notify                    ready_;
+    size_t                    budget_, bytes_;
+
+    mutable std::mutex        m_;
+    std::condition_variable   cv_, idle_;
+    std::deque<uint64_t>      queue_;
+    std::set<uint64_t>        busy_;
+    std::map<uint64_t, Entry> cache_;
+    std::list<uint64_t>       lru_;         /* front = most recent */
+    unsigned                  gen_;         /* bumped by clear()   */
+    bool                      stop_;
+    std::vector<std::thread>  workers_;
+};
+
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef JUICED_D8W_TRACE_H_
+#define JUICED_D8W_TRACE_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_trace.h  –  always-compiled, runtime-toggled instrumentation
+
+   ‣ D8W_TRACE_SCOPE("name")  times the enclosing block
+   ‣ trace::count(kX, n)      bumps one of the fixed counters
+   Both cost one relaxed atomic load while tracing is off.
+
+   When on, scopes are kept as complete events and written as
+   Chrome trace-event JSON (chrome://tracing, Perfetto) or folded
+   into a per-name summary table.  Names must be string literals
+   (the pointer is stored, not the text).
+  ──────────────────────────────────────────────────────────────*/
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+namespace juiced
+{
+namespace trace
+{
+
+enum Counter
+{
+    kBytesRead,             /* whole-file loads + scheduled extents  */
+    kBytesWritten,          /* .d8w / .d8t / exported files         */
+    kSpliceCalls,
+    kSpliceMoved,           /* bytes shifted or copied by a splice  */
+    kIndexRebuilds,
+    kIndexRefs,             /* references visited by rebuilds       */
+    kCounterCount
+};
+
+extern std::atomic<bool> gOn;
+
+inline bool enabled() { return gOn.load(std::memory_order_relaxed); }
+void enable(bool on);
+void reset();                               /* drop events, zero counters */
+
+void     add(Counter c, uint64_t n);
+inline void count(Counter c, uint64_t n = 1) { if (enabled()) add(c, n); }
+uint64_t value(Counter c);
+const char* counterName(Counter c);
+
+class Scope
+{
+public:
+    explicit Scope(const char* name) : name_(enabled() ? name : 0), t0_(name_ ? now() : 0) {}
+    ~Scope() { if (name_) close(); }
+
+private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+
+    static uint64_t now();                  /* µs since the trace epoch */
+    void close();
+
+    const char* name_;
+    uint64_t    t0_;
+};
+
+/* {"traceEvents":[…]} – "X" per scope, "C" per counter; path "-" → stdout */
+bool writeChrome(const std::string& path);
+
+/* name / calls / total / mean / max, then counters */
+std::string summary();
+
+}
+}
+
+#define D8W_TRACE_CAT2(a, b) a##b
+#define D8W_TRACE_CAT(a, b)  D8W_TRACE_CAT2(a, b)
+#define D8W_TRACE_SCOPE(name) \
+    ::juiced::trace::Scope D8W_TRACE_CAT(d8wTraceScope_, __LINE__)(name)
+
+#endif
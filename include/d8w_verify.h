@@ -0,0 +1,62 @@
+#ifndef JUICED_D8W_VERIFY_H_
+#define JUICED_D8W_VERIFY_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_verify.h  –  consistency check of a .d8t against its banks
+   (-verify)
+
+   ‣ structure: every table and texture extent inside the .d8t,
+     textures inside their table, no 32-bit offset wrap, and no
+     partial overlap between extents of any bank (an identical
+     extent in several banks is the normal shared case)
+   ‣ content:   one XXH64 per distinct extent, read in offset
+     order through ReadScheduler and hashed on every core
+   ‣ manifest:  optional text file of those checksums, written by
+     one run and compared by the next
+
+       # d8w verify manifest 1
+       <d8w file name> <pack> <idx> <size> <hash, 16 hex digits>
+
+   Gaps between extents are counted, not flagged – the format
+   puts skips between tables on purpose.
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+
+struct VerifyOptions
+{
+    std::string manifestIn;         /* compare against; empty → none   */
+    std::string manifestOut;        /* write checksums; empty → none   */
+    unsigned    threads;            /* hashing workers, 0 → all cores  */
+    bool        checksums;          /* false → structure only          */
+
+    VerifyOptions() : threads(0), checksums(true) {}
+};
+
+struct VerifyReport
+{
+    size_t   banks, tables, textures;
+    size_t   extents;               /* distinct (offset, size) pairs   */
+    uint64_t d8tBytes;
+    uint64_t bytesHashed;
+    uint64_t gapBytes;              /* .d8t bytes no texture covers    */
+    std::vector<std::string> problems;
+
+    VerifyReport() : banks(0), tables(0), textures(0), extents(0),
+                     d8tBytes(0), bytesHashed(0), gapBytes(0) {}
+    bool ok() const { return problems.empty(); }
+};
+
+/* false only when the check itself could not run (.d8t missing,
+   manifest unreadable / unwritable) – Status set.  Damage found
+   in the files goes to report.problems.                          */
+bool verifyArchive(const std::string& d8tPath,
+                   const std::vector<std::string>& d8wPaths,
+                   const VerifyOptions& opt, VerifyReport& report);
+
+}
+#endif
@@ -0,0 +1,669 @@
+/*───────────────────────────────────────────────────────────────
+   BCEncoder.cpp  –  DXT1/3/5 + ATI2 block compression
+  ──────────────────────────────────────────────────────────────*/
+#include "BCEncoder.h"
+#include "d8w_parallel.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define D8W_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+using namespace juiced;
+
+namespace
+{
+
+/* ─── 565 helpers – expansion must match the GPU / decoder ──── */
+inline uint16_t pack565(int r, int g, int b)
+{
+    return (uint16_t)((((r * 31 + 127) / 255) << 11) |
+                      (((g * 63 + 127) / 255) <<  5) |
+                       ((b * 31 + 127) / 255));
+}
+
+inline void unpack565(uint16_t c, uint8_t* bgra)
+{
+    const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    bgra[0] = (uint8_t)((b << 3) | (b >> 2));
+    bgra[1] = (uint8_t)((g << 2) | (g >> 4));
+    bgra[2] = (uint8_t)((r << 3) | (r >> 2));
+    bgra[3] = 0;
+}
+
+/* palette in BGRA order, alpha byte left 0 (ignored by the search) */
+static void buildPalette(uint16_t c0, uint16_t c1, bool four, uint8_t pal[4][4])
+{
+    unpack565(c0, pal[0]);
+    unpack565(c1, pal[1]);
+    for (int k = 0; k < 3; ++k)
+    {
+        const int a = pal[0][k], b = pal[1][k];
+        if (four)
+        {
+            pal[2][k] = (uint8_t)((2 * a + b) / 3);
+            pal[3][k] = (uint8_t)((a + 2 * b) / 3);
+        }
+        else
+        {
+            pal[2][k] = (uint8_t)((a + b) / 2);
+            pal[3][k] = 0;
+        }
+    }
+    pal[2][3] = pal[3][3] = 0;
+}
+
+/* ─── nearest palette entry per texel (RGB squared error) ───── */
+static uint32_t selectIndices(const uint8_t* px, const uint8_t pal[4][4],
+                              int nPal, uint8_t idx[16])
+{
+#ifdef D8W_SSE2
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i noA   = _mm_set1_epi32(0x00FFFFFF);
+    __m128i       best[4], bidx[4];
+    __m128i       palv[4];
+    int k, g;
+
+    for (k = 0; k < nPal; ++k)
+    {
+        uint32_t c; std::memcpy(&c, pal[k], 4);
+        palv[k] = _mm_set1_epi32((int)(c & 0x00FFFFFF));
+    }
+
+    for (g = 0; g < 4; ++g)                          /* 4 groups of 4 texels */
+    {
+        const __m128i p = _mm_and_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(px + g * 16)), noA);
+        const __m128i plo = _mm_unpacklo_epi8(p, zero);
+        const __m128i phi = _mm_unpackhi_epi8(p, zero);
+
+        for (k = 0; k < nPal; ++k)
+        {
+            const __m128i c  = _mm_unpacklo_epi8(palv[k], zero);
+            __m128i dlo = _mm_sub_epi16(plo, c), dhi = _mm_sub_epi16(phi, c);
+            dlo = _mm_madd_epi16(dlo, dlo);                  /* [bg ra] per texel */
+            dhi = _mm_madd_epi16(dhi, dhi);
+            dlo = _mm_add_epi32(dlo, _mm_shuffle_epi32(dlo, _MM_SHUFFLE(2,3,0,1)));
+            dhi = _mm_add_epi32(dhi, _mm_shuffle_epi32(dhi, _MM_SHUFFLE(2,3,0,1)));
+            const __m128i d = _mm_unpacklo_epi64(
+                _mm_shuffle_epi32(dlo, _MM_SHUFFLE(3,1,2,0)),
+                _mm_shuffle_epi32(dhi, _MM_SHUFFLE(3,1,2,0)));
+
+            if (k == 0) { best[g] = d; bidx[g] = zero; continue; }
+            const __m128i lt = _mm_cmplt_epi32(d, best[g]);
+            best[g] = _mm_or_si128(_mm_and_si128(lt, d), _mm_andnot_si128(lt, best[g]));
+            bidx[g] = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi32(k)),
+                                   _mm_andnot_si128(lt, bidx[g]));
+        }
+    }
+
+    uint32_t err = 0;
+    for (g = 0; g < 4; ++g)
+    {
+        uint32_t e[4], i[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(e), best[g]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(i), bidx[g]);
+        for (k = 0; k < 4; ++k) { idx[g * 4 + k] = (uint8_t)i[k]; err += e[k]; }
+    }
+    return err;
+#else
+    uint32_t err = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        const uint8_t* c = px + t * 4;
+        uint32_t bestE = 0xFFFFFFFFu; int bestK = 0;
+        for (int k = 0; k < nPal; ++k)
+        {
+            const int db = c[0] - pal[k][0], dg = c[1] - pal[k][1], dr = c[2] - pal[k][2];
+            const uint32_t e = (uint32_t)(db * db + dg * dg + dr * dr);
+            if (e < bestE) { bestE = e; bestK = k; }
+        }
+        idx[t] = (uint8_t)bestK;
+        err   += bestE;
+    }
+    return err;
+#endif
+}
+
+/* ─── endpoint search ──────────────────────────────────────── */
+struct Endpoints { int lo[3], hi[3]; };              /* B G R */
+
+static void boundingBox(const uint8_t* px, const bool* use, Endpoints& ep)
+{
+    int mn[3] = { 255, 255, 255 }, mx[3] = { 0, 0, 0 };
+#ifdef D8W_SSE2
+    if (!use)
+    {
+        __m128i vmn = _mm_set1_epi8((char)0xFF), vmx = _mm_setzero_si128();
+        for (int g = 0; g < 4; ++g)
+        {
+            const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px + g * 16));
+            vmn = _mm_min_epu8(vmn, p);
+            vmx = _mm_max_epu8(vmx, p);
+        }
+        uint8_t a[16], b[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a), vmn);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b), vmx);
+        for (int t = 0; t < 4; ++t)
+            for (int k = 0; k < 3; ++k)
+            {
+                mn[k] = std::min(mn[k], (int)a[t * 4 + k]);
+                mx[k] = std::max(mx[k], (int)b[t * 4 + k]);
+            }
+    }
+    else
+#endif
+    for (int t = 0; t < 16; ++t)
+    {
+        if (use && !use[t]) continue;
+        for (int k = 0; k < 3; ++k)
+        {
+            mn[k] = std::min(mn[k], (int)px[t * 4 + k]);
+            mx[k] = std::max(mx[k], (int)px[t * 4 + k]);
+        }
+    }
+
+    for (int k = 0; k < 3; ++k)                      /* inset by 1/16 range */
+    {
+        if (mn[k] > mx[k]) { mn[k] = mx[k] = 0; }
+        const int in = (mx[k] - mn[k]) >> 4;
+        ep.lo[k] = mn[k] + in;
+        ep.hi[k] = mx[k] - in;
+    }
+}
+
+static void principalAxis(const uint8_t* px, const bool* use, Endpoints& ep)
+{
+    float mean[3] = { 0, 0, 0 };
+    int   n = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        if (use && !use[t]) continue;
+        for (int k = 0; k < 3; ++k) mean[k] += px[t * 4 + k];
+        ++n;
+    }
+    if (!n) { boundingBox(px, use, ep); return; }
+    for (int k = 0; k < 3; ++k) mean[k] /= (float)n;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };               /* xx xy xz yy yz zz */
+    for (int t = 0; t < 16; ++t)
+    {
+        if (use && !use[t]) continue;
+        const float d0 = px[t * 4] - mean[0], d1 = px[t * 4 + 1] - mean[1],
+                    d2 = px[t * 4 + 2] - mean[2];
+        cov[0] += d0 * d0; cov[1] += d0 * d1; cov[2] += d0 * d2;
+        cov[3] += d1 * d1; cov[4] += d1 * d2; cov[5] += d2 * d2;
+    }
+
+    /* power iteration, seeded with the bounding-box diagonal */
+    Endpoints bb; boundingBox(px, use, bb);
+    float v[3] = { (float)(bb.hi[0] - bb.lo[0]) + 0.5f,
+                   (float)(bb.hi[1] - bb.lo[1]) + 0.5f,
+                   (float)(bb.hi[2] - bb.lo[2]) + 0.5f };
+    for (int it = 0; it < 6; ++it)
+    {
+        const float w0 = v[0] * cov[0] + v[1] * cov[1] + v[2] * cov[2];
+        const float w1 = v[0] * cov[1] + v[1] * cov[3] + v[2] * cov[4];
+        const float w2 = v[0] * cov[2] + v[1] * cov[4] + v[2] * cov[5];
+        const float m  = std::max(std::fabs(w0), std::max(std::fabs(w1), std::fabs(w2)));
+        if (m < 1e-6f) break;
+        v[0] = w0 / m; v[1] = w1 / m; v[2] = w2 / m;
+    }
+
+    float lo = 1e30f, hi = -1e30f;
+    int   ilo = 0, ihi = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        if (use && !use[t]) continue;
+        const float d = px[t * 4] * v[0] + px[t * 4 + 1] * v[1] + px[t * 4 + 2] * v[2];
+        if (d < lo) { lo = d; ilo = t; }
+        if (d > hi) { hi = d; ihi = t; }
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        ep.lo[k] = px[ilo * 4 + k];
+        ep.hi[k] = px[ihi * 4 + k];
+    }
+}
+
+/* least-squares endpoints for fixed indices (4-colour weights) */
+static bool refine(const uint8_t* px, const uint8_t idx[16], Endpoints& ep)
+{
+    static const float w[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0, ab = 0, bb = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+    for (int t = 0; t < 16; ++t)
+    {
+        const float a = w[idx[t]], b = 1.0f - a;
+        aa += a * a; ab += a * b; bb += b * b;
+        for (int k = 0; k < 3; ++k) { ax[k] += a * px[t * 4 + k]; bx[k] += b * px[t * 4 + k]; }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f) return false;
+    for (int k = 0; k < 3; ++k)
+    {
+        const float hi = (ax[k] * bb - bx[k] * ab) / det;      /* endpoint 0 */
+        const float lo = (bx[k] * aa - ax[k] * ab) / det;      /* endpoint 1 */
+        ep.hi[k] = std::min(255, std::max(0, (int)(hi + 0.5f)));
+        ep.lo[k] = std::min(255, std::max(0, (int)(lo + 0.5f)));
+    }
+    return true;
+}
+
+/* quantise, pick indices; returns error.  c0 = hi, c1 = lo */
+static uint32_t fitColour(const uint8_t* px, const Endpoints& ep, bool four,
+                          uint16_t& c0, uint16_t& c1, uint8_t idx[16])
+{
+    c0 = pack565(ep.hi[2], ep.hi[1], ep.hi[0]);
+    c1 = pack565(ep.lo[2], ep.lo[1], ep.lo[0]);
+    uint8_t pal[4][4];
+    buildPalette(c0, c1, four, pal);
+    return selectIndices(px, pal, four ? 4 : 3, idx);
+}
+
+static void writeColour(uint16_t c0, uint16_t c1, const uint8_t idx[16], uint8_t* out)
+{
+    uint32_t bits = 0;
+    for (int t = 0; t < 16; ++t) bits |= (uint32_t)idx[t] << (t * 2);
+    out[0] = (uint8_t)c0; out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)c1; out[3] = (uint8_t)(c1 >> 8);
+    out[4] = (uint8_t)bits;         out[5] = (uint8_t)(bits >> 8);
+    out[6] = (uint8_t)(bits >> 16); out[7] = (uint8_t)(bits >> 24);
+}
+
+/* 4-colour block (DXT1 opaque and the colour half of DXT3/5) */
+static void encodeColour4(const uint8_t* px, uint8_t* out, bc::Quality q)
+{
+    Endpoints ep;
+    if (q == bc::kFast) boundingBox(px, NULL, ep);
+    else                principalAxis(px, NULL, ep);
+
+    uint16_t c0, c1; uint8_t idx[16];
+    uint32_t err = fitColour(px, ep, true, c0, c1, idx);
+
+    if (q == bc::kHigh)
+    {
+        for (int it = 0; it < 2 && err; ++it)
+        {
+            Endpoints r = ep;
+            if (c0 == c1 || !refine(px, idx, r)) break;
+            uint16_t r0, r1; uint8_t ri[16];
+            const uint32_t e = fitColour(px, r, true, r0, r1, ri);
+            if (e >= err) break;
+            err = e; ep = r; c0 = r0; c1 = r1; std::memcpy(idx, ri, 16);
+        }
+    }
+
+    if (c0 == c1)                                    /* flat block */
+        std::memset(idx, 0, 16);
+    else if (c0 < c1)                                /* keep 4-colour mode */
+    {
+        std::swap(c0, c1);
+        for (int t = 0; t < 16; ++t) idx[t] ^= 1;    /* 0<->1, 2<->3 */
+    }
+    writeColour(c0, c1, idx, out);
+}
+
+/* 3-colour + transparent (DXT1 with 1-bit alpha) */
+static void encodeColour3(const uint8_t* px, const bool* opaque, uint8_t* out, bc::Quality q)
+{
+    Endpoints ep;
+    if (q == bc::kFast) boundingBox(px, opaque, ep);
+    else                principalAxis(px, opaque, ep);
+
+    uint16_t c0, c1; uint8_t idx[16];
+    fitColour(px, ep, false, c0, c1, idx);
+    if (c0 > c1)                                     /* 3-colour needs c0 <= c1 */
+    {
+        std::swap(c0, c1);
+        for (int t = 0; t < 16; ++t) if (idx[t] < 2) idx[t] ^= 1;
+    }
+    for (int t = 0; t < 16; ++t) if (!opaque[t]) idx[t] = 3;
+    writeColour(c0, c1, idx, out);
+}
+
+/* ─── BC4-style 8-entry alpha/channel block ────────────────── */
+static void alphaLut(int a0, int a1, uint8_t lut[8])
+{
+    lut[0] = (uint8_t)a0; lut[1] = (uint8_t)a1;
+    if (a0 > a1)
+        for (int k = 1; k <= 6; ++k) lut[1 + k] = (uint8_t)(((7 - k) * a0 + k * a1) / 7);
+    else
+    {
+        for (int k = 1; k <= 4; ++k) lut[1 + k] = (uint8_t)(((5 - k) * a0 + k * a1) / 5);
+        lut[6] = 0; lut[7] = 255;
+    }
+}
+
+static uint32_t alphaIndices(const uint8_t v[16], const uint8_t lut[8], uint8_t idx[16])
+{
+#ifdef D8W_SSE2
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    const __m128i val  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+    __m128i best = _mm_set1_epi8((char)0xFF), bi = _mm_setzero_si128();
+    for (int k = 0; k < 8; ++k)
+    {
+        const __m128i c  = _mm_set1_epi8((char)lut[k]);
+        const __m128i d  = _mm_or_si128(_mm_subs_epu8(val, c), _mm_subs_epu8(c, val));
+        const __m128i lt = _mm_cmplt_epi8(_mm_xor_si128(d, bias), _mm_xor_si128(best, bias));
+        best = _mm_min_epu8(best, d);
+        bi   = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi8((char)k)), _mm_andnot_si128(lt, bi));
+    }
+    uint8_t d[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(idx), bi);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), best);
+    uint32_t err = 0;
+    for (int t = 0; t < 16; ++t) err += (uint32_t)d[t] * d[t];
+    return err;
+#else
+    uint32_t err = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        int bestD = 256, bestK = 0;
+        for (int k = 0; k < 8; ++k)
+        {
+            const int d = std::abs((int)v[t] - (int)lut[k]);
+            if (d < bestD) { bestD = d; bestK = k; }
+        }
+        idx[t] = (uint8_t)bestK;
+        err   += (uint32_t)(bestD * bestD);
+    }
+    return err;
+#endif
+}
+
+static void encodeAlphaBlock(const uint8_t v[16], uint8_t* out, bc::Quality q)
+{
+    int mn = 255, mx = 0, mn6 = 255, mx6 = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        mn = std::min(mn, (int)v[t]); mx = std::max(mx, (int)v[t]);
+        if (v[t] != 0 && v[t] != 255) { mn6 = std::min(mn6, (int)v[t]); mx6 = std::max(mx6, (int)v[t]); }
+    }
+
+    uint8_t  lut[8], idx[16], bIdx[16];
+    int      b0, b1;
+    uint32_t bestErr;
+
+    if (mn == mx)                                     /* flat: a0 == a1 */
+    {
+        out[0] = out[1] = (uint8_t)mx;
+        std::memset(out + 2, 0, 6);
+        return;
+    }
+
+    b0 = mx; b1 = mn;                                 /* 8-interp, a0 > a1 */
+    alphaLut(b0, b1, lut);
+    bestErr = alphaIndices(v, lut, bIdx);
+
+    if (q == bc::kHigh)                               /* nudge endpoints inward */
+    {
+        for (int d0 = 0; d0 <= 2 && bestErr; ++d0)
+            for (int d1 = 0; d1 <= 2; ++d1)
+            {
+                const int a0 = mx - d0, a1 = mn + d1;
+                if ((d0 | d1) == 0 || a0 <= a1) continue;
+                alphaLut(a0, a1, lut);
+                const uint32_t e = alphaIndices(v, lut, idx);
+                if (e < bestErr) { bestErr = e; b0 = a0; b1 = a1; std::memcpy(bIdx, idx, 16); }
+            }
+    }
+
+    if (q != bc::kFast && (mn == 0 || mx == 255))     /* 6-interp + explicit 0/255 */
+    {
+        if (mn6 > mx6) mn6 = mx6 = mn == 0 ? 255 : 0;
+        alphaLut(mn6, mx6, lut);
+        const uint32_t e = alphaIndices(v, lut, idx);
+        if (e < bestErr) { bestErr = e; b0 = mn6; b1 = mx6; std::memcpy(bIdx, idx, 16); }
+    }
+
+    uint64_t bits = 0;
+    for (int t = 0; t < 16; ++t) bits |= (uint64_t)(bIdx[t] & 7) << (t * 3);
+    out[0] = (uint8_t)b0; out[1] = (uint8_t)b1;
+    for (int k = 0; k < 6; ++k) out[2 + k] = (uint8_t)(bits >> (k * 8));
+}
+
+/* ─── surface helpers ──────────────────────────────────────── */
+static void gatherBlock(const uint8_t* bgra, uint32_t w, uint32_t h,
+                        uint32_t bx, uint32_t by, uint8_t px[64])
+{
+    for (uint32_t y = 0; y < 4; ++y)
+    {
+        const uint32_t sy = std::min(by * 4 + y, h - 1);
+        const uint8_t* row = bgra + size_t(sy) * w * 4;
+        if (bx * 4 + 3 < w)
+            std::memcpy(px + y * 16, row + size_t(bx) * 16, 16);
+        else
+            for (uint32_t x = 0; x < 4; ++x)
+                std::memcpy(px + y * 16 + x * 4, row + size_t(std::min(bx * 4 + x, w - 1)) * 4, 4);
+    }
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                          public API
+   ───────────────────────────────────────────────────────────── */
+bool bc::isEncodable(uint32_t type)
+{
+    return type == kTypeDXT1 || type == kTypeDXT3 || type == kTypeDXT5 ||
+           type == kTypeATI2 || type == kTypeARGB;
+}
+
+uint32_t bc::blockBytes(uint32_t type)
+{
+    if (type == kTypeDXT1) return 8;
+    if (type == kTypeDXT3 || type == kTypeDXT5 || type == kTypeATI2) return 16;
+    return 0;
+}
+
+uint32_t bc::levelBytes(uint32_t type, uint32_t w, uint32_t h)
+{
+    const uint32_t blk = blockBytes(type);
+    if (!blk) return w * h * 4;
+    return std::max(1u, (w + 3) / 4) * std::max(1u, (h + 3) / 4) * blk;
+}
+
+uint32_t bc::fullMipCount(uint32_t w, uint32_t h)
+{
+    uint32_t n = 1, e = std::max(w, h);
+    while (e > 1) { e >>= 1; ++n; }
+    return n;
+}
+
+const char* bc::typeName(uint32_t type)
+{
+    switch (type)
+    {
+    case kTypeDXT1: return "DXT1";
+    case kTypeDXT3: return "DXT3";
+    case kTypeDXT5: return "DXT5";
+    case kTypeATI2: return "ATI2";
+    case kTypeARGB: return "ARGB8888";
+    default:        return "unknown";
+    }
+}
+
+/* exact test for one DXT5 alpha block: bit i of ok set when index i
+   is 255 whatever the decoder's interpolation rounding            */
+static bool dxt5Opaque(const uint8_t* b)
+{
+    const unsigned a0 = b[0], a1 = b[1];
+    unsigned ok;
+    if (a0 > a1) ok = a0 == 255 ? 0x01u : 0u;
+    else         ok = 0x80u | (a1 == 255 ? 0x02u : 0u) | (a0 == 255 ? 0x3Du : 0u);   /* a0 = 255 → a1 = 255 */
+    if (!ok) return false;
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) bits |= (uint64_t)b[2 + i] << (8 * i);
+    for (int i = 0; i < 16; ++i, bits >>= 3)
+        if (!((ok >> (bits & 7)) & 1)) return false;
+    return true;
+}
+
+static bool dxt3Opaque(const uint8_t* b)
+{
+    uint64_t a;
+    std::memcpy(&a, b, 8);
+    return a == ~uint64_t(0);
+}
+
+bool bc::alphaOpaque(uint32_t type, const uint8_t* body, size_t size)
+{
+    if ((type != kTypeDXT3 && type != kTypeDXT5) || !size || size % 16) return false;
+    bool (*exact)(const uint8_t*) = type == kTypeDXT5 ? dxt5Opaque : dxt3Opaque;
+
+    const size_t n = size / 16;
+    size_t j = 0;
+#ifdef D8W_SSE2
+    /* two alpha halves per compare: all 0xFF (DXT3, DXT5 index 7) or
+       a0 = 255 with every index 0 (what encoders emit for DXT5);
+       anything else gets the exact test                              */
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i keep = _mm_set1_epi64x((long long)0xFFFFFFFFFFFF00FFull);
+    const __m128i zero = _mm_set1_epi64x(0xFF);
+    for (; j + 2 <= n; j += 2)
+    {
+        const __m128i a = _mm_unpacklo_epi64(_mm_loadu_si128((const __m128i*)(body + j * 16)),
+                                             _mm_loadu_si128((const __m128i*)(body + j * 16 + 16)));
+        int m = _mm_movemask_epi8(_mm_cmpeq_epi8(a, ones));
+        if (type == kTypeDXT5)
+        {
+            const int z = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, keep), zero));
+            m = ((m & 0x00FF) == 0x00FF || (z & 0x00FF) == 0x00FF ? 0x00FF : 0) |
+                ((m & 0xFF00) == 0xFF00 || (z & 0xFF00) == 0xFF00 ? 0xFF00 : 0);
+        }
+        if (m == 0xFFFF) continue;
+        if ((m & 0x00FF) != 0x00FF && !exact(body + j * 16))      return false;
+        if ((m & 0xFF00) != 0xFF00 && !exact(body + j * 16 + 16)) return false;
+    }
+#endif
+    for (; j < n; ++j)
+        if (!exact(body + j * 16)) return false;
+    return true;
+}
+
+void bc::transcodeToDXT1(const uint8_t* body, size_t size, uint8_t* out)
+{
+    for (size_t j = 0; j < size / 16; ++j, body += 16, out += 8)
+    {
+        std::memcpy(out, body + 8, 8);
+        const uint16_t c0 = (uint16_t)(out[0] | (out[1] << 8));
+        const uint16_t c1 = (uint16_t)(out[2] | (out[3] << 8));
+        if (c0 > c1) continue;
+
+        uint32_t idx;
+        std::memcpy(&idx, out + 4, 4);
+        if (c0 == c1) idx = 0;                   /* every entry is c0 */
+        else
+        {
+            /* swapped endpoints: 0 <-> 1, 2 <-> 3 */
+            out[0] = (uint8_t)c1; out[1] = (uint8_t)(c1 >> 8);
+            out[2] = (uint8_t)c0; out[3] = (uint8_t)(c0 >> 8);
+            idx ^= 0x55555555u;
+        }
+        std::memcpy(out + 4, &idx, 4);
+    }
+}
+
+bool bc::parseQuality(const char* s, Quality& q)
+{
+    if (!s) return false;
+    if (!std::strcmp(s, "fast")   || !std::strcmp(s, "0")) { q = kFast;   return true; }
+    if (!std::strcmp(s, "normal") || !std::strcmp(s, "1")) { q = kNormal; return true; }
+    if (!std::strcmp(s, "high")   || !std::strcmp(s, "2")) { q = kHigh;   return true; }
+    return false;
+}
+
+void bc::encodeBlockDXT1(const uint8_t* px, uint8_t* out, Quality q, bool punchAlpha)
+{
+    if (punchAlpha)
+    {
+        bool opaque[16], anyClear = false;
+        for (int t = 0; t < 16; ++t) { opaque[t] = px[t * 4 + 3] >= 128; anyClear |= !opaque[t]; }
+        if (anyClear) { encodeColour3(px, opaque, out, q); return; }
+    }
+    encodeColour4(px, out, q);
+}
+
+void bc::encodeBlockDXT3(const uint8_t* px, uint8_t* out, Quality q)
+{
+    for (int t = 0; t < 16; t += 2)
+    {
+        const int a0 = (px[t * 4 + 3] * 15 + 127) / 255;
+        const int a1 = (px[t * 4 + 7] * 15 + 127) / 255;
+        out[t / 2] = (uint8_t)(a0 | (a1 << 4));
+    }
+    encodeColour4(px, out + 8, q);
+}
+
+void bc::encodeBlockDXT5(const uint8_t* px, uint8_t* out, Quality q)
+{
+    uint8_t a[16];
+    for (int t = 0; t < 16; ++t) a[t] = px[t * 4 + 3];
+    encodeAlphaBlock(a, out, q);
+    encodeColour4(px, out + 8, q);
+}
+
+/* X from byte 0, Y from byte 1 – where decodeATI2Block puts them */
+void bc::encodeBlockATI2(const uint8_t* px, uint8_t* out, Quality q)
+{
+    uint8_t x[16], y[16];
+    for (int t = 0; t < 16; ++t) { x[t] = px[t * 4 + 0]; y[t] = px[t * 4 + 1]; }
+    encodeAlphaBlock(x, out,     q);
+    encodeAlphaBlock(y, out + 8, q);
+}
+
+void bc::encodeSurface(const uint8_t* bgra, uint32_t w, uint32_t h,
+                       uint32_t type, Quality q, uint8_t* out)
+{
+    const uint32_t blk = blockBytes(type);
+    if (!blk) { std::memcpy(out, bgra, size_t(w) * h * 4); return; }
+
+    const uint32_t bw = (w + 3) / 4, bh = (h + 3) / 4;
+    parallelFor(bh, [&](size_t by)
+    {
+        uint8_t px[64];
+        uint8_t* dst = out + size_t(by) * bw * blk;
+        for (uint32_t bx = 0; bx < bw; ++bx, dst += blk)
+        {
+            gatherBlock(bgra, w, h, bx, (uint32_t)by, px);
+            switch (type)
+            {
+            case kTypeDXT1: encodeBlockDXT1(px, dst, q, true); break;
+            case kTypeDXT3: encodeBlockDXT3(px, dst, q);       break;
+            case kTypeDXT5: encodeBlockDXT5(px, dst, q);       break;
+            case kTypeATI2: encodeBlockATI2(px, dst, q);       break;
+            }
+        }
+    }, 0, bh >= 64 ? 4 : 1);
+}
+
+bool bc::encodeTexture(const RawImage& top, uint32_t type, uint32_t mips,
+                       Quality q, std::vector<uint8_t>& body, MipFilter filter)
+{
+    if (!isEncodable(type) || !top.width || !top.height) return false;
+    D8W_TRACE_SCOPE("bc::encodeTexture");
+    mips = std::max(1u, std::min(mips, fullMipCount(top.width, top.height)));
+
+    std::vector<RawImage> chain;
+    buildMipChain(top, mips, filter, chain);
+
+    size_t total = 0;
+    for (uint32_t l = 0; l < mips; ++l)
+        total += levelBytes(type, std::max(1u, top.width >> l), std::max(1u, top.height >> l));
+    body.resize(total);
+
+    size_t off = 0;
+    for (uint32_t l = 0; l < mips; ++l)
+    {
+        const RawImage& cur = l ? chain[l - 1] : top;
+        encodeSurface(&cur.bgra[0], cur.width, cur.height, type, q, &body[off]);
+        off += levelBytes(type, cur.width, cur.height);
+    }
+    return true;
+}
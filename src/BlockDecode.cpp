@@ -0,0 +1,168 @@
+/*───────────────────────────────────────────────────────────────
+   BlockDecode.cpp  –  DXT1/3/5 + ATI2 → BGRA8
+  ──────────────────────────────────────────────────────────────*/
+#include "BlockDecode.h"
+#include "BCEncoder.h"
+#include "PixelSwizzle.h"
+#include "d8w_parallel.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+/* small LUTs for 565 → 888 */
+struct Tables
+{
+    uint8_t r5[32];
+    uint8_t g6[64];
+    Tables()
+    {
+        for (int i = 0; i < 32; ++i) r5[i] = (uint8_t)((i << 3) | (i >> 2));
+        for (int i = 0; i < 64; ++i) g6[i] = (uint8_t)((i << 2) | (i >> 4));
+    }
+};
+static const Tables LUT;
+
+inline void expand565(uint16_t c, uint8_t* bgra)
+{
+    bgra[0] = LUT.r5[c & 31];
+    bgra[1] = LUT.g6[(c >> 5) & 63];
+    bgra[2] = LUT.r5[(c >> 11) & 31];
+    bgra[3] = 255;
+}
+
+/* colour half; DXT3/5 always use the 4-colour palette */
+static void colourBlock(const uint8_t* s, uint8_t* dst, size_t pitch, bool dxt1)
+{
+    const uint16_t c0 = (uint16_t)(s[0] | (s[1] << 8));
+    const uint16_t c1 = (uint16_t)(s[2] | (s[3] << 8));
+
+    uint8_t clr[4][4];
+    expand565(c0, clr[0]);
+    expand565(c1, clr[1]);
+    if (!dxt1 || c0 > c1)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            clr[2][k] = (uint8_t)((2 * clr[0][k] + clr[1][k]) / 3);
+            clr[3][k] = (uint8_t)((clr[0][k] + 2 * clr[1][k]) / 3);
+        }
+        clr[2][3] = clr[3][3] = 255;
+    }
+    else
+    {
+        for (int k = 0; k < 3; ++k) clr[2][k] = (uint8_t)((clr[0][k] + clr[1][k]) >> 1);
+        clr[2][3] = 255;
+        clr[3][0] = clr[3][1] = clr[3][2] = clr[3][3] = 0;   /* transparent black */
+    }
+
+    uint32_t idx = s[4] | (s[5] << 8) | (s[6] << 16) | ((uint32_t)s[7] << 24);
+    for (int py = 0; py < 4; ++py, dst += pitch)
+        for (int px = 0; px < 4; ++px, idx >>= 2)
+            std::memcpy(dst + px * 4, clr[idx & 3], 4);
+}
+
+/* 8-entry interpolated channel (DXT5 alpha, ATI2 X/Y) */
+static void channelBlock(const uint8_t* q, uint8_t out[16])
+{
+    const unsigned a0 = q[0], a1 = q[1];
+    uint8_t lut[8] = { (uint8_t)a0, (uint8_t)a1 };
+    if (a0 > a1) for (int k = 1; k <= 6; ++k) lut[1 + k] = (uint8_t)(((7 - k) * a0 + k * a1) / 7);
+    else
+    {
+        for (int k = 1; k <= 4; ++k) lut[1 + k] = (uint8_t)(((5 - k) * a0 + k * a1) / 5);
+        lut[6] = 0; lut[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) bits |= (uint64_t)q[2 + i] << (8 * i);
+    for (int i = 0; i < 16; ++i) out[i] = lut[(bits >> (3 * i)) & 7];
+}
+
+} // anon
+
+void dxt::decodeDXT1Block(const uint8_t* s, uint8_t* dst, size_t pitch)
+{
+    colourBlock(s, dst, pitch, true);
+}
+
+void dxt::decodeDXT3Block(const uint8_t* s, uint8_t* dst, size_t pitch)
+{
+    colourBlock(s + 8, dst, pitch, false);
+    for (int py = 0; py < 4; ++py, dst += pitch)
+        for (int px = 0; px < 4; px += 2)
+        {
+            const unsigned v = s[py * 2 + px / 2];
+            dst[px * 4 + 3]       = (uint8_t)((v & 15) * 17);
+            dst[(px + 1) * 4 + 3] = (uint8_t)((v >> 4) * 17);
+        }
+}
+
+void dxt::decodeDXT5Block(const uint8_t* s, uint8_t* dst, size_t pitch)
+{
+    uint8_t a[16];
+    channelBlock(s, a);
+    colourBlock(s + 8, dst, pitch, false);
+    for (int py = 0; py < 4; ++py, dst += pitch)
+        for (int px = 0; px < 4; ++px) dst[px * 4 + 3] = a[py * 4 + px];
+}
+
+/* X lands in byte 0 and Y in byte 1, blue filled with 127 – this is
+   how the preview has always shown Juiced normal maps.             */
+void dxt::decodeATI2Block(const uint8_t* s, uint8_t* dst, size_t pitch)
+{
+    uint8_t x[16], y[16];
+    channelBlock(s, x);
+    channelBlock(s + 8, y);
+    for (int py = 0; py < 4; ++py, dst += pitch)
+        for (int px = 0; px < 4; ++px)
+        {
+            uint8_t* d = dst + px * 4;
+            d[0] = x[py * 4 + px]; d[1] = y[py * 4 + px]; d[2] = 127; d[3] = 255;
+        }
+}
+
+bool dxt::canDecode(uint32_t type)
+{
+    return bc::isEncodable(type);
+}
+
+bool dxt::decodeSurface(uint32_t type, const uint8_t* src, size_t srcSize,
+                        uint32_t w, uint32_t h, uint8_t* bgra, unsigned threads)
+{
+    if (!canDecode(type) || !w || !h) return false;
+    if (srcSize < bc::levelBytes(type, w, h)) return false;
+    D8W_TRACE_SCOPE("dxt::decodeSurface");
+
+    const size_t pitch = size_t(w) * 4;
+    if (type == bc::kTypeARGB) return pix::toBGRA(pix::kJuicedARGB, src, srcSize, w, h, bgra, threads);
+
+    void (*kernel)(const uint8_t*, uint8_t*, size_t) =
+        type == bc::kTypeDXT1 ? decodeDXT1Block :
+        type == bc::kTypeDXT3 ? decodeDXT3Block :
+        type == bc::kTypeDXT5 ? decodeDXT5Block : decodeATI2Block;
+
+    const uint32_t blk = bc::blockBytes(type);
+    const uint32_t bw  = (w + 3) / 4, bh = (h + 3) / 4;
+
+    parallelFor(bh, [&](size_t by)
+    {
+        const uint8_t* s = src + by * bw * blk;
+        uint8_t tmp[64];
+        for (uint32_t bx = 0; bx < bw; ++bx, s += blk)
+        {
+            const uint32_t x0 = bx * 4, y0 = (uint32_t)by * 4;
+            uint8_t* d = bgra + size_t(y0) * pitch + size_t(x0) * 4;
+            if (x0 + 4 <= w && y0 + 4 <= h) { kernel(s, d, pitch); continue; }
+
+            kernel(s, tmp, 16);                          /* clipped edge block */
+            const uint32_t cw = std::min(4u, w - x0), ch = std::min(4u, h - y0);
+            for (uint32_t y = 0; y < ch; ++y) std::memcpy(d + y * pitch, tmp + y * 16, cw * 4);
+        }
+    }, threads, bh >= 64 ? 8 : 1);
+    return true;
+}
@@ -0,0 +1,502 @@
+/*───────────────────────────────────────────────────────────────
+   ImageIO.cpp  –  PNG / TGA readers → BGRA8, PNG / TGA writers
+  ──────────────────────────────────────────────────────────────*/
+#include "ImageIO.h"
+#include "Zlib.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+inline uint32_t be32(const uint8_t* p)
+{ return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; }
+
+inline uint16_t le16(const uint8_t* p)
+{ return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static bool fail(std::string& err, const char* msg) { err = msg; return false; }
+
+/* ─── PNG scanline filters (spec §9) ───────────────────────── */
+inline uint8_t paeth(int a, int b, int c)
+{
+    const int p  = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+static bool unfilter(uint8_t* data, uint32_t rows, size_t rowBytes, unsigned bpp)
+{
+    uint8_t* prev = NULL;
+    for (uint32_t y = 0; y < rows; ++y)
+    {
+        const uint8_t ft = data[0];
+        uint8_t* cur = data + 1;
+        size_t i;
+        switch (ft)
+        {
+        case 0: break;
+        case 1: for (i = bpp; i < rowBytes; ++i) cur[i] += cur[i - bpp]; break;
+        case 2: if (prev) for (i = 0; i < rowBytes; ++i) cur[i] += prev[i]; break;
+        case 3:
+            for (i = 0; i < rowBytes; ++i)
+            {
+                const int a = i >= bpp ? cur[i - bpp] : 0;
+                const int b = prev ? prev[i] : 0;
+                cur[i] += (uint8_t)((a + b) >> 1);
+            }
+            break;
+        case 4:
+            for (i = 0; i < rowBytes; ++i)
+            {
+                const int a = i >= bpp ? cur[i - bpp] : 0;
+                const int b = prev ? prev[i] : 0;
+                const int c = (prev && i >= bpp) ? prev[i - bpp] : 0;
+                cur[i] += paeth(a, b, c);
+            }
+            break;
+        default: return false;
+        }
+        prev  = cur;
+        data += rowBytes + 1;
+    }
+    return true;
+}
+
+struct PngInfo
+{
+    uint32_t w, h;
+    unsigned depth, ctype, channels;
+    uint8_t  pal[256][4];              /* B G R A */
+    bool     hasKey;
+    uint16_t key[3];                   /* gray or R,G,B transparency key */
+};
+
+/* read sample #i (0-based channel-interleaved) from an unfiltered row */
+inline uint32_t sampleAt(const uint8_t* row, size_t i, unsigned depth)
+{
+    switch (depth)
+    {
+    case 8:  return row[i];
+    case 16: return ((uint32_t)row[i * 2] << 8) | row[i * 2 + 1];
+    default:
+    {
+        const size_t bit = i * depth;
+        const unsigned shift = 8 - depth - (unsigned)(bit & 7);
+        return (row[bit >> 3] >> shift) & ((1u << depth) - 1);
+    }
+    }
+}
+
+inline uint8_t to8(uint32_t v, unsigned depth)
+{
+    if (depth == 8)  return (uint8_t)v;
+    if (depth == 16) return (uint8_t)(v >> 8);
+    return (uint8_t)(v * 255 / ((1u << depth) - 1));
+}
+
+static void emitRow(const PngInfo& pi, const uint8_t* row, uint32_t n,
+                    uint8_t* dst, size_t dstStep)
+{
+    for (uint32_t x = 0; x < n; ++x, dst += dstStep)
+    {
+        const size_t s = (size_t)x * pi.channels;
+        switch (pi.ctype)
+        {
+        case 0:
+        {
+            const uint32_t g = sampleAt(row, s, pi.depth);
+            dst[0] = dst[1] = dst[2] = to8(g, pi.depth);
+            dst[3] = (pi.hasKey && g == pi.key[0]) ? 0 : 255;
+            break;
+        }
+        case 2:
+        {
+            const uint32_t r = sampleAt(row, s, pi.depth), g = sampleAt(row, s + 1, pi.depth),
+                           b = sampleAt(row, s + 2, pi.depth);
+            dst[0] = to8(b, pi.depth); dst[1] = to8(g, pi.depth); dst[2] = to8(r, pi.depth);
+            dst[3] = (pi.hasKey && r == pi.key[0] && g == pi.key[1] && b == pi.key[2]) ? 0 : 255;
+            break;
+        }
+        case 3:
+            std::memcpy(dst, pi.pal[sampleAt(row, s, pi.depth) & 0xFF], 4);
+            break;
+        case 4:
+            dst[0] = dst[1] = dst[2] = to8(sampleAt(row, s, pi.depth), pi.depth);
+            dst[3] = to8(sampleAt(row, s + 1, pi.depth), pi.depth);
+            break;
+        case 6:
+            dst[2] = to8(sampleAt(row, s,     pi.depth), pi.depth);
+            dst[1] = to8(sampleAt(row, s + 1, pi.depth), pi.depth);
+            dst[0] = to8(sampleAt(row, s + 2, pi.depth), pi.depth);
+            dst[3] = to8(sampleAt(row, s + 3, pi.depth), pi.depth);
+            break;
+        }
+    }
+}
+
+/* ─── TGA pixel → BGRA ─────────────────────────────────────── */
+inline void tgaPixel(const uint8_t* s, unsigned depth, uint8_t* d)
+{
+    switch (depth)
+    {
+    case 8:
+        d[0] = d[1] = d[2] = s[0]; d[3] = 255;
+        break;
+    case 15:
+    case 16:
+    {
+        const uint16_t v = le16(s);
+        d[0] = (uint8_t)(((v      ) & 31) * 255 / 31);
+        d[1] = (uint8_t)(((v >>  5) & 31) * 255 / 31);
+        d[2] = (uint8_t)(((v >> 10) & 31) * 255 / 31);
+        d[3] = (depth == 16 && !(v & 0x8000)) ? 0 : 255;
+        break;
+    }
+    case 24: d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = 255;  break;
+    case 32: d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = s[3]; break;
+    }
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                              PNG
+   ───────────────────────────────────────────────────────────── */
+bool juiced::isPNG(const uint8_t* p, size_t n)
+{
+    static const uint8_t sig[8] = { 0x89,'P','N','G',0x0D,0x0A,0x1A,0x0A };
+    return n >= 8 && std::memcmp(p, sig, 8) == 0;
+}
+
+bool juiced::decodePNG(const uint8_t* p, size_t n, RawImage& out, std::string& err)
+{
+    if (!isPNG(p, n)) return fail(err, "not a PNG file");
+
+    PngInfo pi;
+    std::memset(&pi, 0, sizeof(pi));
+    for (int i = 0; i < 256; ++i) pi.pal[i][3] = 255;
+
+    unsigned interlace = 0;
+    bool     haveHdr   = false;
+    std::vector<uint8_t> idat;
+
+    size_t off = 8;
+    while (off + 12 <= n)
+    {
+        const uint32_t len = be32(p + off);
+        const uint8_t* typ = p + off + 4;
+        const uint8_t* dat = p + off + 8;
+        if (len > n - off - 12) return fail(err, "PNG chunk overruns file");
+        if (zlib::crc32(typ, size_t(len) + 4) != be32(dat + len))
+            return fail(err, "PNG chunk CRC mismatch");
+
+        if (!std::memcmp(typ, "IHDR", 4))
+        {
+            if (len < 13) return fail(err, "bad IHDR");
+            pi.w = be32(dat); pi.h = be32(dat + 4);
+            pi.depth = dat[8]; pi.ctype = dat[9]; interlace = dat[12];
+            if (dat[10] || dat[11] || interlace > 1) return fail(err, "unsupported PNG method");
+            static const unsigned ch[7] = { 1,0,3,1,2,0,4 };
+            if (pi.ctype > 6 || !ch[pi.ctype]) return fail(err, "bad PNG colour type");
+            pi.channels = ch[pi.ctype];
+            if (pi.depth != 1 && pi.depth != 2 && pi.depth != 4 &&
+                pi.depth != 8 && pi.depth != 16)   return fail(err, "bad PNG bit depth");
+            if (!pi.w || !pi.h || pi.w > 32768 || pi.h > 32768)
+                return fail(err, "PNG dimensions out of range");
+            haveHdr = true;
+        }
+        else if (!std::memcmp(typ, "PLTE", 4))
+        {
+            for (uint32_t i = 0; i < len / 3 && i < 256; ++i)
+            {
+                pi.pal[i][2] = dat[i * 3];
+                pi.pal[i][1] = dat[i * 3 + 1];
+                pi.pal[i][0] = dat[i * 3 + 2];
+            }
+        }
+        else if (!std::memcmp(typ, "tRNS", 4))
+        {
+            if (pi.ctype == 3)
+                for (uint32_t i = 0; i < len && i < 256; ++i) pi.pal[i][3] = dat[i];
+            else if (pi.ctype == 0 && len >= 2)
+            { pi.hasKey = true; pi.key[0] = (uint16_t)((dat[0] << 8) | dat[1]); }
+            else if (pi.ctype == 2 && len >= 6)
+            {
+                pi.hasKey = true;
+                for (int k = 0; k < 3; ++k) pi.key[k] = (uint16_t)((dat[k * 2] << 8) | dat[k * 2 + 1]);
+            }
+        }
+        else if (!std::memcmp(typ, "IDAT", 4))
+            idat.insert(idat.end(), dat, dat + len);
+        else if (!std::memcmp(typ, "IEND", 4))
+            break;
+
+        off += 12 + len;
+    }
+    if (!haveHdr || idat.empty()) return fail(err, "PNG missing IHDR/IDAT");
+
+    /* ── pass geometry (1 pass, or the 7 Adam7 passes) ────────── */
+    static const unsigned X0[7] = { 0,4,0,2,0,1,0 }, Y0[7] = { 0,0,4,0,2,0,1 };
+    static const unsigned DX[7] = { 8,8,4,4,2,2,1 }, DY[7] = { 8,8,8,4,4,2,2 };
+    const unsigned passes = interlace ? 7 : 1;
+    const unsigned bitsPP = pi.channels * pi.depth;
+    const unsigned bpp    = bitsPP >= 8 ? bitsPP / 8 : 1;
+
+    uint32_t pw[7], ph[7];
+    size_t   need = 0;
+    for (unsigned k = 0; k < passes; ++k)
+    {
+        const unsigned x0 = interlace ? X0[k] : 0, y0 = interlace ? Y0[k] : 0;
+        const unsigned dx = interlace ? DX[k] : 1, dy = interlace ? DY[k] : 1;
+        pw[k] = pi.w > x0 ? (pi.w - x0 + dx - 1) / dx : 0;
+        ph[k] = pi.h > y0 ? (pi.h - y0 + dy - 1) / dy : 0;
+        if (pw[k] && ph[k]) need += size_t(ph[k]) * (1 + (size_t(pw[k]) * bitsPP + 7) / 8);
+    }
+
+    std::vector<uint8_t> raw;
+    if (!zlib::inflate(&idat[0], idat.size(), raw, need)) return fail(err, "PNG inflate failed");
+    if (raw.size() < need) return fail(err, "PNG image data truncated");
+
+    out.width  = pi.w;
+    out.height = pi.h;
+    out.bgra.assign(size_t(pi.w) * pi.h * 4, 0);
+
+    uint8_t* src = &raw[0];
+    for (unsigned k = 0; k < passes; ++k)
+    {
+        if (!pw[k] || !ph[k]) continue;
+        const size_t rowBytes = (size_t(pw[k]) * bitsPP + 7) / 8;
+        if (!unfilter(src, ph[k], rowBytes, bpp)) return fail(err, "bad PNG filter type");
+
+        const unsigned x0 = interlace ? X0[k] : 0, y0 = interlace ? Y0[k] : 0;
+        const unsigned dx = interlace ? DX[k] : 1, dy = interlace ? DY[k] : 1;
+        for (uint32_t y = 0; y < ph[k]; ++y)
+        {
+            uint8_t* dst = out.row(y0 + y * dy) + size_t(x0) * 4;
+            emitRow(pi, src + y * (rowBytes + 1) + 1, pw[k], dst, size_t(dx) * 4);
+        }
+        src += size_t(ph[k]) * (rowBytes + 1);
+    }
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                              TGA
+   ───────────────────────────────────────────────────────────── */
+bool juiced::decodeTGA(const uint8_t* p, size_t n, RawImage& out, std::string& err)
+{
+    if (n < 18) return fail(err, "TGA header truncated");
+
+    const unsigned idLen    = p[0];
+    const unsigned cmapType = p[1];
+    const unsigned imgType  = p[2];
+    const unsigned cmapLen  = le16(p + 5);
+    const unsigned cmapBits = p[7];
+    const uint32_t w        = le16(p + 12);
+    const uint32_t h        = le16(p + 14);
+    const unsigned depth    = p[16];
+    const unsigned desc     = p[17];
+
+    const bool rle    = imgType >= 9;
+    const unsigned bt = imgType & 7;                   /* 1 cmap, 2 rgb, 3 gray */
+    if ((bt != 1 && bt != 2 && bt != 3) || (imgType > 3 && imgType < 9) || imgType > 11)
+        return fail(err, "unsupported TGA image type");
+    if (!w || !h) return fail(err, "TGA has zero size");
+    if (bt == 1 && (!cmapType || (depth != 8 && depth != 16)))
+        return fail(err, "bad TGA colour map");
+    if (bt != 1 && depth != 8 && depth != 15 && depth != 16 && depth != 24 && depth != 32)
+        return fail(err, "unsupported TGA bit depth");
+
+    size_t off = 18 + idLen;
+
+    /* ── colour map ──────────────────────────────────────────── */
+    std::vector<uint8_t> cmap;
+    if (cmapType)
+    {
+        const unsigned eb = (cmapBits + 7) / 8;
+        if (off + size_t(cmapLen) * eb > n) return fail(err, "TGA colour map truncated");
+        if (bt == 1)
+        {
+            cmap.resize(size_t(cmapLen) * 4);
+            for (unsigned i = 0; i < cmapLen; ++i)
+                tgaPixel(p + off + i * eb, cmapBits, &cmap[i * 4]);
+        }
+        off += size_t(cmapLen) * eb;
+    }
+
+    const unsigned pb   = (depth + 7) / 8;
+    const size_t   npx  = size_t(w) * h;
+    out.width  = w;
+    out.height = h;
+    out.bgra.assign(npx * 4, 0);
+
+    /* ── pixel stream (raw or RLE) in file order ─────────────── */
+    uint8_t* d = &out.bgra[0];
+    size_t   i = 0;
+    bool     sawAlpha = false;
+    while (i < npx)
+    {
+        size_t run = 1;
+        bool   rep = false;
+        if (rle)
+        {
+            if (off >= n) return fail(err, "TGA RLE data truncated");
+            const uint8_t c = p[off++];
+            run = (c & 0x7F) + 1u;
+            rep = (c & 0x80) != 0;
+        }
+        if (i + run > npx) run = npx - i;
+
+        for (size_t k = 0; k < run; ++k, ++i)
+        {
+            if (!rep || k == 0)
+            {
+                if (off + pb > n) return fail(err, "TGA pixel data truncated");
+                if (bt == 1)
+                {
+                    const unsigned ix = pb == 2 ? le16(p + off) : p[off];
+                    if (ix < cmapLen) std::memcpy(d + i * 4, &cmap[ix * 4], 4);
+                }
+                else tgaPixel(p + off, depth, d + i * 4);
+                off += pb;
+            }
+            else std::memcpy(d + i * 4, d + (i - 1) * 4, 4);
+
+            sawAlpha |= depth == 32 && d[i * 4 + 3] != 0;
+        }
+    }
+
+    /* 32-bit files written without alpha usually leave it zeroed */
+    if (depth == 32 && !sawAlpha)
+        for (size_t k = 0; k < npx; ++k) d[k * 4 + 3] = 255;
+
+    /* ── orientation: bit 5 = top-down, bit 4 = right-to-left ──*/
+    if (!(desc & 0x20))
+        for (uint32_t y = 0; y < h / 2; ++y)
+            std::swap_ranges(out.row(y), out.row(y) + size_t(w) * 4, out.row(h - 1 - y));
+    if (desc & 0x10)
+        for (uint32_t y = 0; y < h; ++y)
+        {
+            uint32_t* r = reinterpret_cast<uint32_t*>(out.row(y));
+            std::reverse(r, r + w);
+        }
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           PNG writer
+   ───────────────────────────────────────────────────────────── */
+static void putBE32(std::vector<uint8_t>& v, uint32_t x)
+{
+    v.push_back((uint8_t)(x >> 24)); v.push_back((uint8_t)(x >> 16));
+    v.push_back((uint8_t)(x >> 8));  v.push_back((uint8_t)x);
+}
+
+static void putChunk(std::vector<uint8_t>& out, const char* type,
+                     const uint8_t* data, size_t n)
+{
+    putBE32(out, (uint32_t)n);
+    const size_t at = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (n) out.insert(out.end(), data, data + n);
+    putBE32(out, zlib::crc32(&out[at], n + 4));
+}
+
+void juiced::encodePNG(const RawImage& img, std::vector<uint8_t>& out, int level)
+{
+    const uint32_t w = img.width, h = img.height;
+    const size_t   rb = size_t(w) * 4;
+
+    /* BGRA → RGBA rows, each behind its filter byte: none when only
+       storing, otherwise the filter with the smallest |residual|  */
+    std::vector<uint8_t> raw((rb + 1) * h), cur(rb), prev(rb, 0), trial(rb);
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        const uint8_t* s = img.row(y);
+        for (size_t x = 0; x < rb; x += 4)
+        {
+            cur[x] = s[x + 2]; cur[x + 1] = s[x + 1]; cur[x + 2] = s[x]; cur[x + 3] = s[x + 3];
+        }
+
+        uint8_t* d = &raw[y * (rb + 1)];
+        d[0] = 0;
+        std::memcpy(d + 1, cur.data(), rb);
+        if (level == 1)                                 /* fast: Up only */
+        {
+            d[0] = 2;
+            for (size_t i = 0; i < rb; ++i) d[1 + i] = (uint8_t)(cur[i] - prev[i]);
+        }
+        else if (level > 1)
+        {
+            uint64_t best = 0;
+            for (size_t i = 0; i < rb; ++i) best += std::abs((int)(int8_t)cur[i]);
+            for (uint8_t ft = 1; ft <= 4; ++ft)
+            {
+                uint64_t sum = 0;
+                for (size_t i = 0; i < rb; ++i)
+                {
+                    const int a = i >= 4 ? cur[i - 4] : 0, b = prev[i], c = i >= 4 ? prev[i - 4] : 0;
+                    const int pr = ft == 1 ? a : ft == 2 ? b : ft == 3 ? (a + b) >> 1 : paeth(a, b, c);
+                    trial[i] = (uint8_t)(cur[i] - pr);
+                    sum += std::abs((int)(int8_t)trial[i]);
+                }
+                if (sum < best) { best = sum; d[0] = ft; std::memcpy(d + 1, trial.data(), rb); }
+            }
+        }
+        prev.swap(cur);
+    }
+
+    static const uint8_t sig[8] = { 0x89,'P','N','G',0x0D,0x0A,0x1A,0x0A };
+    out.insert(out.end(), sig, sig + 8);
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, w);
+    putBE32(ihdr, h);
+    const uint8_t tail[5] = { 8, 6, 0, 0, 0 };          /* 8-bit RGBA, no interlace */
+    ihdr.insert(ihdr.end(), tail, tail + 5);
+    putChunk(out, "IHDR", ihdr.data(), ihdr.size());
+
+    std::vector<uint8_t> z;
+    zlib::deflate(raw.data(), raw.size(), z, level);
+    putChunk(out, "IDAT", z.data(), z.size());
+    putChunk(out, "IEND", NULL, 0);
+}
+
+void juiced::encodeTGA(const RawImage& img, std::vector<uint8_t>& out)
+{
+    uint8_t hdr[18] = { 0 };
+    hdr[2]  = 2;                                        /* uncompressed true-colour */
+    hdr[12] = (uint8_t)img.width;  hdr[13] = (uint8_t)(img.width  >> 8);
+    hdr[14] = (uint8_t)img.height; hdr[15] = (uint8_t)(img.height >> 8);
+    hdr[16] = 32;
+    hdr[17] = 0x28;                                     /* 8 alpha bits, top-left origin */
+    out.insert(out.end(), hdr, hdr + 18);
+    out.insert(out.end(), img.bgra.begin(), img.bgra.end());   /* already B G R A */
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           dispatch
+   ───────────────────────────────────────────────────────────── */
+bool juiced::isImageExt(const std::string& path)
+{
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot + 1);
+    for (size_t i = 0; i < ext.size(); ++i) ext[i] = (char)std::tolower((unsigned char)ext[i]);
+    return ext == "png" || ext == "tga";
+}
+
+bool juiced::decodeImage(const uint8_t* p, size_t n, const std::string& nameHint,
+                         RawImage& out, std::string& err)
+{
+    if (isPNG(p, n))             return decodePNG(p, n, out, err);
+    if (isImageExt(nameHint))    return decodeTGA(p, n, out, err);
+    return fail(err, "unrecognised image format");
+}
@@ -0,0 +1,246 @@
+/*───────────────────────────────────────────────────────────────
+   MipGen.cpp  –  box / Kaiser mip down-sampling
+  ──────────────────────────────────────────────────────────────*/
+#include "MipGen.h"
+#include "d8w_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define D8W_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+using namespace juiced;
+
+namespace
+{
+
+enum { kBandRows = 16 };                   /* output rows per work item */
+
+/* ─── box 2x2 ──────────────────────────────────────────────── */
+static void boxRow(const RawImage& src, RawImage& dst, uint32_t y)
+{
+    const uint8_t* r0 = src.row(std::min(y * 2,     src.height - 1));
+    const uint8_t* r1 = src.row(std::min(y * 2 + 1, src.height - 1));
+    uint8_t*       o  = dst.row(y);
+    uint32_t       x  = 0;
+
+#ifdef D8W_SSE2
+    if (src.width == dst.width * 2)            /* even width: 2 outputs per step */
+    {
+        const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16(2);
+        for (; x + 2 <= dst.width; x += 2)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x * 8));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x * 8));
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            __m128i s = _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+                                           _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+            s = _mm_srli_epi16(_mm_add_epi16(s, two), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(o + x * 4), _mm_packus_epi16(s, zero));
+        }
+    }
+#endif
+    for (; x < dst.width; ++x)
+    {
+        const size_t x0 = size_t(std::min(x * 2,     src.width - 1)) * 4;
+        const size_t x1 = size_t(std::min(x * 2 + 1, src.width - 1)) * 4;
+        for (int k = 0; k < 4; ++k)
+            o[x * 4 + k] = (uint8_t)((r0[x0 + k] + r0[x1 + k] + r1[x0 + k] + r1[x1 + k] + 2) >> 2);
+    }
+}
+
+/* ─── Kaiser-windowed sinc taps for one axis ───────────────── */
+static double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+struct Taps
+{
+    int                n;              /* taps per output sample */
+    std::vector<int>   idx;            /* clamped source index   */
+    std::vector<float> wt;             /* normalised weight      */
+
+    void build(uint32_t srcN, uint32_t dstN)
+    {
+        const double scale  = (double)srcN / dstN;
+        const double radius = 1.5 * scale;              /* 3 output texels wide */
+        const double beta   = 4.0;
+        const double i0b    = besselI0(beta);
+
+        n = (int)std::ceil(2.0 * radius) + 1;
+        idx.assign(size_t(dstN) * n, 0);
+        wt .assign(size_t(dstN) * n, 0.0f);
+
+        for (uint32_t o = 0; o < dstN; ++o)
+        {
+            const double c     = (o + 0.5) * scale - 0.5;
+            const int    first = (int)std::ceil(c - radius);
+            double       sum   = 0.0;
+            for (int k = 0; k < n; ++k)
+            {
+                const int    i = first + k;
+                const double d = i - c;
+                double w = 0.0;
+                if (std::fabs(d) < radius)
+                {
+                    const double x = d / scale;
+                    const double t = d / radius;
+                    const double s = x == 0.0 ? 1.0 : std::sin(3.14159265358979 * x) / (3.14159265358979 * x);
+                    w = s * besselI0(beta * std::sqrt(1.0 - t * t)) / i0b;
+                }
+                idx[o * n + k] = std::min((int)srcN - 1, std::max(0, i));
+                wt [o * n + k] = (float)w;
+                sum += w;
+            }
+            if (sum != 0.0)
+                for (int k = 0; k < n; ++k) wt[o * n + k] = (float)(wt[o * n + k] / sum);
+        }
+    }
+};
+
+static void kaiserHRow(const uint8_t* src, const Taps& tx, uint32_t dstW, float* out)
+{
+    for (uint32_t x = 0; x < dstW; ++x, out += 4)
+    {
+        const int*   ix = &tx.idx[size_t(x) * tx.n];
+        const float* wx = &tx.wt [size_t(x) * tx.n];
+#ifdef D8W_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < tx.n; ++k)
+        {
+            int v; std::memcpy(&v, src + ix[k] * 4, 4);
+            const __m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(p), _mm_set1_ps(wx[k])));
+        }
+        _mm_storeu_ps(out, acc);
+#else
+        float a[4] = { 0, 0, 0, 0 };
+        for (int k = 0; k < tx.n; ++k)
+            for (int c = 0; c < 4; ++c) a[c] += src[ix[k] * 4 + c] * wx[k];
+        std::memcpy(out, a, sizeof(a));
+#endif
+    }
+}
+
+static void kaiserBand(const RawImage& src, RawImage& dst, const Taps& tx, const Taps& ty,
+                       uint32_t y0, uint32_t y1)
+{
+    /* source rows touched by this band */
+    int lo = (int)src.height, hi = -1;
+    for (uint32_t y = y0; y < y1; ++y)
+        for (int k = 0; k < ty.n; ++k)
+        {
+            lo = std::min(lo, ty.idx[size_t(y) * ty.n + k]);
+            hi = std::max(hi, ty.idx[size_t(y) * ty.n + k]);
+        }
+
+    const size_t rowF = size_t(dst.width) * 4;
+    std::vector<float> h(size_t(hi - lo + 1) * rowF);
+    for (int r = lo; r <= hi; ++r)
+        kaiserHRow(src.row(r), tx, dst.width, &h[size_t(r - lo) * rowF]);
+
+    std::vector<float> acc(rowF);
+    for (uint32_t y = y0; y < y1; ++y)
+    {
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        for (int k = 0; k < ty.n; ++k)
+        {
+            const float  w = ty.wt[size_t(y) * ty.n + k];
+            if (w == 0.0f) continue;
+            const float* s = &h[size_t(ty.idx[size_t(y) * ty.n + k] - lo) * rowF];
+            size_t i = 0;
+#ifdef D8W_SSE2
+            const __m128 vw = _mm_set1_ps(w);
+            for (; i + 4 <= rowF; i += 4)
+                _mm_storeu_ps(&acc[i], _mm_add_ps(_mm_loadu_ps(&acc[i]),
+                                                  _mm_mul_ps(_mm_loadu_ps(s + i), vw)));
+#endif
+            for (; i < rowF; ++i) acc[i] += s[i] * w;
+        }
+
+        uint8_t* o = dst.row(y);
+        size_t i = 0;
+#ifdef D8W_SSE2
+        for (; i + 8 <= rowF; i += 8)              /* round, clamp, pack 2 px */
+        {
+            const __m128i a = _mm_cvtps_epi32(_mm_loadu_ps(&acc[i]));
+            const __m128i b = _mm_cvtps_epi32(_mm_loadu_ps(&acc[i + 4]));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(o + i),
+                             _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_setzero_si128()));
+        }
+#endif
+        for (; i < rowF; ++i)
+            o[i] = (uint8_t)std::min(255.0f, std::max(0.0f, acc[i] + 0.5f));
+    }
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                          public API
+   ───────────────────────────────────────────────────────────── */
+bool juiced::parseMipFilter(const char* s, MipFilter& f)
+{
+    if (!s) return false;
+    if (!std::strcmp(s, "box"))    { f = kMipBox;    return true; }
+    if (!std::strcmp(s, "kaiser")) { f = kMipKaiser; return true; }
+    return false;
+}
+
+void juiced::downsample(const RawImage& src, RawImage& dst, MipFilter f)
+{
+    dst.width  = std::max(1u, src.width  / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.bgra.resize(size_t(dst.width) * dst.height * 4);
+
+    const uint32_t bands = (dst.height + kBandRows - 1) / kBandRows;
+
+    if (f == kMipKaiser && (src.width > 1 || src.height > 1))
+    {
+        Taps tx, ty;
+        tx.build(src.width,  dst.width);
+        ty.build(src.height, dst.height);
+        parallelFor(bands, [&](size_t b)
+        {
+            const uint32_t y0 = (uint32_t)b * kBandRows;
+            kaiserBand(src, dst, tx, ty, y0, std::min(dst.height, y0 + kBandRows));
+        });
+        return;
+    }
+
+    parallelFor(bands, [&](size_t b)
+    {
+        const uint32_t y0 = (uint32_t)b * kBandRows;
+        const uint32_t y1 = std::min(dst.height, y0 + kBandRows);
+        for (uint32_t y = y0; y < y1; ++y) boxRow(src, dst, y);
+    });
+}
+
+void juiced::buildMipChain(const RawImage& top, uint32_t count, MipFilter f,
+                           std::vector<RawImage>& chain)
+{
+    chain.clear();
+    if (count < 2) return;
+    chain.resize(count - 1);
+
+    const RawImage* prev = &top;
+    for (uint32_t l = 0; l + 1 < count; ++l)
+    {
+        downsample(*prev, chain[l], f);
+        prev = &chain[l];
+    }
+}
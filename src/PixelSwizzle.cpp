@@ -0,0 +1,327 @@
+/*───────────────────────────────────────────────────────────────
+   PixelSwizzle.cpp  –  mask-driven RGB / luminance → BGRA8
+  ──────────────────────────────────────────────────────────────*/
+#include "PixelSwizzle.h"
+#include "d8w_parallel.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define D8W_SSE2 1
+#   include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#   define D8W_SSSE3 1
+#   include <tmmintrin.h>
+#endif
+
+using namespace juiced;
+using namespace juiced::pix;
+
+#define DDPF_ALPHAPIXELS 0x00000001
+#define DDPF_ALPHA       0x00000002
+#define DDPF_FOURCC      0x00000004
+#define DDPF_RGB         0x00000040
+#define DDPF_LUMINANCE   0x00020000
+
+const PixelLayout pix::kJuicedARGB = { 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000, false };
+
+namespace
+{
+
+/* ── generic path: one shift + LUT per channel ──────────────── */
+
+/* w-bit value → 8 bits by bit replication (5 → (v<<3)|(v>>2), 4 → v*17),
+   so it agrees with the 565 / 4444 fast paths and the DXT endpoints  */
+static uint8_t widen(uint32_t v, int w)
+{
+    if (w >= 8) return (uint8_t)(v >> (w - 8));
+    uint32_t out = 0;
+    for (int s = 8 - w; ; s -= w)
+    {
+        out |= s >= 0 ? v << s : v >> -s;
+        if (s <= 0) break;
+    }
+    return (uint8_t)out;
+}
+
+struct Channel
+{
+    uint32_t mask;
+    int      shift, drop;               /* (px & mask) >> shift >> drop → lut */
+    uint8_t  lut[256];
+    uint8_t  fill;                      /* value when mask == 0               */
+
+    void init(uint32_t m, uint8_t absent)
+    {
+        mask = m; fill = absent; shift = drop = 0;
+        if (!m) return;
+        while (!((m >> shift) & 1)) ++shift;
+        int w = 0;
+        while (w < 32 - shift && (m >> (shift + w))) ++w;
+        drop = std::max(0, w - 8);
+        const int kept = w - drop;
+        for (uint32_t v = 0; v < 256; ++v) lut[v] = widen(v & ((1u << kept) - 1), kept);
+    }
+    uint8_t get(uint32_t px) const { return mask ? lut[((px & mask) >> shift) >> drop] : fill; }
+};
+
+struct Generic
+{
+    Channel  r, g, b, a;
+    uint32_t bytes;
+    bool     lum;
+
+    explicit Generic(const PixelLayout& l) : bytes(l.bits / 8), lum(l.luminance)
+    {
+        r.init(l.rMask, 0); g.init(l.gMask, 0); b.init(l.bMask, 0); a.init(l.aMask, 255);
+    }
+
+    void row(const uint8_t* s, uint8_t* d, uint32_t n) const
+    {
+        for (uint32_t x = 0; x < n; ++x, s += bytes, d += 4)
+        {
+            uint32_t px = 0;
+            for (uint32_t k = 0; k < bytes; ++k) px |= uint32_t(s[k]) << (8 * k);
+            if (lum) d[0] = d[1] = d[2] = r.get(px);
+            else   { d[0] = b.get(px); d[1] = g.get(px); d[2] = r.get(px); }
+            d[3] = a.get(px);
+        }
+    }
+};
+
+/* ── fast paths: whole vectors, the ragged tail goes to Generic ── */
+
+static inline uint32_t ld32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+static inline void     st32(uint8_t* p, uint32_t v) { std::memcpy(p, &v, 4); }
+
+/* X8R8G8B8: alpha forced to 255 */
+static uint32_t rowBGRX(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSE2
+    const __m128i a = _mm_set1_epi32((int)0xFF000000);
+    for (; x + 4 <= w; x += 4)
+        _mm_storeu_si128((__m128i*)(d + x * 4),
+                         _mm_or_si128(_mm_loadu_si128((const __m128i*)(s + x * 4)), a));
+#endif
+    for (; x < w; ++x) st32(d + x * 4, ld32(s + x * 4) | 0xFF000000u);
+    return x;
+}
+
+/* A8B8G8R8: swap bytes 0 and 2 */
+static uint32_t rowRGBA(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSE2
+    const __m128i ag = _mm_set1_epi32((int)0xFF00FF00);
+    for (; x + 4 <= w; x += 4)
+    {
+        const __m128i p  = _mm_loadu_si128((const __m128i*)(s + x * 4));
+        const __m128i rb = _mm_andnot_si128(ag, p);
+        _mm_storeu_si128((__m128i*)(d + x * 4),
+                         _mm_or_si128(_mm_and_si128(p, ag),
+                                      _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16))));
+    }
+#endif
+    for (; x < w; ++x)
+    {
+        const uint32_t p = ld32(s + x * 4);
+        st32(d + x * 4, (p & 0xFF00FF00u) | ((p & 0xFFu) << 16) | ((p >> 16) & 0xFFu));
+    }
+    return x;
+}
+
+/* R8G8B8 (bytes B, G, R): 4 pixels from 12 bytes */
+static uint32_t rowBGR(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSSE3
+    const __m128i shuf = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i a    = _mm_set1_epi32((int)0xFF000000);
+    for (; x + 6 <= w; x += 4)                               /* 16-byte load stays in the row */
+        _mm_storeu_si128((__m128i*)(d + x * 4),
+                         _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + x * 3)), shuf), a));
+#endif
+    for (; x + 4 <= w; x += 4)
+    {
+        const uint32_t w0 = ld32(s + x * 3), w1 = ld32(s + x * 3 + 4), w2 = ld32(s + x * 3 + 8);
+        uint8_t* o = d + x * 4;
+        st32(o,      0xFF000000u |  (w0 & 0xFFFFFFu));
+        st32(o + 4,  0xFF000000u | ((w0 >> 24) | (w1 << 8)));
+        st32(o + 8,  0xFF000000u | ((w1 >> 16) | ((w2 & 0xFFu) << 16)));
+        st32(o + 12, 0xFF000000u |  (w2 >> 8));
+    }
+    return x;
+}
+
+#ifdef D8W_SSE2
+/* 8 x u16 bg / ra pairs → 8 BGRA pixels */
+static inline void store8(uint8_t* d, __m128i bg, __m128i ra)
+{
+    _mm_storeu_si128((__m128i*)d,        _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(bg, ra));
+}
+#endif
+
+static uint32_t row565(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSE2
+    const __m128i m6 = _mm_set1_epi16(0x3F), m5 = _mm_set1_epi16(0x1F);
+    const __m128i a  = _mm_set1_epi16((short)0xFF00);
+    for (; x + 8 <= w; x += 8)
+    {
+        const __m128i p  = _mm_loadu_si128((const __m128i*)(s + x * 2));
+        const __m128i r5 = _mm_srli_epi16(p, 11);
+        const __m128i g6 = _mm_and_si128(_mm_srli_epi16(p, 5), m6);
+        const __m128i b5 = _mm_and_si128(p, m5);
+        const __m128i r8 = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+        const __m128i g8 = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+        const __m128i b8 = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+        store8(d + x * 4, _mm_or_si128(b8, _mm_slli_epi16(g8, 8)), _mm_or_si128(r8, a));
+    }
+#endif
+    return x;
+}
+
+static uint32_t row4444(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSE2
+    const __m128i lo = _mm_set1_epi16(0x0F0F);
+    for (; x + 8 <= w; x += 8)
+    {
+        const __m128i p  = _mm_loadu_si128((const __m128i*)(s + x * 2));
+        __m128i br = _mm_and_si128(p, lo);                         /* B | R << 8 */
+        __m128i ga = _mm_and_si128(_mm_srli_epi16(p, 4), lo);      /* G | A << 8 */
+        br = _mm_or_si128(br, _mm_slli_epi16(br, 4));              /* v * 17     */
+        ga = _mm_or_si128(ga, _mm_slli_epi16(ga, 4));
+        _mm_storeu_si128((__m128i*)(d + x * 4),      _mm_unpacklo_epi8(br, ga));
+        _mm_storeu_si128((__m128i*)(d + x * 4 + 16), _mm_unpackhi_epi8(br, ga));
+    }
+#endif
+    return x;
+}
+
+static uint32_t rowA8L8(const uint8_t* s, uint8_t* d, uint32_t w)
+{
+    uint32_t x = 0;
+#ifdef D8W_SSE2
+    const __m128i ml = _mm_set1_epi16(0x00FF);
+    for (; x + 8 <= w; x += 8)
+    {
+        const __m128i p = _mm_loadu_si128((const __m128i*)(s + x * 2));
+        const __m128i l = _mm_and_si128(p, ml);
+        store8(d + x * 4, _mm_or_si128(l, _mm_slli_epi16(l, 8)), _mm_or_si128(l, _mm_andnot_si128(ml, p)));
+    }
+#endif
+    for (; x < w; ++x)
+    {
+        const uint32_t l = s[x * 2], a = s[x * 2 + 1];
+        st32(d + x * 4, l | (l << 8) | (l << 16) | (a << 24));
+    }
+    return x;
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                              API
+   ───────────────────────────────────────────────────────────── */
+bool pix::fromDDS(uint32_t flags, uint32_t bits, uint32_t r, uint32_t g, uint32_t b,
+                  uint32_t a, PixelLayout& out)
+{
+    if (flags & DDPF_FOURCC) return false;
+    if (bits != 8 && bits != 16 && bits != 24 && bits != 32) return false;
+
+    /* no channel flags at all: what older writers meant by "32-bit" */
+    if (!(flags & (DDPF_RGB | DDPF_LUMINANCE | DDPF_ALPHA)) && bits == 32)
+    {
+        out = kJuicedARGB;
+        return true;
+    }
+
+    out.bits      = bits;
+    out.luminance = (flags & DDPF_LUMINANCE) != 0;
+    out.rMask     = (flags & (DDPF_RGB | DDPF_LUMINANCE)) ? r : 0;
+    out.gMask     = (flags & DDPF_RGB) ? g : 0;
+    out.bMask     = (flags & DDPF_RGB) ? b : 0;
+    out.aMask     = (flags & (DDPF_ALPHAPIXELS | DDPF_ALPHA)) ? a : 0;
+
+    if (bits < 32)
+    {
+        const uint32_t keep = (1u << bits) - 1;
+        out.rMask &= keep; out.gMask &= keep; out.bMask &= keep; out.aMask &= keep;
+    }
+    return (out.rMask | out.gMask | out.bMask | out.aMask) != 0;
+}
+
+Kind pix::classify(const PixelLayout& l)
+{
+    const bool rgb = !l.luminance;
+    if (l.bits == 32 && rgb && l.gMask == 0x0000FF00)
+    {
+        if (l.rMask == 0x00FF0000 && l.bMask == 0x000000FF)
+            return l.aMask == 0xFF000000 ? kBGRA8888 : l.aMask == 0 ? kBGRX8888 : kGeneric;
+        if (l.rMask == 0x000000FF && l.bMask == 0x00FF0000 && l.aMask == 0xFF000000)
+            return kRGBA8888;
+    }
+    if (l.bits == 24 && rgb && l.rMask == 0xFF0000 && l.gMask == 0xFF00 && l.bMask == 0xFF && !l.aMask)
+        return kBGR888;
+    if (l.bits == 16 && rgb)
+    {
+        if (l.rMask == 0xF800 && l.gMask == 0x07E0 && l.bMask == 0x001F && !l.aMask) return kRGB565;
+        if (l.rMask == 0x0F00 && l.gMask == 0x00F0 && l.bMask == 0x000F && l.aMask == 0xF000) return kARGB4444;
+    }
+    if (l.bits == 16 && l.luminance && l.rMask == 0x00FF && l.aMask == 0xFF00) return kA8L8;
+    return kGeneric;
+}
+
+const char* pix::layoutName(const PixelLayout& l)
+{
+    switch (classify(l))
+    {
+    case kBGRA8888: return "ARGB8888";
+    case kBGRX8888: return "XRGB8888";
+    case kRGBA8888: return "ABGR8888";
+    case kBGR888:   return "RGB888";
+    case kRGB565:   return "RGB565";
+    case kARGB4444: return "ARGB4444";
+    case kA8L8:     return "A8L8";
+    default:        break;
+    }
+    if (l.luminance) return l.aMask ? "AL" : "L";
+    if (!(l.rMask | l.gMask | l.bMask)) return "A";
+    return l.aMask ? "ARGB" : "RGB";
+}
+
+bool pix::toBGRA(const PixelLayout& l, const uint8_t* src, size_t srcSize,
+                 uint32_t w, uint32_t h, uint8_t* bgra, unsigned threads)
+{
+    if (!w || !h || !l.bits || l.bits % 8 || l.bits > 32) return false;
+    if (srcSize < levelSize(l, w, h)) return false;
+    D8W_TRACE_SCOPE("pix::toBGRA");
+
+    const Kind k = classify(l);
+    if (k == kBGRA8888) { std::memcpy(bgra, src, size_t(w) * h * 4); return true; }
+
+    uint32_t (*fast)(const uint8_t*, uint8_t*, uint32_t) =
+        k == kBGRX8888 ? rowBGRX : k == kRGBA8888 ? rowRGBA : k == kBGR888 ? rowBGR :
+        k == kRGB565   ? row565  : k == kARGB4444 ? row4444 : k == kA8L8   ? rowA8L8 : 0;
+
+    const Generic gen(l);
+    const size_t  sp = rowBytes(l, w), dp = size_t(w) * 4;
+    const uint32_t bpp = l.bits / 8;
+
+    parallelFor(h, [&](size_t y)
+    {
+        const uint8_t* s = src  + y * sp;
+        uint8_t*       d = bgra + y * dp;
+        const uint32_t x = fast ? fast(s, d, w) : 0;
+        if (x < w) gen.row(s + size_t(x) * bpp, d + size_t(x) * 4, w - x);
+    }, threads, std::max<size_t>(1, (64u << 10) / dp));
+    return true;
+}
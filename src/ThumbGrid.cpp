@@ -0,0 +1,244 @@
+/*  ThumbGrid – virtual thumbnail grid (see ThumbGrid.h)  */
+#include "ThumbGrid.h"
+#include "BCEncoder.h"
+
+#include <wx/dcbuffer.h>
+
+#include <algorithm>
+
+/* ─── event table ──────────────────────────────────────────── */
+wxBEGIN_EVENT_TABLE(ThumbGrid, wxVScrolledWindow)
+    EVT_PAINT     (ThumbGrid::OnPaint     )
+    EVT_SIZE      (ThumbGrid::OnSize      )
+    EVT_LEFT_DOWN (ThumbGrid::OnLeftDown  )
+    EVT_LEFT_DCLICK(ThumbGrid::OnLeftDClick)
+    EVT_KEY_DOWN  (ThumbGrid::OnKey       )
+wxEND_EVENT_TABLE()
+
+/* key = bank | pack | texture – stays valid across packs, so
+   flipping back to a pack finds its thumbs still cached       */
+static uint64_t makeKey(int b, int p, int t)
+{
+    return (uint64_t)(uint32_t)b << 40 | (uint64_t)(uint32_t)p << 20 | (uint32_t)t;
+}
+
+/* BGRA → wxImage with alpha, drawn later over the preview pink */
+static wxBitmap toBitmap(const juiced::RawImage& r)
+{
+    wxImage img(r.width, r.height, false);
+    img.InitAlpha();
+    unsigned char* rgb = img.GetData();
+    unsigned char* a   = img.GetAlpha();
+    const uint8_t* s   = r.bgra.data();
+    for (size_t i = 0, n = size_t(r.width) * r.height; i < n; ++i, s += 4)
+    {
+        rgb[i * 3 + 0] = s[2];
+        rgb[i * 3 + 1] = s[1];
+        rgb[i * 3 + 2] = s[0];
+        a[i]           = s[3];
+    }
+    return wxBitmap(img);
+}
+
+ThumbGrid::ThumbGrid(wxWindow* parent, wxWindowID id)
+        : wxVScrolledWindow(parent, id, wxDefaultPosition, wxDefaultSize,
+                            wxWANTS_CHARS | wxFULL_REPAINT_ON_RESIZE),
+          bank_(-1), pack_(-1), count_(0), sel_(-1), repaint_(false)
+{
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    cache_.reset(new juiced::ThumbCache(
+        [this](uint64_t key, juiced::RawImage& out) { return decode(key, out); },
+        [this](uint64_t)                            { thumbReady(); }));
+}
+
+ThumbGrid::~ThumbGrid()
+{
+    cache_.reset();                         /* join workers before members go */
+}
+
+void ThumbGrid::setBanks(const std::vector<const juiced::D8WBank*>& banks)
+{
+    invalidate();
+    banks_ = banks;
+    bank_  = pack_ = -1;
+    count_ = 0;
+    relayout();
+}
+
+void ThumbGrid::showPack(int bank, int pack)
+{
+    if (bank < 0 || bank >= (int)banks_.size()) return;
+    bank_  = bank;
+    pack_  = pack;
+    count_ = (int)banks_[bank]->textureCount(pack);
+    sel_   = -1;
+    bmps_.clear();
+    relayout();
+    ScrollToRow(0);
+    Refresh(false);
+}
+
+void ThumbGrid::invalidate()
+{
+    cache_->clear();
+    bmps_.clear();
+    Refresh(false);
+}
+
+/* ─── worker side ─────────────────────────────────────────── */
+bool ThumbGrid::decode(uint64_t key, juiced::RawImage& out) const
+{
+    const size_t b = (size_t)(key >> 40), p = (size_t)(key >> 20) & 0xFFFFF, t = (size_t)key & 0xFFFFF;
+    if (b >= banks_.size()) return false;
+
+    const juiced::D8WBank* bank = banks_[b];
+    const std::vector<BYTE>* big = bank->tBuffer();
+    if (!big || p >= bank->texturePackCount() || t >= bank->textureCount(p)) return false;
+
+    const juiced::TextureHdrEx& h = bank->tables()[p].tex[t];
+    if ((uint64_t)h.fileOff + h.size > big->size()) return false;
+    return juiced::decodeThumb(h, big->data() + h.fileOff, h.size, kEdge, out);
+}
+
+/* many thumbs land per frame – one repaint for all of them */
+void ThumbGrid::thumbReady()
+{
+    if (repaint_.exchange(true)) return;
+    CallAfter([this]{ repaint_ = false; Refresh(false); });
+}
+
+/* ─── layout ──────────────────────────────────────────────── */
+int ThumbGrid::columns() const
+{
+    const int w = GetClientSize().GetWidth();
+    return std::max(1, (w - kPad) / (kEdge + kPad));
+}
+
+wxCoord ThumbGrid::OnGetRowHeight(size_t) const
+{
+    return kEdge + kLabel + kPad;
+}
+
+void ThumbGrid::relayout()
+{
+    const int cols = columns();
+    SetRowCount(count_ ? (size_t)((count_ + cols - 1) / cols) : 0);
+}
+
+uint64_t ThumbGrid::keyOf(int tex) const { return makeKey(bank_, pack_, tex); }
+
+int ThumbGrid::cellAt(const wxPoint& p) const
+{
+    const int cols = columns();
+    const int col  = (p.x - kPad / 2) / (kEdge + kPad);
+    if (col < 0 || col >= cols) return -1;
+
+    const int row = (int)GetVisibleRowsBegin() + p.y / (int)OnGetRowHeight(0);
+    const int t   = row * cols + col;
+    return t >= 0 && t < count_ ? t : -1;
+}
+
+void ThumbGrid::OnSize(wxSizeEvent& e)
+{
+    relayout();
+    Refresh(false);
+    e.Skip();
+}
+
+/* ─── painting: visible rows only ─────────────────────────── */
+void ThumbGrid::OnPaint(wxPaintEvent&)
+{
+    wxAutoBufferedPaintDC dc(this);
+    dc.SetBackground(wxBrush(GetBackgroundColour()));
+    dc.Clear();
+    if (bank_ < 0 || !count_) return;
+
+    const juiced::D8WBank* bank = banks_[bank_];
+    const int cols  = columns();
+    const int rowH  = (int)OnGetRowHeight(0);
+    const int first = (int)GetVisibleRowsBegin();
+    const int last  = std::min((int)GetVisibleRowsEnd(), (int)GetRowCount());
+
+    std::vector<uint64_t>        missing;
+    std::map<uint64_t, wxBitmap> keep;
+    dc.SetFont(wxFont(wxFontInfo(7)));
+
+    for (int row = first; row < last; ++row)
+        for (int col = 0; col < cols; ++col)
+        {
+            const int t = row * cols + col;
+            if (t >= count_) break;
+
+            const int x = kPad / 2 + col * (kEdge + kPad);
+            const int y = kPad / 2 + (row - first) * rowH;
+            const uint64_t key = keyOf(t);
+
+            /* thumb: converted once, then reused while on screen */
+            std::map<uint64_t, wxBitmap>::iterator it = bmps_.find(key);
+            wxBitmap bmp;
+            if (it != bmps_.end()) bmp = it->second;
+            else if (juiced::ThumbCache::Thumb th = cache_->lookup(key))
+            {
+                if (th->width) bmp = toBitmap(*th);
+            }
+            else missing.push_back(key);
+            if (bmp.IsOk()) keep[key] = bmp;
+
+            dc.SetPen(t == sel_ ? wxPen(wxColour(0, 120, 215), 2) : *wxLIGHT_GREY_PEN);
+            dc.SetBrush(*wxTRANSPARENT_BRUSH);
+            dc.DrawRectangle(x - 1, y - 1, kEdge + 2, kEdge + 2);
+            if (bmp.IsOk())
+            {
+                const int bx = x + (kEdge - bmp.GetWidth())  / 2;
+                const int by = y + (kEdge - bmp.GetHeight()) / 2;
+                dc.SetPen(*wxTRANSPARENT_PEN);
+                dc.SetBrush(wxBrush(wxColour(255, 0, 255)));
+                dc.DrawRectangle(bx, by, bmp.GetWidth(), bmp.GetHeight());
+                dc.DrawBitmap(bmp, bx, by, true);
+            }
+
+            const juiced::TextureHdr& h = bank->texture(pack_, t);
+            dc.DrawText(wxString::Format(wxT("%05d %s %ux%u"), t,
+                                         juiced::bc::typeName(h.type), h.width, h.height),
+                        x, y + kEdge + 2);
+        }
+
+    bmps_.swap(keep);
+    cache_->want(missing);                  /* replaces whatever scrolled away */
+}
+
+/* ─── input ───────────────────────────────────────────────── */
+void ThumbGrid::OnLeftDown(wxMouseEvent& e)
+{
+    SetFocus();
+    const int t = cellAt(e.GetPosition());
+    if (t != sel_) { sel_ = t; Refresh(false); }
+}
+
+void ThumbGrid::OnLeftDClick(wxMouseEvent& e)
+{
+    const int t = cellAt(e.GetPosition());
+    if (t >= 0 && onPick_) onPick_(t);
+}
+
+void ThumbGrid::OnKey(wxKeyEvent& e)
+{
+    const int cols = columns();
+    int t = sel_ < 0 ? 0 : sel_;
+    switch (e.GetKeyCode())
+    {
+    case WXK_LEFT:   t -= 1;    break;
+    case WXK_RIGHT:  t += 1;    break;
+    case WXK_UP:     t -= cols; break;
+    case WXK_DOWN:   t += cols; break;
+    case WXK_RETURN:
+    case WXK_NUMPAD_ENTER:
+        if (sel_ >= 0 && onPick_) onPick_(sel_);
+        return;
+    default: e.Skip(); return;
+    }
+    if (t < 0 || t >= count_) return;
+    sel_ = t;
+    if (!IsRowVisible((size_t)(t / cols))) ScrollToRow((size_t)(t / cols));
+    Refresh(false);
+}
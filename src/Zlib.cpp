@@ -0,0 +1,760 @@
+/*───────────────────────────────────────────────────────────────
+   Zlib.cpp  –  inflate, deflate + checksums, written from RFC 1950/1951
+  ──────────────────────────────────────────────────────────────*/
+#include "Zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+
+using namespace juiced;
+
+namespace
+{
+
+/* ─── static tables (RFC-1951 §3.2.5) ──────────────────────── */
+static const uint16_t kLenBase[29] = {
+    3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,
+    35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const uint8_t  kLenExtra[29] = {
+    0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const uint16_t kDistBase[30] = {
+    1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,
+    1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const uint8_t  kDistExtra[30] = {
+    0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+static const uint8_t  kClenOrder[19] = {
+    16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+
+/* ─── LSB-first bit reader ─────────────────────────────────── */
+struct BitIn
+{
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t       buf;
+    unsigned       cnt;
+
+    BitIn(const uint8_t* s, size_t n) : p(s), end(s + n), buf(0), cnt(0) {}
+
+    void refill()
+    {
+        while (cnt <= 56 && p < end)
+        {
+            buf |= (uint64_t)(*p++) << cnt;
+            cnt += 8;
+        }
+    }
+    bool need(unsigned n) { if (cnt < n) refill(); return cnt >= n; }
+    uint32_t peek(unsigned n) const { return (uint32_t)(buf & ((1ull << n) - 1)); }
+    void     drop(unsigned n)       { buf >>= n; cnt -= n; }
+    bool bits(unsigned n, uint32_t& v)
+    {
+        if (n == 0) { v = 0; return true; }
+        if (!need(n)) return false;
+        v = peek(n); drop(n); return true;
+    }
+    void alignByte() { drop(cnt & 7); }
+};
+
+/* ─── canonical Huffman decoder with a 10-bit fast table ───── */
+enum { kFastBits = 10 };
+
+struct Huff
+{
+    uint16_t fast[1 << kFastBits];   /* (sym << 4) | len ; 0 = slow path */
+    uint16_t count[16];
+    uint16_t sym[288];
+
+    bool build(const uint8_t* lens, unsigned n)
+    {
+        std::memset(fast,  0, sizeof(fast));
+        std::memset(count, 0, sizeof(count));
+        for (unsigned i = 0; i < n; ++i) ++count[lens[i]];
+        count[0] = 0;
+
+        int left = 1;                             /* over-subscription check */
+        for (unsigned l = 1; l < 16; ++l)
+        {
+            left <<= 1; left -= count[l];
+            if (left < 0) return false;
+        }
+
+        uint16_t offs[16]; offs[1] = 0;
+        for (unsigned l = 1; l < 15; ++l) offs[l + 1] = offs[l] + count[l];
+        for (unsigned i = 0; i < n; ++i)
+            if (lens[i]) sym[offs[lens[i]]++] = (uint16_t)i;
+
+        uint32_t code = 0, next[16];
+        for (unsigned l = 1; l < 16; ++l) { next[l] = code; code = (code + count[l]) << 1; }
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            const unsigned len = lens[i];
+            if (!len) continue;
+            const uint32_t c = next[len]++;
+            if (len > kFastBits) continue;
+
+            uint32_t rev = 0;                      /* codes are MSB-first */
+            for (unsigned b = 0; b < len; ++b) rev |= ((c >> b) & 1u) << (len - 1 - b);
+            for (uint32_t j = rev; j < (1u << kFastBits); j += (1u << len))
+                fast[j] = (uint16_t)((i << 4) | len);
+        }
+        return true;
+    }
+
+    int decode(BitIn& in) const
+    {
+        in.need(15);                  /* bits past the stream end read as 0 */
+        const uint16_t e = fast[in.peek(kFastBits)];
+        if (e && (unsigned)(e & 15) <= in.cnt)
+        {
+            in.drop(e & 15);
+            return e >> 4;
+        }
+
+        /* slow path – walk the canonical code bit by bit */
+        int code = 0, first = 0, index = 0;
+        for (unsigned l = 1; l < 16; ++l)
+        {
+            if (in.cnt == 0) return -1;
+            code |= (int)(in.buf & 1); in.drop(1);
+            const int c = count[l];
+            if (code - first < c) return sym[index + (code - first)];
+            index += c; first += c;
+            first <<= 1; code <<= 1;
+        }
+        return -1;
+    }
+};
+
+static bool inflateBlock(BitIn& in, const Huff& lit, const Huff& dist,
+                         std::vector<uint8_t>& out, size_t base)
+{
+    for (;;)
+    {
+        const int s = lit.decode(in);
+        if (s < 0) return false;
+        if (s < 256) { out.push_back((uint8_t)s); continue; }
+        if (s == 256) return true;
+
+        const int li = s - 257;
+        if (li >= 29) return false;
+        uint32_t e;
+        if (!in.bits(kLenExtra[li], e)) return false;
+        const size_t len = kLenBase[li] + e;
+
+        const int d = dist.decode(in);
+        if (d < 0 || d >= 30) return false;
+        if (!in.bits(kDistExtra[d], e)) return false;
+        const size_t dst = kDistBase[d] + e;
+        if (dst > out.size() - base) return false;
+
+        const size_t from = out.size() - dst;
+        out.resize(out.size() + len);
+        uint8_t* o = &out[out.size() - len];
+        const uint8_t* q = &out[from];
+        if (dst >= len) std::memcpy(o, q, len);
+        else for (size_t k = 0; k < len; ++k) o[k] = q[k];   /* overlapping run */
+    }
+}
+
+static bool fixedTables(Huff& lit, Huff& dist)
+{
+    uint8_t l[288];
+    unsigned i;
+    for (i = 0;   i < 144; ++i) l[i] = 8;
+    for (;        i < 256; ++i) l[i] = 9;
+    for (;        i < 280; ++i) l[i] = 7;
+    for (;        i < 288; ++i) l[i] = 8;
+    if (!lit.build(l, 288)) return false;
+    for (i = 0; i < 30; ++i) l[i] = 5;
+    return dist.build(l, 30);
+}
+
+static bool dynamicTables(BitIn& in, Huff& lit, Huff& dist)
+{
+    uint32_t hlit, hdist, hclen;
+    if (!in.bits(5, hlit) || !in.bits(5, hdist) || !in.bits(4, hclen)) return false;
+    hlit += 257; hdist += 1; hclen += 4;
+    if (hlit > 286 || hdist > 30) return false;
+
+    uint8_t cl[19] = {0};
+    for (uint32_t i = 0; i < hclen; ++i)
+    {
+        uint32_t v; if (!in.bits(3, v)) return false;
+        cl[kClenOrder[i]] = (uint8_t)v;
+    }
+    Huff clh;
+    if (!clh.build(cl, 19)) return false;
+
+    uint8_t lens[286 + 30];
+    uint32_t n = 0;
+    while (n < hlit + hdist)
+    {
+        const int s = clh.decode(in);
+        if (s < 0) return false;
+        if (s < 16) { lens[n++] = (uint8_t)s; continue; }
+
+        uint32_t rep = 0; uint8_t val = 0;
+        if (s == 16)
+        {
+            if (n == 0 || !in.bits(2, rep)) return false;
+            val = lens[n - 1]; rep += 3;
+        }
+        else if (s == 17) { if (!in.bits(3, rep)) return false; rep += 3;  }
+        else              { if (!in.bits(7, rep)) return false; rep += 11; }
+
+        if (n + rep > hlit + hdist) return false;
+        while (rep--) lens[n++] = val;
+    }
+    if (lens[256] == 0) return false;                 /* no end-of-block */
+    return lit.build(lens, hlit) && dist.build(lens + hlit, hdist);
+}
+
+/* ─────────────────────────────────────────────────────────────
+                            deflate
+   LZ77 over a 32 KB window (hash chains; greedy up to level 3,
+   one-step lazy match above), then per block the cheapest of
+   stored / fixed / dynamic codes.
+   ───────────────────────────────────────────────────────────── */
+enum { kWin = 32768, kMinMatch = 3, kMaxMatch = 258, kHashBits = 15,
+       kBlockTokens = 1 << 16 };
+
+/* ─── LSB-first bit writer ─────────────────────────────────── */
+struct BitOut
+{
+    std::vector<uint8_t>& out;
+    uint64_t              buf;
+    unsigned              cnt;
+
+    explicit BitOut(std::vector<uint8_t>& o) : out(o), buf(0), cnt(0) {}
+
+    void bits(uint32_t v, unsigned n)
+    {
+        buf |= (uint64_t)v << cnt;
+        cnt += n;
+        if (cnt < 32) return;
+        const uint8_t b[4] = { (uint8_t)buf, (uint8_t)(buf >> 8), (uint8_t)(buf >> 16), (uint8_t)(buf >> 24) };
+        out.insert(out.end(), b, b + 4);                /* a word at a time, not per byte */
+        buf >>= 32;
+        cnt -= 32;
+    }
+    void drain() { while (cnt >= 8) { out.push_back((uint8_t)buf); buf >>= 8; cnt -= 8; } }
+    void flushByte() { drain(); if (cnt) { out.push_back((uint8_t)buf); buf = 0; cnt = 0; } }
+};
+
+/* literal: dist == 0, sym = byte;  match: len 3…258, dist 1…32768 */
+struct Token
+{
+    uint16_t len;
+    uint16_t dist;
+};
+
+static unsigned lenSym(unsigned len)
+{
+    unsigned i = 28;
+    while (kLenBase[i] > len) --i;
+    return i;
+}
+
+static unsigned distSym(unsigned dist)
+{
+    unsigned i = 29;
+    while (kDistBase[i] > dist) --i;
+    return i;
+}
+
+static uint16_t reverseBits(uint32_t c, unsigned len)
+{
+    uint32_t r = 0;
+    for (unsigned b = 0; b < len; ++b) r |= ((c >> b) & 1u) << (len - 1 - b);
+    return (uint16_t)r;
+}
+
+/* canonical codes (bit-reversed for the LSB-first writer) from lengths */
+static void makeCodes(const uint8_t* lens, unsigned n, uint16_t* codes)
+{
+    uint16_t count[16] = {0};
+    for (unsigned i = 0; i < n; ++i) ++count[lens[i]];
+    count[0] = 0;
+    uint32_t code = 0, next[16];
+    for (unsigned l = 1; l < 16; ++l) { next[l] = code; code = (code + count[l]) << 1; }
+    for (unsigned i = 0; i < n; ++i)
+        codes[i] = lens[i] ? reverseBits(next[lens[i]]++, lens[i]) : 0;
+}
+
+/* Huffman code lengths capped at maxLen; every used symbol gets ≥1
+   bit and a lone symbol gets a partner so the code is complete     */
+static void buildLengths(const uint32_t* freq, unsigned n, unsigned maxLen, uint8_t* lens)
+{
+    std::memset(lens, 0, n);
+
+    std::vector<unsigned> used;
+    for (unsigned i = 0; i < n; ++i) if (freq[i]) used.push_back(i);
+    if (used.empty())      { lens[0] = lens[1] = 1; return; }
+    if (used.size() == 1)  { lens[used[0]] = 1; lens[used[0] ? 0 : 1] = 1; return; }
+
+    /* plain Huffman: nodes [0,m) are leaves, parents appended */
+    const size_t m = used.size();
+    std::vector<uint64_t> w(2 * m);
+    std::vector<int>      parent(2 * m, -1);
+    typedef std::pair<uint64_t, int> Node;
+    std::priority_queue< Node, std::vector<Node>, std::greater<Node> > q;
+    for (size_t i = 0; i < m; ++i) { w[i] = freq[used[i]]; q.push(Node(w[i], (int)i)); }
+
+    int next = (int)m;
+    while (q.size() > 1)
+    {
+        const Node a = q.top(); q.pop();
+        const Node b = q.top(); q.pop();
+        w[next] = a.first + b.first;
+        parent[a.second] = parent[b.second] = next;
+        q.push(Node(w[next], next));
+        ++next;
+    }
+
+    std::vector<unsigned> depth(next, 0);
+    for (int i = next - 2; i >= 0; --i) depth[i] = depth[parent[i]] + 1;
+
+    /* clamp, then lengthen the rarest short codes until Kraft holds */
+    std::vector<unsigned> bySym(used);
+    std::sort(bySym.begin(), bySym.end(), [&](unsigned a, unsigned b)
+    {
+        return freq[a] != freq[b] ? freq[a] > freq[b] : a < b;
+    });
+    uint64_t kraft = 0;
+    const uint64_t one = (uint64_t)1 << maxLen;
+    for (size_t i = 0; i < m; ++i)
+    {
+        const unsigned d = std::min<unsigned>(depth[i], maxLen);
+        lens[used[i]] = (uint8_t)d;
+        kraft += one >> d;
+    }
+    while (kraft > one)
+        for (size_t k = m; k-- > 0 && kraft > one; )
+        {
+            const unsigned s = bySym[k];
+            if (lens[s] == maxLen) continue;
+            kraft -= one >> (lens[s] + 1);
+            ++lens[s];
+        }
+}
+
+static void writeStored(BitOut& bo, const uint8_t* p, size_t n, bool last)
+{
+    do
+    {
+        const size_t k = std::min<size_t>(n, 65535);
+        n -= k;
+        bo.bits(last && n == 0 ? 1 : 0, 1);
+        bo.bits(0, 2);
+        bo.flushByte();
+        bo.bits((uint32_t)k, 16);
+        bo.bits((uint32_t)k ^ 0xFFFF, 16);
+        bo.out.insert(bo.out.end(), p, p + k);
+        p += k;
+    }
+    while (n);
+}
+
+static void writeTokens(BitOut& bo, const std::vector<Token>& tok, const uint8_t* litSrc,
+                        const uint8_t* ll, const uint16_t* lc,
+                        const uint8_t* dl, const uint16_t* dc)
+{
+    size_t at = 0;
+    for (size_t i = 0; i < tok.size(); ++i)
+    {
+        const Token& t = tok[i];
+        if (!t.dist)
+        {
+            const unsigned s = litSrc[at++];
+            bo.bits(lc[s], ll[s]);
+            continue;
+        }
+        const unsigned li = lenSym(t.len), di = distSym(t.dist);
+        bo.bits(lc[257 + li], ll[257 + li]);
+        bo.bits(t.len - kLenBase[li], kLenExtra[li]);
+        bo.bits(dc[di], dl[di]);
+        bo.bits(t.dist - kDistBase[di], kDistExtra[di]);
+        at += t.len;
+    }
+    bo.bits(lc[256], ll[256]);
+}
+
+/* one block: tokens cover src[0,n) */
+static void writeBlock(BitOut& bo, const std::vector<Token>& tok,
+                       const uint8_t* src, size_t n, bool last)
+{
+    uint32_t lf[286] = {0}, df[30] = {0};
+    {
+        size_t at = 0;
+        for (size_t i = 0; i < tok.size(); ++i)
+        {
+            if (!tok[i].dist) { ++lf[src[at++]]; continue; }
+            ++lf[257 + lenSym(tok[i].len)];
+            ++df[distSym(tok[i].dist)];
+            at += tok[i].len;
+        }
+        lf[256] = 1;
+    }
+
+    /* dynamic tables + their run-length coded header */
+    uint8_t ll[286], dl[30];
+    buildLengths(lf, 286, 15, ll);
+    buildLengths(df, 30, 15, dl);
+    unsigned hlit = 286, hdist = 30;
+    while (hlit > 257 && !ll[hlit - 1]) --hlit;
+    while (hdist > 1  && !dl[hdist - 1]) --hdist;
+
+    uint8_t all[286 + 30];
+    std::memcpy(all, ll, hlit);
+    std::memcpy(all + hlit, dl, hdist);
+    std::vector<uint16_t> rle;                      /* sym | extra << 5 */
+    uint32_t cf[19] = {0};
+    for (unsigned i = 0; i < hlit + hdist; )
+    {
+        unsigned run = 1;
+        while (i + run < hlit + hdist && all[i + run] == all[i]) ++run;
+        unsigned left = run;
+        if (all[i] == 0)
+        {
+            while (left >= 11) { const unsigned k = std::min(left, 138u); rle.push_back(uint16_t(18 | (k - 11) << 5)); ++cf[18]; left -= k; }
+            if (left >= 3)     { rle.push_back(uint16_t(17 | (left - 3) << 5)); ++cf[17]; left = 0; }
+        }
+        else
+        {
+            rle.push_back(all[i]); ++cf[all[i]]; --left;
+            while (left >= 3)  { const unsigned k = std::min(left, 6u); rle.push_back(uint16_t(16 | (k - 3) << 5)); ++cf[16]; left -= k; }
+        }
+        while (left--) { rle.push_back(all[i]); ++cf[all[i]]; }
+        i += run;
+    }
+    uint8_t cl[19];
+    buildLengths(cf, 19, 7, cl);
+    unsigned hclen = 19;
+    while (hclen > 4 && !cl[kClenOrder[hclen - 1]]) --hclen;
+
+    /* cost of each encoding in bits */
+    uint8_t fl[288], fd[30];
+    {
+        unsigned i;
+        for (i = 0; i < 144; ++i) fl[i] = 8;
+        for (; i < 256; ++i) fl[i] = 9;
+        for (; i < 280; ++i) fl[i] = 7;
+        for (; i < 288; ++i) fl[i] = 8;
+        for (i = 0; i < 30; ++i) fd[i] = 5;
+    }
+    uint64_t extra = 0, dyn = 0, fix = 0;
+    for (unsigned s = 0; s < 286; ++s)
+    {
+        dyn += (uint64_t)lf[s] * ll[s];
+        fix += (uint64_t)lf[s] * fl[s];
+        if (s >= 257) extra += (uint64_t)lf[s] * kLenExtra[s - 257];
+    }
+    for (unsigned s = 0; s < 30; ++s)
+    {
+        dyn   += (uint64_t)df[s] * dl[s];
+        fix   += (uint64_t)df[s] * fd[s];
+        extra += (uint64_t)df[s] * kDistExtra[s];
+    }
+    dyn += 14 + 3 * hclen;
+    for (size_t i = 0; i < rle.size(); ++i)
+    {
+        const unsigned s = rle[i] & 31;
+        dyn += cl[s] + (s == 16 ? 2 : s == 17 ? 3 : s == 18 ? 7 : 0);
+    }
+    dyn += extra; fix += extra;
+    const uint64_t stored = (uint64_t)(n + 5 * (n / 65535 + 1)) * 8;
+
+    if (stored <= dyn && stored <= fix) { writeStored(bo, src, n, last); return; }
+
+    bo.bits(last ? 1 : 0, 1);
+    uint16_t lc[288], dc[30];
+    if (fix <= dyn)
+    {
+        bo.bits(1, 2);
+        makeCodes(fl, 288, lc);
+        makeCodes(fd, 30, dc);
+        writeTokens(bo, tok, src, fl, lc, fd, dc);
+        return;
+    }
+
+    bo.bits(2, 2);
+    bo.bits(hlit - 257, 5);
+    bo.bits(hdist - 1, 5);
+    bo.bits(hclen - 4, 4);
+    for (unsigned i = 0; i < hclen; ++i) bo.bits(cl[kClenOrder[i]], 3);
+
+    uint16_t cc[19];
+    makeCodes(cl, 19, cc);
+    for (size_t i = 0; i < rle.size(); ++i)
+    {
+        const unsigned s = rle[i] & 31, e = rle[i] >> 5;
+        bo.bits(cc[s], cl[s]);
+        if (s == 16) bo.bits(e, 2);
+        else if (s == 17) bo.bits(e, 3);
+        else if (s == 18) bo.bits(e, 7);
+    }
+    makeCodes(ll, 286, lc);
+    makeCodes(dl, 30, dc);
+    writeTokens(bo, tok, src, ll, lc, dl, dc);
+}
+
+/* per level, after zlib's own table: candidates tried per position,
+   match length that ends the search early, lazy evaluation, and the
+   longest match whose inner positions still go into the hash chains */
+struct LevelCfg { unsigned chain, nice; bool lazy; unsigned insert; };
+static const LevelCfg kLevels[10] =
+{
+    {    0,   0, false,   0 },
+    {    4,   8, false,   4 },      /* 1: fast – PNG export, patches of noise */
+    {    4,  16, false,   8 },
+    {   16,  32, false,  32 },
+    {   16, 258, true,  258 },
+    {   16, 258, true,  258 },
+    {   64, 258, true,  258 },      /* 6: ≈ zlib default */
+    {   64, 258, true,  258 },
+    {   64, 258, true,  258 },
+    { 1024, 258, true,  258 }
+};
+
+/* common prefix length of a and b, at most max – 8 bytes per step */
+static inline unsigned matchLen(const uint8_t* a, const uint8_t* b, unsigned max)
+{
+    unsigned len = 0;
+    while (len + 8 <= max)
+    {
+        uint64_t x, y;
+        std::memcpy(&x, a + len, 8);
+        std::memcpy(&y, b + len, 8);
+        if (x != y)
+        {
+            uint64_t d = x ^ y;                         /* little-endian: lowest byte first */
+            while (!(d & 0xFF)) { d >>= 8; ++len; }
+            return len;
+        }
+        len += 8;
+    }
+    while (len < max && a[len] == b[len]) ++len;
+    return len;
+}
+
+static inline uint32_t hash3(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]) * 2654435761u >> (32 - kHashBits);
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                          public API
+   ───────────────────────────────────────────────────────────── */
+bool zlib::inflateRaw(const uint8_t* src, size_t n,
+                      std::vector<uint8_t>& out, size_t sizeHint)
+{
+    if (sizeHint) out.reserve(out.size() + sizeHint);
+
+    const size_t base = out.size();
+    BitIn in(src, n);
+    Huff lit, dist;
+
+    uint32_t last = 0;
+    while (!last)
+    {
+        uint32_t type;
+        if (!in.bits(1, last) || !in.bits(2, type)) return false;
+
+        if (type == 0)                                 /* stored */
+        {
+            in.alignByte();
+            uint32_t len, nlen;
+            if (!in.bits(16, len) || !in.bits(16, nlen)) return false;
+            if ((len ^ 0xFFFF) != nlen) return false;
+
+            /* drain whole bytes still sitting in the bit buffer first */
+            while (len && in.cnt >= 8)
+            {
+                out.push_back((uint8_t)in.peek(8)); in.drop(8); --len;
+            }
+            if ((size_t)(in.end - in.p) < len) return false;
+            out.insert(out.end(), in.p, in.p + len);
+            in.p += len;
+        }
+        else if (type == 1)
+        {
+            if (!fixedTables(lit, dist) || !inflateBlock(in, lit, dist, out, base))
+                return false;
+        }
+        else if (type == 2)
+        {
+            if (!dynamicTables(in, lit, dist) || !inflateBlock(in, lit, dist, out, base))
+                return false;
+        }
+        else return false;
+    }
+    return true;
+}
+
+bool zlib::inflate(const uint8_t* src, size_t n,
+                   std::vector<uint8_t>& out, size_t sizeHint)
+{
+    if (n < 6) return false;
+    const unsigned cmf = src[0], flg = src[1];
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0) return false;
+    if (flg & 0x20) return false;                      /* preset dictionary */
+
+    const size_t base = out.size();
+    if (!inflateRaw(src + 2, n - 6, out, sizeHint)) return false;
+
+    const uint32_t want = ((uint32_t)src[n - 4] << 24) | ((uint32_t)src[n - 3] << 16) |
+                          ((uint32_t)src[n - 2] <<  8) |  (uint32_t)src[n - 1];
+    return adler32(out.empty() ? NULL : &out[base], out.size() - base) == want;
+}
+
+void zlib::deflateRaw(const uint8_t* src, size_t n, std::vector<uint8_t>& out, int level)
+{
+    BitOut bo(out);
+    if (level <= 0 || n < kMinMatch || n >= 0xFFFFFFFFu)   /* chains hold 32-bit positions */
+    {
+        writeStored(bo, src, n, true);
+        return;
+    }
+
+    const LevelCfg& cfg  = kLevels[std::min(level, 9)];
+    const uint32_t  kNone = ~(uint32_t)0;
+    std::vector<uint32_t> head((size_t)1 << kHashBits, kNone), prev(kWin, kNone);
+
+    auto insert = [&](size_t i)
+    {
+        if (i + kMinMatch > n) return;
+        const uint32_t h = hash3(src + i);
+        prev[i & (kWin - 1)] = head[h];
+        head[h] = (uint32_t)i;
+    };
+    auto longest = [&](size_t i, unsigned& bestLen, unsigned& bestDist)
+    {
+        bestLen = 0;
+        if (i + kMinMatch > n) return;
+        const unsigned maxLen = (unsigned)std::min<size_t>(kMaxMatch, n - i);
+        const unsigned nice   = std::min(cfg.nice, maxLen);
+        size_t   cand  = head[hash3(src + i)];
+        unsigned steps = cfg.chain;
+        while (cand != kNone && cand < i && i - cand <= kWin && steps--)
+        {
+            const uint8_t* a = src + cand;
+            const uint8_t* b = src + i;
+            if (a[bestLen] == b[bestLen] && a[0] == b[0])
+            {
+                const unsigned len = matchLen(a, b, maxLen);
+                if (len > bestLen)
+                {
+                    bestLen  = len;
+                    bestDist = (unsigned)(i - cand);
+                    if (len >= nice) break;
+                }
+            }
+            const size_t next = prev[cand & (kWin - 1)];
+            if (next == kNone || next >= cand) break;      /* slot reused */
+            cand = next;
+        }
+        if (bestLen < kMinMatch) bestLen = 0;
+    };
+
+    std::vector<Token> tok;
+    tok.reserve(kBlockTokens);
+    size_t i = 0, blockStart = 0;
+    while (i < n)
+    {
+        unsigned len, dist = 0;
+        longest(i, len, dist);
+        insert(i);
+
+        if (len && cfg.lazy)
+        {
+            unsigned len2, dist2 = 0;                      /* lazy: one step ahead */
+            longest(i + 1, len2, dist2);
+            if (len2 > len) len = 0;
+        }
+
+        if (len)
+        {
+            const Token t = { (uint16_t)len, (uint16_t)dist };
+            tok.push_back(t);
+            if (len <= cfg.insert)
+                for (size_t k = i + 1; k < i + len; ++k) insert(k);
+            i += len;
+        }
+        else
+        {
+            const Token t = { 1, 0 };
+            tok.push_back(t);
+            ++i;
+        }
+
+        if (tok.size() >= kBlockTokens)
+        {
+            writeBlock(bo, tok, src + blockStart, i - blockStart, false);
+            tok.clear();
+            blockStart = i;
+        }
+    }
+    writeBlock(bo, tok, src + blockStart, n - blockStart, true);
+    bo.flushByte();
+}
+
+void zlib::deflate(const uint8_t* src, size_t n, std::vector<uint8_t>& out, int level)
+{
+    out.push_back(0x78);                               /* 32 KB window, deflate */
+    out.push_back(0x9C);
+    deflateRaw(src, n, out, level);
+    const uint32_t a = adler32(src, n);
+    out.push_back((uint8_t)(a >> 24));
+    out.push_back((uint8_t)(a >> 16));
+    out.push_back((uint8_t)(a >>  8));
+    out.push_back((uint8_t) a);
+}
+
+/* slicing-by-8: t[k][b] is the CRC of byte b followed by k zeros */
+uint32_t zlib::crc32(const uint8_t* p, size_t n, uint32_t crc)
+{
+    struct Table
+    {
+        uint32_t t[8][256];
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[0][i] = c;
+            }
+            for (uint32_t i = 0; i < 256; ++i)
+                for (int k = 1; k < 8; ++k) t[k][i] = t[0][t[k - 1][i] & 0xFF] ^ (t[k - 1][i] >> 8);
+        }
+    };
+    static const Table T;
+
+    crc = ~crc;
+    for (; n >= 8; n -= 8, p += 8)
+    {
+        const uint32_t lo = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = T.t[7][lo & 0xFF] ^ T.t[6][(lo >> 8) & 0xFF] ^ T.t[5][(lo >> 16) & 0xFF] ^ T.t[4][lo >> 24] ^
+              T.t[3][p[4]] ^ T.t[2][p[5]] ^ T.t[1][p[6]] ^ T.t[0][p[7]];
+    }
+    while (n--) crc = T.t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t zlib::adler32(const uint8_t* p, size_t n, uint32_t adler)
+{
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (n)
+    {
+        size_t k = n < 5552 ? n : 5552;             /* no 32-bit overflow */
+        n -= k;
+        while (k--) { a += *p++; b += a; }
+        a %= 65521; b %= 65521;
+    }
+    return (b << 16) | a;
+}
@@ -98,6 +98,10 @@ wxBEGIN_EVENT_TABLE(MainFrame, wxFrame)
     EVT_MENU(ID_Export , MainFrame::OnExport )
     EVT_MENU(ID_Convert, MainFrame::OnConvert)
     EVT_MENU(ID_Import , MainFrame::OnImport )
+    EVT_MENU(wxID_UNDO , MainFrame::OnUndo   )
+    EVT_MENU(wxID_REDO , MainFrame::OnRedo   )
+    EVT_UPDATE_UI(wxID_UNDO, MainFrame::OnUpdateUndo)
+    EVT_UPDATE_UI(wxID_REDO, MainFrame::OnUpdateUndo)
 
     EVT_MENU(ID_ZoomIn , MainFrame::OnZoomIn )
     EVT_MENU(ID_ZoomOut, MainFrame::OnZoomOut)
@@ -135,9 +139,19 @@ MainFrame::MainFrame(const wxString& title)
     wxBoxSizer* vbox = new wxBoxSizer(wxVERTICAL);
     infoText_ = new wxStaticText(preview_, wxID_ANY, wxT("Open a .d8t file…"));
     thumb_    = new wxStaticBitmap(preview_, wxID_ANY, MakeTransparent());
+    grid_     = new ThumbGrid(preview_);
     vbox->Add(infoText_,0,wxALL|wxEXPAND,5);
     vbox->Add(thumb_,0,wxALL,5);
+    vbox->Add(grid_,1,wxALL|wxEXPAND,5);
     preview_->SetSizer(vbox);
+    grid_->Hide();
+
+    /* double-click in the pack grid → that texture's tree node */
+    grid_->setOnPick([this](int t)
+    {
+        int b,p,tt; if(!getSelection(b,p,tt) || p<0) return;
+        selectTexNode(b,p,t);
+    });
 
     splitter_->SplitVertically(tree_, preview_, 400);
     splitter_->SetMinimumPaneSize(200);
@@ -145,12 +159,22 @@ MainFrame::MainFrame(const wxString& title)
     rootSz->Add(splitter_,1,wxEXPAND);
     SetSizer(rootSz);
 
-    // Explicitly load and set your app icon here:
+    // Explicitly load and set your app icon here (from icon.rc on Windows):
+#ifdef __WXMSW__
     SetIcon(wxICON(APP_ICON));
+#endif
 
     Centre();
 }
 
+/* children outlive our members – stop thumbnail decodes before
+   banks_ / bigT_ go away                                        */
+MainFrame::~MainFrame()
+{
+    grid_->setBanks(std::vector<const juiced::D8WBank*>());
+    closeSession();
+}
+
 
 /* ────────────────────────────────────────────────────────────
                          File / tree helpers
@@ -241,6 +265,10 @@ void MainFrame::OnOpen(wxCommandEvent&)
                      wxFD_OPEN | wxFD_FILE_MUST_EXIST);
     if (dlg.ShowModal() != wxID_OK) return;
 
+    /* ---- thumbnail workers read bigT_ – stop them first ---------------- */
+    grid_->setBanks(std::vector<const juiced::D8WBank*>());
+    showGrid(false);
+
     /* ---- load the big bank (.d8t) -------------------------------------- */
     bigTPath_ = dlg.GetPath();          // wxString → keeps UTF-8
     if (!fileToMem(std::string(bigTPath_.mb_str()), bigT_)) {
@@ -257,6 +285,7 @@ void MainFrame::OnOpen(wxCommandEvent&)
     wxArrayString found;
     wxDir::GetAllFiles(folder, &found, wxT("*.d8w"), wxDIR_FILES);
 
+    closeSession();              // history / journal go before their banks
     banks_.clear();              // vector<unique_ptr<D8WBank>>
     wNames_.clear();             // parallel list of nice names
 
@@ -279,7 +308,30 @@ void MainFrame::OnOpen(wxCommandEvent&)
         return;
     }
 
+    /* ---- imports a crashed session staged but never saved ------------- */
+    const std::string tPath(bigTPath_.mb_str());
+    journal_.reset(new juiced::SessionJournal(juiced::D8WContext::shared(), tPath));
+    bool restored = false;
+    if (const size_t n = journal_->leftover())
+    {
+        wxString q;
+        q.Printf(wxT("%u staged edit(s) of an unsaved session were found.\n")
+                 wxT("Restore them?"), (unsigned)n);
+        if (wxMessageBox(q, wxT("Restore session"), wxYES_NO | wxICON_QUESTION) == wxYES)
+        {
+            restored = journal_->replay();
+            if (!restored)
+                wxMessageBox(wxString::FromUTF8(juiced::lastError().c_str()),
+                             wxT("Restore failed"), wxOK | wxICON_ERROR);
+        }
+    }
+    if (!restored) journal_->reset();
+
+    /* ---- undo starts here: untouched bodies are read back from the file - */
+    history_.reset(new juiced::EditHistory(juiced::D8WContext::shared(), tPath));
+
     /* ---- reset UI ------------------------------------------------------ */
+    gridBanks();
     rawBmp_.LoadFile(wxEmptyString);   // ensure empty preview
     zoomPct_   = 100;
     showAlpha_ = true;
@@ -311,6 +363,8 @@ void MainFrame::OnSave(wxCommandEvent&)
         }
         wroteBig = true;                        // only first dirty bank writes .d8t
     }
+    if (history_) history_->clear();            // the file now holds every body
+    if (journal_) journal_->reset();            // … and the journal nothing new
 
     populateTree();
     updateTitle();
@@ -360,7 +414,7 @@ void MainFrame::showWInfo(int b)
     infoText_->SetLabel(wxString::Format(wxT("%s\nPacks: %zu"),
                                          wNames_[b], bank->texturePackCount()));
 
-    preview_->Layout();
+    showGrid(false);
 }
 
 
@@ -373,13 +427,48 @@ void MainFrame::showPackInfo(int b, int p)
     rawBmp_  = MakeTransparent();
 
     const auto* bank = banks_[b].get();
-    infoText_->SetLabel(wxString::Format(wxT("%s / TexSet%u\nTextures: %zu"),
+    infoText_->SetLabel(wxString::Format(wxT("%s / TexSet%u\nTextures: %zu"
+                                             "   (double-click a thumbnail to open it)"),
                                          wNames_[b], p, bank->textureCount(p)));
 
     thumb_->SetBitmap(rawBmp_);
+    grid_->showPack(b, p);
+    showGrid(true);
+}
+
+/* ------------------------------------------------------------------------- */
+/*  MainFrame::showGrid – pack grid ↔ single-texture preview                 */
+/* ------------------------------------------------------------------------- */
+void MainFrame::showGrid(bool on)
+{
+    thumb_->Show(!on);
+    grid_->Show(on);
     preview_->Layout();
 }
 
+/* hand the grid the current banks (after open) */
+void MainFrame::gridBanks()
+{
+    std::vector<const juiced::D8WBank*> raw;
+    for (size_t b = 0; b < banks_.size(); ++b) raw.push_back(banks_[b].get());
+    grid_->setBanks(raw);
+}
+
+/* select root → bank → pack → texture node by position */
+void MainFrame::selectTexNode(int b, int p, int t)
+{
+    const int path[3] = { b, p, t };
+    wxTreeItemId id = tree_->GetRootItem();
+    for (int lvl = 0; lvl < 3 && id.IsOk(); ++lvl)
+    {
+        wxTreeItemIdValue ck;
+        wxTreeItemId c = tree_->GetFirstChild(id, ck);
+        for (int k = 0; k < path[lvl] && c.IsOk(); ++k) c = tree_->GetNextChild(id, ck);
+        id = c;
+    }
+    if (id.IsOk()) { tree_->SelectItem(id); tree_->EnsureVisible(id); }
+}
+
 
 /* helper to pad to 18 chars */
 static wxString col(const wxString& s0)
@@ -449,6 +538,7 @@ void MainFrame::showTexInfo(int bankIdx, int packIdx, int texIdx)
     if (!rawBmp_.IsOk())
         rawBmp_ = MakeTransparent();
 
+    showGrid(false);
     applyZoom();
 }
 
@@ -479,16 +569,26 @@ void MainFrame::OnConvert(wxCommandEvent&)
     int b, p, t; if (!getSelection(b, p, t)) return;
 
     auto* bank = banks_[b].get();
-    if (t >= 0) {
-        wxFileDialog fd(this, wxT("Export .dds"), wxEmptyString, wxEmptyString,
-                        wxT("*.dds"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (t >= 0) {                                   // type from the extension
+        wxFileDialog fd(this, wxT("Convert texture"), wxEmptyString, wxEmptyString,
+                        wxT("DDS (*.dds)|*.dds|PNG (*.png)|*.png|TGA (*.tga)|*.tga"),
+                        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
         if (fd.ShowModal() == wxID_OK)
             bank->convertTexture(p, t, std::string(fd.GetPath().mb_str()));
     }
     else if (p >= 0) {
-        wxDirDialog dd(this, wxT("Folder for .dds set"));
+        const wxString kinds[] = { wxT(".dds"), wxT(".png"), wxT(".tga") };
+        wxSingleChoiceDialog sc(this, wxT("Convert the set to"), wxT("Convert set"), 3, kinds);
+        if (sc.ShowModal() != wxID_OK) return;
+
+        wxDirDialog dd(this, wxT("Folder for the ") + kinds[sc.GetSelection()] + wxT(" set"));
         if (dd.ShowModal() == wxID_OK)
-            bank->convertTextureSet(p, std::string(dd.GetPath().mb_str()));
+        {
+            juiced::ConvertOptions o;
+            o.format = sc.GetSelection();           // kConvertDDS / PNG / TGA
+            wxBusyCursor wait;
+            bank->convertTextureSet(p, std::string(dd.GetPath().mb_str()), o);
+        }
     }
 }
 
@@ -505,34 +605,115 @@ void MainFrame::OnImport(wxCommandEvent&)
     {
         wxFileDialog fd(this, wxT("Import texture"),
                         wxEmptyString, wxEmptyString,
-                        wxT("All supported (*.ddt;*.dds)|*.ddt;*.dds|")
+                        wxT("All supported (*.ddt;*.dds;*.png;*.tga)|*.ddt;*.dds;*.png;*.tga|")
                         wxT("DDT files (*.ddt)|*.ddt|")
                         wxT("DDS files (*.dds)|*.dds|")
+                        wxT("Images (*.png;*.tga)|*.png;*.tga|")
                         wxT("All files (*.*)|*.*"),
                         wxFD_OPEN | wxFD_FILE_MUST_EXIST);
 
         if (fd.ShowModal() == wxID_OK)
+        {
+            grid_->invalidate();            // bodies are about to move
+            if (history_) history_->beginGroup("Import");
             ok = bank->importTexture(p, t,
                     std::string(fd.GetPath().mb_str()));
+            if (history_) history_->endGroup();
+        }
     }
     /* -------- whole set -------- */
     else if (p >= 0)
     {
-        wxDirDialog dd(this, wxT("Pick folder with .ddt / .dds"));
+        wxDirDialog dd(this, wxT("Pick folder with .ddt / .dds / .png / .tga"));
         if (dd.ShowModal() == wxID_OK)
+        {
+            grid_->invalidate();            // bodies are about to move
+            if (history_) history_->beginGroup("Import Set");   // one undo step
             ok = bank->importTextureSet(
                     p, std::string(dd.GetPath().mb_str()));
+            if (history_) history_->endGroup();
+        }
     }
+    syncJournal();                          // whatever got staged, even on failure
 
     if (!ok)
     {
-        wxMessageBox(wxString::FromUTF8(gLastErr.c_str()),
+        wxMessageBox(wxString::FromUTF8(bank->lastError().c_str()),
                      wxT("Import failed"),
                      wxOK | wxICON_ERROR);
         return;
     }
 
-    /* remember current tree item, repopulate, reselect */
+    refreshAfterEdit();
+}
+
+/* ─── undo / redo – swap back only the bodies the step touched ─ */
+void MainFrame::OnUndo(wxCommandEvent&)
+{
+    if (!history_ || !history_->canUndo()) { wxBell(); return; }
+
+    wxBusyCursor wait;
+    grid_->invalidate();                    // bodies are about to move
+    if (!history_->undo())
+        wxMessageBox(wxString::FromUTF8(juiced::lastError().c_str()),
+                     wxT("Undo failed"), wxOK | wxICON_ERROR);
+    syncJournal();
+    refreshAfterEdit();
+}
+
+void MainFrame::OnRedo(wxCommandEvent&)
+{
+    if (!history_ || !history_->canRedo()) { wxBell(); return; }
+
+    wxBusyCursor wait;
+    grid_->invalidate();
+    if (!history_->redo())
+        wxMessageBox(wxString::FromUTF8(juiced::lastError().c_str()),
+                     wxT("Redo failed"), wxOK | wxICON_ERROR);
+    syncJournal();
+    refreshAfterEdit();
+}
+
+void MainFrame::OnUpdateUndo(wxUpdateUIEvent& e)
+{
+    const bool undo = e.GetId() == wxID_UNDO;
+    const bool can  = history_ && (undo ? history_->canUndo() : history_->canRedo());
+    wxString   text = undo ? wxT("&Undo") : wxT("&Redo");
+    if (can)
+        text << wxT(' ') << wxString::FromUTF8((undo ? history_->undoLabel()
+                                                     : history_->redoLabel()).c_str());
+    text << (undo ? wxT("\tCtrl+Z") : wxT("\tCtrl+Y"));
+
+    e.Enable(can);
+    e.SetText(text);
+}
+
+/* one fsync per command; a journal that can't write says so once */
+void MainFrame::syncJournal()
+{
+    if (!journal_ || !journal_->ok()) return;
+    if (!journal_->flush())
+        wxMessageBox(wxT("Cannot write ") + wxString::FromUTF8(journal_->path().c_str()) +
+                     wxT(" – staged edits are not protected until the next save."),
+                     wxT("Session journal"), wxOK | wxICON_WARNING);
+}
+
+/* drop history + journal of the open archive; the journal file only
+   stays when there is something unsaved it can bring back          */
+void MainFrame::closeSession()
+{
+    history_.reset();
+    if (!journal_) return;
+
+    const bool dirty = std::any_of(banks_.begin(), banks_.end(),
+                                   [](const BankPtr& up) { return up->isDirty(); });
+    if (!dirty) journal_->remove();
+    journal_.reset();                       // flushes what's left
+}
+
+/* remember current tree item, repopulate, reselect, refresh right pane */
+void MainFrame::refreshAfterEdit()
+{
     const wxTreeItemId remember = tree_->GetSelection();
 
     populateTree();
@@ -540,7 +721,7 @@ void MainFrame::OnImport(wxCommandEvent&)
 
     if (remember.IsOk()) tree_->SelectItem(remember);
 
-    /* refresh right pane */
+    int b, p, t; if (!getSelection(b, p, t)) return;
     if (t >= 0)      showTexInfo (b, p, t);
     else if (p >= 0) showPackInfo(b, p);
 }
@@ -593,6 +774,9 @@ void MainFrame::buildMenus()
     file->Append(wxID_EXIT,wxT("E&xit\tEsc"));
 
     wxMenu* edit=new wxMenu;
+    edit->Append(wxID_UNDO,wxT("&Undo\tCtrl+Z"));
+    edit->Append(wxID_REDO,wxT("&Redo\tCtrl+Y"));
+    edit->AppendSeparator();
     edit->Append(ID_Export ,wxT("&Export\tCtrl+E"));
     edit->Append(ID_Convert,wxT("Con&vert\tCtrl+C"));
     edit->Append(ID_Import ,wxT("&Import\tCtrl+I"));
@@ -618,6 +802,8 @@ void MainFrame::buildAccelerators()
         {wxACCEL_CTRL,'E',ID_Export},
         {wxACCEL_CTRL,'C',ID_Convert},
         {wxACCEL_CTRL,'I',ID_Import},
+        {wxACCEL_CTRL,'Z',wxID_UNDO},
+        {wxACCEL_CTRL,'Y',wxID_REDO},
         {wxACCEL_NORMAL,WXK_ESCAPE,wxID_EXIT},
         {wxACCEL_NORMAL,'+',ID_ZoomIn},
         {wxACCEL_NORMAL,'-',ID_ZoomOut},
@@ -0,0 +1,216 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_archive.cpp  –  .d8t + companion .d8w grouping
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_archive.h"
+#include "d8w_index.h"
+#include "d8w_platform.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+using namespace juiced;
+
+namespace
+{
+
+static std::string dirOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? std::string(".") : p.substr(0, s);
+}
+
+static std::string stemOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    std::string  n = s == std::string::npos ? p : p.substr(s + 1);
+    const size_t d = n.find_last_of('.');
+    return d == std::string::npos ? n : n.substr(0, d);
+}
+
+static bool samePath(const std::string& a, const std::string& b)
+{
+    return plat::icmp(a.c_str(), b.c_str()) == 0;
+}
+
+} // anon
+
+void juiced::findCompanionBanks(const std::string& d8tPath, std::vector<std::string>& out)
+{
+    out.clear();
+    const std::string dir  = dirOf(d8tPath);
+    const std::string stem = stemOf(d8tPath);
+
+    std::vector<std::string> names;
+    plat::listFiles(dir, names);
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (!plat::hasExt(names[i], ".d8w")) continue;
+        if (plat::nicmp(names[i].c_str(), stem.c_str(), stem.size()) != 0) continue;
+        out.push_back(plat::join(dir, names[i]));
+    }
+
+    std::sort(out.begin(), out.end(),
+              [](const std::string& a, const std::string& b){
+                  return plat::icmp(a.c_str(), b.c_str()) < 0;
+              });
+}
+
+bool Archive::open(const std::string& d8tPath, const std::vector<std::string>& d8wPaths)
+{
+    StatusScope st("open");
+    banks_.clear();
+    paths_.clear();
+    fromIndex_ = false;
+    if (!big_.load(d8tPath))
+        return setError("failed to load %s", d8tPath.c_str());
+
+    std::vector<std::string> list = d8wPaths;
+    if (list.empty()) findCompanionBanks(d8tPath, list);
+
+    if (useIndex_ && readIndex(indexPathFor(d8tPath), d8tPath, big_.buffer(), list, ctx_, banks_))
+    {
+        paths_     = list;
+        fromIndex_ = true;
+        return true;
+    }
+
+    for (size_t i = 0; i < list.size(); ++i)
+        if (!bank(list[i])) return false;                     /* Status set */
+
+    refreshIndex();
+    return true;
+}
+
+/* best effort – a missing sidecar only costs the next open a parse */
+void Archive::refreshIndex() const
+{
+    if (!useIndex_) return;
+    std::vector<const D8WBank*> raw;
+    for (size_t i = 0; i < banks_.size(); ++i) raw.push_back(banks_[i].get());
+    writeIndex(indexPathFor(big_.path()), big_.path(), big_.buffer(), paths_, raw);
+}
+
+D8WBank* Archive::findBank(const std::string& d8wPath) const
+{
+    for (size_t i = 0; i < paths_.size(); ++i)
+        if (samePath(paths_[i], d8wPath)) return banks_[i].get();
+    return 0;
+}
+
+D8WBank* Archive::bank(const std::string& d8wPath)
+{
+    if (D8WBank* b = findBank(d8wPath)) return b;
+
+    StatusScope st("bank");
+    std::unique_ptr<D8WBank> b(new D8WBank(ctx_));
+    if (!b->load(d8wPath, big_.buffer()))
+    {
+        if (lastError().empty()) setError("failed to load %s", d8wPath.c_str());
+        return 0;
+    }
+    paths_.push_back(d8wPath);
+    banks_.push_back(std::move(b));
+    return banks_.back().get();
+}
+
+bool Archive::isDirty() const
+{
+    for (size_t i = 0; i < banks_.size(); ++i)
+        if (banks_[i]->isDirty()) return true;
+    return false;
+}
+
+bool Archive::save()
+{
+    StatusScope st("save");
+    bool wroteBig = false;
+    for (size_t i = 0; i < banks_.size(); ++i)
+    {
+        if (!banks_[i]->isDirty()) continue;
+        if (!banks_[i]->save(paths_[i], wroteBig ? std::string() : big_.path()))
+            return setError("save failed: %s (%s)", paths_[i].c_str(), lastError().c_str());
+        wroteBig = true;                       /* only first dirty bank writes .d8t */
+    }
+    if (wroteBig) refreshIndex();
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                            PartFiles
+   ───────────────────────────────────────────────────────────── */
+PartFiles::~PartFiles()
+{
+    for (size_t i = 0; i < parts_.size(); ++i) plat::removeFile(parts_[i]);
+}
+
+std::string PartFiles::add(const std::string& finalPath)
+{
+    finals_.push_back(finalPath);
+    parts_.push_back(finalPath + suffix_);
+    return parts_.back();
+}
+
+bool PartFiles::commit()
+{
+    for (size_t i = 0; i < parts_.size(); ++i)
+        if (!plat::moveFile(parts_[i], finals_[i]))
+            return setError("cannot replace %s", finals_[i].c_str());
+    parts_.clear();
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                     export straight off disk
+   ───────────────────────────────────────────────────────────── */
+bool juiced::addSetJobs(const D8WBank& bank, size_t pack, const std::string& dir, bool dds,
+                        std::vector<ExportJob>& jobs, const ConvertOptions& conv)
+{
+    if (pack >= bank.texturePackCount()) return false;
+    if (!plat::makeDir(dir)) return false;
+
+    const char* ext = dds ? convertExt((ConvertFormat)conv.format) : "ddt";
+    char fn[32];
+    for (size_t i = 0; i < bank.textureCount(pack); ++i)
+    {
+        std::snprintf(fn, sizeof(fn), "Tex%d%04d.%s", (int)pack, (int)i, ext);
+        ExportJob j = { pack, i, plat::join(dir, fn), dds };
+        jobs.push_back(j);
+    }
+    return true;
+}
+
+bool juiced::exportFromDisk(const D8WBank& bank, const std::string& d8tPath,
+                            const std::vector<ExportJob>& jobs, IoStats* stats,
+                            const ConvertOptions& conv)
+{
+    StatusScope   st("exportdisk");
+    ReadScheduler rs;
+    std::mutex    m;
+    std::string   writeErr;                                 /* first failing job */
+
+    for (size_t k = 0; k < jobs.size(); ++k)
+    {
+        const ExportJob& j = jobs[k];
+        if (j.pack >= bank.texturePackCount() || j.idx >= bank.textureCount(j.pack))
+            return setError("texture OOB: %s", j.out.c_str());
+        const TextureHdrEx& h = bank.tables()[j.pack].tex[j.idx];
+        rs.add(h.fileOff, h.size, k);
+    }
+
+    const bool read = rs.run(d8tPath, [&](size_t k, const uint8_t* body, uint32_t)
+    {
+        const ExportJob& j = jobs[k];
+        const bool done = j.dds ? bank.convertTexture(j.pack, j.idx, j.out, body, conv)
+                                : bank.exportTexture (j.pack, j.idx, j.out, body);
+        if (done) return;
+        std::lock_guard<std::mutex> g(m);
+        if (writeErr.empty()) writeErr = j.out + ": " + lastError();
+    }, conv.threads);
+
+    if (stats) *stats = rs.stats();
+    if (!read)             return setError("%s", rs.error().c_str());
+    if (!writeErr.empty()) return setError("%s", writeErr.c_str());
+    return true;
+}
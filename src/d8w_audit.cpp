@@ -0,0 +1,431 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_audit.cpp  –  -audit: header checks + block statistics
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_audit.h"
+#include "d8w_hash.h"
+#include "d8w_io.h"
+#include "d8w_json.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+
+using namespace juiced;
+
+namespace
+{
+
+/* one distinct (offset, size) body and what its blocks say */
+struct Body
+{
+    uint64_t off;
+    uint32_t size;
+    size_t   first;                 /* row that owns it (lowest bank/pack/idx) */
+    uint32_t refs;
+    bool     read, solid, opaque;
+    uint32_t colour;
+    uint64_t hash;
+};
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static bool pow2(uint32_t v) { return v && !(v & (v - 1)); }
+
+/* bytes of mips levels of type starting at level first */
+static uint64_t chainBytes(uint32_t type, uint32_t w, uint32_t h, uint32_t first, uint32_t mips)
+{
+    uint64_t n = 0;
+    for (uint32_t l = first; l < first + mips && l < 32; ++l)
+        n += bc::levelBytes(type, std::max(1u, w >> l), std::max(1u, h >> l));
+    return n;
+}
+
+/* ── solid-colour test on the compressed blocks ─────────────────
+   Each block yields its colour only if every index it uses picks
+   the same palette entry value – palettes are built the way the
+   decoder builds them, no pixels are written.                   */
+static uint32_t expand565(uint16_t c)
+{
+    const uint32_t r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    return ((b << 3) | (b >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((r << 3) | (r >> 2)) << 16) | 0xFF000000u;
+}
+
+static bool colourUniform(const uint8_t* s, bool dxt1, uint32_t& out)
+{
+    const uint16_t c0 = (uint16_t)(s[0] | (s[1] << 8));
+    const uint16_t c1 = (uint16_t)(s[2] | (s[3] << 8));
+    uint32_t idx;
+    std::memcpy(&idx, s + 4, 4);
+
+    unsigned used = 0;
+    for (int k = 0; k < 16; ++k) used |= 1u << ((idx >> (2 * k)) & 3);
+
+    uint32_t pal[4] = { expand565(c0), expand565(c1) };
+    const uint8_t* a = (const uint8_t*)&pal[0];
+    const uint8_t* b = (const uint8_t*)&pal[1];
+    uint8_t p2[4], p3[4];
+    for (int k = 0; k < 3; ++k)
+    {
+        if (!dxt1 || c0 > c1)
+        {
+            p2[k] = (uint8_t)((2 * a[k] + b[k]) / 3);
+            p3[k] = (uint8_t)((a[k] + 2 * b[k]) / 3);
+        }
+        else { p2[k] = (uint8_t)((a[k] + b[k]) >> 1); p3[k] = 0; }
+    }
+    p2[3] = 255;
+    p3[3] = (!dxt1 || c0 > c1) ? 255 : 0;
+    std::memcpy(&pal[2], p2, 4);
+    std::memcpy(&pal[3], p3, 4);
+
+    int k = 0;
+    while (!((used >> k) & 1)) ++k;
+    out = pal[k];
+    for (++k; k < 4; ++k)
+        if (((used >> k) & 1) && pal[k] != out) return false;
+    return true;
+}
+
+/* DXT5 alpha / ATI2 channel block */
+static bool channelUniform(const uint8_t* q, uint8_t& out)
+{
+    const unsigned a0 = q[0], a1 = q[1];
+    uint8_t lut[8] = { (uint8_t)a0, (uint8_t)a1 };
+    if (a0 > a1) for (int k = 1; k <= 6; ++k) lut[1 + k] = (uint8_t)(((7 - k) * a0 + k * a1) / 7);
+    else
+    {
+        for (int k = 1; k <= 4; ++k) lut[1 + k] = (uint8_t)(((5 - k) * a0 + k * a1) / 5);
+        lut[6] = 0; lut[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) bits |= (uint64_t)q[2 + i] << (8 * i);
+    out = lut[bits & 7];
+    for (int i = 1; i < 16; ++i)
+        if (lut[(bits >> (3 * i)) & 7] != out) return false;
+    return true;
+}
+
+static bool blockColour(uint32_t type, const uint8_t* s, uint32_t& out)
+{
+    uint8_t a = 255, x, y;
+    switch (type)
+    {
+    case bc::kTypeDXT1: return colourUniform(s, true, out);
+    case bc::kTypeDXT3:
+        for (int i = 1; i < 8; ++i) if (s[i] != s[0]) return false;
+        if ((s[0] >> 4) != (s[0] & 15) || !colourUniform(s + 8, false, out)) return false;
+        out = (out & 0x00FFFFFFu) | (uint32_t((s[0] & 15) * 17) << 24);
+        return true;
+    case bc::kTypeDXT5:
+        if (!channelUniform(s, a) || !colourUniform(s + 8, false, out)) return false;
+        out = (out & 0x00FFFFFFu) | (uint32_t(a) << 24);
+        return true;
+    case bc::kTypeATI2:                          /* same layout as the preview */
+        if (!channelUniform(s, x) || !channelUniform(s + 8, y)) return false;
+        out = x | (uint32_t(y) << 8) | (127u << 16) | 0xFF000000u;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* top level only; identical blocks are skipped without a palette */
+static bool solidTop(uint32_t type, const uint8_t* s, uint32_t w, uint32_t h, uint32_t& colour)
+{
+    if (type == bc::kTypeARGB)
+    {
+        std::memcpy(&colour, s, 4);
+        for (size_t i = 1; i < size_t(w) * h; ++i)
+            if (std::memcmp(s + i * 4, &colour, 4)) return false;
+        return true;
+    }
+    const uint32_t blk = bc::blockBytes(type);
+    if (!blk) return false;
+    const size_t n = size_t(std::max(1u, (w + 3) / 4)) * std::max(1u, (h + 3) / 4);
+
+    if (!blockColour(type, s, colour)) return false;
+    for (size_t j = 1; j < n; ++j)
+    {
+        const uint8_t* b = s + j * blk;
+        if (!std::memcmp(b, s, blk)) continue;
+        uint32_t c;
+        if (!blockColour(type, b, c) || c != colour) return false;
+    }
+    return true;
+}
+
+static bool argbOpaque(const uint8_t* s, size_t size)
+{
+    for (size_t i = 3; i < size; i += 4)
+        if (s[i] != 255) return false;
+    return true;
+}
+
+static void csvField(const std::string& s, std::string& out)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos) { out += s; return; }
+    out += '"';
+    for (size_t i = 0; i < s.size(); ++i) { if (s[i] == '"') out += '"'; out += s[i]; }
+    out += '"';
+}
+
+static std::string texName(uint32_t pack, uint32_t idx)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "Tex%u%04u", pack, idx);
+    return buf;
+}
+
+} // anon
+
+bool juiced::parseAuditSort(const char* s, AuditSort& out)
+{
+    if (!s) return false;
+    if (!std::strcmp(s, "cost"))    { out = kAuditByCost;    return true; }
+    if (!std::strcmp(s, "savings")) { out = kAuditBySavings; return true; }
+    if (!std::strcmp(s, "name"))    { out = kAuditByName;    return true; }
+    if (!std::strcmp(s, "offset"))  { out = kAuditByOffset;  return true; }
+    return false;
+}
+
+std::string juiced::auditFlagNames(uint32_t flags)
+{
+    static const char* names[] = { "oversized", "mips", "npot", "solid", "opaque", "duplicate", "size" };
+    std::string s;
+    for (int k = 0; k < 7; ++k)
+        if (flags & (1u << k)) { if (!s.empty()) s += '|'; s += names[k]; }
+    return s;
+}
+
+bool juiced::auditArchive(const std::string& d8tPath, const std::vector<std::string>& d8wPaths,
+                          const AuditOptions& opt, AuditReport& r)
+{
+    D8W_TRACE_SCOPE("auditArchive");
+    StatusScope st("audit");
+    r = AuditReport();
+
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi)) return setError("cannot stat %s", d8tPath.c_str());
+
+    /* ── 1. headers of every bank → rows, distinct bodies ──────── */
+    const std::vector<BYTE> none;
+    D8WContext ctx;                                        /* outlives banks */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector<Body>   body;
+    std::vector<size_t> bodyOf;                            /* row → body    */
+    std::map<std::pair<uint64_t, uint32_t>, size_t> byExtent;
+
+    for (size_t b = 0; b < d8wPaths.size(); ++b)
+    {
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks[b]->load(d8wPaths[b], none))
+            return setError("failed to load %s (%s)", d8wPaths[b].c_str(), lastError().c_str());
+
+        const std::string name = baseName(d8wPaths[b]);
+        const std::vector<TextureTable>& t = banks[b]->tables();
+        for (size_t p = 0; p < t.size(); ++p)
+            for (size_t i = 0; i < t[p].tex.size(); ++i)
+            {
+                const TextureHdrEx& h = t[p].tex[i];
+                AuditRow row;
+                row.bank   = name;
+                row.pack   = (uint32_t)p;   row.idx    = (uint32_t)i;
+                row.offset = h.fileOff;     row.bytes  = h.size;
+                row.type   = h.type;        row.width  = h.width;
+                row.height = h.height;      row.mips   = h.mipCnt;
+                row.refs   = 0;             row.flags  = 0;
+                row.colour = 0;             row.hash   = 0;
+                row.savings = 0;
+                r.rows.push_back(row);
+
+                const std::pair<uint64_t, uint32_t> key(h.fileOff, h.size);
+                std::map<std::pair<uint64_t, uint32_t>, size_t>::iterator it = byExtent.find(key);
+                if (it == byExtent.end())
+                {
+                    Body x = { h.fileOff, h.size, r.rows.size() - 1, 0, false, false, false, 0, 0 };
+                    it = byExtent.insert(std::make_pair(key, body.size())).first;
+                    body.push_back(x);
+                }
+                ++body[it->second].refs;
+                bodyOf.push_back(it->second);
+            }
+    }
+    r.banks  = banks.size();
+    r.bodies = body.size();
+
+    /* ── 2. every body once, offset order, looked at on the workers ── */
+    ReadScheduler rs;
+    for (size_t k = 0; k < body.size(); ++k)
+        if (body[k].size && body[k].off + body[k].size <= fi.size) rs.add(body[k].off, body[k].size, k);
+
+    const bool ok = rs.run(d8tPath, [&](size_t k, const uint8_t* s, uint32_t n)
+    {
+        Body& x = body[k];
+        const AuditRow& h = r.rows[x.first];
+        x.hash = hash64(s, n);
+        x.read = true;
+        if (h.width && h.height && n >= bc::levelBytes(h.type, h.width, h.height))
+            x.solid = solidTop(h.type, s, h.width, h.height, x.colour);
+        x.opaque = h.type == bc::kTypeARGB ? argbOpaque(s, n) : bc::alphaOpaque(h.type, s, n);
+    }, opt.threads);
+    if (!ok) return setError("%s", rs.error().c_str());
+
+    /* duplicates: first body (by offset) of each (type, dims, size, hash) */
+    std::map<std::string, size_t> canon;
+    std::vector<size_t> dupOf(body.size(), SIZE_MAX);
+    std::vector<size_t> byOff(body.size());
+    for (size_t k = 0; k < byOff.size(); ++k) byOff[k] = k;
+    std::sort(byOff.begin(), byOff.end(), [&](size_t a, size_t b) { return body[a].off < body[b].off; });
+    for (size_t j = 0; j < byOff.size(); ++j)
+    {
+        const Body& x = body[byOff[j]];
+        if (!x.read) continue;
+        const AuditRow& h = r.rows[x.first];
+        char key[96];
+        std::snprintf(key, sizeof(key), "%08x %ux%u %u %u %016llx", h.type, h.width, h.height,
+                      h.mips, x.size, (unsigned long long)x.hash);
+        std::map<std::string, size_t>::iterator it = canon.find(key);
+        if (it == canon.end()) canon[key] = byOff[j];
+        else dupOf[byOff[j]] = it->second;
+    }
+
+    /* ── 3. flags, the best suggestion per body, rows ──────────── */
+    std::vector<uint64_t> bodySave(body.size(), 0);
+    std::vector<char>     counted(body.size(), 0);
+    for (size_t k = 0; k < r.rows.size(); ++k)
+    {
+        AuditRow&   row = r.rows[k];
+        const Body& x   = body[bodyOf[k]];
+        row.refs = x.refs;
+        row.hash = x.hash;
+
+        const uint32_t full = bc::fullMipCount(row.width, row.height);
+        const bool     dxt  = bc::isEncodable(row.type);
+        const bool     fits = dxt && row.width && row.height &&
+                              chainBytes(row.type, row.width, row.height, 0, row.mips) == row.bytes;
+
+        if (std::max(row.width, row.height) > opt.maxDim) row.flags |= kAuditOversized;
+        if (row.mips != full)                              row.flags |= kAuditMips;
+        if (!pow2(row.width) || !pow2(row.height))         row.flags |= kAuditNpot;
+        if ((dxt && !fits) || x.off + x.size > fi.size)    row.flags |= kAuditSize;
+        if (x.solid)  { row.flags |= kAuditSolid; row.colour = x.colour; }
+        if (x.opaque)   row.flags |= kAuditOpaque;
+        if (dupOf[bodyOf[k]] != SIZE_MAX) row.flags |= kAuditDuplicate;
+
+        char buf[96];
+        auto offer = [&](uint64_t save, const std::string& what)
+        {
+            if (save > row.savings) { row.savings = save; row.suggestion = what; }
+        };
+        if (row.flags & kAuditDuplicate)
+        {
+            const AuditRow& o = r.rows[body[dupOf[bodyOf[k]]].first];
+            offer(row.bytes, "share with " + o.bank + " " + texName(o.pack, o.idx));
+        }
+        if (fits && (row.flags & kAuditSolid))
+        {
+            std::snprintf(buf, sizeof(buf), "solid #%08X -> 4x4", row.colour);
+            const uint64_t small = bc::levelBytes(row.type, 4, 4);
+            if (row.bytes > small) offer(row.bytes - small, buf);
+        }
+        if (fits && (row.flags & kAuditOversized))
+        {
+            uint32_t drop = 0;
+            while (std::max(row.width >> drop, row.height >> drop) > opt.maxDim) ++drop;
+            const uint32_t keep = row.mips > drop ? row.mips - drop : 1;
+            std::snprintf(buf, sizeof(buf), "downscale to %ux%u",
+                          std::max(1u, row.width >> drop), std::max(1u, row.height >> drop));
+            offer(row.bytes - chainBytes(row.type, row.width, row.height, drop, keep), buf);
+        }
+        if (fits && (row.flags & kAuditOpaque))
+        {
+            if (row.type == bc::kTypeARGB)
+                offer(row.bytes - chainBytes(bc::kTypeDXT1, row.width, row.height, 0, row.mips),
+                      "DXT1 (lossy, alpha unused)");
+            else
+                offer(row.bytes / 2, "DXT1 (-shrink)");
+        }
+
+        if (row.flags) ++r.flagged;
+        if (!counted[bodyOf[k]])
+        {
+            counted[bodyOf[k]] = 1;
+            r.bytes   += row.bytes;
+            r.savings += row.savings;
+        }
+    }
+
+    /* ── 4. order ──────────────────────────────────────────────── */
+    std::stable_sort(r.rows.begin(), r.rows.end(), [&](const AuditRow& a, const AuditRow& b)
+    {
+        switch (opt.sort)
+        {
+        case kAuditBySavings: if (a.savings != b.savings) return a.savings > b.savings; break;
+        case kAuditByOffset:  return a.offset < b.offset;
+        case kAuditByName:    return false;                /* already bank / pack / idx */
+        default:              break;
+        }
+        return a.bytes > b.bytes;
+    });
+    return true;
+}
+
+void juiced::writeAuditCSV(const AuditReport& r, std::string& out)
+{
+    out += "bank,pack,idx,name,offset,type,width,height,mips,bytes,refs,flags,hash,suggestion,savings\n";
+    char buf[160];
+    for (size_t k = 0; k < r.rows.size(); ++k)
+    {
+        const AuditRow& x = r.rows[k];
+        csvField(x.bank, out);
+        std::snprintf(buf, sizeof(buf), ",%u,%u,%s,%u,%s,%u,%u,%u,%u,%u,", x.pack, x.idx,
+                      texName(x.pack, x.idx).c_str(), x.offset, bc::typeName(x.type),
+                      x.width, x.height, x.mips, x.bytes, x.refs);
+        out += buf;
+        out += auditFlagNames(x.flags);
+        std::snprintf(buf, sizeof(buf), ",%016llx,", (unsigned long long)x.hash);
+        out += buf;
+        csvField(x.suggestion, out);
+        std::snprintf(buf, sizeof(buf), ",%llu\n", (unsigned long long)x.savings);
+        out += buf;
+    }
+}
+
+void juiced::writeAuditJSON(const AuditReport& r, std::string& out)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"banks\":%u,\"bodies\":%u,\"bytes\":%llu,\"savings\":%llu,\"flagged\":%u,\"textures\":[",
+                  (unsigned)r.banks, (unsigned)r.bodies, (unsigned long long)r.bytes,
+                  (unsigned long long)r.savings, (unsigned)r.flagged);
+    out += buf;
+    for (size_t k = 0; k < r.rows.size(); ++k)
+    {
+        const AuditRow& x = r.rows[k];
+        out += k ? ",\n{\"bank\":" : "\n{\"bank\":";
+        json::quote(x.bank, out);
+        std::snprintf(buf, sizeof(buf),
+                      ",\"pack\":%u,\"idx\":%u,\"name\":\"%s\",\"offset\":%u,\"type\":\"%s\","
+                      "\"width\":%u,\"height\":%u,\"mips\":%u,\"bytes\":%u,\"refs\":%u,\"flags\":",
+                      x.pack, x.idx, texName(x.pack, x.idx).c_str(), x.offset, bc::typeName(x.type),
+                      x.width, x.height, x.mips, x.bytes, x.refs);
+        out += buf;
+        json::quote(auditFlagNames(x.flags), out);
+        std::snprintf(buf, sizeof(buf), ",\"hash\":\"%016llx\",\"suggestion\":", (unsigned long long)x.hash);
+        out += buf;
+        json::quote(x.suggestion, out);
+        std::snprintf(buf, sizeof(buf), ",\"savings\":%llu}", (unsigned long long)x.savings);
+        out += buf;
+    }
+    out += "\n]}\n";
+}
@@ -0,0 +1,231 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_batch.cpp  –  -batch <manifest> runner
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_batch.h"
+#include "d8w_commands.h"
+#include "d8w_parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+using namespace juiced;
+using json::Value;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+struct Entry
+{
+    Value       cmd;
+    Value       reply;
+    std::string parseErr;           /* non-empty → line was not JSON */
+    size_t      line;               /* 1-based manifest line         */
+};
+
+/* JSON array, or one request per line ('#' comments, blanks skipped) */
+static bool readManifest(const std::string& path, std::vector<Entry>& out, std::string& err)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) { err = "cannot open " + path; return false; }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+
+    const size_t first = text.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && text[first] == '[')
+    {
+        Value doc;
+        if (!json::parse(text, doc, err)) { err = "manifest: " + err; return false; }
+        for (size_t i = 0; i < doc.size(); ++i)
+        {
+            Entry e;
+            e.cmd  = doc.at(i);
+            e.line = i + 1;
+            out.push_back(e);
+        }
+        return true;
+    }
+
+    size_t pos = 0, line = 0;
+    while (pos < text.size())
+    {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string::npos) nl = text.size();
+        const std::string row = text.substr(pos, nl - pos);
+        pos = nl + 1;
+        ++line;
+
+        const size_t s = row.find_first_not_of(" \t\r");
+        if (s == std::string::npos || row[s] == '#') continue;
+
+        Entry e;
+        e.line = line;
+        if (!json::parse(row, e.cmd, e.parseErr)) e.cmd = Value();
+        out.push_back(e);
+    }
+    return true;
+}
+
+static void stamp(Entry& e, double ms)
+{
+    e.reply.set("line", (unsigned)e.line);
+    e.reply.set("ms",   ms);
+}
+
+} // anon
+
+int juiced::runBatch(const std::string& manifestPath, const BatchOptions& opt)
+{
+    const Clock::time_point t0 = Clock::now();
+
+    std::vector<Entry> ops;
+    std::string        err;
+    if (!readManifest(manifestPath, ops, err))
+    {
+        std::cerr << err << '\n';
+        return 2;
+    }
+
+    CommandHost host;
+    host.setUseIndex(opt.index);
+
+    /* ── 1. load every referenced archive / bank once ─────────── */
+    std::set< std::pair<std::string,std::string> > opened;
+    std::vector<std::string>                        archives;
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        const std::string d8t = ops[i].cmd.str("d8t");
+        const std::string d8w = ops[i].cmd.str("d8w");
+        if (d8t.empty() || !opened.insert(std::make_pair(d8t, d8w)).second) continue;
+        if (std::find(archives.begin(), archives.end(), d8t) == archives.end())
+            archives.push_back(d8t);
+
+        Value open = Value::object(), r;
+        open.set("op",  "open");
+        open.set("d8t", d8t);
+        if (!d8w.empty()) open.set("d8w", d8w);
+        host.execute(open, r);          /* a failure resurfaces on the op itself */
+    }
+
+    /* ── 2. runs of reads in parallel, writes in order ─────────── */
+    size_t i = 0;
+    while (i < ops.size())
+    {
+        Entry& e = ops[i];
+        const std::string op = e.cmd.str("op");
+
+        if (!e.parseErr.empty() || !CommandHost::isReadOp(op))
+        {
+            const Clock::time_point ts = Clock::now();
+            if (!e.parseErr.empty())
+            {
+                e.reply = Value::object();
+                e.reply.set("ok", false);
+                e.reply.set("error", "bad json: " + e.parseErr);
+            }
+            else if (op == "save" || op == "shutdown")
+            {
+                e.reply = Value::object();
+                if (const Value* id = e.cmd.find("id")) e.reply.set("id", *id);
+                e.reply.set("ok", true);
+                e.reply.set("deferred", true);                /* saves happen once, at the end */
+            }
+            else
+            {
+                Value c = e.cmd;
+                if (c.has("save")) c.set("save", false);
+                host.execute(c, e.reply);
+            }
+            stamp(e, msSince(ts));
+            ++i;
+            continue;
+        }
+
+        /* gather the run of reads and order it by .d8t offset */
+        size_t j = i;
+        while (j < ops.size() && ops[j].parseErr.empty() &&
+               CommandHost::isReadOp(ops[j].cmd.str("op"))) ++j;
+
+        struct Key { std::string d8t; uint32_t off; size_t at; };
+        std::vector<Key> order;
+        for (size_t k = i; k < j; ++k)
+        {
+            Key key = { ops[k].cmd.str("d8t"), 0xFFFFFFFFu, k };
+            host.extentOf(ops[k].cmd, key.off);
+            order.push_back(key);
+        }
+        std::stable_sort(order.begin(), order.end(), [](const Key& a, const Key& b)
+        {
+            return a.d8t != b.d8t ? a.d8t < b.d8t : a.off < b.off;
+        });
+
+        parallelFor(order.size(), [&](size_t k)
+        {
+            Entry& r = ops[order[k].at];
+            const Clock::time_point ts = Clock::now();
+            host.execute(r.cmd, r.reply);
+            stamp(r, msSince(ts));
+        }, opt.threads);
+        i = j;
+    }
+
+    /* ── 3. one save per dirty archive ─────────────────────────── */
+    Value saved = Value::array();
+    bool  allOk = true;
+    if (opt.save)
+        for (size_t a = 0; a < archives.size(); ++a)
+        {
+            Value s = Value::object(), r;
+            s.set("op",  "save");
+            s.set("d8t", archives[a]);
+            host.execute(s, r);
+            if (!r.flag("ok"))
+            {
+                Value f = Value::object();
+                f.set("d8t",   archives[a]);
+                f.set("error", r.str("error"));
+                saved.push(f);
+                allOk = false;
+            }
+            else if (r.flag("written")) saved.push(archives[a]);
+        }
+
+    /* ── 4. result log, manifest order ─────────────────────────── */
+    std::ofstream file;
+    if (!opt.logPath.empty())
+    {
+        file.open(opt.logPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file) std::cerr << "cannot write " << opt.logPath << '\n';
+    }
+    std::ostream& log = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    size_t failed = 0;
+    for (size_t k = 0; k < ops.size(); ++k)
+    {
+        if (!ops[k].reply.flag("ok")) ++failed;
+        log << ops[k].reply.dump() << '\n';
+    }
+
+    Value sum = Value::object();
+    sum.set("summary", true);
+    sum.set("ops",     (unsigned)ops.size());
+    sum.set("failed",  (unsigned)failed);
+    sum.set("saved",   saved);
+    sum.set("ms",      msSince(t0));
+    log << sum.dump() << '\n';
+    log.flush();
+
+    return failed || !allOk ? 3 : 0;
+}
@@ -0,0 +1,696 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_cli.cpp  –  CLI verbs for d8t + d8w (no GUI dependency)
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_cli.h"
+#include "d8w_parser.h"         /* D8TFile, D8WBank */
+#include "d8w_archive.h"        /* exportFromDisk    */
+#include "d8w_audit.h"          /* -audit            */
+#include "d8w_batch.h"          /* -batch manifests  */
+#include "d8w_diff.h"           /* -diff             */
+#include "d8w_patch.h"          /* -mkpatch / -applypatch */
+#include "d8w_platform.h"       /* plat::writeFile   */
+#include "d8w_repack.h"         /* -repack           */
+#include "d8w_serve.h"          /* -serve daemon     */
+#include "d8w_sheet.h"          /* -contactsheet     */
+#include "d8w_shrink.h"         /* -shrink           */
+#include "d8w_sync.h"           /* -sync             */
+#include "d8w_tar.h"            /* -exporttar        */
+#include "d8w_trace.h"          /* -trace            */
+#include "d8w_verify.h"         /* -verify           */
+#include "BCEncoder.h"          /* bc::parseQuality, parseMipFilter */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using juiced::D8TFile;
+using juiced::D8WBank;
+using juiced::printUsage;
+
+/*──────────────────────── helpers ─────────────────────────────*/
+void juiced::printUsage()
+{
+    std::cout <<
+      "Usage (CLI):\n"
+      "  -export      <d8t> <d8w> <pack> <idx> <out.ddt>\n"
+      "  -exportset   <d8t> <d8w> <pack> <outDir>\n"
+      "  -convert     <d8t> <d8w> <pack> <idx> <out.dds|png|tga> [copts]\n"
+      "  -convertset  <d8t> <d8w> <pack> <outDir> [copts]\n"
+      "  -import      <d8t> <d8w> <pack> <idx> <in.ddt|dds|png|tga> [opts]\n"
+      "  -importset   <d8t> <d8w> <pack> <inDir> [opts]\n"
+      "  -sync        <d8t> <d8w> <pack> <inDir> [--watch] [--dry] [opts]\n"
+      "\n"
+      "  import opts:\n"
+      "    fast | normal | high     encoder quality            (default normal)\n"
+      "    -filter box|kaiser       mip down-sampling filter   (default box)\n"
+      "    -maxmips <n>             cap the imported mip chain at n levels\n"
+      "    -keepmips                keep a DDS/DDT's own mip count\n"
+      "\n"
+      "  convert opts (copts):\n"
+      "    -format dds|png|tga      file type of a -convertset (default dds)\n"
+      "    -store | -fast           PNG without / with quick deflate (default fast)\n"
+      "    -level <0-9>             PNG deflate level, 9 smallest\n"
+      "    -threads <n>             textures decoded at once (default all cores)\n"
+      "\n"
+      "  -sync imports like -importset, but only the files that changed since\n"
+      "      the last sync (<inDir>/.d8wsync: size, mtime, content hash) and\n"
+      "      whose content isn't the slot's already; saves when anything was\n"
+      "      staged. --watch keeps running and syncs whenever the folder\n"
+      "      changes, --dry only counts. Exit code 2 when a file failed.\n"
+      "\n"
+      "  -serve [--socket <path>] [--threads <n>] [--index] [--open <d8t>]...\n"
+      "      resident daemon: newline-delimited JSON requests on stdin\n"
+      "      (or the Unix socket), one JSON reply line each, e.g.\n"
+      "      {\"id\":1,\"op\":\"export\",\"d8t\":\"a.d8t\",\"d8w\":\"a.d8w\",\n"
+      "       \"pack\":0,\"idx\":3,\"out\":\"t.ddt\"}\n"
+      "      ops: open close status list inspect export exportset convert\n"
+      "           convertset import importset save ping shutdown\n"
+      "      --index / \"index\":true on open: reuse a valid <stem>.d8idx\n"
+      "      sidecar instead of parsing every .d8w, refresh it otherwise\n"
+      "\n"
+      "  -batch <manifest> [--log <file>] [--threads <n>] [--nosave] [--index]\n"
+      "      run a file of -serve requests (JSONL or a JSON array); reads are\n"
+      "      ordered by .d8t offset, each dirty archive is saved once at the end\n"
+      "\n"
+      "  -verify <d8t> [<d8w>...] [--manifest <file>] [--write-manifest <file>]\n"
+      "          [--threads <n>] [--nohash]\n"
+      "      check every table / texture extent (bounds, overlap, order) and\n"
+      "      checksum each body; the banks default to the .d8t's companions.\n"
+      "      Exit code 2 when anything is wrong.\n"
+      "\n"
+      "  -audit <d8t> [<d8w>...] [--json] [--out <file>] [--sort cost|savings|name|offset]\n"
+      "          [--maxdim <px>] [--threads <n>]\n"
+      "      one row per texture (CSV, or JSON): byte cost, sharing, flags for\n"
+      "      oversized / mip count / npot / solid colour / unused alpha /\n"
+      "      duplicate / bad size, and the suggestion that saves the most\n"
+      "\n"
+      "  -diff <a.d8t> <b.d8t> [--threads <n>] [--noblocks]\n"
+      "      what changed between two versions: added / removed / moved /\n"
+      "      resized / re-encoded textures and header-field edits; bodies are\n"
+      "      hashed once, only differing ones are compared block by block.\n"
+      "      Exit code 2 when the archives differ.\n"
+      "\n"
+      "  -mkpatch <orig.d8t> <modified.d8t> <out.d8p>\n"
+      "      delta patch of the replaced texture bodies (banks next to each .d8t)\n"
+      "  -applypatch <patch.d8p> <d8t> [<outDir>]\n"
+      "      stream the .d8t once into its patched version; in place without\n"
+      "      outDir (only after every checksum matched)\n"
+      "\n"
+      "  -repack <d8t> [<outDir>] [--order bank|pack|heat] [--heat <file>]\n"
+      "          [--align <bytes>] [--nocoalesce] [--threads <n>]\n"
+      "      rewrite the .d8t without gaps, byte-identical tables shared, in\n"
+      "      the given order (heat: <bank.d8w> <pack> <hits> lines, default\n"
+      "      the number of banks sharing a table); every .d8w follows along.\n"
+      "      In place without outDir\n"
+      "\n"
+      "  -shrink <d8t> [<outDir>] [--dry] [--threads <n>]\n"
+      "      DXT3 / DXT5 textures whose alpha is 255 everywhere become DXT1\n"
+      "      (same pixels, half the bytes); every .d8w follows along. In place\n"
+      "      without outDir, --dry only reports\n"
+      "\n"
+      "  -exporttar <d8t> <out.tar | -> [<bank.d8w> [<pack>]]\n"
+      "          [--format ddt|dds|png|tga] [--level <0-9>] [--threads <n>]\n"
+      "      a pack, a bank or the whole archive as one tar stream (- = stdout),\n"
+      "      members <bank>/Tex<p><iiii>.<ext> in .d8t offset order\n"
+      "\n"
+      "  -contactsheet <d8t> <outDir> [<bank.d8w> [<pack>]] [--tile <px>]\n"
+      "          [--cols <n>] [--rows <n>] [--nolabels] [--level <0-9>] [--threads <n>]\n"
+      "      every texture of a pack, a bank or the whole archive as labelled\n"
+      "      thumbnails on paged PNGs (<bank>_NNN.png); no display needed\n"
+      "\n"
+      "  -trace <out.json | -> <any of the above>\n"
+      "      time the run: Chrome trace-event JSON (chrome://tracing), or a\n"
+      "      per-scope summary table on stderr for '-'\n";
+}
+
+/* simple atoi with range-check */
+static bool parseUint(const char* s, size_t& out)
+{
+    char* end = 0;
+    long v = ::strtol(s, &end, 10);
+    if (!*s || *end || v < 0) return false;
+    out = static_cast<size_t>(v);
+    return true;
+}
+
+/* optional trailing options for the import verbs */
+static bool applyImportOptions(D8WBank& bank, int argc, char** argv, int at)
+{
+    juiced::ImportOptions o = bank.importOptions();
+    for (int i = at; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        juiced::bc::Quality q;
+        juiced::MipFilter   f;
+        size_t              n;
+        if (juiced::bc::parseQuality(argv[i], q))           o.quality = q;
+        else if (a == "-keepmips")                          o.fitMips = false;
+        else if (a == "-filter" && i + 1 < argc &&
+                 juiced::parseMipFilter(argv[i + 1], f))  { o.mipFilter = f; ++i; }
+        else if (a == "-maxmips" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n) && n)          { o.maxMips = (uint32_t)n; ++i; }
+        else return false;
+    }
+    bank.setImportOptions(o);
+    return true;
+}
+
+/* optional trailing options for the convert verbs */
+static bool parseConvertOptions(juiced::ConvertOptions& o, int argc, char** argv, int at)
+{
+    for (int i = at; i < argc; ++i)
+    {
+        const std::string     a = argv[i];
+        juiced::ConvertFormat f;
+        size_t                n;
+        if (a == "-store")                                  o.level = 0;
+        else if (a == "-fast")                              o.level = 1;
+        else if (a == "-format" && i + 1 < argc &&
+                 juiced::parseConvertFormat(argv[i + 1], f)) { o.format = f; ++i; }
+        else if (a == "-level" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n) && n <= 9)     { o.level = (int)n; ++i; }
+        else if (a == "-threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))               { o.threads = (unsigned)n; ++i; }
+        else return false;
+    }
+    return true;
+}
+
+/* -serve [--socket p] [--threads n] [--index] [--open d8t]… */
+static int runServe(int argc, char** argv)
+{
+    juiced::CommandHost  host;
+    juiced::ServeOptions opt;
+    for (int i = 2; i < argc; ++i)                /* before any --open */
+        if (std::string(argv[i]) == "--index") host.setUseIndex(true);
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--socket" && i + 1 < argc)       opt.socketPath = argv[++i];
+        else if (a == "--index")                   continue;
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))       { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--open" && i + 1 < argc)
+        {
+            juiced::json::Value cmd = juiced::json::Value::object(), reply;
+            cmd.set("op",  "open");
+            cmd.set("d8t", argv[++i]);
+            if (!host.execute(cmd, reply))
+            {
+                std::cerr << reply.str("error") << '\n';
+                return 3;
+            }
+        }
+        else { printUsage(); return 1; }
+    }
+    return juiced::serve(host, opt);
+}
+
+/* -batch <manifest> [--log f] [--threads n] [--nosave] [--index] */
+static int runBatchCLI(int argc, char** argv)
+{
+    if (argc < 3) { printUsage(); return 1; }
+
+    juiced::BatchOptions opt;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--log" && i + 1 < argc)          opt.logPath = argv[++i];
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))       { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--nosave")                  opt.save = false;
+        else if (a == "--index")                   opt.index = true;
+        else { printUsage(); return 1; }
+    }
+    return juiced::runBatch(argv[2], opt);
+}
+
+/* bail-out helper (pre-C++11, no lambda) */
+static int bail(const char* msg)
+{
+    std::cout << msg << '\n';
+    return 3;
+}
+
+/* -verify <d8t> [d8w…] [--manifest f] [--write-manifest f] [--threads n] [--nohash] */
+static int runVerifyCLI(int argc, char** argv)
+{
+    if (argc < 3) { printUsage(); return 1; }
+
+    juiced::VerifyOptions    opt;
+    std::vector<std::string> banks;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--manifest" && i + 1 < argc)            opt.manifestIn  = argv[++i];
+        else if (a == "--write-manifest" && i + 1 < argc) opt.manifestOut = argv[++i];
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--nohash")                         opt.checksums = false;
+        else if (a.compare(0, 2, "--") != 0)              banks.push_back(a);
+        else { printUsage(); return 1; }
+    }
+    if (banks.empty()) juiced::findCompanionBanks(argv[2], banks);
+    if (banks.empty()) return bail("no .d8w next to the .d8t");
+
+    juiced::VerifyReport rep;
+    if (!juiced::verifyArchive(argv[2], banks, opt, rep))
+        return bail(juiced::lastError().c_str());
+
+    for (size_t k = 0; k < rep.problems.size(); ++k)
+        std::cout << "FAIL " << rep.problems[k] << '\n';
+    std::cout << rep.banks << " banks, " << rep.tables << " tables, "
+              << rep.textures << " textures, " << rep.extents << " extents, "
+              << rep.bytesHashed << " bytes hashed, " << rep.gapBytes << " gap bytes: "
+              << (rep.ok() ? "OK" : "DAMAGED") << '\n';
+    return rep.ok() ? 0 : 2;
+}
+
+/* -audit <d8t> [d8w...] [--json] [--out f] [--sort s] [--maxdim n] [--threads n] */
+static int runAuditCLI(int argc, char** argv)
+{
+    if (argc < 3) { printUsage(); return 1; }
+
+    juiced::AuditOptions     opt;
+    std::vector<std::string> banks;
+    std::string              outPath;
+    bool                     json = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--json")                                json = true;
+        else if (a == "--out" && i + 1 < argc)            outPath = argv[++i];
+        else if (a == "--sort" && i + 1 < argc &&
+                 juiced::parseAuditSort(argv[i + 1], opt.sort)) ++i;
+        else if (a == "--maxdim" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n) && n)         { opt.maxDim = (uint32_t)n; ++i; }
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.threads = (unsigned)n; ++i; }
+        else if (a.compare(0, 2, "--") != 0)              banks.push_back(a);
+        else { printUsage(); return 1; }
+    }
+    if (banks.empty()) juiced::findCompanionBanks(argv[2], banks);
+    if (banks.empty()) return bail("no .d8w next to the .d8t");
+
+    juiced::AuditReport rep;
+    if (!juiced::auditArchive(argv[2], banks, opt, rep))
+        return bail(juiced::lastError().c_str());
+
+    std::string text;
+    if (json) juiced::writeAuditJSON(rep, text);
+    else      juiced::writeAuditCSV (rep, text);
+    if (outPath.empty()) std::cout << text;
+    else if (!juiced::plat::writeFile(outPath, text.data(), text.size()))
+        return bail(("cannot write " + outPath).c_str());
+
+    std::cerr << rep.banks << " banks, " << rep.rows.size() << " textures, " << rep.bodies
+              << " bodies (" << rep.bytes << " bytes), " << rep.flagged << " flagged, "
+              << rep.savings << " bytes suggested savings\n";
+    return 0;
+}
+
+/* -diff <a.d8t> <b.d8t> [--threads n] [--noblocks] */
+static int runDiffCLI(int argc, char** argv)
+{
+    if (argc < 4) { printUsage(); return 1; }
+
+    juiced::DiffOptions opt;
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--threads" && i + 1 < argc &&
+            parseUint(argv[i + 1], n))                   { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--noblocks")                       opt.blocks = false;
+        else { printUsage(); return 1; }
+    }
+
+    juiced::DiffReport rep;
+    if (!juiced::diffArchives(argv[2], argv[3], opt, rep))
+        return bail(juiced::lastError().c_str());
+
+    static const char mark[] = { '+', '-', '>', '~', '~', '=' };
+    for (size_t k = 0; k < rep.banksRemoved.size(); ++k)
+        std::cout << "- bank " << rep.banksRemoved[k] << '\n';
+    for (size_t k = 0; k < rep.banksAdded.size(); ++k)
+        std::cout << "+ bank " << rep.banksAdded[k] << '\n';
+    for (size_t k = 0; k < rep.entries.size(); ++k)
+    {
+        const juiced::DiffEntry& e = rep.entries[k];
+        std::cout << mark[e.kind] << ' ' << juiced::diffKindName(e.kind) << ' '
+                  << e.where << ": " << e.detail << '\n';
+    }
+    std::cout << rep.banksA << " / " << rep.banksB << " banks, "
+              << rep.texturesA << " / " << rep.texturesB << " textures, "
+              << rep.same << " same, "
+              << rep.count(juiced::DiffEntry::kAdded)     << " added, "
+              << rep.count(juiced::DiffEntry::kRemoved)   << " removed, "
+              << rep.count(juiced::DiffEntry::kMoved)     << " moved, "
+              << rep.count(juiced::DiffEntry::kResized)   << " resized, "
+              << rep.count(juiced::DiffEntry::kReencoded) << " re-encoded, "
+              << rep.count(juiced::DiffEntry::kHeader)    << " header-only, "
+              << rep.bytesHashed << " bytes hashed: "
+              << (rep.identical() ? "IDENTICAL" : "DIFFERENT") << '\n';
+    return rep.identical() ? 0 : 2;
+}
+
+/* -repack <d8t> [outDir] [--order o] [--heat f] [--align n] [--nocoalesce] [--threads n] */
+static int runRepackCLI(int argc, char** argv)
+{
+    if (argc < 3) { printUsage(); return 1; }
+
+    juiced::RepackOptions opt;
+    std::string           outDir;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--order" && i + 1 < argc &&
+            juiced::parseRepackOrder(argv[i + 1], opt.order)) ++i;
+        else if (a == "--heat" && i + 1 < argc)          { opt.heatPath = argv[++i];
+                                                           opt.order    = juiced::kRepackByHeat; }
+        else if (a == "--align" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.align = (uint32_t)n; ++i; }
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--nocoalesce")                     opt.coalesce = false;
+        else if (a.compare(0, 2, "--") != 0 && outDir.empty()) outDir = a;
+        else { printUsage(); return 1; }
+    }
+
+    juiced::RepackStats rs;
+    if (!juiced::repackArchive(argv[2], opt, outDir, &rs))
+        return bail(juiced::lastError().c_str());
+    std::cout << rs.banks << " banks, " << rs.tables << " tables, " << rs.spans << " spans ("
+              << rs.coalesced << " coalesced), " << rs.bytesIn << " → " << rs.bytesOut
+              << " bytes, " << rs.padBytes << " padding\n";
+    return 0;
+}
+
+/* -shrink <d8t> [outDir] [--dry] [--threads n] */
+static int runShrinkCLI(int argc, char** argv)
+{
+    if (argc < 3) { printUsage(); return 1; }
+
+    juiced::ShrinkOptions opt;
+    std::string           outDir;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--dry")                                 opt.dryRun = true;
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.threads = (unsigned)n; ++i; }
+        else if (a.compare(0, 2, "--") != 0 && outDir.empty()) outDir = a;
+        else { printUsage(); return 1; }
+    }
+
+    juiced::ShrinkStats ss;
+    if (!juiced::shrinkArchive(argv[2], opt, outDir, &ss))
+        return bail(juiced::lastError().c_str());
+    std::cout << ss.banks << " banks, " << ss.opaque << " of " << ss.bodies
+              << " DXT3/DXT5 bodies opaque → DXT1 (" << ss.skipped << " skipped), "
+              << ss.bytesIn << " → " << ss.bytesOut << " bytes"
+              << (opt.dryRun ? " (dry run)\n" : "\n");
+    return 0;
+}
+
+/* -exporttar <d8t> <out.tar|-> [d8w [pack]] [--format f] [--level n] [--threads n] */
+static int runTarCLI(int argc, char** argv)
+{
+    if (argc < 4) { printUsage(); return 1; }
+
+    juiced::ConvertOptions   conv;
+    bool                     convert = false;
+    std::vector<std::string> paths;
+    int                      pack = -1;
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string     a = argv[i];
+        juiced::ConvertFormat f;
+        size_t                n;
+        if (a == "--format" && i + 1 < argc && std::string(argv[i + 1]) == "ddt") { convert = false; ++i; }
+        else if (a == "--format" && i + 1 < argc &&
+                 juiced::parseConvertFormat(argv[i + 1], f)) { conv.format = f; convert = true; ++i; }
+        else if (a == "--level" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n) && n <= 9)    { conv.level = (int)n; ++i; }
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { conv.threads = (unsigned)n; ++i; }
+        else if (a.compare(0, 2, "--") != 0 && paths.empty()) paths.push_back(a);
+        else if (a.compare(0, 2, "--") != 0 && pack < 0 &&
+                 parseUint(argv[i], n))                   pack = (int)n;
+        else { printUsage(); return 1; }
+    }
+    if (paths.empty()) juiced::findCompanionBanks(argv[2], paths);
+    if (paths.empty()) return bail("no .d8w next to the .d8t");
+
+    /* headers only – bodies come straight off the .d8t */
+    const std::vector<BYTE>                 none;
+    juiced::D8WContext                      ctx;
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector<juiced::TarEntry>           entries;
+    const char* ext = convert ? juiced::convertExt((juiced::ConvertFormat)conv.format) : "ddt";
+    for (size_t b = 0; b < paths.size(); ++b)
+    {
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks[b]->load(paths[b], none))
+            return bail(("failed to load " + paths[b]).c_str());
+        if (pack >= (int)banks[b]->texturePackCount())
+            return bail(("no such pack in " + paths[b]).c_str());
+
+        std::string stem = paths[b].substr(paths[b].find_last_of("\\/") + 1);
+        stem = stem.substr(0, stem.find_last_of('.'));
+        juiced::addTarEntries(*banks[b], pack, stem + "/", ext, entries);
+    }
+
+    juiced::TarStats ts;
+    if (!juiced::exportTar(argv[2], entries, argv[3], convert, conv, &ts))
+    {
+        std::cerr << juiced::lastError() << '\n';       /* stdout may be the tar */
+        return 3;
+    }
+    std::cerr << ts.members << " members, " << ts.bytesRead << " bytes read, "
+              << ts.bytesWritten << " bytes written\n";
+    return 0;
+}
+
+/* -contactsheet <d8t> <outDir> [d8w [pack]] [--tile n] [--cols n] [--rows n]
+                 [--nolabels] [--level n] [--threads n]                       */
+static int runSheetCLI(int argc, char** argv)
+{
+    if (argc < 4) { printUsage(); return 1; }
+
+    juiced::SheetOptions     opt;
+    std::vector<std::string> banks;
+    int                      pack = -1;
+    for (int i = 4; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        size_t n;
+        if (a == "--tile" && i + 1 < argc &&
+            parseUint(argv[i + 1], n))                   { opt.tile = (uint32_t)n; ++i; }
+        else if (a == "--cols" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.cols = (uint32_t)n; ++i; }
+        else if (a == "--rows" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.rows = (uint32_t)n; ++i; }
+        else if (a == "--level" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n) && n <= 9)    { opt.level = (int)n; ++i; }
+        else if (a == "--threads" && i + 1 < argc &&
+                 parseUint(argv[i + 1], n))              { opt.threads = (unsigned)n; ++i; }
+        else if (a == "--nolabels")                       opt.labels = false;
+        else if (a.compare(0, 2, "--") != 0 && banks.empty()) banks.push_back(a);
+        else if (a.compare(0, 2, "--") != 0 && pack < 0 &&
+                 parseUint(argv[i], n))                   pack = (int)n;
+        else { printUsage(); return 1; }
+    }
+
+    juiced::SheetStats ss;
+    if (!juiced::writeContactSheets(argv[2], banks, pack, argv[3], opt, &ss))
+        return bail(juiced::lastError().c_str());
+    std::cout << ss.textures << " textures (" << ss.failed << " undecodable) on "
+              << ss.sheets << " sheets, " << ss.bytesRead << " bytes read, "
+              << ss.bytesWritten << " bytes written\n";
+    return 0;
+}
+
+/* -sync <d8t> <d8w> <pack> <dir> [--watch] [--dry] [import opts] */
+static int runSyncCLI(int argc, char** argv)
+{
+    size_t pack;
+    if (argc < 6 || !parseUint(argv[4], pack)) { printUsage(); return 1; }
+
+    bool               watch = false, dry = false;
+    std::vector<char*> rest;                      /* import options */
+    for (int i = 6; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (a == "--watch")    watch = true;
+        else if (a == "--dry") dry = true;
+        else                   rest.push_back(argv[i]);
+    }
+
+    /* every companion bank, so shared bodies move everywhere */
+    juiced::Archive arc;
+    if (!arc.open(argv[2])) return bail(juiced::lastError().c_str());
+    D8WBank* bank = arc.bank(argv[3]);
+    if (!bank) return bail(juiced::lastError().c_str());
+    if (!applyImportOptions(*bank, (int)rest.size(), rest.data(), 0)) { printUsage(); return 1; }
+
+    juiced::FolderSync    sync(*bank, pack, argv[5]);
+    juiced::plat::DirWatch dirWatch;
+    if (watch && !dirWatch.open(argv[5])) return bail("cannot watch the folder");
+
+    const int kQuietMs = 250;                     /* an editor's save burst */
+    for (bool first = true; ; first = false)
+    {
+        juiced::SyncStats ss;
+        if (!sync.run(ss, dry)) return bail(juiced::lastError().c_str());
+        if (ss.imported && !dry && !arc.save()) return bail(juiced::lastError().c_str());
+        if (!dry) sync.saveCache();
+
+        /* our own .d8wsync write wakes the watch too – stay quiet then */
+        if (first || ss.unchanged != ss.files)
+            std::cout << ss.files << " files: " << ss.imported << (dry ? " to import, " : " imported, ")
+                      << ss.unchanged << " unchanged, " << ss.identical << " identical, "
+                      << ss.failed << " failed" << std::endl;
+        if (!watch) return ss.failed ? 2 : 0;
+
+        dirWatch.wait(-1);
+        if (dirWatch.native()) while (dirWatch.wait(kQuietMs)) {}
+    }
+}
+
+/*────────────────────── CLI runner ───────────────────────────*/
+int juiced::runCLI(int argc, char** argv)
+{
+    if (argc < 2) { printUsage(); return 1; }
+
+    const std::string verb = argv[1];
+    if (verb == "-h" || verb == "--help") { printUsage(); return 0; }
+
+    if (verb == "-trace")
+    {
+        if (argc < 4) { printUsage(); return 1; }
+        const std::string out = argv[2];
+
+        juiced::trace::enable(true);
+        argv[2] = argv[0];                              /* argv[2..] is a full command line */
+        const int rc = runCLI(argc - 2, argv + 2);
+        juiced::trace::enable(false);
+
+        if (out == "-") std::cerr << juiced::trace::summary();
+        else if (!juiced::trace::writeChrome(out)) std::cerr << "cannot write " << out << '\n';
+        return rc;
+    }
+
+    if (verb == "-serve") return runServe(argc, argv);
+    if (verb == "-batch") return runBatchCLI(argc, argv);
+    if (verb == "-verify") return runVerifyCLI(argc, argv);
+    if (verb == "-diff")   return runDiffCLI(argc, argv);
+    if (verb == "-audit")  return runAuditCLI(argc, argv);
+    if (verb == "-repack") return runRepackCLI(argc, argv);
+    if (verb == "-shrink") return runShrinkCLI(argc, argv);
+    if (verb == "-contactsheet") return runSheetCLI(argc, argv);
+    if (verb == "-exporttar")    return runTarCLI(argc, argv);
+    if (verb == "-sync")         return runSyncCLI(argc, argv);
+
+    if (verb == "-mkpatch" || verb == "-applypatch")
+    {
+        const bool make = verb == "-mkpatch";
+        if (argc < 4 || argc > 5 || (make && argc != 5)) { printUsage(); return 1; }
+
+        juiced::PatchStats ps;
+        const bool done = make ? juiced::makePatch(argv[2], argv[3], argv[4], &ps)
+                               : juiced::applyPatch(argv[2], argv[3], argc == 5 ? argv[4] : "", &ps);
+        if (!done) return bail(juiced::lastError().c_str());
+        std::cout << ps.bodies << " bodies (" << ps.bodyBytes << " bytes) over "
+                  << ps.banks << " banks, patch " << ps.patchBytes << " bytes\n";
+        return 0;
+    }
+
+    /* all verbs need at least <d8t> <d8w> */
+    if (argc < 4) { printUsage(); return 1; }
+
+    /*──────── read-only verbs: bodies straight off disk ────────
+       The bank is loaded against an empty .d8t buffer and only the
+       extents the verb needs are read, in file order.            */
+    const bool wantsDds = verb == "-convert" || verb == "-convertset";
+    const bool single   = (verb == "-export"    && argc == 7) || (verb == "-convert"    && argc >= 7);
+    const bool set      = (verb == "-exportset" && argc == 6) || (verb == "-convertset" && argc >= 6);
+    if (single || set)
+    {
+        juiced::ConvertOptions conv;
+        if (!parseConvertOptions(conv, argc, argv, single ? 7 : 6))
+            { printUsage(); return 1; }
+
+        const std::vector<BYTE> none;
+        D8WBank bank;
+        if (!bank.load(argv[3], none))
+            return bail("failed to load .d8w");
+
+        std::vector<juiced::ExportJob> jobs;
+        size_t pack, idx = 0;
+        if (!parseUint(argv[4], pack) || (single && !parseUint(argv[5], idx)))
+            { printUsage(); return 1; }
+
+        if (single)
+        {
+            juiced::ExportJob j = { pack, idx, argv[6], wantsDds };
+            jobs.push_back(j);
+        }
+        else if (!juiced::addSetJobs(bank, pack, argv[5], wantsDds, jobs, conv))
+            return bail((verb.substr(1) + " failed").c_str());
+
+        if (!juiced::exportFromDisk(bank, argv[2], jobs, 0, conv))
+            return bail(juiced::lastError().c_str());
+        return 0;
+    }
+
+    /* 1) load .d8t */
+    D8TFile big;
+    if (!big.load(argv[2]))
+        return bail("failed to load .d8t");
+
+    /* 2) load one .d8w that references the shared buffer */
+    D8WBank bank;
+    if (!bank.load(argv[3], big.buffer()))
+        return bail("failed to load .d8w");
+
+    /*──────── verb dispatch ────────*/
+    if (verb == "-import" && argc >= 7)
+    {
+        size_t pack, idx;
+        if (!parseUint(argv[4], pack) || !parseUint(argv[5], idx) ||
+            !applyImportOptions(bank, argc, argv, 7))
+            { printUsage(); return 1; }
+
+        if (!bank.importTexture(pack, idx, argv[6]))
+            return bail("import failed");
+
+        if (bank.isDirty())
+            bank.save(argv[3], argv[2]);   /* write .d8w & .d8t */
+        return 0;
+    }
+    else if (verb == "-importset" && argc >= 6)
+    {
+        size_t pack;
+        if (!parseUint(argv[4], pack) || !applyImportOptions(bank, argc, argv, 6))
+            { printUsage(); return 1; }
+
+        if (!bank.importTextureSet(pack, argv[5]))
+            return bail("importset failed");
+
+        if (bank.isDirty())
+            bank.save(argv[3], argv[2]);
+        return 0;
+    }
+
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,519 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_commands.cpp  –  JSON verbs over resident archives
+
+   Locking: banks and their reference index live in each
+   archive's D8WContext and Status is per thread, so every
+   resident archive has a reader/writer lock of its own – requests
+   on different archives run side by side.  Readers only touch
+   their bank's tables and the shared .d8t bytes.  The archive map
+   has a mutex of its own, held for look-ups only, never while an
+   archive lock is taken.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_commands.h"
+#include "BCEncoder.h"
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace juiced;
+using json::Value;
+
+namespace
+{
+
+struct OpEntry
+{
+    const char*           name;
+    bool                  writer;
+};
+
+static const OpEntry kOps[] =
+{
+    { "ping",       false }, { "status",     false }, { "list",       false },
+    { "inspect",    false }, { "export",     false }, { "exportset",  false },
+    { "convert",    false }, { "convertset", false },
+    { "open",       true  }, { "close",      true  }, { "import",     true  },
+    { "importset",  true  }, { "save",       true  }, { "shutdown",   true  }
+};
+
+static const OpEntry* findOp(const std::string& op)
+{
+    for (size_t k = 0; k < sizeof(kOps) / sizeof(kOps[0]); ++k)
+        if (op == kOps[k].name) return &kOps[k];
+    return 0;
+}
+
+static bool fail(Value& reply, const std::string& why)
+{
+    reply.set("ok", false);
+    reply.set("error", why);
+    return false;
+}
+
+static bool index(const Value& cmd, const char* key, size_t& out)
+{
+    const Value* v = cmd.find(key);
+    if (!v || !v->isNumber() || v->asNumber() < 0) return false;
+    out = (size_t)v->asNumber();
+    return true;
+}
+
+static Value textureJson(const D8WBank& b, size_t p, size_t i)
+{
+    const TextureHdrEx& h = b.tables()[p].tex[i];
+    Value t = Value::object();
+    t.set("pack",     (unsigned)p);
+    t.set("idx",      (unsigned)i);
+    t.set("type",     h.type);
+    t.set("format",   bc::typeName(h.type));
+    t.set("width",    h.width);
+    t.set("height",   h.height);
+    t.set("mips",     h.mipCnt);
+    t.set("size",     h.size);
+    t.set("fileOff",  h.fileOff);
+    t.set("modified", h.modified);
+    Value unk = Value::array();
+    unk.push(h.unk07); unk.push(h.unk08); unk.push(h.unk09);
+    unk.push(h.unk10); unk.push(h.unk11);
+    unk.push((double)h.unk12); unk.push((double)h.unk13);
+    t.set("unk", unk);
+    return t;
+}
+
+static bool importOptions(const Value& cmd, ImportOptions& o, std::string& why)
+{
+    if (const Value* q = cmd.find("quality"))
+    {
+        bc::Quality bq;
+        char num[8];
+        const char* s = q->isString() ? q->asString().c_str()
+                      : (std::snprintf(num, sizeof(num), "%d", (int)q->asNumber()), num);
+        if (!bc::parseQuality(s, bq)) { why = "bad quality"; return false; }
+        o.quality = bq;
+    }
+    if (cmd.has("filter"))
+    {
+        MipFilter f;
+        if (!parseMipFilter(cmd.str("filter").c_str(), f)) { why = "bad filter"; return false; }
+        o.mipFilter = f;
+    }
+    if (cmd.has("maxmips")) o.maxMips = (uint32_t)cmd.num("maxmips");
+    if (cmd.has("keepmips")) o.fitMips = !cmd.flag("keepmips");
+    return true;
+}
+
+static bool convertOptions(const Value& cmd, ConvertOptions& o, std::string& why)
+{
+    if (cmd.has("format"))
+    {
+        ConvertFormat f;
+        if (!parseConvertFormat(cmd.str("format").c_str(), f)) { why = "bad format"; return false; }
+        o.format = f;
+    }
+    if (cmd.has("level"))
+    {
+        const double l = cmd.num("level");
+        if (l < 0 || l > 9) { why = "bad level"; return false; }
+        o.level = (int)l;
+    }
+    if (cmd.has("threads")) o.threads = (unsigned)cmd.num("threads");
+    return true;
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                     archive / bank look-up
+   ───────────────────────────────────────────────────────────── */
+CommandHost::ResidentPtr CommandHost::resident(const std::string& d8t, bool create)
+{
+    std::lock_guard<std::mutex> g(mapM_);
+    std::map<std::string, ResidentPtr>::iterator it = archives_.find(d8t);
+    if (it != archives_.end()) return it->second;
+    if (!create) return ResidentPtr();
+    return archives_[d8t] = std::make_shared<Resident>();
+}
+
+/* caller holds the archive's lock */
+Archive* CommandHost::findArchive(const std::string& d8t) const
+{
+    std::lock_guard<std::mutex> g(mapM_);
+    std::map<std::string, ResidentPtr>::const_iterator it = archives_.find(d8t);
+    return it == archives_.end() ? 0 : it->second->arc.get();
+}
+
+/* archive's exclusive lock held: load the .d8t + companions, and the named .d8w */
+Archive* CommandHost::openArchive(const Value& cmd, Value& reply)
+{
+    const std::string d8t = cmd.str("d8t");
+    if (d8t.empty()) return fail(reply, "missing \"d8t\""), (Archive*)0;
+
+    Archive* a = findArchive(d8t);
+    if (!a)
+    {
+        std::unique_ptr<Archive> fresh(new Archive);
+        fresh->setUseIndex(cmd.has("index") ? cmd.flag("index") : useIndex_);
+        if (!fresh->open(d8t)) return fail(reply, lastError()), (Archive*)0;
+        a = fresh.get();
+        resident(d8t, true)->arc = std::move(fresh);
+    }
+    const std::string d8w = cmd.str("d8w");
+    if (!d8w.empty() && !a->bank(d8w)) return fail(reply, lastError()), (Archive*)0;
+    return a;
+}
+
+/* "d8w" path, else "bank" index, else the archive's only bank */
+D8WBank* CommandHost::resolveBank(const Value& cmd, Value& reply, bool load)
+{
+    Archive* a = findArchive(cmd.str("d8t"));
+    if (!a && load) a = openArchive(cmd, reply);
+    if (!a) return reply.has("error") ? 0 : (fail(reply, "archive not open"), (D8WBank*)0);
+
+    const std::string d8w = cmd.str("d8w");
+    D8WBank* b = 0;
+    size_t   bi;
+    if (!d8w.empty())               b = load ? a->bank(d8w) : a->findBank(d8w);
+    else if (index(cmd, "bank", bi)) b = a->bankAt(bi);
+    else if (a->bankCount() == 1)   b = a->bankAt(0);
+    else return fail(reply, "ambiguous bank – give \"d8w\" or \"bank\""), (D8WBank*)0;
+
+    if (!b) fail(reply, "bank not loaded");
+    return b;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                       op classification
+   ───────────────────────────────────────────────────────────── */
+bool CommandHost::isReadOp(const std::string& op)
+{
+    const OpEntry* e = findOp(op);
+    return e && !e->writer;
+}
+
+bool CommandHost::isWriteOp(const std::string& op)
+{
+    const OpEntry* e = findOp(op);
+    return e && e->writer;
+}
+
+bool CommandHost::extentOf(const Value& cmd, uint32_t& fileOff)
+{
+    ResidentPtr res = resident(cmd.str("d8t"), false);
+    if (!res) return false;
+
+    std::shared_lock<std::shared_timed_mutex> r(res->lock);
+    Value    scratch;
+    D8WBank* b = resolveBank(cmd, scratch, false);
+    size_t   p, i;
+    if (!b || !index(cmd, "pack", p) || p >= b->texturePackCount()) return false;
+
+    if (index(cmd, "idx", i) && i < b->textureCount(p))
+        fileOff = b->tables()[p].tex[i].fileOff;
+    else
+        fileOff = b->tables()[p].absOff;
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                          dispatch
+   ───────────────────────────────────────────────────────────── */
+bool CommandHost::execute(const Value& cmd, Value& reply)
+{
+    static const Handler handlers[] =
+    {
+        &CommandHost::opPing,    &CommandHost::opStatus,    &CommandHost::opList,
+        &CommandHost::opInspect, &CommandHost::opExport,    &CommandHost::opExportSet,
+        &CommandHost::opConvert, &CommandHost::opConvertSet,
+        &CommandHost::opOpen,    &CommandHost::opClose,     &CommandHost::opImport,
+        &CommandHost::opImportSet, &CommandHost::opSave,    &CommandHost::opShutdown
+    };
+
+    reply = Value::object();
+    if (const Value* id = cmd.find("id")) reply.set("id", *id);
+    reply.set("ok", true);
+
+    if (!cmd.isObject()) return fail(reply, "request is not an object");
+
+    const std::string op = cmd.str("op");
+    const OpEntry*    e  = findOp(op);
+    if (!e) return fail(reply, "unknown op \"" + op + "\"");
+    const size_t k = size_t(e - kOps);
+    StatusScope  st(e->name);               /* errors are per request, per thread */
+
+    /* no archive named: nothing resident is touched (ping, status,
+       shutdown), or the handler fails on the missing "d8t"          */
+    const std::string d8t = cmd.str("d8t");
+    if (d8t.empty()) return (this->*handlers[k])(cmd, reply);
+
+    const ResidentPtr res = resident(d8t, true);
+    if (e->writer)
+    {
+        std::unique_lock<std::shared_timed_mutex> w(res->lock);
+        return (this->*handlers[k])(cmd, reply);
+    }
+
+    /* readers: make sure the bank is resident first (brief exclusive) */
+    bool loaded;
+    {
+        std::shared_lock<std::shared_timed_mutex> r(res->lock);
+        Value probe;
+        loaded = resolveBank(cmd, probe, false) != 0;
+    }
+    if (!loaded)
+    {
+        std::unique_lock<std::shared_timed_mutex> w(res->lock);
+        if (!resolveBank(cmd, reply, true)) return false;
+    }
+
+    std::shared_lock<std::shared_timed_mutex> r(res->lock);
+    return (this->*handlers[k])(cmd, reply);
+}
+
+std::string CommandHost::executeLine(const std::string& line)
+{
+    Value cmd, reply;
+    std::string err;
+    if (!json::parse(line, cmd, err))
+    {
+        reply = Value::object();
+        fail(reply, "bad json: " + err);
+    }
+    else
+        execute(cmd, reply);
+    return reply.dump();
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           readers
+   ───────────────────────────────────────────────────────────── */
+bool CommandHost::opPing(const Value&, Value& reply)
+{
+    reply.set("pong", true);
+    return true;
+}
+
+bool CommandHost::opStatus(const Value&, Value& reply)
+{
+    std::vector< std::pair<std::string, ResidentPtr> > all;
+    {
+        std::lock_guard<std::mutex> g(mapM_);
+        all.assign(archives_.begin(), archives_.end());
+    }
+
+    Value list = Value::array();
+    for (size_t k = 0; k < all.size(); ++k)
+    {
+        std::shared_lock<std::shared_timed_mutex> r(all[k].second->lock);
+        if (!all[k].second->arc) continue;                  /* closed */
+        const Archive& a = *all[k].second->arc;
+        Value arc = Value::object();
+        arc.set("d8t",   all[k].first);
+        arc.set("dirty", a.isDirty());
+        Value banks = Value::array();
+        for (size_t b = 0; b < a.bankCount(); ++b)
+        {
+            Value bv = Value::object();
+            bv.set("d8w",   a.bankPath(b));
+            bv.set("packs", (unsigned)a.bankAt(b)->texturePackCount());
+            bv.set("dirty", a.bankAt(b)->isDirty());
+            banks.push(bv);
+        }
+        arc.set("banks", banks);
+        list.push(arc);
+    }
+    reply.set("archives", list);
+    return true;
+}
+
+bool CommandHost::opList(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p;
+    if (index(cmd, "pack", p))                      /* one pack → its textures */
+    {
+        if (p >= b->texturePackCount()) return fail(reply, "pack OOB");
+        Value tex = Value::array();
+        for (size_t i = 0; i < b->textureCount(p); ++i) tex.push(textureJson(*b, p, i));
+        reply.set("textures", tex);
+        return true;
+    }
+
+    Value packs = Value::array();
+    for (p = 0; p < b->texturePackCount(); ++p)
+    {
+        const TextureTable& t = b->tables()[p];
+        Value pv = Value::object();
+        pv.set("pack",   (unsigned)p);
+        pv.set("count",  (unsigned)t.tex.size());
+        pv.set("absOff", t.absOff);
+        pv.set("size",   t.size);
+        packs.push(pv);
+    }
+    reply.set("packs", packs);
+    return true;
+}
+
+bool CommandHost::opInspect(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p, i;
+    if (!index(cmd, "pack", p) || !index(cmd, "idx", i)) return fail(reply, "need \"pack\" and \"idx\"");
+    if (p >= b->texturePackCount() || i >= b->textureCount(p)) return fail(reply, "texture OOB");
+
+    reply.set("texture", textureJson(*b, p, i));
+    return true;
+}
+
+bool CommandHost::opExport(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p, i;
+    const std::string out = cmd.str("out");
+    if (!index(cmd, "pack", p) || !index(cmd, "idx", i) || out.empty())
+        return fail(reply, "need \"pack\", \"idx\" and \"out\"");
+    if (!b->exportTexture(p, i, out))
+        return fail(reply, lastError().empty() ? std::string("export failed") : lastError());
+    return true;
+}
+
+bool CommandHost::opExportSet(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p;
+    const std::string dir = cmd.str("dir");
+    if (!index(cmd, "pack", p) || dir.empty()) return fail(reply, "need \"pack\" and \"dir\"");
+    if (!b->exportTextureSet(p, dir))
+        return fail(reply, lastError().empty() ? std::string("exportset failed") : lastError());
+    return true;
+}
+
+bool CommandHost::opConvert(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p, i;
+    const std::string out = cmd.str("out");
+    if (!index(cmd, "pack", p) || !index(cmd, "idx", i) || out.empty())
+        return fail(reply, "need \"pack\", \"idx\" and \"out\"");
+    ConvertOptions o;
+    std::string    why;
+    if (!convertOptions(cmd, o, why)) return fail(reply, why);
+    if (!b->convertTexture(p, i, out, o))
+        return fail(reply, lastError().empty() ? std::string("convert failed") : lastError());
+    return true;
+}
+
+bool CommandHost::opConvertSet(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, false);
+    if (!b) return false;
+
+    size_t p;
+    const std::string dir = cmd.str("dir");
+    if (!index(cmd, "pack", p) || dir.empty()) return fail(reply, "need \"pack\" and \"dir\"");
+    ConvertOptions o;
+    std::string    why;
+    if (!convertOptions(cmd, o, why)) return fail(reply, why);
+    if (!b->convertTextureSet(p, dir, o))
+        return fail(reply, lastError().empty() ? std::string("convertset failed") : lastError());
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           writers
+   ───────────────────────────────────────────────────────────── */
+bool CommandHost::opOpen(const Value& cmd, Value& reply)
+{
+    Archive* a = openArchive(cmd, reply);
+    if (!a) return false;
+
+    Value banks = Value::array();
+    for (size_t b = 0; b < a->bankCount(); ++b) banks.push(a->bankPath(b));
+    reply.set("banks", banks);
+    reply.set("indexed", a->fromIndex());
+    return true;
+}
+
+bool CommandHost::opClose(const Value& cmd, Value& reply)
+{
+    const std::string d8t = cmd.str("d8t");
+    Archive* a = findArchive(d8t);
+    if (!a) return fail(reply, "archive not open");
+    if (a->isDirty() && !cmd.flag("force"))
+        return fail(reply, "archive has unsaved imports (\"force\":true to drop)");
+
+    resident(d8t, false)->arc.reset();                  /* lock stays for waiters */
+    return true;
+}
+
+bool CommandHost::opImport(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, true);
+    if (!b) return false;
+
+    size_t p, i;
+    const std::string in = cmd.str("in");
+    if (!index(cmd, "pack", p) || !index(cmd, "idx", i) || in.empty())
+        return fail(reply, "need \"pack\", \"idx\" and \"in\"");
+
+    ImportOptions o;                                /* this request's only */
+    std::string   why;
+    if (!importOptions(cmd, o, why)) return fail(reply, why);
+
+    if (!b->importTexture(p, i, in, o))
+        return fail(reply, lastError().empty() ? std::string("import failed") : lastError());
+
+    reply.set("texture", textureJson(*b, p, i));
+    if (cmd.flag("save") && !findArchive(cmd.str("d8t"))->save())
+        return fail(reply, lastError());
+    return true;
+}
+
+bool CommandHost::opImportSet(const Value& cmd, Value& reply)
+{
+    D8WBank* b = resolveBank(cmd, reply, true);
+    if (!b) return false;
+
+    size_t p;
+    const std::string dir = cmd.str("dir");
+    if (!index(cmd, "pack", p) || dir.empty()) return fail(reply, "need \"pack\" and \"dir\"");
+
+    ImportOptions o;                                /* this request's only */
+    std::string   why;
+    if (!importOptions(cmd, o, why)) return fail(reply, why);
+
+    if (!b->importTextureSet(p, dir, o))
+        return fail(reply, lastError().empty() ? std::string("importset failed") : lastError());
+
+    if (cmd.flag("save") && !findArchive(cmd.str("d8t"))->save())
+        return fail(reply, lastError());
+    return true;
+}
+
+bool CommandHost::opSave(const Value& cmd, Value& reply)
+{
+    Archive* a = findArchive(cmd.str("d8t"));
+    if (!a) return fail(reply, "archive not open");
+
+    const bool dirty = a->isDirty();
+    if (dirty && !a->save()) return fail(reply, lastError());
+    reply.set("written", dirty);
+    return true;
+}
+
+bool CommandHost::opShutdown(const Value&, Value& reply)
+{
+    shutdown_ = true;
+    reply.set("bye", true);
+    return true;
+}
@@ -0,0 +1,342 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_diff.cpp  –  -diff: hash both sides, compare what differs
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_diff.h"
+#include "d8w_archive.h"
+#include "d8w_io.h"
+#include "d8w_parallel.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+
+using namespace juiced;
+
+namespace
+{
+
+/* one texture of one side */
+struct Tex
+{
+    uint32_t bank, pack, idx;
+    size_t   slot;                  /* distinct-extent index */
+};
+
+/* one archive: .d8t, banks (headers only), body hashes */
+struct Side
+{
+    std::string                             d8t;
+    std::vector<std::string>                names, keys;   /* file, name after stem */
+    D8WContext                              ctx;           /* outlives banks        */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector<Tex>                        tex;
+    std::vector<FileExtent>                 ext;
+    std::vector<uint64_t>                   sums;
+    std::vector< std::vector<size_t> >      first;         /* [bank][pack] → tex    */
+
+    const TextureHdrEx& hdr(const Tex& t) const { return banks[t.bank]->tables()[t.pack].tex[t.idx]; }
+    uint64_t            hash(const Tex& t) const { return sums[t.slot]; }
+    const Tex*          find(uint32_t b, uint32_t p, uint32_t i) const
+    {
+        if (p >= first[b].size() || i >= banks[b]->textureCount(p)) return 0;
+        return &tex[first[b][p] + i];
+    }
+};
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static std::string lowered(std::string s)
+{
+    for (size_t i = 0; i < s.size(); ++i)
+        if (s[i] >= 'A' && s[i] <= 'Z') s[i] = char(s[i] + ('a' - 'A'));
+    return s;
+}
+
+static bool loadSide(const std::string& d8t, unsigned threads, Side& sd, uint64_t& hashed)
+{
+    sd.d8t = d8t;
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8t, fi)) return setError("cannot stat %s", d8t.c_str());
+
+    std::vector<std::string> paths;
+    findCompanionBanks(d8t, paths);
+    if (paths.empty()) return setError("no .d8w next to %s", d8t.c_str());
+
+    const std::string stem = lowered(baseName(d8t)).substr(0, baseName(d8t).find_last_of('.'));
+    const std::vector<BYTE> none;
+    std::map<std::pair<uint64_t, uint32_t>, size_t> slots;
+    for (size_t b = 0; b < paths.size(); ++b)
+    {
+        sd.banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(sd.ctx)));
+        if (!sd.banks[b]->load(paths[b], none))
+            return setError("failed to load %s (%s)", paths[b].c_str(), lastError().c_str());
+
+        const std::string name = baseName(paths[b]);
+        sd.names.push_back(name);
+        sd.keys.push_back(lowered(name).substr(stem.size()));
+
+        const std::vector<TextureTable>& tbls = sd.banks[b]->tables();
+        sd.first.push_back(std::vector<size_t>());
+        for (size_t p = 0; p < tbls.size(); ++p)
+        {
+            sd.first[b].push_back(sd.tex.size());
+            for (size_t i = 0; i < tbls[p].tex.size(); ++i)
+            {
+                const TextureHdrEx& h = tbls[p].tex[i];
+                if ((uint64_t)h.fileOff + h.size > fi.size)
+                    return setError("%s pack %u idx %u: body past end of %s",
+                                    name.c_str(), (uint32_t)p, (uint32_t)i, d8t.c_str());
+
+                const std::pair<uint64_t, uint32_t> key(h.fileOff, h.size);
+                std::map<std::pair<uint64_t, uint32_t>, size_t>::iterator it = slots.find(key);
+                if (it == slots.end())
+                {
+                    it = slots.insert(std::make_pair(key, sd.ext.size())).first;
+                    sd.ext.push_back(key);
+                }
+                Tex t = { (uint32_t)b, (uint32_t)p, (uint32_t)i, it->second };
+                sd.tex.push_back(t);
+            }
+        }
+    }
+
+    std::vector<char> read;
+    IoStats     io;
+    std::string why;
+    if (!hashExtents(d8t, sd.ext, sd.sums, read, threads, &io, &why))
+        return setError("%s", why.c_str());
+    hashed += io.bytesWanted;
+    return true;
+}
+
+static std::string where(const Side& sd, const Tex& t)
+{
+    char b[32];
+    std::snprintf(b, sizeof(b), " %u %u", t.pack, t.idx);
+    return sd.names[t.bank] + b;
+}
+
+static std::string shape(const TextureHdr& h)
+{
+    char b[96];
+    std::snprintf(b, sizeof(b), "%s %ux%u/%u", bc::typeName(h.type), h.width, h.height, h.mipCnt);
+    return b;
+}
+
+/* "unk09 3 → 5, unk12 1 → 0.5" for the opaque header fields */
+static std::string headerDelta(const TextureHdr& a, const TextureHdr& b)
+{
+    std::string s;
+    char buf[96];
+    const uint32_t* ua[] = { &a.unk07, &a.unk08, &a.unk09, &a.unk10, &a.unk11 };
+    const uint32_t* ub[] = { &b.unk07, &b.unk08, &b.unk09, &b.unk10, &b.unk11 };
+    for (int k = 0; k < 5; ++k)
+        if (*ua[k] != *ub[k])
+        {
+            std::snprintf(buf, sizeof(buf), "%sunk%02d %u → %u", s.empty() ? "" : ", ",
+                          7 + k, *ua[k], *ub[k]);
+            s += buf;
+        }
+    const float* fa[] = { &a.unk12, &a.unk13 };
+    const float* fb[] = { &b.unk12, &b.unk13 };
+    for (int k = 0; k < 2; ++k)
+        if (std::memcmp(fa[k], fb[k], sizeof(float)) != 0)
+        {
+            std::snprintf(buf, sizeof(buf), "%sunk%02d %g → %g", s.empty() ? "" : ", ",
+                          12 + k, *fa[k], *fb[k]);
+            s += buf;
+        }
+    return s;
+}
+
+static void add(DiffReport& r, DiffEntry::Kind k, const std::string& w, const std::string& d)
+{
+    DiffEntry e;
+    e.kind   = k;
+    e.where  = w;
+    e.detail = d;
+    r.entries.push_back(e);
+}
+
+} // anon
+
+const char* juiced::diffKindName(DiffEntry::Kind k)
+{
+    switch (k)
+    {
+    case DiffEntry::kAdded:     return "added";
+    case DiffEntry::kRemoved:   return "removed";
+    case DiffEntry::kMoved:     return "moved";
+    case DiffEntry::kResized:   return "resized";
+    case DiffEntry::kReencoded: return "reencoded";
+    case DiffEntry::kHeader:    return "header";
+    }
+    return "?";
+}
+
+size_t DiffReport::count(DiffEntry::Kind k) const
+{
+    size_t n = 0;
+    for (size_t i = 0; i < entries.size(); ++i) n += entries[i].kind == k;
+    return n;
+}
+
+bool juiced::diffArchives(const std::string& d8tA, const std::string& d8tB,
+                          const DiffOptions& opt, DiffReport& r)
+{
+    D8W_TRACE_SCOPE("diffArchives");
+    StatusScope st("diff");
+    r = DiffReport();
+
+    /* ── 1. both sides: headers, then one hashing pass each ────── */
+    Side A, B;
+    if (!loadSide(d8tA, opt.threads, A, r.bytesHashed)) return false;
+    if (!loadSide(d8tB, opt.threads, B, r.bytesHashed)) return false;
+    r.banksA    = A.banks.size();  r.banksB    = B.banks.size();
+    r.texturesA = A.tex.size();    r.texturesB = B.tex.size();
+
+    /* ── 2. align banks by name after the stem ─────────────────── */
+    std::vector<int> mate(A.banks.size(), -1);
+    std::vector<bool> taken(B.banks.size(), false);
+    for (size_t a = 0; a < A.banks.size(); ++a)
+        for (size_t b = 0; b < B.banks.size(); ++b)
+            if (!taken[b] && A.keys[a] == B.keys[b]) { mate[a] = (int)b; taken[b] = true; break; }
+    for (size_t a = 0; a < A.banks.size(); ++a) if (mate[a] < 0) r.banksRemoved.push_back(A.names[a]);
+    for (size_t b = 0; b < B.banks.size(); ++b) if (!taken[b])   r.banksAdded.push_back(B.names[b]);
+
+    /* ── 3. texture by texture over paired banks ───────────────── */
+    std::vector<const Tex*> added, removed;
+    std::vector< std::pair<const Tex*, const Tex*> > recheck;   /* same size, other body */
+    std::vector<size_t> recheckEntry;
+    for (size_t a = 0; a < A.banks.size(); ++a)
+    {
+        if (mate[a] < 0) continue;
+        const uint32_t b = (uint32_t)mate[a];
+        const size_t packs = std::max(A.banks[a]->texturePackCount(), B.banks[b]->texturePackCount());
+        for (uint32_t p = 0; p < packs; ++p)
+        {
+            const size_t n = std::max(A.banks[a]->textureCount(p), B.banks[b]->textureCount(p));
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const Tex* ta = A.find((uint32_t)a, p, i);
+                const Tex* tb = B.find(b, p, i);
+                if (!ta) { added.push_back(tb);   continue; }
+                if (!tb) { removed.push_back(ta); continue; }
+
+                const TextureHdrEx& ha = A.hdr(*ta);
+                const TextureHdrEx& hb = B.hdr(*tb);
+                const std::string   hd = headerDelta(ha, hb);
+                if (A.hash(*ta) == B.hash(*tb) && ha.size == hb.size)
+                {
+                    if (hd.empty() && ha.type == hb.type && ha.width == hb.width &&
+                        ha.height == hb.height && ha.mipCnt == hb.mipCnt) ++r.same;
+                    else add(r, DiffEntry::kHeader, where(A, *ta),
+                             hd.empty() ? shape(ha) + " → " + shape(hb) : hd);
+                    continue;
+                }
+
+                std::string d;
+                DiffEntry::Kind k = DiffEntry::kReencoded;
+                if (ha.width != hb.width || ha.height != hb.height || ha.mipCnt != hb.mipCnt)
+                {
+                    k = DiffEntry::kResized;
+                    d = shape(ha) + " → " + shape(hb);
+                }
+                else if (ha.type != hb.type)
+                    d = std::string(bc::typeName(ha.type)) + " → " + bc::typeName(hb.type);
+                else
+                    d = bc::typeName(ha.type);
+
+                char sz[64];
+                if (ha.size != hb.size)
+                {
+                    std::snprintf(sz, sizeof(sz), ", %u → %u bytes", ha.size, hb.size);
+                    d += sz;
+                }
+                else if (opt.blocks && ha.type == hb.type)
+                {
+                    recheck.push_back(std::make_pair(ta, tb));
+                    recheckEntry.push_back(r.entries.size());
+                }
+                if (!hd.empty()) d += ", " + hd;
+                add(r, k, where(A, *ta), d);
+            }
+        }
+    }
+
+    /* ── 4. moves: a removed body that reappears elsewhere ─────── */
+    std::multimap<std::pair<uint64_t, uint32_t>, const Tex*> gone;
+    for (size_t k = 0; k < removed.size(); ++k)
+        gone.insert(std::make_pair(std::make_pair(A.hash(*removed[k]), A.hdr(*removed[k]).size), removed[k]));
+    std::map<std::pair<uint64_t, uint32_t>, const Tex*> anyA;
+    for (size_t k = 0; k < A.tex.size(); ++k)
+        anyA.insert(std::make_pair(std::make_pair(A.hash(A.tex[k]), A.hdr(A.tex[k]).size), &A.tex[k]));
+
+    std::vector<const Tex*> moved;
+    for (size_t k = 0; k < added.size(); ++k)
+    {
+        const std::pair<uint64_t, uint32_t> key(B.hash(*added[k]), B.hdr(*added[k]).size);
+        std::multimap<std::pair<uint64_t, uint32_t>, const Tex*>::iterator g = gone.find(key);
+        if (g != gone.end())
+        {
+            add(r, DiffEntry::kMoved, where(A, *g->second), "→ " + where(B, *added[k]));
+            moved.push_back(g->second);
+            gone.erase(g);
+            continue;
+        }
+        std::string d = shape(B.hdr(*added[k]));
+        std::map<std::pair<uint64_t, uint32_t>, const Tex*>::const_iterator same = anyA.find(key);
+        if (same != anyA.end()) d += ", same body as " + where(A, *same->second);
+        add(r, DiffEntry::kAdded, where(B, *added[k]), d);
+    }
+    for (size_t k = 0; k < removed.size(); ++k)
+        if (std::find(moved.begin(), moved.end(), removed[k]) == moved.end())
+            add(r, DiffEntry::kRemoved, where(A, *removed[k]), shape(A.hdr(*removed[k])));
+
+    /* ── 5. bodies only where the hashes differ: changed blocks ── */
+    if (!recheck.empty())
+    {
+        D8W_TRACE_SCOPE("diffArchives::blocks");
+        plat::File fa, fb;
+        if (!fa.open(d8tA, plat::File::kRead) || !fb.open(d8tB, plat::File::kRead))
+            return setError("cannot reopen %s / %s", d8tA.c_str(), d8tB.c_str());
+
+        std::vector<std::string> notes(recheck.size());
+        parallelFor(recheck.size(), [&](size_t k)
+        {
+            const TextureHdrEx& ha = A.hdr(*recheck[k].first);
+            const TextureHdrEx& hb = B.hdr(*recheck[k].second);
+            std::vector<BYTE> x(ha.size), y(hb.size);
+            if (!fa.readAt(ha.fileOff, x.data(), x.size()) ||
+                !fb.readAt(hb.fileOff, y.data(), y.size())) return;
+
+            uint32_t blk = bc::blockBytes(ha.type);
+            if (!blk) blk = 64;                               /* ARGB: 4x4 pixels */
+            size_t total = 0, diff = 0;
+            for (size_t o = 0; o < x.size(); o += blk, ++total)
+                diff += std::memcmp(&x[o], &y[o], std::min<size_t>(blk, x.size() - o)) != 0;
+
+            char b[64];
+            std::snprintf(b, sizeof(b), ", %u/%u blocks differ", (uint32_t)diff, (uint32_t)total);
+            notes[k] = b;
+        }, opt.threads, 8);
+
+        for (size_t k = 0; k < recheck.size(); ++k)
+        {
+            std::string& d = r.entries[recheckEntry[k]].detail;
+            const size_t comma = d.find(", unk");
+            d.insert(comma == std::string::npos ? d.size() : comma, notes[k]);
+        }
+    }
+    return true;
+}
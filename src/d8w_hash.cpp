@@ -0,0 +1,106 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_hash.cpp  –  XXH64, reference algorithm
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+const uint64_t P1 = 11400714785074694791ull;
+const uint64_t P2 = 14029467366897019727ull;
+const uint64_t P3 =  1609587929392839161ull;
+const uint64_t P4 =  9650029242287828579ull;
+const uint64_t P5 =  2870177450012600261ull;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+/* little-endian loads; every target we build for is LE */
+inline uint64_t ld64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+inline uint32_t ld32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+inline uint64_t round1(uint64_t acc, uint64_t in)
+{
+    acc += in * P2;
+    return rotl(acc, 31) * P1;
+}
+
+inline uint64_t merge(uint64_t h, uint64_t v)
+{
+    h ^= round1(0, v);
+    return h * P1 + P4;
+}
+
+} // anon
+
+uint64_t juiced::hash64(const void* data, size_t n, uint64_t seed)
+{
+    const uint8_t*       p   = (const uint8_t*)data;
+    const uint8_t* const end = p + n;
+    uint64_t h;
+
+    if (n >= 32)
+    {
+        uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+        const uint8_t* const last = end - 32;
+        do {
+            v1 = round1(v1, ld64(p));      v2 = round1(v2, ld64(p + 8));
+            v3 = round1(v3, ld64(p + 16)); v4 = round1(v4, ld64(p + 24));
+            p += 32;
+        } while (p <= last);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge(h, v1); h = merge(h, v2); h = merge(h, v3); h = merge(h, v4);
+    }
+    else
+        h = seed + P5;
+
+    h += (uint64_t)n;
+
+    for (; p + 8 <= end; p += 8) h = rotl(h ^ round1(0, ld64(p)), 27) * P1 + P4;
+    if (p + 4 <= end)          { h = rotl(h ^ (uint64_t)ld32(p) * P1, 23) * P2 + P3; p += 4; }
+    for (; p < end; ++p)         h = rotl(h ^ (uint64_t)*p * P5, 11) * P1;
+
+    h ^= h >> 33; h *= P2;
+    h ^= h >> 29; h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                            StreamHash
+   ───────────────────────────────────────────────────────────── */
+namespace { const size_t kBlock = size_t(1) << 20; }
+
+void StreamHash::add(const void* data, size_t n)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    total_ += n;
+    if (!part_.empty())
+    {
+        const size_t k = std::min(n, kBlock - part_.size());
+        part_.insert(part_.end(), p, p + k);
+        p += k; n -= k;
+        if (part_.size() < kBlock) return;
+        h_ = hash64(part_.data(), kBlock, h_);
+        part_.clear();
+    }
+    for (; n >= kBlock; p += kBlock, n -= kBlock) h_ = hash64(p, kBlock, h_);
+    part_.assign(p, p + n);
+}
+
+uint64_t StreamHash::value() const
+{
+    return hash64(part_.data(), part_.size(), h_ ^ total_);
+}
+
+uint64_t StreamHash::of(const void* data, size_t n)
+{
+    StreamHash s;
+    s.add(data, n);
+    return s.value();
+}
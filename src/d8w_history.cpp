@@ -0,0 +1,237 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_history.cpp  –  undo / redo of staged imports
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_history.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+static size_t bytesOf(const std::vector<BYTE>& v) { return v.capacity(); }
+
+static void release(std::vector<BYTE>& v) { std::vector<BYTE>().swap(v); }
+
+static BodySplice makeSplice(uint32_t pos, uint32_t oldSize, uint32_t newSize,
+                             const TextureHdr& hdr, const BYTE* body)
+{
+    BodySplice sp;
+    std::memset(&sp, 0, sizeof(sp));
+    sp.pos     = pos;
+    sp.oldSize = oldSize;
+    sp.newSize = newSize;
+    sp.hdr     = hdr;
+    sp.body    = body;
+    return sp;
+}
+
+} // anon
+
+EditHistory::EditHistory(D8WContext& ctx, const std::string& d8tPath, size_t maxBytes)
+    : ctx_(ctx), path_(d8tPath), backed_(false), maxBytes_(maxBytes), held_(0),
+      replaying_(false), group_(0), open_(false)
+{
+    std::memset(&stamp_, 0, sizeof(stamp_));
+    clear();
+    ctx_.addObserver(this);
+}
+
+EditHistory::~EditHistory()
+{
+    ctx_.removeObserver(this);
+}
+
+void EditHistory::clear()
+{
+    done_.clear();
+    undone_.clear();
+    applied_.clear();
+    held_ = 0;
+
+    /* file references only hold while every bank is what the file has */
+    backed_ = !path_.empty() && plat::fileInfo(path_, stamp_);
+    for (size_t b = 0; backed_ && b < ctx_.bankCount(); ++b)
+    {
+        const D8WBank* bank = ctx_.bankAt(b);
+        backed_ = !bank->isDirty() && bank->tBuffer() &&
+                  bank->tBuffer()->size() == stamp_.size;
+    }
+}
+
+void EditHistory::beginGroup(const std::string& label)
+{
+    if (group_++ == 0) { label_ = label; open_ = false; }
+}
+
+void EditHistory::endGroup()
+{
+    if (group_ > 0 && --group_ == 0) { open_ = false; trim(); }
+}
+
+/* where the file has the unmodified body now at pos, -1 if it can't say */
+int64_t EditHistory::sourceOf(uint32_t pos, uint32_t size) const
+{
+    if (!backed_) return -1;
+
+    int64_t x = pos;
+    for (size_t k = applied_.size(); k-- > 0; )
+    {
+        const Shift& a = applied_[k];
+        if (x >= (int64_t)a.pos + a.newSize) x -= (int64_t)a.newSize - (int64_t)a.oldSize;
+        else if (x + size > a.pos)           return -1;      /* inside a replacement */
+    }
+    return x + size <= (int64_t)stamp_.size ? x : -1;
+}
+
+void EditHistory::beforeSplice(D8WBank& bank, const BodySplice& sp, const TextureHdrEx& old, bool)
+{
+    if (replaying_) return;
+    D8W_TRACE_SCOPE("EditHistory::record");
+
+    if (group_ == 0 || !open_)
+    {
+        for (size_t u = 0; u < undone_.size(); ++u)          /* redo is gone */
+            for (size_t k = 0; k < undone_[u].edits.size(); ++k)
+                held_ -= bytesOf(undone_[u].edits[k].oldBody) + bytesOf(undone_[u].edits[k].newBody);
+        undone_.clear();
+        done_.push_back(Step());
+        done_.back().label = group_ ? label_ : std::string("Import");
+        open_ = group_ > 0;
+    }
+
+    done_.back().edits.push_back(Edit());
+    Edit& e = done_.back().edits.back();
+    e.bank        = &bank;
+    e.pos         = sp.pos;
+    e.oldSize     = sp.oldSize;
+    e.newSize     = sp.newSize;
+    e.oldHdr      = old;
+    e.newHdr      = sp.hdr;
+    e.oldModified = old.modified;
+    e.src         = old.modified ? -1 : sourceOf(sp.pos, sp.oldSize);
+    if (e.src < 0 && sp.oldSize)
+    {
+        const BYTE* at = &(*bank.tBuffer())[sp.pos];         /* caller checked bounds */
+        e.oldBody.assign(at, at + sp.oldSize);
+        held_ += bytesOf(e.oldBody);
+    }
+
+    Shift a = { sp.pos, sp.oldSize, sp.newSize };
+    applied_.push_back(a);
+    if (group_ == 0) trim();
+}
+
+/* oldest steps go while the copies are over budget; the newest stays */
+void EditHistory::trim()
+{
+    size_t drop = 0;
+    while (held_ > maxBytes_ && done_.size() - drop > 1)
+    {
+        const std::vector<Edit>& v = done_[drop++].edits;
+        for (size_t k = 0; k < v.size(); ++k) held_ -= bytesOf(v[k].oldBody);
+    }
+    if (drop) done_.erase(done_.begin(), done_.begin() + drop);
+}
+
+bool EditHistory::revert(Edit& e)
+{
+    const std::vector<BYTE>* T = e.bank->tBuffer();
+    if (!T || (uint64_t)e.pos + e.newSize > T->size())
+        return setError("body 0x%08X+%u past the end of the .d8t", e.pos, e.newSize);
+
+    std::vector<BYTE> file;
+    const BYTE* body = e.oldBody.empty() ? 0 : &e.oldBody[0];
+    if (e.src >= 0 && e.oldSize)
+    {
+        plat::FileInfo now;
+        if (!plat::fileInfo(path_, now) || now.size != stamp_.size || now.mtime != stamp_.mtime)
+            return setError("%s changed on disk, the old body is gone", path_.c_str());
+
+        plat::File f;
+        file.resize(e.oldSize);
+        if (!f.open(path_, plat::File::kRead) || !f.readAt((uint64_t)e.src, &file[0], file.size()))
+            return setError("cannot read %s at 0x%08X", path_.c_str(), (uint32_t)e.src);
+        trace::count(trace::kBytesRead, file.size());
+        body = &file[0];
+    }
+
+    std::vector<BYTE> cur;
+    if (e.newSize) cur.assign(T->begin() + e.pos, T->begin() + e.pos + e.newSize);
+
+    replaying_ = true;
+    const bool ok = e.bank->replaceBody(makeSplice(e.pos, e.newSize, e.oldSize, e.oldHdr, body),
+                                        e.oldModified);
+    replaying_ = false;
+    if (!ok) return false;                                   /* Status set */
+
+    e.newBody.swap(cur);
+    held_ += bytesOf(e.newBody);
+    applied_.pop_back();
+    return true;
+}
+
+bool EditHistory::reapply(Edit& e)
+{
+    replaying_ = true;
+    const bool ok = e.bank->replaceBody(makeSplice(e.pos, e.oldSize, e.newSize, e.newHdr,
+                                                   e.newBody.empty() ? 0 : &e.newBody[0]));
+    replaying_ = false;
+    if (!ok) return false;                                   /* Status set */
+
+    held_ -= bytesOf(e.newBody);
+    release(e.newBody);
+    Shift a = { e.pos, e.oldSize, e.newSize };
+    applied_.push_back(a);
+    return true;
+}
+
+bool EditHistory::undo()
+{
+    D8W_TRACE_SCOPE("EditHistory::undo");
+    StatusScope st("undo");
+    if (done_.empty()) return setError("nothing to undo");
+    if (group_)        return setError("an edit is still in progress");
+
+    std::vector<Edit>& v = done_.back().edits;
+    for (size_t k = v.size(); k-- > 0; )
+        if (!revert(v[k]))
+        {
+            const Status s = lastStatus();                   /* keep the cause */
+            for (size_t j = k + 1; j < v.size(); ++j) reapply(v[j]);
+            return setError("%s", s.error.c_str());
+        }
+
+    undone_.push_back(Step());
+    undone_.back().label.swap(done_.back().label);
+    undone_.back().edits.swap(v);
+    done_.pop_back();
+    return true;
+}
+
+bool EditHistory::redo()
+{
+    D8W_TRACE_SCOPE("EditHistory::redo");
+    StatusScope st("redo");
+    if (undone_.empty()) return setError("nothing to redo");
+    if (group_)          return setError("an edit is still in progress");
+
+    std::vector<Edit>& v = undone_.back().edits;
+    for (size_t k = 0; k < v.size(); ++k)
+        if (!reapply(v[k]))
+        {
+            const Status s = lastStatus();
+            for (size_t j = k; j-- > 0; ) revert(v[j]);
+            return setError("%s", s.error.c_str());
+        }
+
+    done_.push_back(Step());
+    done_.back().label.swap(undone_.back().label);
+    done_.back().edits.swap(v);
+    undone_.pop_back();
+    trim();
+    return true;
+}
@@ -0,0 +1,373 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_index.cpp  –  .d8idx sidecar writer / validating reader
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_index.h"
+#include "d8w_hash.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+const char     kMagic[8] = { 'D', '8', 'W', 'I', 'D', 'X', 0, 0 };
+const uint32_t kVersion  = 1;
+
+struct IdxHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t banks;
+    uint64_t d8tSize;
+    int64_t  d8tMtime;
+    uint64_t d8tHash;               /* sampled, see sampleHash() */
+    uint32_t tables, textures, sets, cells, refs, pad;
+    uint64_t offBanks, offTables, offTex, offSets, offCells, offRefs, offBlob;
+    uint64_t blobBytes;
+    uint64_t bodyHash;              /* everything after this header */
+};
+
+struct IdxBank
+{
+    uint64_t size;
+    int64_t  mtime;
+    uint64_t hash;
+    uint32_t header[3];
+    uint32_t firstTable, tables;
+    uint32_t firstSet, sets;
+    uint32_t pathOff, pathLen;
+    uint32_t tailOff, tailLen;
+    uint32_t pad;
+};
+
+struct IdxTable
+{
+    uint32_t skip, size, absOff;
+    uint32_t firstTex, textures;
+    uint32_t pad;
+};
+
+struct IdxTex
+{
+    TextureHdr hdr;
+    uint32_t   fileOff;
+    uint32_t   pad;
+};
+
+struct IdxSet
+{
+    char     name[32];
+    uint32_t firstCell, cells;
+};
+
+struct IdxRef
+{
+    uint32_t off, bank, pack, tex;
+
+    bool operator<(const IdxRef& o) const
+    {
+        if (off  != o.off)  return off  < o.off;
+        if (bank != o.bank) return bank < o.bank;
+        if (pack != o.pack) return pack < o.pack;
+        return tex < o.tex;
+    }
+};
+
+static_assert(sizeof(TextureHdr) == 48, "TextureHdr layout");
+static_assert(sizeof(IdxHeader) == 136 && sizeof(IdxBank) == 72 && sizeof(IdxTable) == 24 &&
+              sizeof(IdxTex) == 56 && sizeof(IdxSet) == 40 && sizeof(IdxRef) == 16,
+              ".d8idx record layout");
+
+/* 16 × 64 KB spread over the file (all of it when small): catches
+   truncation, appends and most rewrites without reading gigabytes */
+static uint64_t sampleHash(const std::vector<BYTE>& b)
+{
+    const size_t kWin = 64 << 10, kSamples = 16;
+    if (b.size() <= kWin * kSamples) return hash64(b.data(), b.size(), b.size());
+
+    uint64_t h = b.size();
+    for (size_t k = 0; k < kSamples; ++k)
+    {
+        const size_t at = (size_t)((uint64_t)(b.size() - kWin) * k / (kSamples - 1));
+        h = hash64(&b[at], kWin, h);
+    }
+    return h;
+}
+
+static uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+static bool fail(std::string* why, const std::string& msg)
+{
+    if (why) *why = msg;
+    return false;
+}
+
+/* bounds-checked view of one section */
+template<typename T>
+static const T* section(const std::vector<BYTE>& f, uint64_t off, uint64_t count)
+{
+    if (off % 8 || off > f.size() || count > (f.size() - off) / sizeof(T)) return 0;
+    return reinterpret_cast<const T*>(count ? &f[(size_t)off] : f.data());
+}
+
+} // anon
+
+std::string juiced::indexPathFor(const std::string& d8tPath)
+{
+    const size_t slash = d8tPath.find_last_of("\\/");
+    const size_t dot   = d8tPath.find_last_of('.');
+    const bool   ext   = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (ext ? d8tPath.substr(0, dot) : d8tPath) + ".d8idx";
+}
+
+/* ─────────────────────────────────────────────────────────────
+                              writer
+   ───────────────────────────────────────────────────────────── */
+bool juiced::writeIndex(const std::string& idxPath, const std::string& d8tPath,
+                        const std::vector<BYTE>& tBuf,
+                        const std::vector<std::string>& d8wPaths,
+                        const std::vector<const D8WBank*>& banks)
+{
+    D8W_TRACE_SCOPE("writeIndex");
+    if (banks.size() != d8wPaths.size()) return false;
+
+    IdxHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.banks   = (uint32_t)banks.size();
+
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi) || fi.size != tBuf.size()) return false;
+    h.d8tSize  = fi.size;
+    h.d8tMtime = fi.mtime;
+    h.d8tHash  = sampleHash(tBuf);
+
+    std::vector<IdxBank>  ib(banks.size());
+    std::vector<IdxTable> it;
+    std::vector<IdxTex>   tx;
+    std::vector<IdxSet>   st;
+    std::vector<int32_t>  cells;
+    std::vector<IdxRef>   refs;
+    std::vector<BYTE>     blob;
+
+    for (size_t b = 0; b < banks.size(); ++b)
+    {
+        const D8WBank& bank = *banks[b];
+        IdxBank&       r    = ib[b];
+        std::memset(&r, 0, sizeof(r));
+
+        std::vector<BYTE> raw;          /* hash what is on disk, not what we hold */
+        if (!plat::fileInfo(d8wPaths[b], fi) || !plat::readFile(d8wPaths[b], raw, 0x7FFFFFFF))
+            return false;
+        r.size  = fi.size;
+        r.mtime = fi.mtime;
+        r.hash  = hash64(raw.data(), raw.size());
+
+        const std::vector<TextureTable>& tbls = bank.tables();
+        uint32_t texCnt = 0, total = 0;
+        for (size_t p = 0; p < tbls.size(); ++p)
+        {
+            texCnt += (uint32_t)tbls[p].tex.size();
+            total  += tbls[p].size;
+        }
+        r.header[0] = texCnt;
+        r.header[1] = (uint32_t)tbls.size();
+        r.header[2] = total;
+
+        r.firstTable = (uint32_t)it.size();
+        r.tables     = (uint32_t)tbls.size();
+        for (size_t p = 0; p < tbls.size(); ++p)
+        {
+            IdxTable t = { tbls[p].skip, tbls[p].size, tbls[p].absOff,
+                           (uint32_t)tx.size(), (uint32_t)tbls[p].tex.size(), 0 };
+            it.push_back(t);
+            for (size_t i = 0; i < tbls[p].tex.size(); ++i)
+            {
+                IdxTex e;
+                std::memset(&e, 0, sizeof(e));
+                e.hdr     = tbls[p].tex[i];
+                e.fileOff = tbls[p].tex[i].fileOff;
+                tx.push_back(e);
+
+                IdxRef ref = { e.fileOff, (uint32_t)b, (uint32_t)p, (uint32_t)i };
+                refs.push_back(ref);
+            }
+        }
+
+        const std::vector<TextureSet>& sets = bank.sets();
+        r.firstSet = (uint32_t)st.size();
+        r.sets     = (uint32_t)sets.size();
+        for (size_t s = 0; s < sets.size(); ++s)
+        {
+            IdxSet e;
+            std::memset(&e, 0, sizeof(e));
+            std::memcpy(e.name, sets[s].name.data(), std::min<size_t>(sets[s].name.size(), 32));
+            e.firstCell = (uint32_t)cells.size();
+            e.cells     = (uint32_t)sets[s].indexTable.size();
+            cells.insert(cells.end(), sets[s].indexTable.begin(), sets[s].indexTable.end());
+            st.push_back(e);
+        }
+
+        r.pathOff = (uint32_t)blob.size();
+        r.pathLen = (uint32_t)d8wPaths[b].size();
+        blob.insert(blob.end(), d8wPaths[b].begin(), d8wPaths[b].end());
+        r.tailOff = (uint32_t)blob.size();
+        r.tailLen = (uint32_t)bank.tailData().size();
+        blob.insert(blob.end(), bank.tailData().begin(), bank.tailData().end());
+    }
+    std::sort(refs.begin(), refs.end());
+
+    h.tables   = (uint32_t)it.size();
+    h.textures = (uint32_t)tx.size();
+    h.sets     = (uint32_t)st.size();
+    h.cells    = (uint32_t)cells.size();
+    h.refs     = (uint32_t)refs.size();
+
+    uint64_t at = sizeof(IdxHeader);
+    h.offBanks  = at; at = align8(at + ib.size()    * sizeof(IdxBank));
+    h.offTables = at; at = align8(at + it.size()    * sizeof(IdxTable));
+    h.offTex    = at; at = align8(at + tx.size()    * sizeof(IdxTex));
+    h.offSets   = at; at = align8(at + st.size()    * sizeof(IdxSet));
+    h.offCells  = at; at = align8(at + cells.size() * sizeof(int32_t));
+    h.offRefs   = at; at = align8(at + refs.size()  * sizeof(IdxRef));
+    h.offBlob   = at; at = align8(at + blob.size());
+    h.blobBytes = blob.size();
+
+    std::vector<BYTE> out((size_t)at, 0);
+    if (!ib.empty())    std::memcpy(&out[(size_t)h.offBanks],  ib.data(),    ib.size()    * sizeof(IdxBank));
+    if (!it.empty())    std::memcpy(&out[(size_t)h.offTables], it.data(),    it.size()    * sizeof(IdxTable));
+    if (!tx.empty())    std::memcpy(&out[(size_t)h.offTex],    tx.data(),    tx.size()    * sizeof(IdxTex));
+    if (!st.empty())    std::memcpy(&out[(size_t)h.offSets],   st.data(),    st.size()    * sizeof(IdxSet));
+    if (!cells.empty()) std::memcpy(&out[(size_t)h.offCells],  cells.data(), cells.size() * sizeof(int32_t));
+    if (!refs.empty())  std::memcpy(&out[(size_t)h.offRefs],   refs.data(),  refs.size()  * sizeof(IdxRef));
+    if (!blob.empty())  std::memcpy(&out[(size_t)h.offBlob],   blob.data(),  blob.size());
+
+    h.bodyHash = hash64(&out[sizeof(h)], out.size() - sizeof(h));
+    std::memcpy(&out[0], &h, sizeof(h));
+
+    trace::count(trace::kBytesWritten, out.size());
+    return plat::writeFile(idxPath, out.data(), out.size());
+}
+
+/* ─────────────────────────────────────────────────────────────
+                              reader
+   ───────────────────────────────────────────────────────────── */
+bool juiced::readIndex(const std::string& idxPath, const std::string& d8tPath,
+                       const std::vector<BYTE>& tBuf,
+                       const std::vector<std::string>& d8wPaths,
+                       D8WContext& ctx,
+                       std::vector< std::unique_ptr<D8WBank> >& banks,
+                       std::string* why)
+{
+    D8W_TRACE_SCOPE("readIndex");
+
+    /* ── 1. the sidecar itself ─────────────────────────────────── */
+    std::vector<BYTE> f;
+    if (!plat::readFile(idxPath, f, 0x7FFFFFFF)) return fail(why, "no index");
+    trace::count(trace::kBytesRead, f.size());
+    if (f.size() < sizeof(IdxHeader)) return fail(why, "index truncated");
+
+    IdxHeader h;
+    std::memcpy(&h, f.data(), sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion)
+        return fail(why, "index version mismatch");
+    if (hash64(&f[sizeof(h)], f.size() - sizeof(h)) != h.bodyHash)
+        return fail(why, "index damaged");
+
+    const IdxBank*  ib    = section<IdxBank> (f, h.offBanks,  h.banks);
+    const IdxTable* it    = section<IdxTable>(f, h.offTables, h.tables);
+    const IdxTex*   tx    = section<IdxTex>  (f, h.offTex,    h.textures);
+    const IdxSet*   st    = section<IdxSet>  (f, h.offSets,   h.sets);
+    const int32_t*  cells = section<int32_t> (f, h.offCells,  h.cells);
+    const IdxRef*   refs  = section<IdxRef>  (f, h.offRefs,   h.refs);
+    const BYTE*     blob  = section<BYTE>    (f, h.offBlob,   h.blobBytes);
+    if (!ib || !it || !tx || !st || !cells || !refs || !blob) return fail(why, "index damaged");
+
+    /* ── 2. is it still the same install? ──────────────────────── */
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi) || fi.size != h.d8tSize || fi.mtime != h.d8tMtime ||
+        tBuf.size() != h.d8tSize || sampleHash(tBuf) != h.d8tHash)
+        return fail(why, "index stale: .d8t changed");
+
+    if (d8wPaths.size() != h.banks) return fail(why, "index stale: bank list changed");
+    for (uint32_t b = 0; b < h.banks; ++b)
+    {
+        const IdxBank& r = ib[b];
+        if ((uint64_t)r.pathOff + r.pathLen > h.blobBytes ||
+            (uint64_t)r.tailOff + r.tailLen > h.blobBytes ||
+            (uint64_t)r.firstTable + r.tables > h.tables ||
+            (uint64_t)r.firstSet + r.sets > h.sets)
+            return fail(why, "index damaged");
+
+        const std::string path((const char*)blob + r.pathOff, r.pathLen);
+        if (plat::icmp(path.c_str(), d8wPaths[b].c_str()) != 0)
+            return fail(why, "index stale: bank list changed");
+
+        std::vector<BYTE> raw;
+        if (!plat::fileInfo(d8wPaths[b], fi) || fi.size != r.size || fi.mtime != r.mtime ||
+            !plat::readFile(d8wPaths[b], raw, 0x7FFFFFFF) ||
+            hash64(raw.data(), raw.size()) != r.hash)
+            return fail(why, "index stale: " + d8wPaths[b] + " changed");
+    }
+
+    /* ── 3. materialise – no .d8w parse, no index rebuild walk ─── */
+    std::vector< std::unique_ptr<D8WBank> > fresh;
+    for (uint32_t b = 0; b < h.banks; ++b)
+    {
+        const IdxBank& r = ib[b];
+        BankImage img;
+        std::memcpy(img.header, r.header, sizeof(img.header));
+
+        img.tables.resize(r.tables);
+        for (uint32_t p = 0; p < r.tables; ++p)
+        {
+            const IdxTable& s = it[r.firstTable + p];
+            if ((uint64_t)s.firstTex + s.textures > h.textures) return fail(why, "index damaged");
+
+            TextureTable& t = img.tables[p];
+            t.skip   = s.skip;
+            t.size   = s.size;
+            t.absOff = s.absOff;
+            t.tex.resize(s.textures);
+            for (uint32_t i = 0; i < s.textures; ++i)
+            {
+                const IdxTex& e = tx[s.firstTex + i];
+                static_cast<TextureHdr&>(t.tex[i]) = e.hdr;
+                t.tex[i].fileOff  = e.fileOff;
+                t.tex[i].modified = false;
+            }
+        }
+
+        img.sets.resize(r.sets);
+        for (uint32_t s = 0; s < r.sets; ++s)
+        {
+            const IdxSet& e = st[r.firstSet + s];
+            if ((uint64_t)e.firstCell + e.cells > h.cells) return fail(why, "index damaged");
+            img.sets[s].name.assign(e.name, strnlen(e.name, sizeof(e.name)));
+            img.sets[s].indexTable.assign(cells + e.firstCell, cells + e.firstCell + e.cells);
+        }
+        img.tail.assign(blob + r.tailOff, blob + r.tailOff + r.tailLen);
+
+        fresh.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        fresh.back()->adopt(d8wPaths[b], tBuf, img, false);
+    }
+
+    std::vector< std::pair<uint32_t, Reference*> > sorted(h.refs);
+    for (uint32_t k = 0; k < h.refs; ++k)
+    {
+        const IdxRef& r = refs[k];
+        if (r.bank >= fresh.size() || r.pack >= fresh[r.bank]->tables().size() ||
+            r.tex >= fresh[r.bank]->tables()[r.pack].refs.size())
+            return fail(why, "index damaged");
+        sorted[k] = std::make_pair(r.off, &fresh[r.bank]->tables()[r.pack].refs[r.tex]);
+    }
+    ctx.rebuildIndex(sorted);
+
+    banks.swap(fresh);
+    return true;
+}
@@ -0,0 +1,164 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_io.cpp  –  read scheduler: plan, read ahead, hand out
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_io.h"
+#include "d8w_hash.h"
+#include "d8w_parallel.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+using namespace juiced;
+
+/* ─────────────────────────────────────────────────────────────
+                         ReadScheduler
+   ───────────────────────────────────────────────────────────── */
+ReadScheduler::ReadScheduler(uint32_t mergeGap, uint32_t maxRun)
+    : gap_(mergeGap), maxRun_(maxRun ? maxRun : 1) {}
+
+void ReadScheduler::add(uint64_t off, uint32_t size, size_t tag)
+{
+    Req r = { off, size, tag };
+    reqs_.push_back(r);
+    ++stats_.requests;
+    stats_.bytesWanted += size;
+}
+
+/* reqs_ sorted → runs of neighbouring requests */
+void ReadScheduler::plan(std::vector<Run>& runs) const
+{
+    runs.clear();
+    size_t i = 0;
+    while (i < reqs_.size())
+    {
+        Run r = { reqs_[i].off, reqs_[i].size, i, i + 1 };
+        uint64_t end = r.off + r.len;
+        while (r.last < reqs_.size())
+        {
+            const Req&     n      = reqs_[r.last];
+            const uint64_t newEnd = std::max(end, n.off + n.size);
+            if (n.off > end + gap_ || newEnd - r.off > maxRun_) break;
+            end = newEnd;
+            ++r.last;
+        }
+        r.len = end - r.off;
+        runs.push_back(r);
+        i = r.last;
+    }
+}
+
+bool ReadScheduler::run(const std::string& path, const Sink& sink, unsigned threads)
+{
+    D8W_TRACE_SCOPE("ReadScheduler::run");
+    err_.clear();
+    failed_.clear();
+
+    plat::File f;
+    if (!f.open(path, plat::File::kRead))
+    {
+        err_ = "cannot open " + path;
+        for (size_t i = 0; i < reqs_.size(); ++i) failed_.push_back(reqs_[i].tag);
+        reqs_.clear();
+        return false;
+    }
+    const uint64_t fileSz = f.size();
+
+    std::stable_sort(reqs_.begin(), reqs_.end(),
+                     [](const Req& a, const Req& b){ return a.off < b.off; });
+
+    /* requests past EOF never reach a run */
+    std::vector<Req> ok;
+    ok.reserve(reqs_.size());
+    for (size_t i = 0; i < reqs_.size(); ++i)
+    {
+        if (reqs_[i].off + reqs_[i].size <= fileSz) ok.push_back(reqs_[i]);
+        else                                        failed_.push_back(reqs_[i].tag);
+    }
+    if (!failed_.empty()) err_ = "request beyond end of " + path;
+    reqs_.swap(ok);
+
+    std::vector<Run> runs;
+    plan(runs);
+
+    /* read run k+1 while run k is handed out */
+    std::vector<uint8_t> cur, next;
+    auto readRun = [&f](const Run& r, std::vector<uint8_t>& buf) -> bool
+    {
+        D8W_TRACE_SCOPE("ReadScheduler::read");
+        buf.resize((size_t)r.len);
+        trace::count(trace::kBytesRead, r.len);
+        return r.len == 0 || f.readAt(r.off, buf.data(), (size_t)r.len);
+    };
+
+    bool curOk = runs.empty() || readRun(runs[0], cur);
+    for (size_t k = 0; k < runs.size(); ++k)
+    {
+        std::future<bool> ahead;
+        if (k + 1 < runs.size())
+        {
+            f.willNeed(runs[k + 1].off, runs[k + 1].len);
+            ahead = std::async(std::launch::async, readRun, std::cref(runs[k + 1]), std::ref(next));
+        }
+
+        const Run& r = runs[k];
+        ++stats_.runs;
+        if (curOk)
+        {
+            stats_.bytesRead += r.len;
+            parallelFor(r.last - r.first, [&](size_t j)
+            {
+                const Req& q = reqs_[r.first + j];
+                sink(q.tag, cur.data() + (q.off - r.off), q.size);
+            }, threads);
+        }
+        else
+        {
+            err_ = "read error in " + path;
+            for (size_t j = r.first; j < r.last; ++j) failed_.push_back(reqs_[j].tag);
+        }
+
+        if (ahead.valid())
+        {
+            curOk = ahead.get();
+            cur.swap(next);
+        }
+    }
+
+    reqs_.clear();
+    return failed_.empty();
+}
+
+/* ─────────────────────────────────────────────────────────────
+                          hashExtents
+   ───────────────────────────────────────────────────────────── */
+bool juiced::hashExtents(const std::string& path, const std::vector<FileExtent>& ext,
+                         std::vector<uint64_t>& sums, std::vector<char>& read,
+                         unsigned threads, IoStats* stats, std::string* why)
+{
+    D8W_TRACE_SCOPE("hashExtents");
+    sums.assign(ext.size(), 0);
+    read.assign(ext.size(), 0);
+
+    ReadScheduler rs;
+    for (size_t i = 0; i < ext.size(); ++i)
+    {
+        if (ext[i].second) rs.add(ext[i].first, ext[i].second, i);
+        else             { sums[i] = hash64(0, 0); read[i] = 1; }
+    }
+
+    bool ok = true;
+    if (rs.pending())
+    {
+        ok = rs.run(path, [&](size_t i, const uint8_t* data, uint32_t size)
+        {
+            sums[i] = hash64(data, size);                /* one slot per tag */
+            read[i] = 1;
+        }, threads);
+        if (!ok && why) *why = rs.error();
+    }
+    if (stats) *stats = rs.stats();
+    return ok;
+}
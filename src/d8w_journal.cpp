@@ -0,0 +1,340 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_journal.cpp  –  .d8j session journal
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_journal.h"
+#include "d8w_hash.h"
+#include "d8w_parallel.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "Zlib.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+const char     kMagic[8] = { 'D', '8', 'W', 'J', 'R', 'N', 'L', 0 };
+const uint32_t kVersion  = 1;
+const char*    kPart     = ".part";                 /* temp while rewriting */
+
+enum { kStored, kDeflate };
+
+struct JHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t pad;
+    uint64_t d8tSize;
+    int64_t  d8tMtime;
+};
+
+/* followed by `stored` bytes of body */
+struct JRecord
+{
+    uint32_t   stored;
+    uint32_t   pos, oldSize, newSize;   /* as BodySplice, offsets at that moment */
+    TextureHdr hdr;
+    uint8_t    modified;
+    uint8_t    codec;
+    uint8_t    pad[6];
+    uint64_t   hash;                    /* everything before it + the body      */
+};
+
+static_assert(sizeof(JHeader) == 32 && sizeof(JRecord) == 80, ".d8j record layout");
+
+static uint64_t recordHash(const JRecord& r, const BYTE* body)
+{
+    return hash64(body, r.stored, hash64(&r, offsetof(JRecord, hash)));
+}
+
+/* one body the journal ends up replacing, in .d8t-as-loaded terms */
+struct Net
+{
+    uint32_t orig, origSize;
+    uint32_t size;
+    size_t   rec;                       /* offset of its last record in the file */
+};
+
+static bool readRecord(const std::vector<BYTE>& f, size_t at, JRecord& r)
+{
+    if (f.size() - at < sizeof(JRecord)) return false;
+    std::memcpy(&r, &f[at], sizeof(r));
+    return r.stored <= f.size() - at - sizeof(JRecord) &&
+           recordHash(r, f.data() + at + sizeof(JRecord)) == r.hash;
+}
+
+} // anon
+
+std::string juiced::journalPathFor(const std::string& d8tPath)
+{
+    const size_t slash = d8tPath.find_last_of("\\/");
+    const size_t dot   = d8tPath.find_last_of('.');
+    const bool   ext   = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    return (ext ? d8tPath.substr(0, dot) : d8tPath) + ".d8j";
+}
+
+SessionJournal::SessionJournal(D8WContext& ctx, const std::string& d8tPath, const JournalOptions& o)
+    : ctx_(ctx), d8tPath_(d8tPath), path_(journalPathFor(d8tPath)), opt_(o),
+      left_(0), good_(0), failed_(false)
+{
+    ctx_.addObserver(this);
+
+    /* ── what an earlier session left, if it's for this .d8t ───── */
+    plat::FileInfo fi;
+    JHeader h;
+    const D8WBank* bank = ctx_.bankAt(0);
+    if (!plat::readFile(path_, old_, ~uint64_t(0)) || old_.size() < sizeof(h) ||
+        !plat::fileInfo(d8tPath_, fi) || !bank || !bank->tBuffer())
+    {
+        old_.clear();
+        return;
+    }
+    std::memcpy(&h, &old_[0], sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion ||
+        h.d8tSize != fi.size || h.d8tMtime != fi.mtime || bank->tBuffer()->size() != fi.size)
+    {
+        old_.clear();                                        /* stale or foreign */
+        return;
+    }
+
+    /* intact records up to the first torn one */
+    JRecord r;
+    good_ = sizeof(h);
+    while (readRecord(old_, good_, r))
+    {
+        good_ += sizeof(r) + r.stored;
+        ++left_;
+    }
+}
+
+SessionJournal::~SessionJournal()
+{
+    ctx_.removeObserver(this);
+    flush();
+}
+
+/* the live file becomes old_[0, keep) – or a fresh header – and is
+   opened for appends; rewrites go through a synced temp + rename   */
+bool SessionJournal::start(size_t keep)
+{
+    file_.close();
+    batch_.clear();
+    failed_ = false;
+
+    if (!keep || keep != old_.size())
+    {
+        std::vector<BYTE> head;
+        if (keep)
+            head.assign(old_.begin(), old_.begin() + keep);
+        else
+        {
+            plat::FileInfo fi;
+            if (!plat::fileInfo(d8tPath_, fi)) return failed_ = true, setError("cannot stat %s", d8tPath_.c_str());
+            JHeader h;
+            std::memset(&h, 0, sizeof(h));
+            std::memcpy(h.magic, kMagic, sizeof(kMagic));
+            h.version  = kVersion;
+            h.d8tSize  = fi.size;
+            h.d8tMtime = fi.mtime;
+            head.resize(sizeof(h));
+            std::memcpy(&head[0], &h, sizeof(h));
+        }
+
+        const std::string part = path_ + kPart;
+        plat::File f;
+        if (!f.open(part, plat::File::kWrite) || !f.write(head.data(), head.size()) || !f.sync())
+            return failed_ = true, setError("cannot write %s", part.c_str());
+        f.close();
+        if (!plat::moveFile(part, path_))
+            return failed_ = true, setError("cannot replace %s", path_.c_str());
+    }
+    std::vector<BYTE>().swap(old_);
+    left_ = 0;
+
+    if (!file_.open(path_, plat::File::kAppend))
+        return failed_ = true, setError("cannot open %s", path_.c_str());
+    return true;
+}
+
+bool SessionJournal::reset()
+{
+    StatusScope st("journal");
+    return start(0);
+}
+
+void SessionJournal::remove()
+{
+    file_.close();
+    batch_.clear();
+    std::vector<BYTE>().swap(old_);
+    left_ = 0;
+    plat::removeFile(path_);
+}
+
+bool SessionJournal::replay()
+{
+    D8W_TRACE_SCOPE("SessionJournal::replay");
+    StatusScope st("replay");
+    if (!left_) return start(0);
+
+    D8WBank* bank = ctx_.bankAt(0);
+    std::vector<BYTE>* T = bank ? bank->tBuffer() : 0;
+    if (!T) return setError("no bank loaded");
+
+    /* ── 1. fold: each record replaces one body at its then-offset ─ */
+    std::vector<Net> net;                                  /* by orig */
+    JRecord r;
+    for (size_t at = sizeof(JHeader); at < good_; at += sizeof(r) + r.stored)
+    {
+        readRecord(old_, at, r);                           /* checked by the ctor */
+
+        int64_t shift = 0;                                 /* Σ growth in front   */
+        size_t  k     = 0;
+        for (; k < net.size(); ++k)
+        {
+            const int64_t cur = (int64_t)net[k].orig + shift;
+            if (cur >= r.pos) break;
+            shift += (int64_t)net[k].size - (int64_t)net[k].origSize;
+        }
+
+        if (k < net.size() && (int64_t)net[k].orig + shift == r.pos && net[k].size == r.oldSize)
+        {
+            net[k].size = r.newSize;                       /* a journal body again */
+            net[k].rec  = at;
+            continue;
+        }
+
+        const int64_t orig = (int64_t)r.pos - shift;
+        if (orig < 0 || orig + r.oldSize > (int64_t)T->size() ||
+            (k < net.size() && orig + r.oldSize > net[k].orig) ||
+            (k > 0 && (int64_t)net[k - 1].orig + net[k - 1].origSize > orig))
+            return setError("%s: record at %zu doesn't fit the .d8t", path_.c_str(), at);
+
+        Net n = { (uint32_t)orig, r.oldSize, r.newSize, at };
+        net.insert(net.begin() + k, n);
+    }
+
+    /* every replaced body must be one the banks reference */
+    std::vector<uint32_t> offs;
+    for (size_t b = 0; b < ctx_.bankCount(); ++b)
+    {
+        const std::vector<TextureTable>& tbl = ctx_.bankAt(b)->tables();
+        for (size_t p = 0; p < tbl.size(); ++p)
+            for (size_t i = 0; i < tbl[p].tex.size(); ++i) offs.push_back(tbl[p].tex[i].fileOff);
+    }
+    std::sort(offs.begin(), offs.end());
+    for (size_t k = 0; k < net.size(); ++k)
+        if (!std::binary_search(offs.begin(), offs.end(), net[k].orig))
+            return setError("%s: no texture at 0x%08X", path_.c_str(), net[k].orig);
+
+    /* ── 2. final bodies, inflated on all cores ────────────────── */
+    std::vector< std::vector<BYTE> > body(net.size());
+    std::vector<BodySplice>          s(net.size());
+    std::vector<char>                bad(net.size(), 0);
+    parallelFor(net.size(), [&](size_t k)
+    {
+        JRecord q;
+        std::memcpy(&q, &old_[net[k].rec], sizeof(q));
+        const BYTE* src = old_.data() + net[k].rec + sizeof(q);
+
+        if (q.codec == kDeflate)
+        {
+            bad[k] = !zlib::inflateRaw(src, q.stored, body[k], q.newSize) || body[k].size() != q.newSize;
+        }
+        else
+        {
+            bad[k] = q.codec != kStored || q.stored != q.newSize;
+            body[k].assign(src, src + q.stored);
+        }
+
+        BodySplice& sp = s[k];
+        std::memset(&sp, 0, sizeof(sp));
+        sp.pos     = net[k].orig;
+        sp.oldSize = net[k].origSize;
+        sp.newSize = net[k].size;
+        sp.hdr     = q.hdr;
+        sp.body    = body[k].empty() ? 0 : &body[k][0];
+    });
+    for (size_t k = 0; k < net.size(); ++k)
+        if (bad[k]) return setError("%s: body at 0x%08X doesn't inflate", path_.c_str(), net[k].orig);
+
+    /* ── 3. one copy of the .d8t, one header pass ──────────────── */
+    std::vector<BYTE> out;
+    if (!detail::spliceBatch(*T, s, out)) return false;    /* Status set */
+    if (!bank->applySplices(s)) return setError("reference index lost a journal body");
+    T->swap(out);
+    trace::count(trace::kBytesRead, good_);
+
+    /* bodies an undo put back are the file's own again */
+    std::vector<uint32_t> clean;
+    int64_t shift = 0;
+    for (size_t k = 0; k < net.size(); ++k)
+    {
+        JRecord q;
+        std::memcpy(&q, &old_[net[k].rec], sizeof(q));
+        if (!q.modified) clean.push_back((uint32_t)(net[k].orig + shift));
+        shift += (int64_t)net[k].size - (int64_t)net[k].origSize;
+    }
+    for (size_t b = 0; !clean.empty() && b < ctx_.bankCount(); ++b)
+    {
+        std::vector<TextureTable>& tbl = ctx_.bankAt(b)->tables();
+        for (size_t p = 0; p < tbl.size(); ++p)
+            for (size_t i = 0; i < tbl[p].tex.size(); ++i)
+                if (std::binary_search(clean.begin(), clean.end(), tbl[p].tex[i].fileOff))
+                    tbl[p].tex[i].modified = false;
+    }
+
+    return start(good_);                                   /* torn tail goes */
+}
+
+void SessionJournal::beforeSplice(D8WBank&, const BodySplice& sp, const TextureHdrEx&, bool modified)
+{
+    if (failed_) return;
+    if (!file_.isOpen() && !reset()) return;               /* nobody started it */
+
+    JRecord r;
+    std::memset(&r, 0, sizeof(r));
+    r.pos      = sp.pos;
+    r.oldSize  = sp.oldSize;
+    r.newSize  = sp.newSize;
+    r.hdr      = sp.hdr;
+    r.modified = modified ? 1 : 0;
+    r.codec    = kStored;
+
+    const size_t at = batch_.size();
+    batch_.resize(at + sizeof(r));
+    if (sp.newSize && opt_.level > 0)
+        zlib::deflateRaw(sp.body, sp.newSize, batch_, opt_.level);
+    if (batch_.size() - at - sizeof(r) < sp.newSize && sp.newSize)
+        r.codec = kDeflate;
+    else
+    {
+        batch_.resize(at + sizeof(r));
+        if (sp.newSize) batch_.insert(batch_.end(), sp.body, sp.body + sp.newSize);
+    }
+    r.stored = uint32_t(batch_.size() - at - sizeof(r));
+    r.hash   = recordHash(r, batch_.data() + at + sizeof(r));
+    std::memcpy(&batch_[at], &r, sizeof(r));
+
+    if (batch_.size() >= opt_.batchBytes) flush();
+}
+
+bool SessionJournal::flush()
+{
+    D8W_TRACE_SCOPE("SessionJournal::flush");
+    if (failed_) return false;
+    if (batch_.empty()) return true;
+
+    if (!file_.write(batch_.data(), batch_.size()) || !file_.sync())
+    {
+        failed_ = true;
+        return false;
+    }
+    trace::count(trace::kBytesWritten, batch_.size());
+    batch_.clear();
+    return true;
+}
@@ -0,0 +1,329 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_json.cpp  –  recursive-descent JSON reader / writer
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace juiced;
+using json::Value;
+
+/* ─────────────────────────────────────────────────────────────
+                         Value helpers
+   ───────────────────────────────────────────────────────────── */
+const Value* Value::find(const std::string& key) const
+{
+    for (size_t i = 0; i < obj_.size(); ++i)
+        if (obj_[i].first == key) return &obj_[i].second;
+    return 0;
+}
+
+Value& Value::set(const std::string& key, const Value& v)
+{
+    kind_ = kObject;
+    for (size_t i = 0; i < obj_.size(); ++i)
+        if (obj_[i].first == key) { obj_[i].second = v; return obj_[i].second; }
+    obj_.push_back(std::make_pair(key, v));
+    return obj_.back().second;
+}
+
+std::string Value::str(const std::string& key, const std::string& def) const
+{
+    const Value* v = find(key);
+    return v && v->isString() ? v->asString() : def;
+}
+
+double Value::num(const std::string& key, double def) const
+{
+    const Value* v = find(key);
+    return v && v->isNumber() ? v->asNumber() : def;
+}
+
+bool Value::flag(const std::string& key, bool def) const
+{
+    const Value* v = find(key);
+    return v && !v->isNull() ? v->asBool() : def;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           writer
+   ───────────────────────────────────────────────────────────── */
+void json::quote(const std::string& s, std::string& out)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        const unsigned char c = (unsigned char)s[i];
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) { out += "\\u00"; out += hex[c >> 4]; out += hex[c & 15]; }
+            else            out += (char)c;
+        }
+    }
+    out += '"';
+}
+
+void Value::dump(std::string& out) const
+{
+    switch (kind_)
+    {
+    case kNull:   out += "null"; break;
+    case kBool:   out += b_ ? "true" : "false"; break;
+    case kNumber:
+    {
+        char buf[32];
+        if (!std::isfinite(n_))                          std::strcpy(buf, "null");
+        else if (n_ == std::floor(n_) && std::fabs(n_) < 9.007e15)
+            std::snprintf(buf, sizeof(buf), "%lld", (long long)n_);
+        else
+        {
+            std::snprintf(buf, sizeof(buf), "%.15g", n_);   /* shortest that round-trips */
+            if (std::strtod(buf, 0) != n_) std::snprintf(buf, sizeof(buf), "%.17g", n_);
+        }
+        out += buf;
+        break;
+    }
+    case kString: quote(s_, out); break;
+    case kArray:
+        out += '[';
+        for (size_t i = 0; i < arr_.size(); ++i)
+        {
+            if (i) out += ',';
+            arr_[i].dump(out);
+        }
+        out += ']';
+        break;
+    case kObject:
+        out += '{';
+        for (size_t i = 0; i < obj_.size(); ++i)
+        {
+            if (i) out += ',';
+            quote(obj_[i].first, out);
+            out += ':';
+            obj_[i].second.dump(out);
+        }
+        out += '}';
+        break;
+    }
+}
+
+std::string Value::dump() const
+{
+    std::string s;
+    dump(s);
+    return s;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           reader
+   ───────────────────────────────────────────────────────────── */
+namespace
+{
+
+enum { kMaxDepth = 64 };
+
+struct Reader
+{
+    const char* p;
+    const char* end;
+    std::string err;
+
+    bool fail(const char* what)
+    {
+        if (err.empty()) err = what;
+        return false;
+    }
+
+    void ws()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+
+    bool lit(const char* w)
+    {
+        const size_t n = std::strlen(w);
+        if (size_t(end - p) < n || std::memcmp(p, w, n)) return fail("bad literal");
+        p += n;
+        return true;
+    }
+
+    static void utf8(uint32_t cp, std::string& o)
+    {
+        if (cp < 0x80)        o += (char)cp;
+        else if (cp < 0x800)  { o += (char)(0xC0 | (cp >> 6));  o += (char)(0x80 | (cp & 63)); }
+        else if (cp < 0x10000)
+        {
+            o += (char)(0xE0 | (cp >> 12));
+            o += (char)(0x80 | ((cp >> 6) & 63));
+            o += (char)(0x80 | (cp & 63));
+        }
+        else
+        {
+            o += (char)(0xF0 | (cp >> 18));
+            o += (char)(0x80 | ((cp >> 12) & 63));
+            o += (char)(0x80 | ((cp >> 6) & 63));
+            o += (char)(0x80 | (cp & 63));
+        }
+    }
+
+    bool hex4(uint32_t& v)
+    {
+        if (end - p < 4) return fail("short \\u escape");
+        v = 0;
+        for (int i = 0; i < 4; ++i, ++p)
+        {
+            const char c = *p;
+            v <<= 4;
+            if      (c >= '0' && c <= '9') v |= c - '0';
+            else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+            else return fail("bad \\u escape");
+        }
+        return true;
+    }
+
+    bool string(std::string& o)
+    {
+        ++p;                                            /* opening quote */
+        while (p < end && *p != '"')
+        {
+            if ((unsigned char)*p < 0x20) return fail("control char in string");
+            if (*p != '\\') { o += *p++; continue; }
+            if (++p >= end) break;
+            switch (*p++)
+            {
+            case '"':  o += '"';  break;
+            case '\\': o += '\\'; break;
+            case '/':  o += '/';  break;
+            case 'b':  o += '\b'; break;
+            case 'f':  o += '\f'; break;
+            case 'n':  o += '\n'; break;
+            case 'r':  o += '\r'; break;
+            case 't':  o += '\t'; break;
+            case 'u':
+            {
+                uint32_t cp;
+                if (!hex4(cp)) return false;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                {
+                    p += 2;
+                    uint32_t lo;
+                    if (!hex4(lo)) return false;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                utf8(cp, o);
+                break;
+            }
+            default: return fail("bad escape");
+            }
+        }
+        if (p >= end) return fail("unterminated string");
+        ++p;
+        return true;
+    }
+
+    bool number(Value& v)
+    {
+        const char* s = p;
+        if (p < end && (*p == '-' || *p == '+')) ++p;
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' ||
+                           *p == 'E' || *p == '-' || *p == '+')) ++p;
+        if (p == s) return fail("unexpected character");
+
+        const std::string tok(s, p);
+        char* stop = 0;
+        const double d = std::strtod(tok.c_str(), &stop);
+        if (!stop || *stop) return fail("bad number");
+        v = Value(d);
+        return true;
+    }
+
+    bool value(Value& v, int depth)
+    {
+        if (depth > kMaxDepth) return fail("nesting too deep");
+        ws();
+        if (p >= end) return fail("unexpected end");
+
+        switch (*p)
+        {
+        case 'n': v = Value();      return lit("null");
+        case 't': v = Value(true);  return lit("true");
+        case 'f': v = Value(false); return lit("false");
+        case '"':
+        {
+            std::string s;
+            if (!string(s)) return false;
+            v = Value(s);
+            return true;
+        }
+        case '[':
+        {
+            ++p;
+            v = Value::array();
+            ws();
+            if (p < end && *p == ']') { ++p; return true; }
+            for (;;)
+            {
+                Value e;
+                if (!value(e, depth + 1)) return false;
+                v.push(e);
+                ws();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == ']') { ++p; return true; }
+                return fail("expected , or ]");
+            }
+        }
+        case '{':
+        {
+            ++p;
+            v = Value::object();
+            ws();
+            if (p < end && *p == '}') { ++p; return true; }
+            for (;;)
+            {
+                ws();
+                if (p >= end || *p != '"') return fail("expected key");
+                std::string k;
+                if (!string(k)) return false;
+                ws();
+                if (p >= end || *p != ':') return fail("expected :");
+                ++p;
+                Value e;
+                if (!value(e, depth + 1)) return false;
+                v.set(k, e);
+                ws();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == '}') { ++p; return true; }
+                return fail("expected , or }");
+            }
+        }
+        default:
+            return number(v);
+        }
+    }
+};
+
+} // anon
+
+bool json::parse(const char* text, size_t n, Value& out, std::string& err)
+{
+    Reader r;
+    r.p   = text;
+    r.end = text + n;
+
+    out = Value();
+    if (!r.value(out, 0)) { err = r.err; return false; }
+    r.ws();
+    if (r.p != r.end)     { err = "trailing characters"; return false; }
+    return true;
+}
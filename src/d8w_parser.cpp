@@ -2,17 +2,27 @@
 
 
 #include "d8w_parser.h"
+#include "d8w_parallel.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+#include "BlockDecode.h"
+#include "ImageIO.h"
+#include "MipGen.h"
+#include "PixelSwizzle.h"
 
-#include <windows.h>
-#include <direct.h>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
 #include <map>
+#include <mutex>
 
 #define DDS_MAGIC 0x20534444
 #define DDSD_CAPS 0x00000001
 #define DDSD_HEIGHT 0x00000002
 #define DDSD_WIDTH 0x00000004
+#define DDSD_PITCH 0x00000008
 #define DDSD_PIXELFORMAT 0x00001000
 #define DDSD_MIPMAPCOUNT 0x00020000
 #define DDSD_LINEARSIZE 0x00080000
@@ -29,28 +39,14 @@
 /* ========================================================================== */
 /*  Debug / error infrastructure                                              */
 /*  ------------------------------------------------------------------------ */
-/*  • SETERR()  – write formatted message into gLastErr                       */
+/*  • SETERR()  – write formatted message into the thread's Status            */
 /*  • DBGPOP()  – message-box only in a _DEBUG build                          */
 /*  • DBGBOX()  – printf-style shorthand used throughout the parser           */
 /* ========================================================================== */
-std::string gLastErr;
-
-static void setErr(const char* fmt, ...)     // printf → gLastErr
-{
-    char buf[256];
-    va_list ap; va_start(ap, fmt);
-    _vsnprintf(buf, sizeof(buf), fmt, ap);
-    va_end(ap);
-    gLastErr = buf;
-}
-
-static void pop(const char* fmt, ...)        // printf → MessageBoxA
+namespace
 {
-    char buf[256];
-    va_list ap; va_start(ap, fmt);
-    _vsnprintf(buf, sizeof(buf), fmt, ap);
-    va_end(ap);
-    MessageBoxA(nullptr, buf, "d8w-debug", MB_OK | MB_ICONINFORMATION);
+thread_local juiced::Status tStatus;       /* last / current operation      */
+thread_local int            tDepth = 0;    /* StatusScope nesting           */
 }
 
 /* ========================================================================== */
@@ -70,7 +66,7 @@ static void pop(const char* fmt, ...)        // printf → MessageBoxA
 #endif
 
 /* ------------------------------------------------------------------------- */
-/*  helper – write gLastErr                                                  */
+/*  helper – write the calling thread's Status                               */
 /* ------------------------------------------------------------------------- */
 static void SetErrF(const char* fmt, ...)        /* ALWAYS call through macro */
 {
@@ -82,7 +78,8 @@ static void SetErrF(const char* fmt, ...)        /* ALWAYS call through macro */
     buf[sizeof(buf)-1] = '\0';
     va_end(ap);
 
-    gLastErr = buf;
+    tStatus.ok    = false;
+    tStatus.error = buf;
 }
 
 /*  call like  SETERR("plain msg")  or  SETERR("fmt %d", n)                  */
@@ -90,14 +87,12 @@ static void SetErrF(const char* fmt, ...)        /* ALWAYS call through macro */
 
 /* ------------------------------------------------------------------------- */
 #ifdef _DEBUG                    /* message boxes only in debug builds       */
-#   define DBGPOP(msg)  MessageBoxA(nullptr, (msg), "d8w-debug",             \
-                                    MB_OK | MB_ICONERROR)
+#   define DBGPOP(msg)  plat::debugBox("d8w-debug", (msg))
 
 #   define DBGBOX(fmt, ...)                                                  \
         do { char _b_[256];                                                  \
              SNPRINTF(_b_, sizeof(_b_), (fmt), __VA_ARGS__);                 \
-             MessageBoxA(nullptr, _b_, "d8w-debug",                          \
-                         MB_OK | MB_ICONINFORMATION);                        \
+             plat::debugBox("d8w-debug", _b_);                               \
         } while (0)
 #else
 #   define DBGPOP(msg)      ((void)0)
@@ -110,6 +105,29 @@ static void SetErrF(const char* fmt, ...)        /* ALWAYS call through macro */
 
 using namespace juiced;
 
+const Status& juiced::lastStatus() { return tStatus; }
+
+bool juiced::setError(const char* fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    VSNPRINTF(buf, sizeof(buf), fmt, ap);
+    buf[sizeof(buf)-1] = '\0';
+    va_end(ap);
+
+    tStatus.ok    = false;
+    tStatus.error = buf;
+    return false;
+}
+
+StatusScope::StatusScope(const char* op)
+{
+    if (tDepth++ == 0) { tStatus = Status(); tStatus.op = op; }
+}
+
+StatusScope::~StatusScope() { --tDepth; }
+
 namespace
 {
 
@@ -141,58 +159,38 @@ v.push_back( BYTE((x >> 24) &0xFF) );
    --------------------------------------------------------------*/
 static bool fileToMem(const std::string& path, std::vector<BYTE>& dst)
 {
+    D8W_TRACE_SCOPE("fileToMem");
     dst.clear();
 
-    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ,
-                           FILE_SHARE_READ | FILE_SHARE_WRITE,
-                           nullptr, OPEN_EXISTING,
-                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
-                           nullptr);
-    if (h == INVALID_HANDLE_VALUE) return false;
-
-    LARGE_INTEGER li{};
-    if (!GetFileSizeEx(h, &li) || li.QuadPart == 0 || li.QuadPart > 0x7FFFFFFF)
-    { CloseHandle(h); return false; }
-
-    const DWORD bytesWanted = static_cast<DWORD>(li.QuadPart);
-    dst.resize(bytesWanted);
-
-    BYTE* ptr   = dst.data();
-    DWORD bytes = bytesWanted;
-    while (bytes > 0)
-    {
-        DWORD chunk = 0;
-        if (!ReadFile(h, ptr, bytes, &chunk, nullptr) || chunk == 0)
-        { CloseHandle(h); dst.clear(); return false; }
-
-        ptr   += chunk;
-        bytes -= chunk;
-    }
-    CloseHandle(h);
+    /* offsets are 32-bit and signed in places: refuse ≥ 2 GB */
+    if (!plat::readFile(path, dst, 0x7FFFFFFF)) return false;
+    trace::count(trace::kBytesRead, dst.size());
     return true;
 }
 
 static bool ensureDir(const std::string& d)
 {
-DWORD a = GetFileAttributesA(d.c_str());
-return (a!=INVALID_FILE_ATTRIBUTES) || (_mkdir(d.c_str())==0);
+return plat::makeDir(d);
 }
 
-static bool writeDDSHeader(HANDLE f,const TextureHdr& h)
+static void makeDDSHeader(const TextureHdr& h,BYTE* buf)
 {
-BYTE buf[128]={0}; BYTE* p=buf;
+std::memset(buf,0,128); BYTE* p=buf;
 
-*(DWORD*)p = DDS_MAGIC; p+=4;
+wr<uint32_t>(p,DDS_MAGIC);
 wr<uint32_t>(p,124);
 
-uint32_t flags = DDSD_CAPS|DDSD_HEIGHT|DDSD_WIDTH|
-DDSD_PIXELFORMAT|DDSD_LINEARSIZE;
+/* 0x15 is the only non-FourCC type: raw pixels in pix::kJuicedARGB */
+const bool raw = h.type==bc::kTypeARGB;
+
+uint32_t flags = DDSD_CAPS|DDSD_HEIGHT|DDSD_WIDTH|DDSD_PIXELFORMAT|
+(raw ? DDSD_PITCH : DDSD_LINEARSIZE);
 if(h.mipCnt>1) flags|=DDSD_MIPMAPCOUNT;
 wr<uint32_t>(p,flags);
 
 wr<uint32_t>(p,h.height);
 wr<uint32_t>(p,h.width );
-wr<uint32_t>(p,h.size );
+wr<uint32_t>(p,raw ? (uint32_t)pix::rowBytes(pix::kJuicedARGB,h.width) : h.size);
 wr<uint32_t>(p,0);
 wr<uint32_t>(p,h.mipCnt);
 
@@ -200,62 +198,162 @@ p += 11*4;
 
 wr<uint32_t>(p,32);
 
-uint32_t pf = (h.type==0x31545844 || h.type==0x35545844)
-? DDPF_FOURCC : (DDPF_RGB|DDPF_ALPHAPIXELS);
-wr<uint32_t>(p,pf);
+if(!raw)
+{
+wr<uint32_t>(p,DDPF_FOURCC);
 wr<uint32_t>(p,h.type);
-
-if(pf & DDPF_FOURCC) p += 20;
+p += 20;
+}
 else
 {
-wr<uint32_t>(p,32); wr<uint32_t>(p,0x00FF0000);
-wr<uint32_t>(p,0x0000FF00); wr<uint32_t>(p,0x000000FF);
-wr<uint32_t>(p,0xFF000000);
+const pix::PixelLayout& l = pix::kJuicedARGB;
+wr<uint32_t>(p,DDPF_RGB|DDPF_ALPHAPIXELS); wr<uint32_t>(p,0);
+wr<uint32_t>(p,l.bits);  wr<uint32_t>(p,l.rMask);
+wr<uint32_t>(p,l.gMask); wr<uint32_t>(p,l.bMask);
+wr<uint32_t>(p,l.aMask);
 }
 
 uint32_t caps = DDSCAPS_TEXTURE;
 if(h.mipCnt>1) caps |= DDSCAPS_COMPLEX|DDSCAPS_MIPMAP;
 wr<uint32_t>(p,caps);
-p += 16;
+}
+
+static bool writeDDSHeader(plat::File& f,const TextureHdr& h)
+{
+BYTE buf[128];
+makeDDSHeader(h,buf);
+return f.write(buf,128);
+}
+}
+
+/* ─────────────────────────────────────────────────────────────
+                          D8WContext
+   ───────────────────────────────────────────────────────────── */
+D8WContext& D8WContext::shared()
+{
+    static D8WContext ctx;
+    return ctx;
+}
+
+D8WContext::~D8WContext()
+{
+    /* banks outliving their context fall back to the shared one */
+    if (this == &shared()) return;
+    for (size_t i = 0; i < banks_.size(); ++i)
+    {
+        banks_[i]->ctx_ = &shared();
+        shared().attach(banks_[i]);
+    }
+}
 
-DWORD bw; return WriteFile(f,buf,128,&bw,NULL) && bw==128;
+void D8WContext::attach(D8WBank* b)
+{
+    if (!isLive(b)) banks_.push_back(b);
 }
+
+bool D8WContext::isLive(const D8WBank* b) const
+{
+    for (size_t i = 0; i < banks_.size(); ++i)
+        if (banks_[i] == b) return true;
+    return false;
 }
 
-typedef std::map< uint32_t, std::vector<juiced::Reference*> > RefMap;
+void D8WContext::addObserver(SpliceObserver* o)
+{
+    if (o && std::find(observers_.begin(), observers_.end(), o) == observers_.end())
+        observers_.push_back(o);
+}
 
-static RefMap gRefIdx;
-static std::vector<juiced::D8WBank*> gBanks;
+void D8WContext::removeObserver(SpliceObserver* o)
+{
+    observers_.erase(std::remove(observers_.begin(), observers_.end(), o), observers_.end());
+}
 
-static void addRef(uint32_t abs, juiced::Reference* r)
+size_t D8WContext::refCount() const
 {
-gRefIdx[abs].push_back(r);
+    size_t n = 0;
+    for (RefMap::const_iterator it = refs_.begin(); it != refs_.end(); ++it) n += it->second.size();
+    return n;
 }
 
-static void rebuildIndex()
+void D8WContext::rebuildIndex()
 {
-gRefIdx.clear();
+D8W_TRACE_SCOPE("rebuildIndex");
+trace::count(trace::kIndexRebuilds);
+refs_.clear();
 
 size_t bi, pi, ti;
-for (bi = 0; bi < gBanks.size(); ++bi)
+for (bi = 0; bi < banks_.size(); ++bi)
 {
 
-std::vector<juiced::TextureTable>& tbls = gBanks[bi]->tables();
+std::vector<juiced::TextureTable>& tbls = banks_[bi]->tables();
 
 for (pi = 0; pi < tbls.size(); ++pi)
 {
 for (ti = 0; ti < tbls[pi].refs.size(); ++ti)
 {
 juiced::Reference* ref = &tbls[pi].refs[ti];
-addRef(ref->hdr->fileOff, ref);
+refs_[ref->hdr->fileOff].push_back(ref);
 }
+trace::count(trace::kIndexRefs, tbls[pi].refs.size());
 }
 }
 }
 
-static inline std::vector<BYTE>* bigBuf()
+void D8WContext::rebuildIndex(const std::vector< std::pair<uint32_t, Reference*> >& sorted)
 {
-return gBanks.empty() ? NULL : gBanks.front()->tBuffer();
+    D8W_TRACE_SCOPE("rebuildIndex");
+    trace::count(trace::kIndexRebuilds);
+    trace::count(trace::kIndexRefs, sorted.size());
+    refs_.clear();
+
+    /* offsets arrive ascending: append at the end, no tree search */
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        RefMap::iterator it = refs_.end();
+        if (!refs_.empty() && (--it)->first == sorted[i].first)
+            it->second.push_back(sorted[i].second);
+        else
+            refs_.insert(refs_.end(), RefMap::value_type(sorted[i].first,
+                                      std::vector<Reference*>(1, sorted[i].second)));
+    }
+}
+
+void D8WContext::detach(D8WBank* b)
+{
+    /* ─── 1. remove the bank from the registry ────────────────── */
+    size_t i;
+    for (i = 0; i < banks_.size(); )
+    {
+        if (banks_[i] == b)
+            banks_.erase(banks_.begin() + i);
+        else
+            ++i;
+    }
+
+    /* ─── 2. scrub every Reference that still points there ───── */
+    RefMap::iterator it = refs_.begin();
+    while (it != refs_.end())
+    {
+        std::vector<juiced::Reference*>& v = it->second;
+
+        /* erase-by-index so we stay portable pre-C++11 */
+        size_t k;
+        for (k = 0; k < v.size(); )
+        {
+            juiced::Reference* r = v[k];
+            if (!r || r->ownerBank == b)
+                v.erase(v.begin() + k);   /* remove zombie */
+            else
+                ++k;
+        }
+
+        /* drop empty map buckets altogether */
+        if (v.empty())
+            it = refs_.erase(it);
+        else
+            ++it;
+    }
 }
 
 /******************************************************************************
@@ -269,7 +367,7 @@ return gBanks.empty() ? NULL : gBanks.front()->tBuffer();
 * delta    : (out) newSz – oldSz  →  caller adds this to every header/offset
 *
 * RETURNS  : true  – splice succeeded
-*            false – bounds or parameter error (gLastErr is set)
+*            false – bounds or parameter error (Status is set)
 *
 * Behaviour
 * ─────────
@@ -286,6 +384,7 @@ static bool spliceReplace(std::vector<BYTE>& big,
                           int32_t&           delta /* out */)
 {
     /* ── 0. sanity guards ──────────────────────────────────────────── */
+    D8W_TRACE_SCOPE("spliceReplace");
     delta = 0;
 
     const size_t fileSz = big.size();
@@ -304,6 +403,9 @@ static bool spliceReplace(std::vector<BYTE>& big,
     /* ── 1. size reconciliation ───────────────────────────────────── */
     delta = (int32_t)newSz - (int32_t)oldSz;
 
+    trace::count(trace::kSpliceCalls);
+    trace::count(trace::kSpliceMoved, newSz + (delta ? fileSz - abs - oldSz : 0));
+
     if (delta > 0)   /* grow: make room AFTER the old body */
         big.insert(big.begin() + abs + oldSz, delta, 0);
 
@@ -324,51 +426,63 @@ static bool spliceReplace(std::vector<BYTE>& big,
 }
 
 
+bool juiced::detail::spliceReplace(std::vector<BYTE>& big, uint32_t abs, uint32_t oldSz,
+                                   const BYTE* newData, uint32_t newSz, int32_t& delta)
+{ return ::spliceReplace(big, abs, oldSz, newData, newSz, delta); }
+
+bool juiced::detail::spliceBatch(const std::vector<BYTE>& src, const std::vector<BodySplice>& s,
+                                 std::vector<BYTE>& out)
+{
+    D8W_TRACE_SCOPE("spliceBatch");
+    int64_t grow = 0;
+    uint64_t cursor = 0;
+    for (size_t j = 0; j < s.size(); ++j)
+    {
+        if (s[j].pos < cursor || (uint64_t)s[j].pos + s[j].oldSize > src.size())
+            return SETERR("spliceBatch: splice %u out of order or bounds (pos=0x%08X)",
+                          (uint32_t)j, s[j].pos), false;
+        if (s[j].newSize && s[j].body == NULL)
+            return SETERR("spliceBatch: splice %u has no body", (uint32_t)j), false;
+        cursor = (uint64_t)s[j].pos + s[j].oldSize;
+        grow  += (int64_t)s[j].newSize - (int64_t)s[j].oldSize;
+    }
+
+    out.clear();
+    out.reserve((size_t)((int64_t)src.size() + grow));
+    cursor = 0;
+    for (size_t j = 0; j < s.size(); ++j)
+    {
+        out.insert(out.end(), src.begin() + (size_t)cursor, src.begin() + s[j].pos);
+        out.insert(out.end(), s[j].body, s[j].body + s[j].newSize);
+        cursor = (uint64_t)s[j].pos + s[j].oldSize;
+    }
+    out.insert(out.end(), src.begin() + (size_t)cursor, src.end());
+
+    trace::count(trace::kSpliceCalls, s.size());
+    trace::count(trace::kSpliceMoved, out.size());
+    return true;
+}
 
 bool D8TFile::loadFileToMem(const std::string& p,std::vector<BYTE>& dst) const
 { return fileToMem(p,dst); }
 
 bool D8TFile::load(const std::string& p)
 {
-pathT_=p; return loadFileToMem(p,buf_);
+StatusScope st("loadD8T");
+pathT_=p;
+if(!loadFileToMem(p,buf_)) return SETERR("cannot read %s", p.c_str()), false;
+return true;
 }
 
-D8WBank::D8WBank(): dirty_(false), tBuf_(NULL), headerFixed(false) {}
-D8WBank::~D8WBank()
-{
-    /* ─── 1. remove “this” from gBanks ────────────────────────── */
-    size_t i;
-    for (i = 0; i < gBanks.size(); )
-    {
-        if (gBanks[i] == this)
-            gBanks.erase(gBanks.begin() + i);
-        else
-            ++i;
-    }
+D8WBank::D8WBank()
+    : ctx_(&D8WContext::shared()), dirty_(false), headerFixed(false), tBuf_(NULL) {}
 
-    /* ─── 2. scrub every Reference that still points here ─────── */
-    RefMap::iterator it = gRefIdx.begin();
-    while (it != gRefIdx.end())
-    {
-        std::vector<juiced::Reference*>& v = it->second;
-
-        /* erase-by-index so we stay portable pre-C++11 */
-        size_t k;
-        for (k = 0; k < v.size(); )
-        {
-            juiced::Reference* r = v[k];
-            if (!r || r->ownerBank == this)
-                v.erase(v.begin() + k);   /* remove zombie */
-            else
-                ++k;
-        }
+D8WBank::D8WBank(D8WContext& ctx)
+    : ctx_(&ctx), dirty_(false), headerFixed(false), tBuf_(NULL) {}
 
-        /* drop empty map buckets altogether */
-        if (v.empty())
-            it = gRefIdx.erase(it);
-        else
-            ++it;
-    }
+D8WBank::~D8WBank()
+{
+    ctx_->detach(this);
 }
 
 
@@ -381,18 +495,22 @@ std::string& out) const
 {
 if(!hint.empty()){ out=hint; return true; }
 
-out = folder + "\\" + stem + ".d8t";
-if(GetFileAttributesA(out.c_str())!=INVALID_FILE_ATTRIBUTES) return true;
+out = plat::join(folder, stem + ".d8t");
+if(plat::exists(out)) return true;
 
-WIN32_FIND_DATAA fd;
-HANDLE h = FindFirstFileA((folder+"\\*.d8t").c_str(),&fd);
-if(h!=INVALID_HANDLE_VALUE){ out=folder+"\\"+fd.cFileName; FindClose(h); return true; }
+std::vector<std::string> names;
+plat::listFiles(folder, names);
+for(size_t k=0;k<names.size();++k)
+if(plat::hasExt(names[k],".d8t")){ out=plat::join(folder,names[k]); return true; }
 return false;
 }
 
 bool D8WBank::load(const std::string& wPath,
                    const std::vector<BYTE>& sharedTbuf)
 {
+    D8W_TRACE_SCOPE("D8WBank::load");
+    StatusScope st("load");
+
     /* keep the shared big-bank buffer -------------------------- */
     tBuf_  = const_cast< std::vector<BYTE>* >(&sharedTbuf);
     pathW_ = wPath;
@@ -407,11 +525,11 @@ bool D8WBank::load(const std::string& wPath,
     locateD8T(folder, stem, "", pathT_);         /* fills pathT_ (best effort) */
 
     /* load whole *.d8w into RAM -------------------------------- */
-    if(!fileToMem(wPath, wBuf_)) return false;
+    if(!fileToMem(wPath, wBuf_)) return SETERR("cannot read %s", wPath.c_str()), false;
 
     const BYTE* p   = &wBuf_[0];
     const BYTE* end = p + wBuf_.size();
-    if(end-p < 12) return false;
+    if(end-p < 12) return SETERR("truncated .d8w header"), false;
 
     const uint32_t totalTex = rd<uint32_t>(p);   /* not used – sanity only   */
     const uint32_t tblCnt   = rd<uint32_t>(p);
@@ -425,7 +543,7 @@ bool D8WBank::load(const std::string& wPath,
 
     for(pi = 0; pi < texBuf_.size(); ++pi)
     {
-        if(end-p < 12) return false;
+        if(end-p < 12) return SETERR("truncated table %u", (uint32_t)pi), false;
 
         TextureTable& tbl = texBuf_[pi];
 
@@ -433,10 +551,9 @@ bool D8WBank::load(const std::string& wPath,
         tbl.size = rd<uint32_t>(p);
         const uint32_t n = rd<uint32_t>(p);
 
-        if(end-p < n * sizeof(TextureHdr)) return false;
+        if(end-p < n * sizeof(TextureHdr)) return SETERR("truncated table %u", (uint32_t)pi), false;
 
         tbl.tex .resize(n);
-        tbl.refs.resize(n);
 
         cursor += tbl.skip;            /* table starts after previous gap  */
         tbl.absOff = cursor;
@@ -453,22 +570,14 @@ bool D8WBank::load(const std::string& wPath,
             tbl.tex[ti].fileOff  = off;
             tbl.tex[ti].modified = false;
 
-            /* build quick-reference for later splices -- */
-            Reference& R = tbl.refs[ti];
-            R.hdr        = &tbl.tex[ti];
-            R.ownerBank  = this;
-            R.pSetSize   = &tbl.size;         /* <── 2nd int  in table header */
-            R.pFileTotal = (uint32_t*)&wBuf_[8]; /* <── 3rd int in global hdr */
-
-            addRef(off, &R);                  /* push into global index      */
-
             off += tbl.tex[ti].size;          /* next texture starts here    */
         }
         cursor = tbl.absOff + tbl.size;       /* next table’s base offset    */
     }
+    wireRefs();                               /* quick-references for splices */
 
     /* ────────────────── texture-set section ────────────────── */
-    if(end-p < 4) return false;
+    if(end-p < 4) return SETERR("missing texture-set section"), false;
     const uint32_t setCnt = rd<uint32_t>(p);
     texSet_.resize(setCnt);
 
@@ -477,7 +586,7 @@ bool D8WBank::load(const std::string& wPath,
         const BYTE* const setsBeg = p;        /* remember for stride detect  */
 
         /* detect stride (= columns per set) ------------------- */
-        if(end-p < 32) return false;          /* need at least one name      */
+        if(end-p < 32) return SETERR("truncated texture-set section"), false;
         const uint32_t firstName = rd<uint32_t>(p);
         p += 28;                              /* skip rest of 32-byte name   */
 
@@ -491,7 +600,7 @@ bool D8WBank::load(const std::string& wPath,
                 break;
             }
         }
-        if(stride == 0 && setCnt > 1) return false;
+        if(stride == 0 && setCnt > 1) return SETERR("texture-set stride not found"), false;
 
         /* rewind & really parse -------------------------------- */
         p = setsBeg;
@@ -536,8 +645,8 @@ bool D8WBank::load(const std::string& wPath,
     tailRaw_.assign(p, end);
 
     /* ─────────── register in globals & rebuild index ────────── */
-    gBanks.push_back(this);
-    rebuildIndex();
+    ctx_->attach(this);
+    ctx_->rebuildIndex();
 
     dirty_       = false;
     headerFixed  = false;
@@ -545,6 +654,56 @@ bool D8WBank::load(const std::string& wPath,
 }
 
 
+/* one Reference per texture: header, owner, the two sizes a splice patches */
+void D8WBank::wireRefs()
+{
+    for (size_t pi = 0; pi < texBuf_.size(); ++pi)
+    {
+        TextureTable& tbl = texBuf_[pi];
+        tbl.refs.resize(tbl.tex.size());
+        for (size_t ti = 0; ti < tbl.tex.size(); ++ti)
+        {
+            Reference& R = tbl.refs[ti];
+            R.hdr        = &tbl.tex[ti];
+            R.ownerBank  = this;
+            R.pSetSize   = &tbl.size;            /* <── 2nd int  in table header */
+            R.pFileTotal = (uint32_t*)&wBuf_[8]; /* <── 3rd int in global hdr    */
+        }
+    }
+}
+
+bool D8WBank::adopt(const std::string& wPath, const std::vector<BYTE>& sharedTbuf,
+                    BankImage& img, bool reindex)
+{
+    D8W_TRACE_SCOPE("D8WBank::adopt");
+    tBuf_  = const_cast< std::vector<BYTE>* >(&sharedTbuf);
+    pathW_ = wPath;
+
+    size_t slash = wPath.find_last_of("\\/"); if(slash==std::string::npos) slash = 0;
+    size_t dot   = wPath.find_last_of('.');   if(dot  ==std::string::npos) dot   = wPath.size();
+    locateD8T(wPath.substr(0, slash), wPath.substr(slash ? slash+1 : 0, dot-slash-1), "", pathT_);
+
+    /* only the 12-byte header is kept: pFileTotal points into it,
+       save() rebuilds the rest from tables / sets / tail            */
+    wBuf_.resize(12);
+    std::memcpy(&wBuf_[0], img.header, 12);
+
+    texBuf_.swap(img.tables);
+    texSet_.swap(img.sets);
+    tailRaw_.swap(img.tail);
+    for (size_t pi = 0; pi < texBuf_.size(); ++pi)
+        for (size_t ti = 0; ti < texBuf_[pi].tex.size(); ++ti)
+            texBuf_[pi].tex[ti].modified = false;
+    wireRefs();
+
+    ctx_->attach(this);
+    if (reindex) ctx_->rebuildIndex();
+
+    dirty_       = false;
+    headerFixed  = false;
+    return true;
+}
+
 /*******************************************************************************
 *  D8WBank::save  –  write one playlist (*.d8w) and, once, the big bank (*.d8t)
 *******************************************************************************/
@@ -562,26 +721,16 @@ static inline void le32push(std::vector<BYTE>& v, uint32_t x)
 static bool dumpWhole(const std::string& path,
                       const std::vector<BYTE>& data)
 {
-    HANDLE h = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr,
-                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
-    if (h == INVALID_HANDLE_VALUE) return false;
-
-    DWORD done = 0;
-    const BOOL ok = WriteFile(h, data.data(),
-                              static_cast<DWORD>(data.size()),
-                              &done, nullptr);
-    CloseHandle(h);
-    return ok && done == data.size();
+    D8W_TRACE_SCOPE("dumpWhole");
+    if (!plat::writeFile(path, data.data(), data.size())) return false;
+    trace::count(trace::kBytesWritten, data.size());
+    return true;
 }
 
-/* ───────────────────────────  D8WBank::save  ────────────────────────── */
-bool D8WBank::save(const std::string& outW, const std::string& outT)
+/* ─────────────────────────  D8WBank::serialize  ─────────────────────── */
+void D8WBank::serialize(std::vector<BYTE>& wOut) const
 {
-    /* nothing changed or no big-buffer pointer? */
-    if (!dirty_ || !tBuf_) return false;
-
-    /* ── 1. rebuild fresh *.d8w into wOut ─────────────────────────────── */
-    std::vector<BYTE> wOut;
+    wOut.clear();
     wOut.reserve(wBuf_.size());                /* upper bound */
 
     /* global header ---------------------------------------------------- */
@@ -613,34 +762,55 @@ bool D8WBank::save(const std::string& outW, const std::string& outT)
         cursor = tbl.absOff + tbl.size;
     }
 
+    /* texture sets – name[32] + stride × global index ----------------- */
+    le32push(wOut, (uint32_t)texSet_.size());
+    for (size_t s = 0; s < texSet_.size(); ++s)
+    {
+        BYTE name[32] = {0};
+        std::memcpy(name, texSet_[s].name.data(),
+                    std::min<size_t>(texSet_[s].name.size(), sizeof(name)));
+        wOut.insert(wOut.end(), name, name + sizeof(name));
+
+        for (size_t k = 0; k < texSet_[s].indexTable.size(); ++k)
+            le32push(wOut, (uint32_t)texSet_[s].indexTable[k]);
+    }
+
     /* unknown tail – copy verbatim ------------------------------------ */
     wOut.insert(wOut.end(), tailRaw_.begin(), tailRaw_.end());
+}
+
+/* ───────────────────────────  D8WBank::save  ────────────────────────── */
+bool D8WBank::save(const std::string& outW, const std::string& outT)
+{
+    /* nothing changed or no big-buffer pointer? */
+    if (!dirty_ || !tBuf_) return false;
+    D8W_TRACE_SCOPE("D8WBank::save");
+    StatusScope st("save");
+
+    /* ── 1. rebuild fresh *.d8w into wOut ─────────────────────────────── */
+    std::vector<BYTE> wOut;
+    serialize(wOut);
 
     /* ── 2. write to disk ────────────────────────────────────────────── */
     if (!dumpWhole(outW, wOut))                     /* *.d8w */
-        return false;
+        return SETERR("cannot write %s", outW.c_str()), false;
 
     if (!outT.empty() && !dumpWhole(outT, *tBuf_)) /* *.d8t, once */
-        return false;
+        return SETERR("cannot write %s", outT.c_str()), false;
 
     /* ── 3. keep our in-memory buffer in sync (avoid double deltas) ─── */
     wBuf_.assign(wOut.begin(), wOut.end());
-
-    /* ── 4. clear dirty / headerFixed for every bank sharing this big T ─*/
-    for (size_t b = 0; b < gBanks.size(); ++b)
-    {
-        if (gBanks[b]->tBuf_ != tBuf_) continue;
-
-        gBanks[b]->dirty_      = false;
-        gBanks[b]->headerFixed = false;
-
-        for (size_t p = 0; p < gBanks[b]->texBuf_.size(); ++p)
-            for (size_t k = 0; k < gBanks[b]->texBuf_[p].tex.size(); ++k)
-                gBanks[b]->texBuf_[p].tex[k].modified = false;
-
-        /* also copy fresh header into the partner banks’ wBuf_ */
-        gBanks[b]->wBuf_.assign(wOut.begin(), wOut.end());
-    }
+    for (size_t p = 0; p < texBuf_.size(); ++p)        /* wBuf_ may have moved */
+        for (size_t k = 0; k < texBuf_[p].refs.size(); ++k)
+            texBuf_[p].refs[k].pFileTotal = (uint32_t*)&wBuf_[8];
+
+    /* ── 4. this .d8w is clean; partner banks that share the big T ────
+            still carry shifted headers and save their own .d8w later   */
+    dirty_      = false;
+    headerFixed = false;
+    for (size_t p = 0; p < texBuf_.size(); ++p)
+        for (size_t k = 0; k < texBuf_[p].tex.size(); ++k)
+            texBuf_[p].tex[k].modified = false;
     return true;
 }
 
@@ -658,54 +828,151 @@ bool D8WBank::isTextureModified(size_t p,size_t i) const
 
 bool D8WBank::exportTexture(size_t p,size_t i,const std::string& path) const
 {
-if(!tBuf_||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return false;
+StatusScope st("export");
+if(!tBuf_||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
+const TextureHdrEx& h = texBuf_[p].tex[i];
+if(h.fileOff+h.size > tBuf_->size()) return SETERR("body past end of .d8t"), false;
+return exportTexture(p,i,path,&(*tBuf_)[h.fileOff]);
+}
+bool D8WBank::exportTexture(size_t p,size_t i,const std::string& path,const BYTE* body) const
+{
+StatusScope st("export");
+if(!body||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
+D8W_TRACE_SCOPE("exportTexture");
 const TextureHdrEx& h = texBuf_[p].tex[i];
-if(h.fileOff+h.size > tBuf_->size()) return false;
 
-HANDLE f=CreateFileA(path.c_str(),GENERIC_WRITE,0,NULL,
-CREATE_ALWAYS,FILE_ATTRIBUTE_NORMAL,NULL);
-if(f==INVALID_HANDLE_VALUE) return false;
-DWORD bw;
-WriteFile(f,((BYTE*)&h)+4,sizeof(TextureHdr)-4,&bw,NULL);
-WriteFile(f,&(*tBuf_)[h.fileOff],h.size,&bw,NULL);
-CloseHandle(f); return true;
+plat::File f;
+if(!f.open(path,plat::File::kWrite)) return SETERR("cannot write %s", path.c_str()), false;
+if(!f.write(((const BYTE*)&h)+4,sizeof(TextureHdr)-4) || !f.write(body,h.size))
+return SETERR("write failed: %s", path.c_str()), false;
+trace::count(trace::kBytesWritten, sizeof(TextureHdr)-4+h.size);
+return true;
 }
 bool D8WBank::exportTextureSet(size_t p,const std::string& dir) const
 {
-if(p>=texBuf_.size()) return false;
-if(!ensureDir(dir)) return false;
-char fn[260];
+StatusScope st("exportset");
+if(p>=texBuf_.size()) return SETERR("pack OOB"), false;
+if(!ensureDir(dir)) return SETERR("cannot create %s", dir.c_str()), false;
+char fn[32];
 size_t i; for(i=0;i<texBuf_[p].tex.size();++i){
-sprintf_s(fn,"%s\\Tex%d%04d.ddt",dir.c_str(),(int)p,(int)i);
-if(!exportTexture(p,i,fn)) return false;
+SNPRINTF(fn,sizeof(fn),"Tex%d%04d.ddt",(int)p,(int)i);
+if(!exportTexture(p,i,plat::join(dir,fn))) return false;
 }
 return true;
 }
 
-bool D8WBank::convertTexture(size_t p,size_t i,const std::string& out) const
+bool juiced::parseConvertFormat(const char* s, ConvertFormat& f)
+{
+static const char* const names[] = { "dds", "png", "tga" };
+for(int k=0;k<3;++k){
+size_t n=0; while(s[n] && names[k][n] && (s[n]|0x20)==names[k][n]) ++n;
+if(n==3 && !s[3]){ f=(ConvertFormat)k; return true; }
+}
+return false;
+}
+
+ConvertFormat juiced::convertFormatOf(const std::string& path)
+{
+const size_t dot = path.find_last_of('.');
+ConvertFormat f = kConvertDDS;
+if(dot!=std::string::npos && path.find_first_of("\\/",dot)==std::string::npos)
+parseConvertFormat(path.c_str()+dot+1,f);
+return f;
+}
+
+const char* juiced::convertExt(ConvertFormat f)
+{
+return f==kConvertPNG? "png" : f==kConvertTGA? "tga" : "dds";
+}
+
+bool D8WBank::convertTexture(size_t p,size_t i,const std::string& out,const ConvertOptions& o) const
 {
-if(!tBuf_||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return false;
+StatusScope st("convert");
+if(!tBuf_||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
 const TextureHdrEx& h = texBuf_[p].tex[i];
-if(h.fileOff+h.size > tBuf_->size()) return false;
+if(h.fileOff+h.size > tBuf_->size()) return SETERR("body past end of .d8t"), false;
+return convertTexture(p,i,out,&(*tBuf_)[h.fileOff],o);
+}
+bool D8WBank::convertTexture(size_t p,size_t i,const std::string& out,const BYTE* body,
+                             const ConvertOptions& o) const
+{
+StatusScope st("convert");
+if(!body||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
+D8W_TRACE_SCOPE("convertTexture");
+const TextureHdrEx& h = texBuf_[p].tex[i];
+const ConvertFormat fmt = convertFormatOf(out);
+
+if(fmt!=kConvertDDS)
+{
+std::vector<uint8_t> file;
+if(!convertTextureBytes(p,i,fmt,body,file,o)) return false;
+if(!plat::writeFile(out,file.data(),file.size())) return SETERR("write failed: %s", out.c_str()), false;
+trace::count(trace::kBytesWritten, file.size());
+return true;
+}
 
-HANDLE f=CreateFileA(out.c_str(),GENERIC_WRITE,0,NULL,
-CREATE_ALWAYS,FILE_ATTRIBUTE_NORMAL,NULL);
-if(f==INVALID_HANDLE_VALUE) return false;
-bool ok = writeDDSHeader(f,h);
-if(ok){
-DWORD bw;
-ok = WriteFile(f,&(*tBuf_)[h.fileOff],h.size,&bw,NULL) && bw==h.size;
+plat::File f;
+if(!f.open(out,plat::File::kWrite)) return SETERR("cannot write %s", out.c_str()), false;
+const bool ok = writeDDSHeader(f,h) && f.write(body,h.size);
+if(ok) trace::count(trace::kBytesWritten, 128+h.size);
+if(!ok) return SETERR("write failed: %s", out.c_str()), false;
+return true;
 }
-CloseHandle(f); return ok;
+bool D8WBank::exportTextureBytes(size_t p,size_t i,const BYTE* body,std::vector<BYTE>& out) const
+{
+if(!body||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
+const TextureHdrEx& h = texBuf_[p].tex[i];
+const BYTE* hb = ((const BYTE*)&h)+4;
+out.insert(out.end(),hb,hb+sizeof(TextureHdr)-4);
+out.insert(out.end(),body,body+h.size);
+return true;
 }
-bool D8WBank::convertTextureSet(size_t p,const std::string& dir) const
+bool D8WBank::convertTextureBytes(size_t p,size_t i,ConvertFormat fmt,const BYTE* body,
+                                  std::vector<BYTE>& out,const ConvertOptions& o) const
 {
-if(p>=texBuf_.size()) return false; ensureDir(dir);
-char fn[260]; size_t i;
-for(i=0;i<texBuf_[p].tex.size();++i){
-sprintf_s(fn,"%s\\Tex%d%04d.dds",dir.c_str(),(int)p,(int)i);
-if(!convertTexture(p,i,fn)) return false;
+if(!body||p>=texBuf_.size()||i>=texBuf_[p].tex.size()) return SETERR("texture OOB"), false;
+const TextureHdrEx& h = texBuf_[p].tex[i];
+
+if(fmt==kConvertDDS)
+{
+const size_t at = out.size();
+out.resize(at+128);
+makeDDSHeader(h,&out[at]);
+out.insert(out.end(),body,body+h.size);
+return true;
+}
+
+/* top mip only; one decode per texture – sets run one per core */
+if(!dxt::canDecode(h.type)) return SETERR("cannot decode %s to %s", bc::typeName(h.type), convertExt(fmt)), false;
+if(fmt==kConvertTGA && (h.width>0xFFFF||h.height>0xFFFF)) return SETERR("too large for TGA"), false;
+RawImage img;
+img.width=h.width; img.height=h.height;
+img.bgra.resize(size_t(h.width)*h.height*4);
+if(!dxt::decodeSurface(h.type,body,h.size,h.width,h.height,img.bgra.data(),1))
+return SETERR("body too short for %ux%u %s", h.width, h.height, bc::typeName(h.type)), false;
+
+if(fmt==kConvertPNG) encodePNG(img,out,o.level);
+else                 encodeTGA(img,out);
+return true;
 }
+bool D8WBank::convertTextureSet(size_t p,const std::string& dir,const ConvertOptions& o) const
+{
+StatusScope st("convertset");
+if(p>=texBuf_.size()) return SETERR("pack OOB"), false; ensureDir(dir);
+
+/* textures are independent: one per worker, first failure reported */
+const char* ext = convertExt((ConvertFormat)o.format);
+std::atomic<size_t> bad(SIZE_MAX);
+std::mutex m; std::string why;
+parallelFor(texBuf_[p].tex.size(),[&](size_t i){
+char fn[32];
+SNPRINTF(fn,sizeof(fn),"Tex%d%04d.%s",(int)p,(int)i,ext);
+if(convertTexture(p,i,plat::join(dir,fn),o)) return;
+std::lock_guard<std::mutex> g(m);
+if(i<bad){ bad=i; why=lastError(); }
+},o.threads);
+
+if(bad!=SIZE_MAX) return SETERR("Tex%d%04d: %s", (int)p, (int)bad.load(), why.c_str()), false;
 return true;
 }
 
@@ -726,17 +993,41 @@ static bool DDS2DDT(const BYTE* dds, size_t ddsSz, std::vector<BYTE>& out)
     const DDSHdr* h = reinterpret_cast<const DDSHdr*>(dds);
     if (h->size != 124 || h->pf.sz != 32 || h->w == 0 || h->h == 0) return false;
 
-    uint32_t fourCC = h->pf.fourCC;
-    uint32_t juType = (fourCC==0x31545844||fourCC==0x35545844)
-                    ? fourCC : 0x00000015;
+    uint32_t juType = (h->pf.flags & DDPF_FOURCC) ? h->pf.fourCC : 0x00000015;
     uint32_t body   = uint32_t(ddsSz - 128);
+    uint32_t mips   = h->mips ? h->mips : 1;
+
+    /* uncompressed but not already A8R8G8B8 (X8R8G8B8, R5G6B5, A8L8, …):
+       swizzle each level into the 0x15 layout                            */
+    pix::PixelLayout lay;
+    const bool swz = !(h->pf.flags & DDPF_FOURCC) &&
+        pix::fromDDS(h->pf.flags, h->pf.rgbBits, h->pf.r, h->pf.g, h->pf.b, h->pf.a, lay) &&
+        pix::classify(lay) != pix::kBGRA8888;
+    std::vector<BYTE> conv;
+    if (swz)
+    {
+        size_t in = 0;
+        for (uint32_t l = 0; l < mips; ++l)
+        {
+            const uint32_t mw = std::max(1u, h->w >> l), mh = std::max(1u, h->h >> l);
+            const size_t   n  = pix::levelSize(lay, mw, mh);
+            if (in + n > body) { mips = l; break; }          /* truncated chain */
+            const size_t at = conv.size();
+            conv.resize(at + size_t(mw) * mh * 4);
+            pix::toBGRA(lay, dds + 128 + in, n, mw, mh, &conv[at]);
+            in += n;
+        }
+        if (!mips) return false;
+        body = (uint32_t)conv.size();
+        DBGBOX("DDS2DDT  %s → ARGB8888, %u mips", pix::layoutName(lay), mips);
+    }
 
     TextureHdr hdr{};
     hdr.size   = body;
     hdr.type   = juType;
     hdr.width  = h->w;
     hdr.height = h->h;
-    hdr.mipCnt = h->mips ? h->mips : 1;
+    hdr.mipCnt = mips;
     hdr.unk07  = hdr.unk08 = hdr.unk09 = 2;
     hdr.unk10  = hdr.unk11 = 1;
     hdr.unk12  = -1.5f;
@@ -744,12 +1035,139 @@ static bool DDS2DDT(const BYTE* dds, size_t ddsSz, std::vector<BYTE>& out)
 
     out.resize(sizeof(hdr) + body);
     std::memcpy(out.data(), &hdr, sizeof(hdr));
-    std::memcpy(out.data() + sizeof(hdr), dds + 128, body);
+    std::memcpy(out.data() + sizeof(hdr), swz ? conv.data() : dds + 128, body);
 
     DBGBOX("DDS2DDT  ✔ ok  body=%u  type=0x%08X", body, juType);
     return true;
 }
 
+/* mip count an import into <slot> should end up with */
+static uint32_t slotMips(const TextureHdr& slot, uint32_t w, uint32_t h,
+                         const ImportOptions& opt)
+{
+    uint32_t m = std::min(slot.mipCnt ? slot.mipCnt : 1u, bc::fullMipCount(w, h));
+    if (opt.maxMips) m = std::min(m, opt.maxMips);
+    return m ? m : 1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Image2DDT – PNG / TGA → DDT, encoded to the slot's own format     */
+/*                                                                    */
+/*  ‣ keeps the slot's type and engine fields (unk07 … unk13)         */
+/*  ‣ mip chain length follows slot.mipCnt (clamped to the new size)  */
+/* ------------------------------------------------------------------ */
+static bool Image2DDT(const BYTE* src, size_t n, const std::string& name,
+                      const TextureHdr& slot, const ImportOptions& opt,
+                      std::vector<BYTE>& out)
+{
+    D8W_TRACE_SCOPE("Image2DDT");
+    RawImage    img;
+    std::string why;
+    if (!decodeImage(src, n, name, img, why))
+        return SETERR("image decode: %s", why.c_str()), false;
+
+    if (!bc::isEncodable(slot.type))
+        return SETERR("slot type 0x%08X has no encoder", slot.type), false;
+
+    const uint32_t mips = slotMips(slot, img.width, img.height, opt);
+
+    std::vector<BYTE> body;
+    if (!bc::encodeTexture(img, slot.type, mips, (bc::Quality)opt.quality, body,
+                           (MipFilter)opt.mipFilter))
+        return SETERR("encode failed (%ux%u)", img.width, img.height), false;
+
+    TextureHdr hdr = slot;
+    hdr.size   = (uint32_t)body.size();
+    hdr.width  = img.width;
+    hdr.height = img.height;
+    hdr.mipCnt = mips;
+
+    out.resize(sizeof(hdr) + body.size());
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    std::memcpy(out.data() + sizeof(hdr), body.data(), body.size());
+
+    DBGBOX("Image2DDT  ✔ %ux%u  mips=%u  type=0x%08X  body=%u",
+           img.width, img.height, mips, slot.type, hdr.size);
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/*  FitMipChain – make a DDS / DDT body carry the slot's mip count    */
+/*                                                                    */
+/*  ‣ surplus levels are cut off                                      */
+/*  ‣ missing levels are rebuilt from the last authored level:        */
+/*    decode → MipGen → encode, in the body's own format              */
+/*  ‣ unknown formats / short bodies are passed through untouched     */
+/* ------------------------------------------------------------------ */
+static bool FitMipChain(std::vector<BYTE>& ddt, const TextureHdr& slot,
+                        const ImportOptions& opt)
+{
+    D8W_TRACE_SCOPE("FitMipChain");
+    TextureHdr hdr;
+    std::memcpy(&hdr, ddt.data(), sizeof(hdr));
+    if (!bc::isEncodable(hdr.type) || !hdr.width || !hdr.height) return true;
+
+    const uint32_t have = std::min(hdr.mipCnt ? hdr.mipCnt : 1u,
+                                   bc::fullMipCount(hdr.width, hdr.height));
+    const uint32_t want = opt.fitMips
+                        ? slotMips(slot, hdr.width, hdr.height, opt)
+                        : slotMips(hdr,  hdr.width, hdr.height, opt);
+
+    size_t   chain = 0, lastOff = 0;
+    uint32_t l;
+    for (l = 0; l < have; ++l)
+    {
+        if (l == have - 1) lastOff = chain;
+        chain += bc::levelBytes(hdr.type, std::max(1u, hdr.width >> l),
+                                          std::max(1u, hdr.height >> l));
+    }
+    if (ddt.size() - sizeof(hdr) < chain)
+    {
+        DBGBOX("FitMipChain  body short (%u < %u) – kept as is",
+               (uint32_t)(ddt.size() - sizeof(hdr)), (uint32_t)chain);
+        return true;
+    }
+    if (want == have && hdr.mipCnt == have) return true;
+
+    if (want <= have)                                    /* trim */
+    {
+        size_t keep = 0;
+        for (l = 0; l < want; ++l)
+            keep += bc::levelBytes(hdr.type, std::max(1u, hdr.width >> l),
+                                             std::max(1u, hdr.height >> l));
+        ddt.resize(sizeof(hdr) + keep);
+    }
+    else                                                 /* extend */
+    {
+        ddt.resize(sizeof(hdr) + chain);
+
+        RawImage last;
+        last.width  = std::max(1u, hdr.width  >> (have - 1));
+        last.height = std::max(1u, hdr.height >> (have - 1));
+        last.bgra.resize(size_t(last.width) * last.height * 4);
+        if (!dxt::decodeSurface(hdr.type, ddt.data() + sizeof(hdr) + lastOff,
+                                chain - lastOff, last.width, last.height,
+                                last.bgra.data()))
+            return SETERR("mip decode failed (type 0x%08X)", hdr.type), false;
+
+        std::vector<RawImage> more;
+        buildMipChain(last, want - have + 1, (MipFilter)opt.mipFilter, more);
+        for (l = 0; l < more.size(); ++l)
+        {
+            const size_t at = ddt.size();
+            ddt.resize(at + bc::levelBytes(hdr.type, more[l].width, more[l].height));
+            bc::encodeSurface(more[l].bgra.data(), more[l].width, more[l].height,
+                              hdr.type, (bc::Quality)opt.quality, ddt.data() + at);
+        }
+    }
+
+    DBGBOX("FitMipChain  %ux%u  mips %u → %u", hdr.width, hdr.height, have, want);
+    hdr.mipCnt = want;
+    hdr.size   = uint32_t(ddt.size() - sizeof(hdr));
+    std::memcpy(ddt.data(), &hdr, sizeof(hdr));
+    return true;
+}
+
 /* ------------------------------------------------------------------ */
 /*  importTexture – replace ONE texture in the big bank (.d8t)        */
 /* ------------------------------------------------------------------ */
@@ -778,23 +1196,26 @@ static bool DDS2DDT(const BYTE* dds, size_t ddsSz, std::vector<BYTE>& out)
    =========================================================================
    • pack / idx : texture location inside *this* D8WBank
    • inPath     : .ddt  or  .dds  (DDS is auto-converted to DDT)
-   • Returns    : true  on success,  false on any failure (gLastErr set)
+                  .png  or  .tga  (encoded to the slot's format)
+   • opt        : this call's knobs – the bank's importOptions() when
+                  not given
+   • Returns    : true  on success,  false on any failure (Status set)
 *****************************************************************************/
 
-static bool isLiveBank(juiced::D8WBank* p)          /* helper */
+bool D8WBank::importTexture(size_t pack, size_t idx, const std::string& inPath)
 {
-    size_t i;
-    for (i = 0; i < gBanks.size(); ++i)
-        if (gBanks[i] == p) return true;
-    return false;
+    return importTexture(pack, idx, inPath, importOpt_);
 }
 
 bool D8WBank::importTexture(size_t pack,
                             size_t idx,
-                            const std::string& inPath)
+                            const std::string& inPath,
+                            const ImportOptions& opt)
 {
     DBGBOX("importTexture  pack=%zu  idx=%zu  «%s»",
            pack, idx, inPath.c_str());
+    D8W_TRACE_SCOPE("D8WBank::importTexture");
+    StatusScope st("import");
 
     /* ── 0. guards ─────────────────────────────────────────────── */
     if (!tBuf_)                              { SETERR("big-bank null");   return false; }
@@ -806,46 +1227,124 @@ bool D8WBank::importTexture(size_t pack,
     if (!fileToMem(inPath, src))
         return SETERR("file read fail"), false;
 
-    /* ── 2. DDS → DDT (if needed) ──────────────────────────────── */
+    /* ── 2. DDS / PNG / TGA → DDT (if needed) ──────────────────── */
     std::vector<BYTE> ddt;
     if (src.size() >= 128 && std::memcmp(src.data(), "DDS ", 4) == 0)
     {
         if (!DDS2DDT(src.data(), src.size(), ddt))
             return SETERR("DDS2DDT fail"), false;
     }
+    else if (isPNG(src.data(), src.size()) || isImageExt(inPath))
+    {
+        if (!Image2DDT(src.data(), src.size(), inPath,
+                       texBuf_[pack].tex[idx], opt, ddt))
+            return false;                                    /* Status set    */
+    }
     else
     {
-        if (src.size() < sizeof(TextureHdr))
+        if (src.size() < sizeof(TextureHdr) - 4)
             return SETERR("DDT too small"), false;
-        ddt.swap(src);                             /* already DDT */
+
+        /* already DDT – exportTexture writes the header without “size”;
+           a full header is taken as is when its size fits what follows */
+        uint32_t sz = 0;
+        std::memcpy(&sz, src.data(), 4);
+        if (src.size() >= sizeof(TextureHdr) && sz == src.size() - sizeof(TextureHdr))
+            ddt.swap(src);
+        else
+        {
+            sz = uint32_t(src.size() - (sizeof(TextureHdr) - 4));
+            ddt.resize(4);
+            std::memcpy(ddt.data(), &sz, 4);
+            ddt.insert(ddt.end(), src.begin(), src.end());
+        }
     }
 
+    /* ── 2b. mip chain → slot's count (PNG / TGA already match) ── */
+    if (!FitMipChain(ddt, texBuf_[pack].tex[idx], opt))
+        return false;                                        /* Status set    */
+
     /* ── 3. locate old body & sizes ────────────────────────────── */
     TextureHdrEx& old = texBuf_[pack].tex[idx];
     const uint32_t pos     = old.fileOff;
     const uint32_t oldBody = old.size;
     const uint32_t newBody = uint32_t(ddt.size() - sizeof(TextureHdr));
 
-    /* ── 4. splice big-bank buffer ─────────────────────────────── */
-    int32_t delta = 0;
-    if (!spliceReplace(*tBuf_, pos, oldBody,
-                       &ddt[sizeof(TextureHdr)], newBody, delta))
-        return false;                                        /* gLastErr set */
-
-    /* ── 5. craft fresh header ────────────────────────────────── */
-    TextureHdrEx fresh;
-    std::memset(&fresh, 0, sizeof(fresh));
-    std::memcpy(reinterpret_cast<BYTE*>(&fresh)+4,
+    /* ── 4. craft fresh header ────────────────────────────────── */
+    BodySplice sp;
+    std::memset(&sp, 0, sizeof(sp));
+    std::memcpy(reinterpret_cast<BYTE*>(&sp.hdr)+4,
                 &ddt[4], sizeof(TextureHdr) - 4);            /* skip “size” */
-    fresh.size     = newBody;
-    fresh.fileOff  = pos;
-    fresh.modified = true;
+    sp.hdr.size = newBody;
+    sp.pos      = pos;
+    sp.oldSize  = oldBody;
+    sp.newSize  = newBody;
+    sp.body     = &ddt[sizeof(TextureHdr)];
+
+    /* ── 5. splice big-bank buffer (observers see the old body) ── */
+    if ((uint64_t)pos + oldBody > tBuf_->size())
+        return SETERR("spliceReplace: out-of-bounds (pos=0x%08X old=%u file=%zu)",
+                      pos, oldBody, tBuf_->size()), false;
+    for (size_t o = 0; o < ctx_->observers_.size(); ++o)
+        ctx_->observers_[o]->beforeSplice(*this, sp, old, true);
+
+    int32_t delta = 0;
+    if (!spliceReplace(*tBuf_, pos, oldBody, sp.body, newBody, delta))
+        return false;                                        /* Status set    */
+
+    /* ── 6-8. shift every live bank, re-point refs at ‘pos’ ───── */
+    if (!applySplices(std::vector<BodySplice>(1, sp)))
+    {
+        /* Shouldn’t happen, but patch owner-bank to stay consistent */
+        TextureHdrEx& fresh = texBuf_[pack].tex[idx];
+        static_cast<TextureHdr&>(fresh) = sp.hdr;
+        fresh.fileOff  = pos;
+        fresh.modified = true;
+        DBGPOP("importTexture: no ref node – patched caller only");
+        return true;
+    }
+
+    DBGBOX("importTexture ✔ old=%u  new=%u  Δ=%d",
+           oldBody, newBody, delta);
+    return true;
+}
+
+
+/*****************************************************************************
+   D8WBank::applySplices  –  header side of one or more body replacements
+   =========================================================================
+   • s        : sorted by pos, non-overlapping, pos / sizes in the .d8t
+                as it was BEFORE any of them (the bytes are the caller's
+                job: spliceReplace, spliceBatch or a streamed copy)
+   • Every live bank on the same .d8t gets its tables and entries shifted
+     by the summed deltas in front of them, then every Reference at a
+     replaced body takes the new header.
+   • Returns  : false if some body had no Reference (others still patched)
+*****************************************************************************/
+bool D8WBank::applySplices(const std::vector<BodySplice>& s)
+{
+    D8W_TRACE_SCOPE("D8WBank::applySplices");
+    if (s.empty()) return true;
 
-    /* ── 6. shift tables & entries in *every* live bank ───────── */
+    /* before[j] = Σ delta of splices 0 … j-1 */
+    std::vector<uint32_t> at(s.size());
+    std::vector<int64_t>  before(s.size() + 1, 0);
+    for (size_t j = 0; j < s.size(); ++j)
+    {
+        at[j]         = s[j].pos;
+        before[j + 1] = before[j] + (int64_t)s[j].newSize - (int64_t)s[j].oldSize;
+    }
+    /* Σ delta of splices strictly in front of x */
+    auto shiftAt = [&](uint32_t x) -> int64_t
+    {
+        return before[std::lower_bound(at.begin(), at.end(), x) - at.begin()];
+    };
+
+    /* ── 1. shift tables & entries in *every* live bank ───────── */
     size_t b, t, k;
-    for (b = 0; b < gBanks.size(); ++b)
+    for (b = 0; b < ctx_->banks_.size(); ++b)
     {
-        D8WBank* bk = gBanks[b];
+        D8WBank* bk = ctx_->banks_[b];
         if (!bk || bk->tBuf_ != tBuf_) continue;             /* diff .d8t */
 
         std::vector<TextureTable>& tbls = bk->tables();
@@ -854,76 +1353,174 @@ bool D8WBank::importTexture(size_t pack,
         {
             TextureTable& tbl = tbls[t];
 
-            if (tbl.absOff > pos)                /* tables after splice */
-                tbl.absOff += delta;             /* (skip untouched)    */
-
-            if (pos >= tbl.absOff && pos < tbl.absOff + tbl.size)
-                tbl.size += delta;
+            const int64_t lo = shiftAt(tbl.absOff);          /* splices inside */
+            const int64_t hi = shiftAt(tbl.absOff + tbl.size); /* the table grow */
+            tbl.size   = uint32_t(tbl.size + (hi - lo));    /* or shrink it   */
+            tbl.absOff = uint32_t(tbl.absOff + lo);
 
             for (k = 0; k < tbl.tex.size(); ++k)
-                if (tbl.tex[k].fileOff > pos)
-                    tbl.tex[k].fileOff += delta;
+                tbl.tex[k].fileOff = uint32_t(tbl.tex[k].fileOff + shiftAt(tbl.tex[k].fileOff));
         }
         bk->dirty_      = true;
         bk->headerFixed = true;
     }
 
-    /* ── 7. rebuild ref-map so look-up is guaranteed ───────────── */
-    rebuildIndex();
-
-    /* ── 8. patch every Reference pointing at ‘pos’ ────────────── */
-    RefMap::iterator node = gRefIdx.find(pos);
-    if (node == gRefIdx.end())
-    {
-        /* Shouldn’t happen, but patch owner-bank to stay consistent */
-        texBuf_[pack].tex[idx] = fresh;
-        texBuf_[pack].size           += delta;
-        *(uint32_t*)&wBuf_[8]        += delta;    /* global total in this .d8w */
-        DBGPOP("importTexture: no ref node – patched caller only");
-        return true;
-    }
+    /* ── 2. rebuild ref-map so look-up is guaranteed ───────────── */
+    ctx_->rebuildIndex();
 
+    /* ── 3. patch every Reference pointing at each new body ────── */
+    bool allFound = true;
     size_t ok = 0, skip = 0;
-
-    std::vector<juiced::Reference*>& refs = node->second;
-    size_t r;
-    for (r = 0; r < refs.size(); ++r)
+    for (size_t j = 0; j < s.size(); ++j)
     {
-        juiced::Reference* ref = refs[r];
-        if (!ref || !ref->hdr || !ref->ownerBank) { ++skip; continue; }
-        if (!isLiveBank(ref->ownerBank))          { ++skip; continue; }
+        TextureHdrEx fresh;
+        std::memset(&fresh, 0, sizeof(fresh));
+        static_cast<TextureHdr&>(fresh) = s[j].hdr;
+        fresh.fileOff  = uint32_t(s[j].pos + before[j]);
+        fresh.modified = true;
 
-        /* —— make sure hdr really lives in one of ownerBank’s tables —— */
-        const std::vector<TextureTable>& tbls2 = ref->ownerBank->tables();
-        bool inRange = false;
-        for (t = 0; t < tbls2.size() && !inRange; ++t)
+        D8WContext::RefMap::iterator node = ctx_->refs_.find(fresh.fileOff);
+        if (node == ctx_->refs_.end()) { allFound = false; continue; }
+
+        std::vector<juiced::Reference*>& refs = node->second;
+        for (size_t r = 0; r < refs.size(); ++r)
         {
-            const std::vector<TextureHdrEx>& texV = tbls2[t].tex;
-            if (texV.empty()) continue;
-            const TextureHdrEx* base = &texV.front();
-            inRange = (ref->hdr >= base) &&
-                      (ref->hdr <  base + texV.size());
-        }
-        if (!inRange) { ++skip; continue; }
+            juiced::Reference* ref = refs[r];
+            if (!ref || !ref->hdr || !ref->ownerBank) { ++skip; continue; }
+            if (!ctx_->isLive(ref->ownerBank))        { ++skip; continue; }
+
+            /* —— make sure hdr really lives in one of ownerBank’s tables —— */
+            const std::vector<TextureTable>& tbls2 = ref->ownerBank->tables();
+            bool inRange = false;
+            for (t = 0; t < tbls2.size() && !inRange; ++t)
+            {
+                const std::vector<TextureHdrEx>& texV = tbls2[t].tex;
+                if (texV.empty()) continue;
+                const TextureHdrEx* base = &texV.front();
+                inRange = (ref->hdr >= base) &&
+                          (ref->hdr <  base + texV.size());
+            }
+            if (!inRange) { ++skip; continue; }
 
-        /* —— overwrite header & fix size fields ——————————————— */
-        *(ref->hdr) = fresh;
-        if (ref->pSetSize)   *(ref->pSetSize)   += delta;
-        if (ref->pFileTotal) *(ref->pFileTotal) += delta;
-        ++ok;
+            /* —— overwrite header (table sizes were shifted in step 1,
+                   the .d8w total is recomputed by save) ——————————— */
+            *(ref->hdr) = fresh;
+            ++ok;
+        }
     }
 
-    DBGBOX("importTexture ✔ old=%u  new=%u  Δ=%d  refs ok=%zu  skipped=%zu",
-           oldBody, newBody, delta, ok, skip);
+    DBGBOX("applySplices ✔ bodies=%zu  refs ok=%zu  skipped=%zu",
+           s.size(), ok, skip);
+    return allFound;
+}
+
+
+
+
+
+/*****************************************************************************
+   D8WBank::replaceBody  –  put sp.body (sp.hdr) where the body at sp.pos is
+   =========================================================================
+   • importTexture's steps 5-8 for a body the caller already has: the one
+     write path EditHistory's undo / redo take, so observers see it too
+   • modified : what the re-pointed headers' flag becomes – false when an
+                undo puts back the body the file still holds
+*****************************************************************************/
+bool D8WBank::replaceBody(const BodySplice& sp, bool modified)
+{
+    D8W_TRACE_SCOPE("D8WBank::replaceBody");
+    StatusScope st("replace");
+
+    if (!tBuf_) return setError("big-bank null");
+    if ((uint64_t)sp.pos + sp.oldSize > tBuf_->size())
+        return setError("body 0x%08X+%u past the end of the .d8t", sp.pos, sp.oldSize);
+
+    D8WContext::RefMap::iterator node = ctx_->refs_.find(sp.pos);
+    if (node == ctx_->refs_.end() || node->second.empty() || !node->second[0]->hdr)
+        return setError("no texture references the body at 0x%08X", sp.pos);
+    if (node->second[0]->hdr->size != sp.oldSize)
+        return setError("body at 0x%08X is %u bytes, not %u",
+                        sp.pos, node->second[0]->hdr->size, sp.oldSize);
+
+    const TextureHdrEx old = *node->second[0]->hdr;
+    for (size_t o = 0; o < ctx_->observers_.size(); ++o)
+        ctx_->observers_[o]->beforeSplice(*this, sp, old, modified);
+
+    int32_t delta = 0;
+    if (!spliceReplace(*tBuf_, sp.pos, sp.oldSize, sp.body, sp.newSize, delta))
+        return false;                                        /* Status set    */
+    if (!applySplices(std::vector<BodySplice>(1, sp)))
+        return setError("reference index lost the body at 0x%08X", sp.pos);
+
+    if (!modified)
+    {
+        node = ctx_->refs_.find(sp.pos);
+        for (size_t r = 0; node != ctx_->refs_.end() && r < node->second.size(); ++r)
+            if (node->second[r]->hdr) node->second[r]->hdr->modified = false;
+    }
     return true;
 }
 
 
+/* Tex<pack><slot> → slot; the pack has to be the one asked for */
+static bool importSlotOf(const std::string& name, size_t pack, size_t& slot)
+{
+    const size_t dot  = name.find_last_of('.');
+    const size_t stem = dot == std::string::npos ? name.size() : dot;
+    if (stem < 3 || plat::nicmp(name.c_str(), "tex", 3) != 0) return false;
 
+    const std::string digits = name.substr(3, stem - 3);
+    if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos)
+        return false;
 
+    char p[24];
+    SNPRINTF(p, sizeof(p), "%u", (unsigned)pack);
+    const size_t pl = std::strlen(p);
+    if (digits.size() < pl + 4 || digits.compare(0, pl, p) != 0) return false;
+    if (digits.size() > pl + 4 && digits[pl] == '0') return false;  /* %04d pads to 4 only */
+
+    slot = (size_t)std::strtoul(digits.c_str() + pl, 0, 10);
+    return true;
+}
+
+bool juiced::listImportFiles(const std::string& dir, size_t pack, std::vector<ImportFile>& files)
+{
+    std::vector<std::string> names;
+    files.clear();
+    if (!plat::listFiles(dir, names)) return SETERR("cannot list \"%s\"", dir.c_str()), false;
+    for (size_t k = 0; k < names.size(); ++k)
+    {
+        ImportFile f;
+        if (!(plat::hasExt(names[k], ".ddt") || plat::hasExt(names[k], ".dds") ||
+              plat::hasExt(names[k], ".png") || plat::hasExt(names[k], ".tga")) ||
+            !importSlotOf(names[k], pack, f.slot))
+            continue;
+        f.name = names[k];
+        files.push_back(f);
+    }
+
+    std::sort(files.begin(), files.end(),
+              [](const ImportFile& a, const ImportFile& b){
+                  return a.slot != b.slot ? a.slot < b.slot
+                                          : plat::icmp(a.name.c_str(), b.name.c_str()) < 0;
+              });
+    for (size_t k = 1; k < files.size(); ++k)
+        if (files[k].slot == files[k - 1].slot)
+            return SETERR("\"%s\" and \"%s\" are both slot %u – keep one",
+                          files[k - 1].name.c_str(), files[k].name.c_str(),
+                          (unsigned)files[k].slot), false;
+    return true;
+}
 
 bool D8WBank::importTextureSet(size_t pack, const std::string& dir)
 {
+    return importTextureSet(pack, dir, importOpt_);
+}
+
+bool D8WBank::importTextureSet(size_t pack, const std::string& dir,
+                               const ImportOptions& opt)
+{
+    StatusScope st("importset");
     DBGBOX("importTextureSet  pack=%u  dir=\"%s\"",
            (uint32_t)pack, dir.c_str());
 
@@ -934,54 +1531,35 @@ bool D8WBank::importTextureSet(size_t pack, const std::string& dir)
         return false;
     }
 
-    // 1) gather .ddt/.dds files
-    std::vector<std::string> files;
-    WIN32_FIND_DATAA fd;
-    HANDLE h = FindFirstFileA((dir + "\\*.dd?").c_str(), &fd);
-    if (h != INVALID_HANDLE_VALUE)
-    {
-        do {
-            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
-            const char* ext = strrchr(fd.cFileName, '.');
-            if (!ext) continue;
-            if (_stricmp(ext, ".ddt")==0 || _stricmp(ext, ".dds")==0)
-                files.push_back(fd.cFileName);
-        } while (FindNextFileA(h, &fd));
-        FindClose(h);
-    }
+    // 1) gather the Tex<pack>NNNN .ddt/.dds/.png/.tga files, each with its slot
+    std::vector<ImportFile> files;
+    if (!listImportFiles(dir, pack, files))
+        return false;                                        /* Status set */
 
     DBGBOX("importTextureSet  found %u candidate files",
            (uint32_t)files.size());
     if (files.empty())
     {
-        SETERR("No .ddt/.dds files in \"%s\"", dir.c_str());
+        SETERR("No Tex%u####.ddt/.dds/.png/.tga files in \"%s\"",
+               (uint32_t)pack, dir.c_str());
         return false;
     }
 
-    // 2) sort so Tex0000N lines up with index N
-    std::sort(files.begin(), files.end(),
-              [](const std::string& a, const std::string& b){
-                  return _stricmp(a.c_str(), b.c_str()) < 0;
-              });
-
-    size_t limit = std::min(files.size(), texBuf_[pack].tex.size());
+    size_t limit = 0;
     bool changed = false;
-    char full[MAX_PATH];
 
-    // 3) import one by one
-    for (size_t i = 0; i < limit; ++i)
+    // 2) import one by one, each into the slot its name gives
+    for (size_t k = 0; k < files.size(); ++k)
     {
-        if (_snprintf(full, sizeof(full), "%s\\%s",
-                      dir.c_str(), files[i].c_str()) < 0)
-            continue;
-
-        if (importTexture(pack, i, full))
+        if (files[k].slot >= texBuf_[pack].tex.size()) continue;
+        ++limit;
+        if (importTexture(pack, files[k].slot, plat::join(dir, files[k].name), opt))
             changed = true;
     }
 
     if (changed)
     {
-        rebuildIndex();  // re-sync the global ref map
+        ctx_->rebuildIndex();  // re-sync the context's ref map
         DBGBOX("importTextureSet ✔ replaced %u of %u textures",
                (uint32_t)limit, (uint32_t)files.size());
     }
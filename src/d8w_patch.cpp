@@ -0,0 +1,521 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_patch.cpp  –  .d8p delta patches: make, stream-apply
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_patch.h"
+#include "d8w_archive.h"
+#include "d8w_hash.h"
+#include "d8w_parallel.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "Zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+
+using namespace juiced;
+
+namespace
+{
+
+const char     kMagic[4] = { 'D', '8', 'W', 'P' };
+const uint32_t kVersion  = 1;
+const char*    kPart     = ".d8p-part";         /* temp suffix while applying */
+
+enum BodyFlags
+{
+    kKeepBody = 1,                  /* header-only change: copy the old body */
+    kStored   = 2                   /* payload is raw, deflate didn't pay    */
+};
+
+/* one replaced body as stored in the patch */
+struct PatchBody
+{
+    BodySplice           sp;
+    uint32_t             flags;
+    uint64_t             oldHash;
+    const BYTE*          payload;   /* into the patch buffer / packed below */
+    uint32_t             bytes;
+    std::vector<uint8_t> packed;    /* makePatch only */
+};
+
+struct PatchBank
+{
+    std::string name;
+    uint64_t    oldSize, oldHash, newSize, newHash;
+    const BYTE* embed;              /* deflated .d8w or NULL */
+    uint32_t    embedBytes;
+    std::vector<uint8_t> packed;    /* makePatch only */
+};
+
+struct Patch
+{
+    uint64_t oldSize, oldHash, newSize, newHash;
+    std::vector<PatchBank> banks;
+    std::vector<PatchBody> bodies;
+};
+
+/* ─── little-endian field writer / bounds-checked reader ───── */
+static void put32(std::vector<BYTE>& v, uint32_t x)
+{
+    for (int i = 0; i < 4; ++i) v.push_back(BYTE(x >> (8 * i)));
+}
+
+static void put64(std::vector<BYTE>& v, uint64_t x)
+{
+    for (int i = 0; i < 8; ++i) v.push_back(BYTE(x >> (8 * i)));
+}
+
+static void putBytes(std::vector<BYTE>& v, const void* p, size_t n)
+{
+    v.insert(v.end(), (const BYTE*)p, (const BYTE*)p + n);
+}
+
+struct Reader
+{
+    const BYTE* p;
+    const BYTE* end;
+    bool        ok;
+
+    Reader(const BYTE* b, size_t n) : p(b), end(b + n), ok(true) {}
+
+    const BYTE* take(size_t n)
+    {
+        if (!ok || (size_t)(end - p) < n) { ok = false; return 0; }
+        const BYTE* r = p; p += n; return r;
+    }
+    uint32_t u32()
+    {
+        const BYTE* b = take(4);
+        if (!b) return 0;
+        return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+    }
+    uint64_t u64() { const uint64_t lo = u32(); return lo | (uint64_t)u32() << 32; }
+};
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static std::string dirOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? std::string(".") : p.substr(0, s);
+}
+
+static void serializePatch(const Patch& pt, std::vector<BYTE>& out)
+{
+    putBytes(out, kMagic, 4);
+    put32(out, kVersion);
+    put64(out, pt.oldSize); put64(out, pt.oldHash);
+    put64(out, pt.newSize); put64(out, pt.newHash);
+    put32(out, (uint32_t)pt.banks.size());
+    put32(out, (uint32_t)pt.bodies.size());
+
+    for (size_t i = 0; i < pt.banks.size(); ++i)
+    {
+        const PatchBank& b = pt.banks[i];
+        put32(out, (uint32_t)b.name.size());
+        putBytes(out, b.name.data(), b.name.size());
+        put64(out, b.oldSize); put64(out, b.oldHash);
+        put64(out, b.newSize); put64(out, b.newHash);
+        put32(out, b.embedBytes);
+        putBytes(out, b.embed, b.embedBytes);
+    }
+    for (size_t j = 0; j < pt.bodies.size(); ++j)
+    {
+        const PatchBody& b = pt.bodies[j];
+        put32(out, b.sp.pos); put32(out, b.sp.oldSize); put32(out, b.sp.newSize);
+        put32(out, b.flags);
+        put64(out, b.oldHash);
+        putBytes(out, &b.sp.hdr, sizeof(TextureHdr));
+        put32(out, b.bytes);
+        putBytes(out, b.payload, b.bytes);
+    }
+}
+
+static bool parsePatch(const std::vector<BYTE>& buf, Patch& pt)
+{
+    Reader in(buf.data(), buf.size());
+    const BYTE* magic = in.take(4);
+    if (!magic || std::memcmp(magic, kMagic, 4) != 0) return setError("not a .d8p patch");
+    if (in.u32() != kVersion) return setError("unsupported .d8p version");
+
+    pt.oldSize = in.u64(); pt.oldHash = in.u64();
+    pt.newSize = in.u64(); pt.newHash = in.u64();
+    const uint32_t banks = in.u32(), bodies = in.u32();
+    if (!in.ok) return setError("truncated .d8p header");
+
+    pt.banks.resize(banks);
+    for (uint32_t i = 0; i < banks && in.ok; ++i)
+    {
+        PatchBank& b = pt.banks[i];
+        const uint32_t n = in.u32();
+        const BYTE* name = in.take(n);
+        if (name) b.name.assign((const char*)name, n);
+        b.oldSize = in.u64(); b.oldHash = in.u64();
+        b.newSize = in.u64(); b.newHash = in.u64();
+        b.embedBytes = in.u32();
+        b.embed      = b.embedBytes ? in.take(b.embedBytes) : 0;
+    }
+
+    pt.bodies.resize(bodies);
+    uint64_t cursor = 0;
+    for (uint32_t j = 0; j < bodies && in.ok; ++j)
+    {
+        PatchBody& b = pt.bodies[j];
+        std::memset(&b.sp, 0, sizeof(b.sp));
+        b.sp.pos     = in.u32();
+        b.sp.oldSize = in.u32();
+        b.sp.newSize = in.u32();
+        b.flags      = in.u32();
+        b.oldHash    = in.u64();
+        const BYTE* hdr = in.take(sizeof(TextureHdr));
+        if (hdr) std::memcpy(&b.sp.hdr, hdr, sizeof(TextureHdr));
+        b.bytes   = in.u32();
+        b.payload = in.take(b.bytes);
+
+        if (in.ok && (b.sp.pos < cursor || (uint64_t)b.sp.pos + b.sp.oldSize > pt.oldSize))
+            return setError("body %u out of order or past the .d8t", j);
+        if (in.ok && ((b.flags & kKeepBody) ? b.sp.newSize != b.sp.oldSize
+                                            : (b.flags & kStored) && b.bytes != b.sp.newSize))
+            return setError("body %u: payload doesn't match its size", j);
+        cursor = (uint64_t)b.sp.pos + b.sp.oldSize;
+    }
+    if (!in.ok) return setError("truncated .d8p");
+    return true;
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                            makePatch
+   ───────────────────────────────────────────────────────────── */
+bool juiced::makePatch(const std::string& origD8t, const std::string& modD8t,
+                       const std::string& outPatch, PatchStats* stats)
+{
+    D8W_TRACE_SCOPE("makePatch");
+    StatusScope st("mkpatch");
+
+    D8TFile ot, mt;
+    if (!ot.load(origD8t)) return setError("failed to load %s", origD8t.c_str());
+    if (!mt.load(modD8t))  return setError("failed to load %s", modD8t.c_str());
+    const std::vector<BYTE>& O = ot.buffer();
+    const std::vector<BYTE>& M = mt.buffer();
+
+    std::vector<std::string> op, mp;
+    findCompanionBanks(origD8t, op);
+    findCompanionBanks(modD8t,  mp);
+    if (op.empty()) return setError("no .d8w next to %s", origD8t.c_str());
+    if (op.size() != mp.size())
+        return setError("%s has %u banks, %s has %u", origD8t.c_str(), (uint32_t)op.size(),
+                        modD8t.c_str(), (uint32_t)mp.size());
+
+    D8WContext oc, mc;                                     /* outlive the banks */
+    std::vector< std::unique_ptr<D8WBank> > ob, mb;
+    for (size_t i = 0; i < op.size(); ++i)
+    {
+        ob.push_back(std::unique_ptr<D8WBank>(new D8WBank(oc)));
+        mb.push_back(std::unique_ptr<D8WBank>(new D8WBank(mc)));
+        if (!ob[i]->load(op[i], O)) return setError("failed to load %s (%s)", op[i].c_str(), lastError().c_str());
+        if (!mb[i]->load(mp[i], M)) return setError("failed to load %s (%s)", mp[i].c_str(), lastError().c_str());
+    }
+
+    /* ── 1. replaced bodies, keyed by original offset ──────────── */
+    std::map<uint32_t, BodySplice> edits;
+    std::set<uint32_t>             kept;
+    for (size_t i = 0; i < ob.size(); ++i)
+    {
+        const std::vector<TextureTable>& ta = ob[i]->tables();
+        const std::vector<TextureTable>& tb = mb[i]->tables();
+        if (ta.size() != tb.size())
+            return setError("%s: %u tables, modified has %u", op[i].c_str(),
+                            (uint32_t)ta.size(), (uint32_t)tb.size());
+
+        for (size_t p = 0; p < ta.size(); ++p)
+        {
+            if (ta[p].tex.size() != tb[p].tex.size())
+                return setError("%s pack %u: texture count differs", op[i].c_str(), (uint32_t)p);
+
+            for (size_t k = 0; k < ta[p].tex.size(); ++k)
+            {
+                const TextureHdrEx& a = ta[p].tex[k];
+                const TextureHdrEx& b = tb[p].tex[k];
+                if ((uint64_t)a.fileOff + a.size > O.size() || (uint64_t)b.fileOff + b.size > M.size())
+                    return setError("%s pack %u idx %u: body past end of .d8t",
+                                    op[i].c_str(), (uint32_t)p, (uint32_t)k);
+
+                const bool same = std::memcmp(&a, &b, sizeof(TextureHdr)) == 0 &&
+                                  std::memcmp(&O[0] + a.fileOff, &M[0] + b.fileOff, a.size) == 0;
+                if (same) { kept.insert(a.fileOff); continue; }
+
+                BodySplice sp;
+                std::memset(&sp, 0, sizeof(sp));
+                sp.pos     = a.fileOff;
+                sp.oldSize = a.size;
+                sp.newSize = b.size;
+                sp.hdr     = b;
+                sp.body    = &M[0] + b.fileOff;
+
+                std::map<uint32_t, BodySplice>::iterator it = edits.find(sp.pos);
+                if (it == edits.end()) { edits[sp.pos] = sp; continue; }
+                const BodySplice& e = it->second;
+                if (e.oldSize != sp.oldSize || e.newSize != sp.newSize ||
+                    std::memcmp(&e.hdr, &sp.hdr, sizeof(TextureHdr)) != 0 ||
+                    std::memcmp(e.body, sp.body, sp.newSize) != 0)
+                    return setError("%s pack %u idx %u: shared body at 0x%08X replaced two ways",
+                                    op[i].c_str(), (uint32_t)p, (uint32_t)k, sp.pos);
+            }
+        }
+    }
+
+    Patch pt;
+    std::vector<BodySplice> s;
+    for (std::map<uint32_t, BodySplice>::const_iterator it = edits.begin(); it != edits.end(); ++it)
+    {
+        if (kept.count(it->first))
+            return setError("shared body at 0x%08X replaced for only some of its textures", it->first);
+        if (!s.empty() && it->first < s.back().pos + s.back().oldSize)
+            return setError("bodies at 0x%08X and 0x%08X overlap", s.back().pos, it->first);
+        s.push_back(it->second);
+    }
+
+    /* ── 2. dry run: the splices must reproduce the modified files ── */
+    {
+        std::vector<BYTE> predicted;
+        if (!detail::spliceBatch(O, s, predicted)) return false;   /* Status set */
+        if (predicted != M)
+            return setError("%s differs from %s outside the replaced texture bodies",
+                            modD8t.c_str(), origD8t.c_str());
+    }
+    if (!s.empty() && !ob[0]->applySplices(s))
+        return setError("reference index lost a replaced body");
+
+    pt.oldSize = O.size(); pt.oldHash = StreamHash::of(O.data(), O.size());
+    pt.newSize = M.size(); pt.newHash = StreamHash::of(M.data(), M.size());
+
+    pt.banks.resize(ob.size());
+    for (size_t i = 0; i < ob.size(); ++i)
+    {
+        std::vector<BYTE> was, now, rebuilt;
+        if (!plat::readFile(op[i], was, uint64_t(1) << 31) ||
+            !plat::readFile(mp[i], now, uint64_t(1) << 31))
+            return setError("cannot read %s", op[i].c_str());
+
+        PatchBank& b = pt.banks[i];
+        b.name    = baseName(op[i]);
+        b.oldSize = was.size(); b.oldHash = hash64(was.data(), was.size());
+        b.newSize = now.size(); b.newHash = hash64(now.data(), now.size());
+        b.embed   = 0; b.embedBytes = 0;
+
+        ob[i]->serialize(rebuilt);
+        if (rebuilt != now)                        /* not ours to derive – ship it */
+        {
+            zlib::deflate(now.data(), now.size(), b.packed, 9);
+            b.embed      = b.packed.data();
+            b.embedBytes = (uint32_t)b.packed.size();
+        }
+    }
+
+    /* ── 3. bodies: deflate on every core, keep raw where it loses ── */
+    pt.bodies.resize(s.size());
+    parallelFor(s.size(), [&](size_t j)
+    {
+        PatchBody& b = pt.bodies[j];
+        b.sp      = s[j];
+        b.oldHash = hash64(&O[0] + b.sp.pos, b.sp.oldSize);
+        b.flags   = 0;
+        b.payload = 0;
+        b.bytes   = 0;
+
+        if (b.sp.newSize == b.sp.oldSize &&
+            std::memcmp(&O[0] + b.sp.pos, b.sp.body, b.sp.newSize) == 0)
+        {
+            b.flags = kKeepBody;
+            return;
+        }
+        zlib::deflate(b.sp.body, b.sp.newSize, b.packed);
+        if (b.packed.size() >= b.sp.newSize)
+        {
+            std::vector<uint8_t>().swap(b.packed);
+            b.flags   = kStored;
+            b.payload = b.sp.body;
+            b.bytes   = b.sp.newSize;
+        }
+        else
+        {
+            b.payload = b.packed.data();
+            b.bytes   = (uint32_t)b.packed.size();
+        }
+    });
+
+    std::vector<BYTE> out;
+    serializePatch(pt, out);
+    if (!plat::writeFile(outPatch, out.data(), out.size()))
+        return setError("cannot write %s", outPatch.c_str());
+    trace::count(trace::kBytesWritten, out.size());
+
+    if (stats)
+    {
+        *stats = PatchStats();
+        stats->banks      = pt.banks.size();
+        stats->bodies     = pt.bodies.size();
+        stats->patchBytes = out.size();
+        for (size_t j = 0; j < s.size(); ++j) stats->bodyBytes += s[j].newSize;
+    }
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                            applyPatch
+   ───────────────────────────────────────────────────────────── */
+bool juiced::applyPatch(const std::string& patchPath, const std::string& d8tPath,
+                        const std::string& outDir, PatchStats* stats)
+{
+    D8W_TRACE_SCOPE("applyPatch");
+    StatusScope st("applypatch");
+
+    std::vector<BYTE> buf;
+    if (!plat::readFile(patchPath, buf, uint64_t(1) << 31))
+        return setError("cannot read %s", patchPath.c_str());
+    Patch pt;
+    if (!parsePatch(buf, pt)) return false;                /* Status set */
+
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi)) return setError("cannot stat %s", d8tPath.c_str());
+    if (fi.size != pt.oldSize)
+        return setError("%s is %llu bytes, the patch expects %llu",
+                        d8tPath.c_str(), (unsigned long long)fi.size,
+                        (unsigned long long)pt.oldSize);
+    if (!outDir.empty() && !plat::makeDir(outDir))
+        return setError("cannot create %s", outDir.c_str());
+
+    const std::string dir  = dirOf(d8tPath);
+    const std::string dest = outDir.empty() ? dir : outDir;
+    PartFiles parts(kPart);
+
+    /* ── 1. banks: check, shift headers, rebuild every .d8w ──────── */
+    std::vector<BodySplice> s(pt.bodies.size());
+    for (size_t j = 0; j < s.size(); ++j) s[j] = pt.bodies[j].sp;
+
+    const std::vector<BYTE> none;                          /* headers only */
+    D8WContext ctx;
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    for (size_t i = 0; i < pt.banks.size(); ++i)
+    {
+        const PatchBank& b = pt.banks[i];
+        const std::string path = plat::join(dir, b.name);
+        std::vector<BYTE> raw;
+        if (!plat::readFile(path, raw, uint64_t(1) << 31))
+            return setError("cannot read %s", path.c_str());
+        if (raw.size() != b.oldSize || hash64(raw.data(), raw.size()) != b.oldHash)
+            return setError("%s is not the version this patch was made from", path.c_str());
+
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks.back()->load(path, none))
+            return setError("failed to load %s (%s)", path.c_str(), lastError().c_str());
+    }
+    if (!s.empty() && !banks.empty() && !banks[0]->applySplices(s))
+        return setError("patch replaces a body no bank references");
+
+    for (size_t i = 0; i < pt.banks.size(); ++i)
+    {
+        const PatchBank& b = pt.banks[i];
+        std::vector<BYTE> w;
+        if (b.embed)
+        {
+            if (!zlib::inflate(b.embed, b.embedBytes, w, (size_t)b.newSize))
+                return setError("%s: damaged .d8w in patch", b.name.c_str());
+        }
+        else banks[i]->serialize(w);
+
+        if (w.size() != b.newSize || hash64(w.data(), w.size()) != b.newHash)
+            return setError("%s: rebuilt .d8w doesn't match the patch", b.name.c_str());
+        const std::string part = parts.add(plat::join(dest, b.name));
+        if (!plat::writeFile(part, w.data(), w.size()))
+            return setError("cannot write %s", part.c_str());
+        trace::count(trace::kBytesWritten, w.size());
+    }
+
+    /* ── 2. one front-to-back pass over the .d8t ─────────────────── */
+    {
+        D8W_TRACE_SCOPE("applyPatch::stream");
+        plat::File in, out;
+        const std::string part = parts.add(plat::join(dest, baseName(d8tPath)));
+        if (!in.open(d8tPath, plat::File::kRead)) return setError("cannot open %s", d8tPath.c_str());
+        if (!out.open(part, plat::File::kWrite))   return setError("cannot write %s", part.c_str());
+
+        StreamHash ih, oh;
+        std::vector<BYTE> chunk(size_t(1) << 20), old, body;
+        auto emit = [&](const BYTE* p, size_t n) -> bool
+        {
+            oh.add(p, n);
+            trace::count(trace::kBytesWritten, n);
+            return out.write(p, n);
+        };
+        auto copy = [&](uint64_t n) -> bool
+        {
+            while (n)
+            {
+                const size_t k = (size_t)std::min<uint64_t>(n, chunk.size());
+                if (!in.read(chunk.data(), k)) return false;
+                ih.add(chunk.data(), k);
+                trace::count(trace::kBytesRead, k);
+                if (!emit(chunk.data(), k)) return false;
+                n -= k;
+            }
+            return true;
+        };
+
+        uint64_t cursor = 0;
+        for (size_t j = 0; j < pt.bodies.size(); ++j)
+        {
+            const PatchBody& b = pt.bodies[j];
+            if (!copy(b.sp.pos - cursor)) return setError("I/O error on %s", d8tPath.c_str());
+
+            old.resize(b.sp.oldSize);
+            if (!in.read(old.data(), old.size())) return setError("I/O error on %s", d8tPath.c_str());
+            ih.add(old.data(), old.size());
+            trace::count(trace::kBytesRead, old.size());
+            if (hash64(old.data(), old.size()) != b.oldHash)
+                return setError("body at 0x%08X differs from the patch's original", b.sp.pos);
+
+            const BYTE* nb = b.payload;
+            if (b.flags & kKeepBody) nb = old.data();
+            else if (!(b.flags & kStored))
+            {
+                body.clear();
+                if (!zlib::inflate(b.payload, b.bytes, body, b.sp.newSize) ||
+                    body.size() != b.sp.newSize)
+                    return setError("body at 0x%08X: damaged payload", b.sp.pos);
+                nb = body.data();
+            }
+            if (!emit(nb, b.sp.newSize)) return setError("cannot write %s", part.c_str());
+            cursor = (uint64_t)b.sp.pos + b.sp.oldSize;
+        }
+        if (!copy(pt.oldSize - cursor)) return setError("I/O error on %s", d8tPath.c_str());
+
+        if (ih.value() != pt.oldHash)
+            return setError("%s is not the version this patch was made from", d8tPath.c_str());
+        if (oh.total() != pt.newSize || oh.value() != pt.newHash)
+            return setError("patched .d8t doesn't match the patch");
+    }
+
+    /* ── 3. every hash matched – move the results into place ─────── */
+    if (!parts.commit()) return false;                    /* Status set */
+
+    if (stats)
+    {
+        *stats = PatchStats();
+        stats->banks      = pt.banks.size();
+        stats->bodies     = pt.bodies.size();
+        stats->patchBytes = buf.size();
+        for (size_t j = 0; j < s.size(); ++j) stats->bodyBytes += s[j].newSize;
+    }
+    return true;
+}
@@ -0,0 +1,515 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_platform.cpp  –  Win32 and POSIX back ends of d8w_platform.h
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_platform.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <dirent.h>
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <time.h>
+#   ifdef __linux__
+#       include <poll.h>
+#       include <sys/inotify.h>
+#   endif
+#endif
+
+using namespace juiced;
+
+namespace
+{
+
+const size_t kChunk = size_t(1) << 30;     /* per syscall, well below 2 GB */
+
+#ifdef _WIN32
+inline HANDLE toHandle(intptr_t h) { return (HANDLE)h; }
+#else
+/* '\\' → '/' so Windows-style paths from manifests still resolve */
+static std::string native(const std::string& p)
+{
+    std::string s = p;
+    std::replace(s.begin(), s.end(), '\\', '/');
+    return s;
+}
+#endif
+
+inline int lower(int c) { return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                              File
+   ───────────────────────────────────────────────────────────── */
+plat::File::File() : h_(-1) {}
+plat::File::~File() { close(); }
+
+bool plat::File::isOpen() const { return h_ != -1; }
+
+#ifdef _WIN32
+
+bool plat::File::open(const std::string& path, Mode m)
+{
+    close();
+    HANDLE h;
+    if (m == kWrite)
+        h = CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, NULL);
+    else if (m == kAppend)
+        h = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, NULL);
+    else
+        h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                        NULL, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    h_ = (intptr_t)h;
+    return true;
+}
+
+bool plat::File::openStdout()
+{
+    close();
+    std::fflush(stdout);                                /* earlier text stays ahead */
+    HANDLE h;
+    if (!DuplicateHandle(GetCurrentProcess(), GetStdHandle(STD_OUTPUT_HANDLE),
+                         GetCurrentProcess(), &h, 0, FALSE, DUPLICATE_SAME_ACCESS))
+        return false;
+    h_ = (intptr_t)h;
+    return true;
+}
+
+void plat::File::close()
+{
+    if (h_ != -1) CloseHandle(toHandle(h_));
+    h_ = -1;
+}
+
+uint64_t plat::File::size() const
+{
+    LARGE_INTEGER li;
+    return isOpen() && GetFileSizeEx(toHandle(h_), &li) ? (uint64_t)li.QuadPart : 0;
+}
+
+bool plat::File::read(void* dst, size_t n)
+{
+    BYTE* p = (BYTE*)dst;
+    while (n)
+    {
+        DWORD got = 0;
+        if (!ReadFile(toHandle(h_), p, (DWORD)std::min(n, kChunk), &got, NULL) || got == 0)
+            return false;
+        p += got; n -= got;
+    }
+    return true;
+}
+
+bool plat::File::readAt(uint64_t off, void* dst, size_t n) const
+{
+    BYTE* p = (BYTE*)dst;
+    while (n)
+    {
+        OVERLAPPED ov;
+        std::memset(&ov, 0, sizeof(ov));
+        ov.Offset     = (DWORD)off;
+        ov.OffsetHigh = (DWORD)(off >> 32);
+        DWORD got = 0;
+        if (!ReadFile(toHandle(h_), p, (DWORD)std::min(n, kChunk), &got, &ov) || got == 0)
+            return false;
+        off += got; p += got; n -= got;
+    }
+    return true;
+}
+
+bool plat::File::write(const void* src, size_t n)
+{
+    const BYTE* p = (const BYTE*)src;
+    while (n)
+    {
+        DWORD put = 0;
+        if (!WriteFile(toHandle(h_), p, (DWORD)std::min(n, kChunk), &put, NULL) || put == 0)
+            return false;
+        p += put; n -= put;
+    }
+    return true;
+}
+
+bool plat::File::sync()
+{
+    return isOpen() && FlushFileBuffers(toHandle(h_)) != 0;
+}
+
+void plat::File::willNeed(uint64_t, uint64_t) const {}     /* FILE_FLAG_SEQUENTIAL_SCAN covers it */
+
+#else /* POSIX */
+
+bool plat::File::open(const std::string& path, Mode m)
+{
+    close();
+    int fd;
+    const int flags = m == kWrite  ? O_WRONLY | O_CREAT | O_TRUNC
+                    : m == kAppend ? O_WRONLY | O_CREAT | O_APPEND
+                    :                O_RDONLY;
+    do fd = ::open(native(path).c_str(), flags, 0644);
+    while (fd < 0 && errno == EINTR);
+    if (fd < 0) return false;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if (m == kRead) ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    h_ = fd;
+    return true;
+}
+
+bool plat::File::openStdout()
+{
+    close();
+    std::fflush(stdout);                                /* earlier text stays ahead */
+    const int fd = ::dup(1);
+    if (fd < 0) return false;
+    h_ = fd;
+    return true;
+}
+
+void plat::File::close()
+{
+    if (h_ != -1) ::close((int)h_);
+    h_ = -1;
+}
+
+uint64_t plat::File::size() const
+{
+    struct stat st;
+    return isOpen() && ::fstat((int)h_, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+bool plat::File::read(void* dst, size_t n)
+{
+    BYTE* p = (BYTE*)dst;
+    while (n)
+    {
+        const ssize_t got = ::read((int)h_, p, std::min(n, kChunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        p += got; n -= (size_t)got;
+    }
+    return true;
+}
+
+bool plat::File::readAt(uint64_t off, void* dst, size_t n) const
+{
+    BYTE* p = (BYTE*)dst;
+    while (n)
+    {
+        const ssize_t got = ::pread((int)h_, p, std::min(n, kChunk), (off_t)off);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        off += (uint64_t)got; p += got; n -= (size_t)got;
+    }
+    return true;
+}
+
+bool plat::File::write(const void* src, size_t n)
+{
+    const BYTE* p = (const BYTE*)src;
+    while (n)
+    {
+        const ssize_t put = ::write((int)h_, p, std::min(n, kChunk));
+        if (put < 0 && errno == EINTR) continue;
+        if (put <= 0) return false;
+        p += put; n -= (size_t)put;
+    }
+    return true;
+}
+
+bool plat::File::sync()
+{
+    int r;
+    do r = isOpen() ? ::fsync((int)h_) : -1;
+    while (r < 0 && errno == EINTR);
+    return r == 0;
+}
+
+void plat::File::willNeed(uint64_t off, uint64_t n) const
+{
+#if defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise((int)h_, (off_t)off, (off_t)n, POSIX_FADV_WILLNEED);
+#else
+    (void)off; (void)n;
+#endif
+}
+
+#endif
+
+/* ─────────────────────────────────────────────────────────────
+                         whole-file helpers
+   ───────────────────────────────────────────────────────────── */
+bool plat::readFile(const std::string& path, std::vector<BYTE>& dst, uint64_t maxBytes)
+{
+    dst.clear();
+    File f;
+    if (!f.open(path, File::kRead)) return false;
+
+    const uint64_t n = f.size();
+    if (n == 0 || n > maxBytes) return false;
+
+    dst.resize((size_t)n);
+    if (!f.read(dst.data(), dst.size())) { dst.clear(); return false; }
+    return true;
+}
+
+bool plat::writeFile(const std::string& path, const void* data, size_t n)
+{
+    File f;
+    return f.open(path, File::kWrite) && f.write(data, n);
+}
+
+/* ─────────────────────────────────────────────────────────────
+                       directories and names
+   ───────────────────────────────────────────────────────────── */
+#ifdef _WIN32
+
+bool plat::fileInfo(const std::string& path, FileInfo& out)
+{
+    WIN32_FILE_ATTRIBUTE_DATA a;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &a)) return false;
+    out.size  = ((uint64_t)a.nFileSizeHigh << 32) | a.nFileSizeLow;
+    out.mtime = (int64_t)(((uint64_t)a.ftLastWriteTime.dwHighDateTime << 32) |
+                          a.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+bool plat::exists(const std::string& path)
+{
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+bool plat::isDir(const std::string& path)
+{
+    const DWORD a = GetFileAttributesA(path.c_str());
+    return a != INVALID_FILE_ATTRIBUTES && (a & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+bool plat::makeDir(const std::string& path)
+{
+    return isDir(path) || CreateDirectoryA(path.c_str(), NULL) != 0;
+}
+
+bool plat::removeFile(const std::string& path)
+{
+    return DeleteFileA(path.c_str()) != 0;
+}
+
+bool plat::moveFile(const std::string& from, const std::string& to)
+{
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool plat::listFiles(const std::string& dir, std::vector<std::string>& names)
+{
+    names.clear();
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(join(dir, "*").c_str(), &fd);
+    if (h == INVALID_HANDLE_VALUE) return isDir(dir);
+    do {
+        if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) names.push_back(fd.cFileName);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+    return true;
+}
+
+void plat::debugBox(const char* caption, const char* text)
+{
+    MessageBoxA(NULL, text, caption, MB_OK | MB_ICONINFORMATION);
+}
+
+plat::DirWatch::DirWatch() : h_(-1) {}
+plat::DirWatch::~DirWatch() { close(); }
+
+bool plat::DirWatch::native() const { return h_ != -1; }
+
+bool plat::DirWatch::open(const std::string& dir)
+{
+    close();
+    HANDLE h = FindFirstChangeNotificationA(dir.c_str(), FALSE,
+                   FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                   FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    h_ = (intptr_t)h;
+    return true;
+}
+
+void plat::DirWatch::close()
+{
+    if (h_ != -1) FindCloseChangeNotification(toHandle(h_));
+    h_ = -1;
+}
+
+bool plat::DirWatch::wait(int timeoutMs)
+{
+    if (h_ == -1) { Sleep(timeoutMs < 0 ? 1000 : (DWORD)timeoutMs); return true; }
+    if (WaitForSingleObject(toHandle(h_), timeoutMs < 0 ? INFINITE : (DWORD)timeoutMs) != WAIT_OBJECT_0)
+        return false;
+    FindNextChangeNotification(toHandle(h_));               /* re-arm */
+    return true;
+}
+
+#else /* POSIX */
+
+bool plat::fileInfo(const std::string& path, FileInfo& out)
+{
+    struct stat st;
+    if (::stat(native(path).c_str(), &st) != 0) return false;
+    out.size = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+    out.mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    out.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool plat::exists(const std::string& path)
+{
+    struct stat st;
+    return ::stat(native(path).c_str(), &st) == 0;
+}
+
+bool plat::isDir(const std::string& path)
+{
+    struct stat st;
+    return ::stat(native(path).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool plat::makeDir(const std::string& path)
+{
+    return ::mkdir(native(path).c_str(), 0755) == 0 || (errno == EEXIST && isDir(path));
+}
+
+bool plat::removeFile(const std::string& path)
+{
+    return ::unlink(native(path).c_str()) == 0;
+}
+
+bool plat::moveFile(const std::string& from, const std::string& to)
+{
+    return ::rename(native(from).c_str(), native(to).c_str()) == 0;
+}
+
+bool plat::listFiles(const std::string& dir, std::vector<std::string>& names)
+{
+    names.clear();
+    const std::string d = native(dir);
+    DIR* h = ::opendir(d.c_str());
+    if (!h) return false;
+    while (dirent* e = ::readdir(h))
+    {
+        struct stat st;
+        if (::stat((d + "/" + e->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            names.push_back(e->d_name);
+    }
+    ::closedir(h);
+    return true;
+}
+
+void plat::debugBox(const char* caption, const char* text)
+{
+    std::fprintf(stderr, "[%s] %s\n", caption ? caption : "", text ? text : "");
+}
+
+plat::DirWatch::DirWatch() : h_(-1) {}
+plat::DirWatch::~DirWatch() { close(); }
+
+bool plat::DirWatch::native() const { return h_ != -1; }
+
+#ifdef __linux__
+
+bool plat::DirWatch::open(const std::string& dir)
+{
+    close();
+    const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    if (::inotify_add_watch(fd, ::native(dir).c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    h_ = fd;
+    return true;
+}
+
+void plat::DirWatch::close()
+{
+    if (h_ != -1) ::close((int)h_);
+    h_ = -1;
+}
+
+bool plat::DirWatch::wait(int timeoutMs)
+{
+    pollfd p = { (int)h_, POLLIN, 0 };
+    int r;
+    do r = ::poll(&p, 1, timeoutMs);
+    while (r < 0 && errno == EINTR);
+    if (r <= 0) return false;
+
+    char buf[4096];                                         /* drain, names unused */
+    while (::read((int)h_, buf, sizeof(buf)) > 0) {}
+    return true;
+}
+
+#else /* no native watch – poll */
+
+bool plat::DirWatch::open(const std::string& dir) { close(); return isDir(dir); }
+void plat::DirWatch::close() {}
+
+bool plat::DirWatch::wait(int timeoutMs)
+{
+    const int ms = timeoutMs < 0 ? 1000 : timeoutMs;
+    timespec t = { ms / 1000, (long)(ms % 1000) * 1000000 };
+    while (::nanosleep(&t, &t) != 0 && errno == EINTR) {}
+    return true;
+}
+
+#endif
+
+#endif
+
+std::string plat::join(const std::string& dir, const std::string& name)
+{
+    if (dir.empty()) return name;
+    const char last = dir[dir.size() - 1];
+    if (last == '/' || last == '\\') return dir + name;
+    return dir + kSep + name;
+}
+
+int plat::icmp(const char* a, const char* b)
+{
+    for (;; ++a, ++b)
+    {
+        const int d = lower((unsigned char)*a) - lower((unsigned char)*b);
+        if (d || !*a) return d;
+    }
+}
+
+int plat::nicmp(const char* a, const char* b, size_t n)
+{
+    for (; n; --n, ++a, ++b)
+    {
+        const int d = lower((unsigned char)*a) - lower((unsigned char)*b);
+        if (d || !*a) return d;
+    }
+    return 0;
+}
+
+bool plat::hasExt(const std::string& name, const char* ext)
+{
+    const size_t n = std::strlen(ext);
+    return name.size() >= n && icmp(name.c_str() + name.size() - n, ext) == 0;
+}
@@ -0,0 +1,389 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_repack.cpp  –  -repack: spans, coalescing, one write pass
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_repack.h"
+#include "d8w_archive.h"
+#include "d8w_io.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <queue>
+
+using namespace juiced;
+
+namespace
+{
+
+const char* kPart = ".repack-part";            /* temp suffix while in place */
+
+/* one table of one bank, as found in the .d8t */
+struct Table
+{
+    uint32_t bank, pack;
+    uint64_t off;
+    uint32_t size;
+    size_t   span;
+    uint64_t rel;                   /* offset inside its span */
+};
+
+/* tables whose extents overlap, moved as one */
+struct Span
+{
+    uint64_t off, size;
+};
+
+typedef std::map<std::string, uint64_t> Heat;  /* "<bank> <pack>" → hits */
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static std::string dirOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? std::string(".") : p.substr(0, s);
+}
+
+static std::string keyOf(const std::string& name, uint32_t pack)
+{
+    std::string k = name;
+    for (size_t i = 0; i < k.size(); ++i)
+        if (k[i] >= 'A' && k[i] <= 'Z') k[i] = char(k[i] + ('a' - 'A'));
+    char tail[16];
+    std::snprintf(tail, sizeof(tail), " %u", pack);
+    return k + tail;
+}
+
+static bool readHeat(const std::string& path, Heat& h)
+{
+    std::vector<BYTE> buf;
+    if (!plat::readFile(path, buf, uint64_t(1) << 30))
+        return setError("cannot read heat file %s", path.c_str());
+
+    const std::string text(buf.begin(), buf.end());
+    size_t line = 0, at = 0;
+    while (at < text.size())
+    {
+        size_t eol = text.find('\n', at);
+        if (eol == std::string::npos) eol = text.size();
+        std::string l = text.substr(at, eol - at);
+        at = eol + 1;
+        ++line;
+
+        if (!l.empty() && l[l.size() - 1] == '\r') l.erase(l.size() - 1);
+        const size_t first = l.find_first_not_of(" \t");
+        if (first == std::string::npos || l[first] == '#') continue;
+
+        char name[260];
+        unsigned pack;
+        unsigned long long hits;
+        if (std::sscanf(l.c_str(), "%259s %u %llu", name, &pack, &hits) != 3)
+            return setError("%s:%u: malformed heat line", path.c_str(), (unsigned)line);
+        h[keyOf(name, pack)] += hits;
+    }
+    return true;
+}
+
+/* span ids → class representative; no path compression, so a
+   tentative union is undone by resetting one parent             */
+static size_t rootOf(const std::vector<size_t>& parent, size_t s)
+{
+    while (parent[s] != s) s = parent[s];
+    return s;
+}
+
+/* Kahn over the classes: every bank's tables must keep their order
+   (skip is unsigned).  prio == 0 → any order (cycle test only).
+   false when some bank would have to run backwards               */
+static bool layout(const std::vector<size_t>& parent,
+                   const std::vector< std::pair<size_t, size_t> >& edges,
+                   const std::vector<uint64_t>* prio, std::vector<size_t>* out)
+{
+    const size_t n = parent.size();
+    std::vector< std::vector<size_t> > next(n);
+    std::vector<size_t> in(n, 0);
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+        const size_t u = rootOf(parent, edges[e].first);
+        const size_t v = rootOf(parent, edges[e].second);
+        if (u == v) return false;                          /* A … A' in one bank */
+        next[u].push_back(v);
+        ++in[v];
+    }
+
+    typedef std::pair<uint64_t, size_t> Item;              /* (prio, root) */
+    std::priority_queue< Item, std::vector<Item>, std::greater<Item> > ready;
+    size_t roots = 0, done = 0;
+    for (size_t s = 0; s < n; ++s)
+    {
+        if (parent[s] != s) continue;
+        ++roots;
+        if (!in[s]) ready.push(Item(prio ? (*prio)[s] : 0, s));
+    }
+    while (!ready.empty())
+    {
+        const size_t u = ready.top().second;
+        ready.pop();
+        ++done;
+        if (out) out->push_back(u);
+        for (size_t k = 0; k < next[u].size(); ++k)
+            if (!--in[next[u][k]])
+                ready.push(Item(prio ? (*prio)[next[u][k]] : 0, next[u][k]));
+    }
+    return done == roots;
+}
+
+} // anon
+
+bool juiced::parseRepackOrder(const char* s, RepackOrder& out)
+{
+    if (!s) return false;
+    if (!std::strcmp(s, "bank")) { out = kRepackByBank; return true; }
+    if (!std::strcmp(s, "pack")) { out = kRepackByPack; return true; }
+    if (!std::strcmp(s, "heat")) { out = kRepackByHeat; return true; }
+    return false;
+}
+
+bool juiced::repackArchive(const std::string& d8tPath, const RepackOptions& opt,
+                           const std::string& outDir, RepackStats* stats)
+{
+    D8W_TRACE_SCOPE("repackArchive");
+    StatusScope st("repack");
+
+    if (opt.align & (opt.align - 1))
+        return setError("alignment %u is not a power of two", opt.align);
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi)) return setError("cannot stat %s", d8tPath.c_str());
+    Heat heat;
+    if (!opt.heatPath.empty() && !readHeat(opt.heatPath, heat)) return false;
+
+    std::vector<std::string> paths;
+    findCompanionBanks(d8tPath, paths);
+    if (paths.empty()) return setError("no .d8w next to %s", d8tPath.c_str());
+
+    /* ── 1. banks (headers only) and their tables ──────────────── */
+    const std::vector<BYTE> none;
+    D8WContext ctx;                                        /* outlives banks */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector<Table> tbl;
+    for (size_t b = 0; b < paths.size(); ++b)
+    {
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks[b]->load(paths[b], none))
+            return setError("failed to load %s (%s)", paths[b].c_str(), lastError().c_str());
+
+        const std::vector<TextureTable>& t = banks[b]->tables();
+        for (size_t p = 0; p < t.size(); ++p)
+        {
+            if ((uint64_t)t[p].absOff + t[p].size > fi.size)
+                return setError("%s pack %u: table past end of %s",
+                                baseName(paths[b]).c_str(), (uint32_t)p, d8tPath.c_str());
+            Table x = { (uint32_t)b, (uint32_t)p, t[p].absOff, t[p].size, 0, 0 };
+            tbl.push_back(x);
+        }
+    }
+
+    /* ── 2. spans: overlapping (or identical) tables travel together ── */
+    std::vector<size_t> byOff(tbl.size());
+    for (size_t k = 0; k < byOff.size(); ++k) byOff[k] = k;
+    std::sort(byOff.begin(), byOff.end(), [&](size_t a, size_t b)
+    {
+        return tbl[a].off != tbl[b].off ? tbl[a].off < tbl[b].off : tbl[a].size > tbl[b].size;
+    });
+
+    std::vector<Span> span;
+    for (size_t k = 0; k < byOff.size(); ++k)
+    {
+        Table& t = tbl[byOff[k]];
+        if (span.empty() || t.off >= span.back().off + span.back().size)
+        {
+            Span s = { t.off, t.size };
+            span.push_back(s);
+        }
+        Span& s = span.back();
+        s.size  = std::max(s.size, t.off + t.size - s.off);
+        t.span  = span.size() - 1;
+        t.rel   = t.off - s.off;
+    }
+
+    /* chains: each bank's spans in table order must stay in order */
+    std::vector< std::pair<size_t, size_t> > edges;
+    for (size_t k = 1; k < tbl.size(); ++k)
+        if (tbl[k].bank == tbl[k - 1].bank && tbl[k].span != tbl[k - 1].span)
+            edges.push_back(std::make_pair(tbl[k - 1].span, tbl[k].span));
+
+    std::vector<size_t> parent(span.size());
+    for (size_t s = 0; s < parent.size(); ++s) parent[s] = s;
+    if (!layout(parent, edges, 0, 0))
+        return setError("%s: a bank's tables already run backwards", d8tPath.c_str());
+
+    /* ── 3. coalesce byte-identical spans ──────────────────────── */
+    size_t coalesced = 0;
+    if (opt.coalesce)
+    {
+        std::vector<FileExtent> ext(span.size());
+        for (size_t s = 0; s < span.size(); ++s)
+        {
+            if (span[s].size > 0xFFFFFFFFull)
+                return setError("span at %llu is over 4 GB", (unsigned long long)span[s].off);
+            ext[s] = FileExtent(span[s].off, (uint32_t)span[s].size);
+        }
+        std::vector<uint64_t> sums;
+        std::vector<char>     read;
+        std::string           why;
+        if (!hashExtents(d8tPath, ext, sums, read, opt.threads, 0, &why))
+            return setError("%s", why.c_str());
+
+        std::map< std::pair<uint64_t, uint64_t>, size_t > first;   /* (hash, size) → span */
+        for (size_t s = 0; s < span.size(); ++s)
+        {
+            if (!span[s].size) continue;
+            const std::pair<uint64_t, uint64_t> key(sums[s], span[s].size);
+            std::map< std::pair<uint64_t, uint64_t>, size_t >::iterator it = first.find(key);
+            if (it == first.end()) { first.insert(std::make_pair(key, s)); continue; }
+
+            parent[s] = it->second;                        /* tentative */
+            if (layout(parent, edges, 0, 0)) ++coalesced;
+            else parent[s] = s;
+        }
+    }
+
+    /* ── 4. order: bank / pack / heat, chains respected ────────── */
+    std::vector<uint64_t> prio(span.size(), ~uint64_t(0));
+    std::vector<uint64_t> hits(span.size(), 0);
+    for (size_t k = 0; k < tbl.size(); ++k)
+    {
+        const Table& t = tbl[k];
+        const size_t r = rootOf(parent, t.span);
+        const uint64_t byBank = (uint64_t)t.bank << 32 | t.pack;
+        const uint64_t byPack = (uint64_t)t.pack << 32 | t.bank;
+        prio[r] = std::min(prio[r], opt.order == kRepackByPack ? byPack : byBank);
+        hits[r] += opt.heatPath.empty() ? 1 : heat[keyOf(baseName(paths[t.bank]), t.pack)];
+    }
+    if (opt.order == kRepackByHeat)
+    {
+        /* hottest first, bank order among equals */
+        std::vector<size_t> roots;
+        for (size_t s = 0; s < span.size(); ++s) if (parent[s] == s) roots.push_back(s);
+        std::sort(roots.begin(), roots.end(), [&](size_t a, size_t b)
+        {
+            return hits[a] != hits[b] ? hits[a] > hits[b] : prio[a] < prio[b];
+        });
+        for (size_t k = 0; k < roots.size(); ++k) prio[roots[k]] = k;
+    }
+
+    std::vector<size_t> order;
+    layout(parent, edges, &prio, &order);
+
+    std::vector<uint64_t> newOff(span.size(), 0);
+    uint64_t cursor = 0, pad = 0;
+    const uint64_t a = opt.align > 1 ? opt.align : 1;
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        const Span& s = span[order[k]];
+        if (s.size)
+        {
+            const uint64_t at = (cursor + a - 1) & ~(a - 1);
+            pad   += at - cursor;
+            cursor = at;
+        }
+        newOff[order[k]] = cursor;
+        cursor += s.size;
+    }
+    if (cursor > 0xFFFFFFFFull)
+        return setError("repacked .d8t would be %llu bytes, offsets are 32-bit",
+                        (unsigned long long)cursor);
+
+    /* ── 5. every .d8w from the new offsets ────────────────────── */
+    if (!outDir.empty() && !plat::makeDir(outDir))
+        return setError("cannot create %s", outDir.c_str());
+    const std::string dest = outDir.empty() ? dirOf(d8tPath) : outDir;
+    PartFiles parts(kPart);
+
+    for (size_t k = 0; k < tbl.size(); ++k)
+    {
+        const Table&  t = tbl[k];
+        TextureTable& x = banks[t.bank]->tables()[t.pack];
+        x.absOff = uint32_t(newOff[rootOf(parent, t.span)] + t.rel);
+
+        uint32_t off = x.absOff;
+        for (size_t i = 0; i < x.tex.size(); ++i)
+        {
+            x.tex[i].fileOff = off;
+            off += x.tex[i].size;
+        }
+    }
+    for (size_t b = 0; b < banks.size(); ++b)
+    {
+        std::vector<BYTE> w;
+        banks[b]->serialize(w);
+        const std::string part = parts.add(plat::join(dest, baseName(paths[b])));
+        if (!plat::writeFile(part, w.data(), w.size()))
+            return setError("cannot write %s", part.c_str());
+        trace::count(trace::kBytesWritten, w.size());
+    }
+
+    /* ── 6. the .d8t, front to back ────────────────────────────── */
+    {
+        D8W_TRACE_SCOPE("repackArchive::stream");
+        plat::File in, out;
+        const std::string part = parts.add(plat::join(dest, baseName(d8tPath)));
+        if (!in.open(d8tPath, plat::File::kRead)) return setError("cannot open %s", d8tPath.c_str());
+        if (!out.open(part, plat::File::kWrite))   return setError("cannot write %s", part.c_str());
+
+        std::vector<BYTE> chunk(size_t(1) << 20);
+        uint64_t written = 0;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const Span& s = span[order[k]];
+            if (k + 1 < order.size())                      /* sources jump around */
+                in.willNeed(span[order[k + 1]].off, span[order[k + 1]].size);
+
+            if (newOff[order[k]] > written)
+            {
+                std::memset(chunk.data(), 0, chunk.size());
+                while (written < newOff[order[k]])
+                {
+                    const size_t n = (size_t)std::min<uint64_t>(newOff[order[k]] - written, chunk.size());
+                    if (!out.write(chunk.data(), n)) return setError("cannot write %s", part.c_str());
+                    written += n;
+                }
+            }
+            for (uint64_t done = 0; done < s.size; )
+            {
+                const size_t n = (size_t)std::min<uint64_t>(s.size - done, chunk.size());
+                if (!in.readAt(s.off + done, chunk.data(), n))
+                    return setError("I/O error on %s", d8tPath.c_str());
+                if (!out.write(chunk.data(), n)) return setError("cannot write %s", part.c_str());
+                trace::count(trace::kBytesRead, n);
+                done += n;
+            }
+            written += s.size;
+        }
+        trace::count(trace::kBytesWritten, written);
+    }
+
+    /* ── 7. all written – move the results into place ─────────── */
+    if (!parts.commit()) return false;                    /* Status set */
+
+    if (stats)
+    {
+        *stats = RepackStats();
+        stats->banks     = banks.size();
+        stats->tables    = tbl.size();
+        stats->spans     = order.size();
+        stats->coalesced = coalesced;
+        stats->bytesIn   = fi.size;
+        stats->bytesOut  = cursor;
+        stats->padBytes  = pad;
+    }
+    return true;
+}
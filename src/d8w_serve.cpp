@@ -0,0 +1,291 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_serve.cpp  –  request pump for the resident daemon
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_serve.h"
+#include "d8w_parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#   include <errno.h>
+#   include <poll.h>
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#   include <cstring>
+#endif
+
+using namespace juiced;
+
+namespace
+{
+
+/* ─── fixed worker pool ────────────────────────────────────── */
+class WorkQueue
+{
+public:
+    explicit WorkQueue(unsigned n) : stop_(false)
+    {
+        if (!n) n = hardwareThreads();
+        for (unsigned i = 0; i < n; ++i)
+            workers_.push_back(std::thread(&WorkQueue::run, this));
+    }
+
+    ~WorkQueue() { drain(); }
+
+    void push(const std::function<void()>& job)
+    {
+        { std::lock_guard<std::mutex> g(m_); jobs_.push_back(job); }
+        cv_.notify_one();
+    }
+
+    /* finish everything queued, then join */
+    void drain()
+    {
+        { std::lock_guard<std::mutex> g(m_); stop_ = true; }
+        cv_.notify_all();
+        for (size_t i = 0; i < workers_.size(); ++i)
+            if (workers_[i].joinable()) workers_[i].join();
+        workers_.clear();
+    }
+
+private:
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> g(m_);
+                cv_.wait(g, [this]{ return stop_ || !jobs_.empty(); });
+                if (jobs_.empty()) return;                   /* stop_ && drained */
+                job.swap(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex                          m_;
+    std::condition_variable             cv_;
+    std::deque< std::function<void()> > jobs_;
+    std::vector<std::thread>            workers_;
+    bool                                stop_;
+};
+
+static bool blankLine(const std::string& s)
+{
+    return s.find_first_not_of(" \t\r") == std::string::npos;
+}
+
+/* ─── stdin / stdout ───────────────────────────────────────── */
+/* all the reader thread may touch: it runs detached, so it can
+   outlive serveStdio – and the host – while blocked in getline   */
+struct StdinLines
+{
+    std::mutex              m;
+    std::condition_variable cv;
+    std::deque<std::string> lines;
+    bool                    eof, stop;
+
+    StdinLines() : eof(false), stop(false) {}
+};
+
+static void readStdin(std::shared_ptr<StdinLines> in)
+{
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (blankLine(line)) continue;
+        std::lock_guard<std::mutex> g(in->m);
+        if (in->stop) return;
+        in->lines.push_back(line);
+        in->cv.notify_all();
+    }
+    std::lock_guard<std::mutex> g(in->m);
+    in->eof = true;
+    in->cv.notify_all();
+}
+
+static int serveStdio(CommandHost& host, unsigned threads)
+{
+    std::shared_ptr<StdinLines> in = std::make_shared<StdinLines>();
+    std::thread(readStdin, in).detach();     /* a blocked getline must not hold up shutdown */
+
+    std::mutex outM;
+    WorkQueue  pool(threads);
+    for (;;)
+    {
+        std::string line;
+        {
+            std::unique_lock<std::mutex> g(in->m);
+            in->cv.wait(g, [&]{ return !in->lines.empty() || in->eof || host.shutdownRequested(); });
+            if (host.shutdownRequested() || in->lines.empty()) { in->stop = true; break; }
+            line.swap(in->lines.front());
+            in->lines.pop_front();
+        }
+        pool.push([&host, &outM, in, line]()
+        {
+            const std::string r = host.executeLine(line);
+            {
+                std::lock_guard<std::mutex> g(outM);
+                std::cout << r << '\n' << std::flush;
+            }
+            if (host.shutdownRequested())
+            {
+                std::lock_guard<std::mutex> g(in->m);
+                in->cv.notify_all();
+            }
+        });
+    }
+    pool.drain();                            /* host and outM outlive every job */
+    return 0;
+}
+
+#ifndef _WIN32
+/* ─── Unix domain socket ───────────────────────────────────── */
+struct Conn
+{
+    int        fd;
+    std::mutex wm;                  /* one reply line at a time */
+
+    explicit Conn(int f) : fd(f) {}
+    ~Conn() { ::close(fd); }
+
+    void send(const std::string& s)
+    {
+        std::lock_guard<std::mutex> g(wm);
+        size_t done = 0;
+        while (done < s.size())
+        {
+#ifdef MSG_NOSIGNAL
+            const ssize_t n = ::send(fd, s.data() + done, s.size() - done, MSG_NOSIGNAL);
+#else
+            const ssize_t n = ::send(fd, s.data() + done, s.size() - done, 0);
+#endif
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;                              /* client gone */
+            done += (size_t)n;
+        }
+    }
+};
+
+static void connLoop(CommandHost& host, WorkQueue& pool, std::shared_ptr<Conn> c,
+                     std::shared_ptr< std::atomic<bool> > finished)
+{
+    struct Done { std::atomic<bool>& f; ~Done() { f = true; } } done = { *finished };
+
+    std::string buf;
+    char        chunk[64 * 1024];
+    while (!host.shutdownRequested())
+    {
+        pollfd pf = { c->fd, POLLIN, 0 };
+        const int pr = ::poll(&pf, 1, 250);
+        if (pr < 0 && errno != EINTR) break;
+        if (pr <= 0) continue;
+
+        const ssize_t n = ::recv(c->fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buf.append(chunk, (size_t)n);
+
+        size_t nl;
+        while ((nl = buf.find('\n')) != std::string::npos)
+        {
+            const std::string line = buf.substr(0, nl);
+            buf.erase(0, nl + 1);
+            if (blankLine(line)) continue;
+            pool.push([&host, c, line]()
+            {
+                c->send(host.executeLine(line) + '\n');
+            });
+        }
+    }
+}
+
+static int serveSocket(CommandHost& host, const std::string& path, unsigned threads)
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "socket path too long\n";
+        return 2;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    struct stat st;                                         /* only a stale socket */
+    if (::lstat(path.c_str(), &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+        {
+            std::cerr << path << " exists and is not a socket\n";
+            return 2;
+        }
+        ::unlink(path.c_str());
+    }
+
+    const int ls = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (ls < 0) { std::cerr << "socket: " << std::strerror(errno) << '\n'; return 2; }
+
+    if (::bind(ls, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(ls, 16) < 0)
+    {
+        std::cerr << "bind " << path << ": " << std::strerror(errno) << '\n';
+        ::close(ls);
+        return 2;
+    }
+
+    typedef std::shared_ptr< std::atomic<bool> > Flag;
+    WorkQueue                                  pool(threads);
+    std::vector< std::pair<std::thread,Flag> > conns;
+    while (!host.shutdownRequested())
+    {
+        for (size_t i = 0; i < conns.size(); )               /* reap closed clients */
+        {
+            if (!*conns[i].second) { ++i; continue; }
+            conns[i].first.join();
+            conns.erase(conns.begin() + i);
+        }
+
+        pollfd pf = { ls, POLLIN, 0 };
+        const int pr = ::poll(&pf, 1, 250);
+        if (pr < 0 && errno != EINTR) break;
+        if (pr <= 0) continue;
+
+        const int fd = ::accept(ls, 0, 0);
+        if (fd < 0) continue;
+        Flag f = std::make_shared< std::atomic<bool> >(false);
+        conns.push_back(std::make_pair(std::thread(connLoop, std::ref(host), std::ref(pool),
+                                                   std::make_shared<Conn>(fd), f), f));
+    }
+
+    ::close(ls);
+    ::unlink(path.c_str());
+    for (size_t i = 0; i < conns.size(); ++i) conns[i].first.join();
+    pool.drain();
+    return 0;
+}
+#endif
+
+} // anon
+
+int juiced::serve(CommandHost& host, const ServeOptions& opt)
+{
+    if (opt.socketPath.empty()) return serveStdio(host, opt.threads);
+#ifndef _WIN32
+    return serveSocket(host, opt.socketPath, opt.threads);
+#else
+    std::cerr << "-serve --socket is not available on Windows; use stdin/stdout\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,291 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_sheet.cpp  –  -contactsheet: batched read, decode, tile
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_sheet.h"
+#include "d8w_archive.h"
+#include "d8w_io.h"
+#include "d8w_parallel.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_thumbs.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+#include "ImageIO.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using namespace juiced;
+
+namespace
+{
+
+/* classic 5x7 ASCII font, 0x20 … 0x7E: five columns, bit 0 = top row */
+const uint8_t kFont[95][5] =
+{
+    {0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x5F,0x00,0x00},{0x00,0x07,0x00,0x07,0x00},
+    {0x14,0x7F,0x14,0x7F,0x14},{0x24,0x2A,0x7F,0x2A,0x12},{0x23,0x13,0x08,0x64,0x62},
+    {0x36,0x49,0x55,0x22,0x50},{0x00,0x05,0x03,0x00,0x00},{0x00,0x1C,0x22,0x41,0x00},
+    {0x00,0x41,0x22,0x1C,0x00},{0x14,0x08,0x3E,0x08,0x14},{0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00},{0x08,0x08,0x08,0x08,0x08},{0x00,0x60,0x60,0x00,0x00},
+    {0x20,0x10,0x08,0x04,0x02},{0x3E,0x51,0x49,0x45,0x3E},{0x00,0x42,0x7F,0x40,0x00},
+    {0x42,0x61,0x51,0x49,0x46},{0x21,0x41,0x45,0x4B,0x31},{0x18,0x14,0x12,0x7F,0x10},
+    {0x27,0x45,0x45,0x45,0x39},{0x3C,0x4A,0x49,0x49,0x30},{0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36},{0x06,0x49,0x49,0x29,0x1E},{0x00,0x36,0x36,0x00,0x00},
+    {0x00,0x56,0x36,0x00,0x00},{0x08,0x14,0x22,0x41,0x00},{0x14,0x14,0x14,0x14,0x14},
+    {0x00,0x41,0x22,0x14,0x08},{0x02,0x01,0x51,0x09,0x06},{0x32,0x49,0x79,0x41,0x3E},
+    {0x7E,0x11,0x11,0x11,0x7E},{0x7F,0x49,0x49,0x49,0x36},{0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C},{0x7F,0x49,0x49,0x49,0x41},{0x7F,0x09,0x09,0x09,0x01},
+    {0x3E,0x41,0x49,0x49,0x7A},{0x7F,0x08,0x08,0x08,0x7F},{0x00,0x41,0x7F,0x41,0x00},
+    {0x20,0x40,0x41,0x3F,0x01},{0x7F,0x08,0x14,0x22,0x41},{0x7F,0x40,0x40,0x40,0x40},
+    {0x7F,0x02,0x0C,0x02,0x7F},{0x7F,0x04,0x08,0x10,0x7F},{0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06},{0x3E,0x41,0x51,0x21,0x5E},{0x7F,0x09,0x19,0x29,0x46},
+    {0x46,0x49,0x49,0x49,0x31},{0x01,0x01,0x7F,0x01,0x01},{0x3F,0x40,0x40,0x40,0x3F},
+    {0x1F,0x20,0x40,0x20,0x1F},{0x3F,0x40,0x38,0x40,0x3F},{0x63,0x14,0x08,0x14,0x63},
+    {0x07,0x08,0x70,0x08,0x07},{0x61,0x51,0x49,0x45,0x43},{0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20},{0x00,0x41,0x41,0x7F,0x00},{0x04,0x02,0x01,0x02,0x04},
+    {0x40,0x40,0x40,0x40,0x40},{0x00,0x01,0x02,0x04,0x00},{0x20,0x54,0x54,0x54,0x78},
+    {0x7F,0x48,0x44,0x44,0x38},{0x38,0x44,0x44,0x44,0x20},{0x38,0x44,0x44,0x48,0x7F},
+    {0x38,0x54,0x54,0x54,0x18},{0x08,0x7E,0x09,0x01,0x02},{0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78},{0x00,0x44,0x7D,0x40,0x00},{0x20,0x40,0x44,0x3D,0x00},
+    {0x7F,0x10,0x28,0x44,0x00},{0x00,0x41,0x7F,0x40,0x00},{0x7C,0x04,0x18,0x04,0x78},
+    {0x7C,0x08,0x04,0x04,0x78},{0x38,0x44,0x44,0x44,0x38},{0x7C,0x14,0x14,0x14,0x08},
+    {0x08,0x14,0x14,0x18,0x7C},{0x7C,0x08,0x04,0x04,0x08},{0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20},{0x3C,0x40,0x40,0x20,0x7C},{0x1C,0x20,0x40,0x20,0x1C},
+    {0x3C,0x40,0x30,0x40,0x3C},{0x44,0x28,0x10,0x28,0x44},{0x0C,0x50,0x50,0x50,0x3C},
+    {0x44,0x64,0x54,0x4C,0x44},{0x00,0x08,0x36,0x41,0x00},{0x00,0x00,0x7F,0x00,0x00},
+    {0x00,0x41,0x36,0x08,0x00},{0x08,0x04,0x08,0x10,0x08}
+};
+
+const uint32_t kPad    = 4;         /* around each tile               */
+const uint32_t kLine   = 9;         /* label line height (7 + 2)      */
+const uint32_t kLines  = 3;
+const uint32_t kBatch  = 8;         /* pages in memory at once (min)  */
+
+const uint8_t kBack [4] = { 0x20, 0x20, 0x20, 0xFF };    /* BGRA */
+const uint8_t kPink [4] = { 0xFF, 0x00, 0xFF, 0xFF };    /* preview's alpha backdrop */
+const uint8_t kInk  [4] = { 0xE0, 0xE0, 0xE0, 0xFF };
+const uint8_t kBad  [4] = { 0x30, 0x30, 0x80, 0xFF };    /* undecodable: dark red */
+
+/* one tile: which texture, on which page, where */
+struct Cell
+{
+    uint32_t bank, pack, idx;
+    size_t   page;                  /* index into the batch's canvases */
+    uint32_t x, y;                  /* top-left of the tile box         */
+};
+
+/* one output PNG */
+struct Page
+{
+    uint32_t    bank;
+    size_t      first, count;       /* cells of its bank series */
+    std::string path;
+};
+
+static std::string stemOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    const std::string n = s == std::string::npos ? p : p.substr(s + 1);
+    return n.substr(0, n.find_last_of('.'));
+}
+
+static void fill(RawImage& c, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint8_t* bgra)
+{
+    for (uint32_t r = y; r < y + h && r < c.height; ++r)
+    {
+        uint8_t* d = c.row(r) + size_t(x) * 4;
+        for (uint32_t k = x; k < x + w && k < c.width; ++k, d += 4) std::memcpy(d, bgra, 4);
+    }
+}
+
+/* clipped to maxChars; characters outside ASCII print as '?' */
+static void text(RawImage& c, uint32_t x, uint32_t y, const char* s, size_t maxChars)
+{
+    for (size_t i = 0; s[i] && i < maxChars; ++i, x += 6)
+    {
+        unsigned ch = (unsigned char)s[i];
+        if (ch < 0x20 || ch > 0x7E) ch = '?';
+        const uint8_t* g = kFont[ch - 0x20];
+        for (uint32_t col = 0; col < 5; ++col)
+            for (uint32_t row = 0; row < 7; ++row)
+                if (g[col] >> row & 1) fill(c, x + col, y + row, 1, 1, kInk);
+    }
+}
+
+/* thumb centred in the tile box, alpha blended over pink */
+static void blit(RawImage& c, const RawImage& t, uint32_t x, uint32_t y, uint32_t tile)
+{
+    const uint32_t ox = x + (tile - t.width) / 2, oy = y + (tile - t.height) / 2;
+    for (uint32_t r = 0; r < t.height; ++r)
+    {
+        const uint8_t* s = t.row(r);
+        uint8_t*       d = c.row(oy + r) + size_t(ox) * 4;
+        for (uint32_t k = 0; k < t.width; ++k, s += 4, d += 4)
+        {
+            const unsigned a = s[3];
+            for (int ch = 0; ch < 3; ++ch)
+                d[ch] = (uint8_t)((s[ch] * a + kPink[ch] * (255 - a) + 127) / 255);
+            d[3] = 0xFF;
+        }
+    }
+}
+
+} // anon
+
+bool juiced::writeContactSheets(const std::string& d8tPath, const std::vector<std::string>& d8wPaths,
+                                int pack, const std::string& outDir,
+                                const SheetOptions& opt, SheetStats* stats)
+{
+    D8W_TRACE_SCOPE("writeContactSheets");
+    StatusScope st("contactsheet");
+
+    if (opt.tile < 8 || !opt.cols || !opt.rows)
+        return setError("tile must be 8 px or more, cols / rows at least 1");
+    if (!outDir.empty() && !plat::makeDir(outDir))
+        return setError("cannot create %s", outDir.c_str());
+
+    std::vector<std::string> paths = d8wPaths;
+    if (paths.empty()) findCompanionBanks(d8tPath, paths);
+    if (paths.empty()) return setError("no .d8w next to %s", d8tPath.c_str());
+
+    /* ── 1. banks (headers only), cells, pages ─────────────────── */
+    const std::vector<BYTE> none;
+    D8WContext ctx;                                        /* outlives banks */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector< std::vector<Cell> > series(paths.size());
+    std::vector<Page> pages;
+    const size_t perPage = size_t(opt.cols) * opt.rows;
+
+    for (size_t b = 0; b < paths.size(); ++b)
+    {
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks[b]->load(paths[b], none))
+            return setError("failed to load %s (%s)", paths[b].c_str(), lastError().c_str());
+        if (pack >= (int)banks[b]->texturePackCount())
+            return setError("%s has no pack %d", paths[b].c_str(), pack);
+
+        for (size_t p = 0; p < banks[b]->texturePackCount(); ++p)
+        {
+            if (pack >= 0 && (int)p != pack) continue;
+            for (size_t i = 0; i < banks[b]->textureCount(p); ++i)
+            {
+                Cell c = { (uint32_t)b, (uint32_t)p, (uint32_t)i, 0, 0, 0 };
+                series[b].push_back(c);
+            }
+        }
+
+        char tag[32] = "";
+        if (pack >= 0) std::snprintf(tag, sizeof(tag), "_TexSet%d", pack);
+        for (size_t at = 0, n = 0; at < series[b].size(); at += perPage, ++n)
+        {
+            char name[48];
+            std::snprintf(name, sizeof(name), "%s_%03u.png", tag, (unsigned)n);
+            Page pg = { (uint32_t)b, at, std::min(perPage, series[b].size() - at),
+                        plat::join(outDir.empty() ? "." : outDir, stemOf(paths[b]) + name) };
+            pages.push_back(pg);
+        }
+    }
+
+    /* ── 2. geometry ───────────────────────────────────────────── */
+    const uint32_t labelH = opt.labels ? kLines * kLine + 2 : 0;
+    const uint32_t cellW  = opt.tile + 2 * kPad;
+    const uint32_t cellH  = opt.tile + 2 * kPad + labelH;
+    const size_t   chars  = opt.tile / 6;
+    const unsigned threads = opt.threads ? opt.threads : hardwareThreads();
+    const size_t   batch   = std::max<size_t>(kBatch, threads);
+
+    SheetStats s;
+    for (size_t first = 0; first < pages.size(); first += batch)
+    {
+        const size_t n = std::min(batch, pages.size() - first);
+        std::vector<RawImage> canvas(n);
+        std::vector<Cell>     cells;
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            const Page& pg = pages[first + k];
+            const uint32_t rows = (uint32_t)((pg.count + opt.cols - 1) / opt.cols);
+            RawImage& c = canvas[k];
+            c.width  = cellW * std::min<uint32_t>(opt.cols, (uint32_t)pg.count);
+            c.height = cellH * rows;
+            c.bgra.resize(size_t(c.width) * c.height * 4);
+            fill(c, 0, 0, c.width, c.height, kBack);
+
+            for (size_t j = 0; j < pg.count; ++j)
+            {
+                Cell cl = series[pg.bank][pg.first + j];
+                cl.page = k;
+                cl.x    = (uint32_t)(j % opt.cols) * cellW + kPad;
+                cl.y    = (uint32_t)(j / opt.cols) * cellH + kPad;
+                cells.push_back(cl);
+            }
+        }
+
+        /* ── 3. read in offset order, decode into cells on the workers ── */
+        ReadScheduler rs;
+        for (size_t k = 0; k < cells.size(); ++k)
+        {
+            const TextureHdrEx& h = banks[cells[k].bank]->tables()[cells[k].pack].tex[cells[k].idx];
+            rs.add(h.fileOff, h.size, k);
+        }
+
+        std::vector<char> drawn(cells.size(), 0);
+        rs.run(d8tPath, [&](size_t k, const uint8_t* data, uint32_t size)
+        {
+            const Cell& cl = cells[k];
+            const TextureHdrEx& h = banks[cl.bank]->tables()[cl.pack].tex[cl.idx];
+            RawImage th;
+            if (decodeThumb(h, data, size, opt.tile, th))
+            {
+                blit(canvas[cl.page], th, cl.x, cl.y, opt.tile);
+                drawn[k] = 1;
+            }
+        }, threads);
+
+        /* labels + failures: cheap, and off the I/O workers' backs */
+        parallelFor(cells.size(), [&](size_t k)
+        {
+            const Cell& cl = cells[k];
+            RawImage& c = canvas[cl.page];
+            if (!drawn[k]) fill(c, cl.x, cl.y, opt.tile, opt.tile, kBad);
+            if (!opt.labels) return;
+
+            const TextureHdrEx& h = banks[cl.bank]->tables()[cl.pack].tex[cl.idx];
+            char line[3][48];
+            std::snprintf(line[0], sizeof(line[0]), "Tex%u%04u", cl.pack, cl.idx);
+            std::snprintf(line[1], sizeof(line[1]), "0x%08X", h.fileOff);
+            std::snprintf(line[2], sizeof(line[2]), "%s [%u x %u]", bc::typeName(h.type), h.width, h.height);
+            for (uint32_t l = 0; l < kLines; ++l)
+                text(c, cl.x, cl.y + opt.tile + 3 + l * kLine, line[l], chars);
+        }, threads, 64);
+
+        for (size_t k = 0; k < cells.size(); ++k) s.failed += !drawn[k];
+        s.textures  += cells.size();
+        s.bytesRead += rs.stats().bytesRead;
+
+        /* ── 4. encode + write the batch's pages ───────────────── */
+        std::vector<char>     written(n, 0);
+        std::vector<uint64_t> bytes(n, 0);
+        parallelFor(n, [&](size_t k)
+        {
+            std::vector<uint8_t> png;
+            encodePNG(canvas[k], png, opt.level);
+            written[k] = plat::writeFile(pages[first + k].path, png.data(), png.size());
+            bytes[k]   = png.size();
+        }, threads);
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (!written[k]) return setError("cannot write %s", pages[first + k].path.c_str());
+            s.bytesWritten += bytes[k];
+            trace::count(trace::kBytesWritten, bytes[k]);
+            ++s.sheets;
+        }
+    }
+
+    if (stats) *stats = s;
+    return true;
+}
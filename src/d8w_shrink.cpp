@@ -0,0 +1,198 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_shrink.cpp  –  -shrink: opaque DXT3 / DXT5 → DXT1
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_shrink.h"
+#include "d8w_archive.h"
+#include "d8w_parallel.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+
+using namespace juiced;
+
+namespace
+{
+
+const char* kPart = ".shrink-part";            /* temp suffix while in place */
+
+/* one distinct body of the .d8t and the header every reference agrees on */
+struct Body
+{
+    TextureHdr hdr;
+    uint32_t   pos;
+    bool       ok;                  /* consistent, in bounds, no overlap  */
+    bool       opaque;
+    size_t     out;                 /* offset into the DXT1 buffer        */
+};
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static std::string dirOf(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? std::string(".") : p.substr(0, s);
+}
+
+/* the body is exactly mipCnt levels of 16-byte blocks */
+static bool wholeChain(const TextureHdr& h)
+{
+    if (!h.width || !h.height || !h.mipCnt || h.size % 16) return false;
+    uint64_t n = 0;
+    for (uint32_t l = 0; l < h.mipCnt && l < 32; ++l)
+        n += bc::levelBytes(h.type, std::max(1u, h.width >> l), std::max(1u, h.height >> l));
+    return n == h.size;
+}
+
+} // anon
+
+bool juiced::shrinkArchive(const std::string& d8tPath, const ShrinkOptions& opt,
+                           const std::string& outDir, ShrinkStats* stats)
+{
+    D8W_TRACE_SCOPE("shrinkArchive");
+    StatusScope st("shrink");
+
+    std::vector<std::string> paths;
+    findCompanionBanks(d8tPath, paths);
+    if (paths.empty()) return setError("no .d8w next to %s", d8tPath.c_str());
+
+    D8TFile t;
+    if (!t.load(d8tPath)) return setError("failed to load %s", d8tPath.c_str());
+    const std::vector<BYTE>& T = t.buffer();
+
+    D8WContext ctx;                                        /* outlives banks */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    for (size_t b = 0; b < paths.size(); ++b)
+    {
+        banks.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+        if (!banks[b]->load(paths[b], T))
+            return setError("failed to load %s (%s)", paths[b].c_str(), lastError().c_str());
+    }
+
+    /* ── 1. distinct bodies; shared ones must agree on their header ── */
+    std::map<uint32_t, Body> byPos;
+    for (size_t b = 0; b < banks.size(); ++b)
+    {
+        const std::vector<TextureTable>& tbl = banks[b]->tables();
+        for (size_t p = 0; p < tbl.size(); ++p)
+            for (size_t i = 0; i < tbl[p].tex.size(); ++i)
+            {
+                const TextureHdrEx& h = tbl[p].tex[i];
+                std::map<uint32_t, Body>::iterator it = byPos.find(h.fileOff);
+                if (it != byPos.end())
+                {
+                    if (std::memcmp(&it->second.hdr, &h, sizeof(TextureHdr)) != 0) it->second.ok = false;
+                    continue;
+                }
+                Body x;
+                x.hdr    = h;
+                x.pos    = h.fileOff;
+                x.ok     = (uint64_t)h.fileOff + h.size <= T.size();
+                x.opaque = false;
+                x.out    = 0;
+                byPos[h.fileOff] = x;
+            }
+    }
+
+    /* overlapping extents belong to neither */
+    Body*    last = 0;
+    uint64_t end  = 0;
+    for (std::map<uint32_t, Body>::iterator it = byPos.begin(); it != byPos.end(); ++it)
+    {
+        Body& x = it->second;
+        if (last && x.pos < end) { x.ok = false; last->ok = false; }
+        if (!last || (uint64_t)x.pos + x.hdr.size > end) { last = &x; end = (uint64_t)x.pos + x.hdr.size; }
+    }
+
+    std::vector<Body*> cand;
+    for (std::map<uint32_t, Body>::iterator it = byPos.begin(); it != byPos.end(); ++it)
+        if (it->second.hdr.type == bc::kTypeDXT3 || it->second.hdr.type == bc::kTypeDXT5)
+            cand.push_back(&it->second);
+
+    /* ── 2. alpha scan, one body per worker ────────────────────── */
+    parallelFor(cand.size(), [&](size_t k)
+    {
+        Body& x = *cand[k];
+        x.opaque = x.ok && wholeChain(x.hdr) && bc::alphaOpaque(x.hdr.type, &T[0] + x.pos, x.hdr.size);
+    }, opt.threads);
+
+    size_t   skipped = 0;
+    uint64_t fresh   = 0;
+    std::vector<Body*> hit;
+    for (size_t k = 0; k < cand.size(); ++k)
+    {
+        if (!cand[k]->ok) { ++skipped; continue; }
+        if (!cand[k]->opaque) continue;
+        cand[k]->out = (size_t)fresh;
+        fresh += cand[k]->hdr.size / 2;
+        hit.push_back(cand[k]);
+    }
+
+    if (stats)
+    {
+        *stats = ShrinkStats();
+        stats->banks    = banks.size();
+        stats->bodies   = cand.size();
+        stats->opaque   = hit.size();
+        stats->skipped  = skipped;
+        stats->bytesIn  = T.size();
+        stats->bytesOut = T.size() - fresh;                /* each body halves */
+    }
+    if (opt.dryRun || (hit.empty() && outDir.empty())) return true;
+
+    /* ── 3. DXT1 bodies, then every splice in one copy ─────────── */
+    std::vector<BYTE>       dxt1((size_t)fresh);
+    std::vector<BodySplice> s(hit.size());
+    parallelFor(hit.size(), [&](size_t k)
+    {
+        const Body& x = *hit[k];
+        if (x.hdr.size) bc::transcodeToDXT1(&T[0] + x.pos, x.hdr.size, &dxt1[0] + x.out);
+
+        BodySplice& sp = s[k];
+        std::memset(&sp, 0, sizeof(sp));
+        sp.pos      = x.pos;
+        sp.oldSize  = x.hdr.size;
+        sp.newSize  = x.hdr.size / 2;
+        sp.hdr      = x.hdr;
+        sp.hdr.type = bc::kTypeDXT1;
+        sp.hdr.size = sp.newSize;
+        sp.body     = dxt1.empty() ? 0 : &dxt1[0] + x.out;
+    }, opt.threads);
+
+    std::vector<BYTE> out;
+    if (!detail::spliceBatch(T, s, out)) return false;    /* Status set */
+    if (!s.empty() && !banks[0]->applySplices(s))
+        return setError("reference index lost a rewritten body");
+
+    /* ── 4. write everything, then move it into place ──────────── */
+    if (!outDir.empty() && !plat::makeDir(outDir))
+        return setError("cannot create %s", outDir.c_str());
+    const std::string dest = outDir.empty() ? dirOf(d8tPath) : outDir;
+    PartFiles parts(kPart);
+
+    for (size_t b = 0; b < banks.size(); ++b)
+    {
+        std::vector<BYTE> w;
+        banks[b]->serialize(w);
+        const std::string part = parts.add(plat::join(dest, baseName(paths[b])));
+        if (!plat::writeFile(part, w.data(), w.size()))
+            return setError("cannot write %s", part.c_str());
+        trace::count(trace::kBytesWritten, w.size());
+    }
+    {
+        const std::string part = parts.add(plat::join(dest, baseName(d8tPath)));
+        if (!plat::writeFile(part, out.data(), out.size()))
+            return setError("cannot write %s", part.c_str());
+        trace::count(trace::kBytesWritten, out.size());
+    }
+    return parts.commit();                                 /* Status set */
+}
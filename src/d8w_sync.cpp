@@ -0,0 +1,200 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_sync.cpp  –  -sync: import only the files that changed
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_sync.h"
+#include "d8w_hash.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace juiced;
+
+namespace
+{
+
+const char* kCacheName = ".d8wsync";
+const char* kCacheHead = "# d8w sync cache 1\n";
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+/* a .ddt carrying exactly the slot's header and body – importing it
+   would splice the same bytes back.  Both layouts count: the full
+   TextureHdr importTexture reads, and the one without "size" that
+   exportTexture writes                                               */
+static bool sameAsSlot(const std::string& name, const std::vector<BYTE>& f,
+                       const TextureHdr& h, const std::vector<BYTE>& T, uint32_t fileOff)
+{
+    const size_t hb = sizeof(TextureHdr) - 4;
+    if (!plat::hasExt(name, ".ddt") || (uint64_t)fileOff + h.size > T.size()) return false;
+
+    size_t at;
+    if      (f.size() == hb + 4 + h.size) at = 4;
+    else if (f.size() == hb + h.size)     at = 0;
+    else return false;
+    return std::memcmp(&f[at], reinterpret_cast<const BYTE*>(&h) + 4, hb) == 0 &&
+           (!h.size || std::memcmp(&f[at + hb], &T[fileOff], h.size) == 0);
+}
+
+} // anon
+
+std::string juiced::syncCachePath(const std::string& dir)
+{
+    return plat::join(dir, kCacheName);
+}
+
+FolderSync::FolderSync(D8WBank& bank, size_t pack, const std::string& dir)
+    : bank_(bank), pack_(pack), dir_(dir), dirty_(true)
+{
+    std::vector<BYTE> buf;
+    if (!plat::readFile(syncCachePath(dir_), buf, uint64_t(1) << 30)) return;
+
+    /* bank <file name> <pack>, then one line per file:
+       <slot> <size> <mtime> <file hash> <body hash> <file name>   */
+    const std::string text(buf.begin(), buf.end());
+    bool   ours = false;
+    size_t at   = 0;
+    while (at < text.size())
+    {
+        size_t eol = text.find('\n', at);
+        if (eol == std::string::npos) eol = text.size();
+        std::string l = text.substr(at, eol - at);
+        at = eol + 1;
+
+        if (!l.empty() && l[l.size() - 1] == '\r') l.erase(l.size() - 1);
+        if (l.empty() || l[0] == '#') continue;
+
+        if (l.compare(0, 5, "bank ") == 0)
+        {
+            const size_t sp = l.find_last_of(' ');
+            ours = sp > 5 && l.substr(5, sp - 5) == baseName(bank_.d8wPath()) &&
+                   std::strtoul(l.c_str() + sp + 1, 0, 10) == pack_;
+            continue;
+        }
+        if (!ours) break;                                   /* someone else's */
+
+        unsigned           slot;
+        unsigned long long size, fh, bh;
+        long long          mtime;
+        int                name = 0;
+        if (std::sscanf(l.c_str(), "%u %llu %lld %llx %llx %n",
+                        &slot, &size, &mtime, &fh, &bh, &name) != 5 || !name || !l[name])
+            continue;                                       /* costs a re-read */
+
+        Entry e = { slot, (uint64_t)size, (int64_t)mtime, (uint64_t)fh, (uint64_t)bh };
+        cache_[l.substr(name)] = e;
+    }
+    if (!ours) cache_.clear();
+    else       dirty_ = false;
+}
+
+uint64_t FolderSync::bodyHash(size_t idx) const
+{
+    const TextureHdrEx&      h = bank_.tables()[pack_].tex[idx];
+    const std::vector<BYTE>& T = *bank_.tBuffer();
+    if ((uint64_t)h.fileOff + h.size > T.size()) return 0;
+    return hash64(h.size ? &T[h.fileOff] : T.data(), h.size);
+}
+
+bool FolderSync::run(SyncStats& st, bool dryRun)
+{
+    D8W_TRACE_SCOPE("FolderSync::run");
+    StatusScope s("sync");
+    st = SyncStats();
+
+    if (!bank_.tBuffer() || bank_.tBuffer()->empty()) return setError("bank loaded without its .d8t");
+    if (pack_ >= bank_.texturePackCount())            return setError("no pack %u", (unsigned)pack_);
+
+    std::vector<ImportFile> files;
+    if (!listImportFiles(dir_, pack_, files)) return false;            /* Status set */
+    const size_t count = bank_.textureCount(pack_);
+
+    /* files gone, or past the pack's end, leave the cache */
+    Cache keep;
+    for (size_t k = 0; k < files.size(); ++k)
+    {
+        if (files[k].slot >= count) continue;
+        ++st.files;
+        Cache::iterator c = cache_.find(files[k].name);
+        if (c != cache_.end()) keep.insert(*c);
+    }
+    if (keep.size() != cache_.size()) { cache_.swap(keep); dirty_ = true; }
+
+    for (size_t k = 0; k < files.size(); ++k)
+    {
+        const size_t       i    = files[k].slot;
+        const std::string& name = files[k].name;
+        const std::string  path = plat::join(dir_, name);
+        if (i >= count) continue;
+
+        plat::FileInfo fi;
+        if (!plat::fileInfo(path, fi)) { ++st.failed; continue; }
+
+        /* ── stat only: same file, same slot, bank body as we left it ── */
+        const uint64_t  body  = bodyHash(i);
+        Cache::iterator c     = cache_.find(name);
+        const bool      known = c != cache_.end() && c->second.slot == i && c->second.bodyHash == body;
+        if (known && c->second.size == fi.size && c->second.mtime == fi.mtime)
+        {
+            ++st.unchanged;
+            continue;
+        }
+
+        /* ── touched: compare content before splicing anything ──────── */
+        std::vector<BYTE> data;
+        if (!plat::readFile(path, data, uint64_t(1) << 30)) { ++st.failed; continue; }
+        trace::count(trace::kBytesRead, data.size());
+
+        Entry e = { (uint32_t)i, fi.size, fi.mtime, hash64(data.data(), data.size()), body };
+        const TextureHdrEx& h = bank_.tables()[pack_].tex[i];
+        if ((known && c->second.fileHash == e.fileHash) ||
+            sameAsSlot(name, data, h, *bank_.tBuffer(), h.fileOff))
+        {
+            ++st.identical;
+            cache_[name] = e;
+            dirty_ = true;
+            continue;
+        }
+
+        if (dryRun) { ++st.imported; continue; }
+        if (!bank_.importTexture(pack_, i, path)) { ++st.failed; continue; }
+
+        e.bodyHash   = bodyHash(i);
+        cache_[name] = e;
+        dirty_       = true;
+        ++st.imported;
+    }
+    return true;
+}
+
+bool FolderSync::saveCache()
+{
+    if (!dirty_) return true;
+
+    std::string out = kCacheHead;
+    char line[128];
+    std::snprintf(line, sizeof(line), " %u\n", (unsigned)pack_);
+    out += "bank " + baseName(bank_.d8wPath()) + line;
+    for (Cache::const_iterator it = cache_.begin(); it != cache_.end(); ++it)
+    {
+        const Entry& e = it->second;
+        std::snprintf(line, sizeof(line), "%u %llu %lld %016llx %016llx ",
+                      e.slot, (unsigned long long)e.size, (long long)e.mtime,
+                      (unsigned long long)e.fileHash, (unsigned long long)e.bodyHash);
+        out += line + it->first + '\n';
+    }
+
+    const std::string path = syncCachePath(dir_);
+    if (!plat::writeFile(path, out.data(), out.size()))
+        return setError("cannot write %s", path.c_str());
+    dirty_ = false;
+    return true;
+}
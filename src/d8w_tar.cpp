@@ -0,0 +1,247 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_tar.cpp  –  ustar writer, windowed offset-order export
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_tar.h"
+#include "d8w_io.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+using namespace juiced;
+
+namespace
+{
+
+const uint64_t kWindow = 16u << 20;     /* body bytes per ReadScheduler run */
+const size_t   kBlock  = 512;
+
+/* width-1 octal digits + NUL, zero padded; false if v doesn't fit */
+static bool octal(char* dst, size_t width, uint64_t v)
+{
+    dst[width - 1] = 0;
+    for (size_t i = width - 1; i-- > 0; v >>= 3) dst[i] = (char)('0' + (v & 7));
+    return v == 0;
+}
+
+/* name → ustar name / prefix fields; false if it can't be split */
+static bool splitName(const std::string& name, char* hdr)
+{
+    if (name.size() <= 100) { std::memcpy(hdr, name.data(), name.size()); return true; }
+
+    for (size_t s = std::min<size_t>(name.size() - 1, 155); s > 0; --s)
+    {
+        if (name[s] != '/' || name.size() - s - 1 > 100) continue;
+        std::memcpy(hdr + 345, name.data(), s);
+        std::memcpy(hdr, name.data() + s + 1, name.size() - s - 1);
+        return true;
+    }
+    return false;
+}
+
+} // anon
+
+/* ─────────────────────────────────────────────────────────────
+                           TarWriter
+   ───────────────────────────────────────────────────────────── */
+TarWriter::TarWriter(size_t bufBytes)
+    : buf_(std::max<size_t>(bufBytes, kBlock)), used_(0), total_(0), mtime_(0) {}
+
+TarWriter::~TarWriter() {}
+
+bool TarWriter::open(const std::string& path)
+{
+    used_  = 0;
+    total_ = 0;
+    mtime_ = (int64_t)std::time(0);
+    const bool ok = path == "-" ? f_.openStdout() : f_.open(path, plat::File::kWrite);
+    return ok || setError("cannot write %s", path.c_str());
+}
+
+bool TarWriter::flush()
+{
+    if (!used_) return true;
+    if (!f_.write(buf_.data(), used_)) return setError("write failed");
+    trace::count(trace::kBytesWritten, used_);
+    used_ = 0;
+    return true;
+}
+
+bool TarWriter::put(const void* p, size_t n)
+{
+    const uint8_t* s = (const uint8_t*)p;
+    if (n >= buf_.size() / 8)                               /* big body: straight through */
+    {
+        if (!flush()) return false;
+        if (!f_.write(s, n)) return setError("write failed");
+        trace::count(trace::kBytesWritten, n);
+        total_ += n;
+        return true;
+    }
+    while (n)
+    {
+        const size_t k = std::min(n, buf_.size() - used_);
+        std::memcpy(&buf_[used_], s, k);
+        used_ += k; total_ += k; s += k; n -= k;
+        if (used_ == buf_.size() && !flush()) return false;
+    }
+    return true;
+}
+
+bool TarWriter::add(const std::string& name, const void* head, size_t headSize,
+                    const void* body, uint64_t bodySize)
+{
+    if (!f_.isOpen()) return setError("tar not open");
+
+    char hdr[kBlock];
+    std::memset(hdr, 0, sizeof(hdr));
+    if (!splitName(name, hdr)) return setError("name too long for tar: %s", name.c_str());
+
+    const uint64_t size = headSize + bodySize;
+    octal(hdr + 100, 8, 0644);
+    octal(hdr + 108, 8, 0);
+    octal(hdr + 116, 8, 0);
+    if (!octal(hdr + 124, 12, size))
+    {
+        /* > 8 GB: GNU base-256, big-endian with the top bit set */
+        std::memset(hdr + 124, 0, 12);
+        for (int i = 11; i > 3; --i) hdr[124 + i] = (char)(size >> ((11 - i) * 8));
+        hdr[124] = (char)0x80;
+    }
+    octal(hdr + 136, 12, (uint64_t)mtime_);
+    hdr[156] = '0';
+    std::memcpy(hdr + 257, "ustar", 6);
+    std::memcpy(hdr + 263, "00", 2);
+
+    std::memset(hdr + 148, ' ', 8);
+    unsigned sum = 0;
+    for (size_t i = 0; i < kBlock; ++i) sum += (unsigned char)hdr[i];
+    octal(hdr + 148, 7, sum);                               /* 6 digits, NUL, space */
+
+    static const char zero[kBlock] = { 0 };
+    const size_t pad = (size_t)((kBlock - size % kBlock) % kBlock);
+    return put(hdr, kBlock) && put(head, headSize) &&
+           (!bodySize || put(body, (size_t)bodySize)) && put(zero, pad);
+}
+
+bool TarWriter::finish()
+{
+    static const char zero[2 * kBlock] = { 0 };
+    const bool ok = f_.isOpen() && put(zero, sizeof(zero)) && flush();
+    f_.close();
+    return ok || setError("write failed");
+}
+
+/* ─────────────────────────────────────────────────────────────
+                             export
+   ───────────────────────────────────────────────────────────── */
+void juiced::addTarEntries(const D8WBank& bank, int pack, const std::string& prefix,
+                           const char* ext, std::vector<TarEntry>& out)
+{
+    char fn[32];
+    for (size_t p = 0; p < bank.texturePackCount(); ++p)
+    {
+        if (pack >= 0 && (size_t)pack != p) continue;
+        for (size_t i = 0; i < bank.textureCount(p); ++i)
+        {
+            std::snprintf(fn, sizeof(fn), "Tex%d%04d.%s", (int)p, (int)i, ext);
+            TarEntry e = { &bank, p, i, prefix + fn };
+            out.push_back(e);
+        }
+    }
+}
+
+bool juiced::exportTar(const std::string& d8tPath, const std::vector<TarEntry>& entries,
+                       const std::string& tarPath, bool convert, const ConvertOptions& conv,
+                       TarStats* stats)
+{
+    D8W_TRACE_SCOPE("exportTar");
+    StatusScope st("exporttar");
+
+    /* ── members in .d8t offset order (stable: shared bodies keep list order) ── */
+    std::vector<size_t> order(entries.size());
+    for (size_t k = 0; k < entries.size(); ++k)
+    {
+        const TarEntry& e = entries[k];
+        if (!e.bank || e.pack >= e.bank->texturePackCount() || e.idx >= e.bank->textureCount(e.pack))
+            return setError("texture OOB: %s", e.name.c_str());
+        order[k] = k;
+    }
+    auto hdrOf = [&](size_t k) -> const TextureHdrEx&
+        { return entries[k].bank->tables()[entries[k].pack].tex[entries[k].idx]; };
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return hdrOf(a).fileOff < hdrOf(b).fileOff; });
+
+    TarWriter tw;
+    if (!tw.open(tarPath)) return false;
+
+    /* ── windows: read + build window w+1 while window w is written ── */
+    TarStats s;
+    std::vector< std::vector<BYTE> > data, writing;     /* swapped: capacity is reused */
+    std::vector<size_t>              writingIdx;
+    std::thread                      writer;
+    std::string                      writeErr;
+    auto join = [&]() { if (writer.joinable()) writer.join(); };
+
+    for (size_t first = 0; first < order.size(); )
+    {
+        size_t   last  = first;
+        uint64_t bytes = 0;
+        while (last < order.size() && (last == first || bytes + hdrOf(order[last]).size <= kWindow))
+            bytes += hdrOf(order[last++]).size;
+
+        const size_t n = last - first;
+        data.resize(n);
+        for (size_t k = 0; k < n; ++k) data[k].clear();
+        std::mutex  m;
+        std::string buildErr;
+
+        ReadScheduler rs;
+        for (size_t k = 0; k < n; ++k)
+            rs.add(hdrOf(order[first + k]).fileOff, hdrOf(order[first + k]).size, k);
+
+        const bool read = rs.run(d8tPath, [&](size_t k, const uint8_t* body, uint32_t)
+        {
+            const TarEntry& e = entries[order[first + k]];
+            const bool ok = convert
+                ? e.bank->convertTextureBytes(e.pack, e.idx, (ConvertFormat)conv.format, body, data[k], conv)
+                : e.bank->exportTextureBytes (e.pack, e.idx, body, data[k]);
+            if (ok) return;
+            std::lock_guard<std::mutex> g(m);
+            if (buildErr.empty()) buildErr = e.name + ": " + lastError();
+        }, conv.threads);
+        s.bytesRead += rs.stats().bytesRead;
+
+        join();
+        if (!writeErr.empty()) return setError("%s", writeErr.c_str());
+        if (!read)             return setError("%s", rs.error().c_str());
+        if (!buildErr.empty()) return setError("%s", buildErr.c_str());
+
+        writing.swap(data);
+        writing.resize(n);
+        writingIdx.assign(order.begin() + first, order.begin() + last);
+        writer = std::thread([&]()
+        {
+            StatusScope ws("exporttar");
+            for (size_t k = 0; k < writing.size(); ++k)
+                if (!tw.add(entries[writingIdx[k]].name, writing[k].data(), writing[k].size()))
+                {
+                    writeErr = lastError();
+                    return;
+                }
+        });
+        s.members += n;
+        first = last;
+    }
+    join();
+    if (!writeErr.empty()) return setError("%s", writeErr.c_str());
+    if (!tw.finish())      return false;
+
+    s.bytesWritten = tw.bytes();
+    if (stats) *stats = s;
+    return true;
+}
@@ -0,0 +1,188 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_thumbs.cpp  –  smallest-mip decode, background thumb cache
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_thumbs.h"
+#include "BCEncoder.h"
+#include "BlockDecode.h"
+#include "d8w_parallel.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+
+using namespace juiced;
+
+/* ─────────────────────────────────────────────────────────────
+                            decoding
+   ───────────────────────────────────────────────────────────── */
+uint32_t juiced::thumbLevel(const TextureHdr& h, uint32_t edge)
+{
+    const uint32_t mips = std::max(1u, h.mipCnt);
+    uint32_t l = 0;
+    while (l + 1 < mips && std::max(h.width >> (l + 1), h.height >> (l + 1)) >= edge) ++l;
+    return l;
+}
+
+void juiced::fitThumb(const RawImage& src, uint32_t edge, RawImage& out)
+{
+    const uint32_t sw = src.width, sh = src.height, big = std::max(sw, sh);
+    if (!edge || big <= edge) { out = src; return; }
+
+    out.width  = std::max(1u, (uint32_t)((uint64_t)sw * edge / big));
+    out.height = std::max(1u, (uint32_t)((uint64_t)sh * edge / big));
+    out.bgra.assign(size_t(out.width) * out.height * 4, 0);
+
+    for (uint32_t y = 0; y < out.height; ++y)
+    {
+        const uint32_t y0 = (uint32_t)((uint64_t)y * sh / out.height);
+        const uint32_t y1 = std::max(y0 + 1, (uint32_t)((uint64_t)(y + 1) * sh / out.height));
+        uint8_t* d = out.row(y);
+        for (uint32_t x = 0; x < out.width; ++x, d += 4)
+        {
+            const uint32_t x0 = (uint32_t)((uint64_t)x * sw / out.width);
+            const uint32_t x1 = std::max(x0 + 1, (uint32_t)((uint64_t)(x + 1) * sw / out.width));
+            uint32_t acc[4] = { 0, 0, 0, 0 };
+            for (uint32_t sy = y0; sy < y1; ++sy)
+            {
+                const uint8_t* s = src.row(sy) + size_t(x0) * 4;
+                for (uint32_t sx = x0; sx < x1; ++sx, s += 4)
+                    for (int c = 0; c < 4; ++c) acc[c] += s[c];
+            }
+            const uint32_t n = (y1 - y0) * (x1 - x0);
+            for (int c = 0; c < 4; ++c) d[c] = (uint8_t)((acc[c] + n / 2) / n);
+        }
+    }
+}
+
+bool juiced::decodeThumb(const TextureHdr& h, const BYTE* body, size_t size,
+                         uint32_t edge, RawImage& out)
+{
+    D8W_TRACE_SCOPE("decodeThumb");
+    if (!dxt::canDecode(h.type) || !h.width || !h.height || !body) return false;
+
+    /* skip the levels above the one we want */
+    const uint32_t level = thumbLevel(h, edge);
+    size_t off = 0;
+    for (uint32_t l = 0; l < level; ++l)
+        off += bc::levelBytes(h.type, std::max(1u, h.width >> l), std::max(1u, h.height >> l));
+    if (off >= size) return false;
+
+    RawImage lv;
+    lv.width  = std::max(1u, h.width  >> level);
+    lv.height = std::max(1u, h.height >> level);
+    lv.bgra.resize(size_t(lv.width) * lv.height * 4);
+    if (!dxt::decodeSurface(h.type, body + off, size - off, lv.width, lv.height, lv.bgra.data(), 1))
+        return false;
+
+    fitThumb(lv, edge, out);
+    return true;
+}
+
+/* ─────────────────────────────────────────────────────────────
+                           ThumbCache
+   ───────────────────────────────────────────────────────────── */
+ThumbCache::ThumbCache(const Decoder& decode, const Notify& ready,
+                       size_t budgetBytes, unsigned threads)
+    : decode_(decode), ready_(ready), budget_(budgetBytes), bytes_(0),
+      gen_(0), stop_(false)
+{
+    if (!threads) threads = std::max(1u, hardwareThreads() - 1);   /* leave the UI a core */
+    for (unsigned i = 0; i < threads; ++i)
+        workers_.push_back(std::thread(&ThumbCache::run, this));
+}
+
+ThumbCache::~ThumbCache()
+{
+    {
+        std::lock_guard<std::mutex> g(m_);
+        stop_ = true;
+        queue_.clear();
+    }
+    cv_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) workers_[i].join();
+}
+
+ThumbCache::Thumb ThumbCache::lookup(uint64_t key)
+{
+    std::lock_guard<std::mutex> g(m_);
+    std::map<uint64_t, Entry>::iterator it = cache_.find(key);
+    if (it == cache_.end()) return Thumb();
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.img;
+}
+
+void ThumbCache::want(const std::vector<uint64_t>& keys)
+{
+    {
+        std::lock_guard<std::mutex> g(m_);
+        queue_.clear();
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (!cache_.count(keys[i]) && !busy_.count(keys[i])) queue_.push_back(keys[i]);
+    }
+    cv_.notify_all();
+}
+
+void ThumbCache::clear()
+{
+    std::unique_lock<std::mutex> g(m_);
+    ++gen_;
+    queue_.clear();
+    idle_.wait(g, [this]{ return busy_.empty(); });
+    cache_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+size_t ThumbCache::bytes() const
+{
+    std::lock_guard<std::mutex> g(m_);
+    return bytes_;
+}
+
+void ThumbCache::evict()
+{
+    while (bytes_ > budget_ && !lru_.empty())
+    {
+        std::map<uint64_t, Entry>::iterator it = cache_.find(lru_.back());
+        bytes_ -= it->second.img->bgra.size();
+        cache_.erase(it);
+        lru_.pop_back();
+    }
+}
+
+void ThumbCache::run()
+{
+    for (;;)
+    {
+        uint64_t key;
+        unsigned gen;
+        {
+            std::unique_lock<std::mutex> g(m_);
+            cv_.wait(g, [this]{ return stop_ || !queue_.empty(); });
+            if (stop_) return;
+            key = queue_.front();
+            queue_.pop_front();
+            busy_.insert(key);
+            gen = gen_;
+        }
+
+        std::shared_ptr<RawImage> img(new RawImage);
+        if (!decode_(key, *img)) *img = RawImage();          /* failed: cached empty */
+
+        bool fresh;
+        {
+            std::lock_guard<std::mutex> g(m_);
+            busy_.erase(key);
+            fresh = gen == gen_ && !cache_.count(key);
+            if (fresh)
+            {
+                lru_.push_front(key);
+                Entry e = { img, lru_.begin() };
+                cache_[key] = e;
+                bytes_ += img->bgra.size();
+                evict();
+            }
+        }
+        idle_.notify_all();
+        if (fresh && ready_) ready_(key);
+    }
+}
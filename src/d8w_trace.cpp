@@ -0,0 +1,191 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_trace.cpp  –  event store, Chrome JSON and summary output
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_trace.h"
+#include "d8w_json.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace juiced;
+
+std::atomic<bool> trace::gOn(false);
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+struct Event
+{
+    const char* name;
+    uint64_t    ts, dur;                    /* µs */
+    uint32_t    tid;
+};
+
+enum { kMaxEvents = 1 << 22 };              /* ~128 MB worst case, then drop */
+
+std::atomic<uint64_t> gCounters[trace::kCounterCount];
+std::atomic<uint32_t> gNextTid(1);
+std::atomic<uint64_t> gDropped(0);
+std::mutex            gLock;
+std::vector<Event>    gEvents;
+
+static const Clock::time_point& epoch()
+{
+    static const Clock::time_point t0 = Clock::now();
+    return t0;
+}
+
+static uint32_t threadId()
+{
+    static thread_local uint32_t id = 0;
+    if (!id) id = gNextTid.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+static const char* const kCounterNames[trace::kCounterCount] =
+{
+    "bytesRead", "bytesWritten", "spliceCalls", "spliceMoved", "indexRebuilds", "indexRefs"
+};
+
+} // anon
+
+void trace::enable(bool on)
+{
+    epoch();                                /* pin the epoch before the first scope */
+    gOn.store(on, std::memory_order_relaxed);
+}
+
+void trace::reset()
+{
+    std::lock_guard<std::mutex> lk(gLock);
+    gEvents.clear();
+    gDropped = 0;
+    for (int c = 0; c < kCounterCount; ++c) gCounters[c] = 0;
+}
+
+void trace::add(Counter c, uint64_t n)
+{
+    gCounters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t trace::value(Counter c)
+{
+    return gCounters[c].load(std::memory_order_relaxed);
+}
+
+const char* trace::counterName(Counter c)
+{
+    return c < kCounterCount ? kCounterNames[c] : "?";
+}
+
+uint64_t trace::Scope::now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               Clock::now() - epoch()).count();
+}
+
+void trace::Scope::close()
+{
+    const Event e = { name_, t0_, now() - t0_, threadId() };
+    std::lock_guard<std::mutex> lk(gLock);
+    if (gEvents.size() < kMaxEvents) gEvents.push_back(e);
+    else                             ++gDropped;
+}
+
+bool trace::writeChrome(const std::string& path)
+{
+    std::vector<Event> ev;
+    {
+        std::lock_guard<std::mutex> lk(gLock);
+        ev = gEvents;
+    }
+
+    std::string out = "{\"traceEvents\":[\n";
+    uint64_t    end = 0;
+    char        buf[160];
+    for (size_t i = 0; i < ev.size(); ++i)
+    {
+        out += "{\"name\":";
+        json::quote(ev[i].name, out);
+        std::snprintf(buf, sizeof(buf),
+                      ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu},\n",
+                      ev[i].tid, (unsigned long long)ev[i].ts, (unsigned long long)ev[i].dur);
+        out += buf;
+        end = std::max(end, ev[i].ts + ev[i].dur);
+    }
+    for (int c = 0; c < kCounterCount; ++c)
+    {
+        std::snprintf(buf, sizeof(buf),
+                      "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%llu,\"args\":{\"value\":%llu}}%s\n",
+                      kCounterNames[c], (unsigned long long)end,
+                      (unsigned long long)value((Counter)c), c + 1 < kCounterCount ? "," : "");
+        out += buf;
+    }
+    std::snprintf(buf, sizeof(buf), "],\"otherData\":{\"dropped\":%llu}}\n",
+                  (unsigned long long)gDropped.load());
+    out += buf;
+
+    if (path == "-") { std::fwrite(out.data(), 1, out.size(), stdout); return true; }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+std::string trace::summary()
+{
+    struct Agg { uint64_t calls, total, max; };
+    std::map<std::string, Agg> by;
+    {
+        std::lock_guard<std::mutex> lk(gLock);
+        for (size_t i = 0; i < gEvents.size(); ++i)
+        {
+            Agg& a = by[gEvents[i].name];
+            ++a.calls;
+            a.total += gEvents[i].dur;
+            a.max    = std::max(a.max, gEvents[i].dur);
+        }
+    }
+
+    std::vector< std::pair<std::string, Agg> > rows(by.begin(), by.end());
+    std::sort(rows.begin(), rows.end(), [](const std::pair<std::string, Agg>& a,
+                                           const std::pair<std::string, Agg>& b)
+    {
+        return a.second.total > b.second.total;
+    });
+
+    std::string out;
+    char        buf[160];
+    std::snprintf(buf, sizeof(buf), "%-28s %8s %12s %10s %10s\n",
+                  "scope", "calls", "total ms", "mean ms", "max ms");
+    out += buf;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        const Agg& a = rows[i].second;
+        std::snprintf(buf, sizeof(buf), "%-28s %8llu %12.3f %10.3f %10.3f\n",
+                      rows[i].first.c_str(), (unsigned long long)a.calls,
+                      a.total / 1000.0, a.total / 1000.0 / a.calls, a.max / 1000.0);
+        out += buf;
+    }
+    out += "\n";
+    for (int c = 0; c < kCounterCount; ++c)
+    {
+        std::snprintf(buf, sizeof(buf), "%-28s %llu\n",
+                      kCounterNames[c], (unsigned long long)value((Counter)c));
+        out += buf;
+    }
+    if (gDropped.load())
+    {
+        std::snprintf(buf, sizeof(buf), "%-28s %llu\n", "droppedEvents",
+                      (unsigned long long)gDropped.load());
+        out += buf;
+    }
+    return out;
+}
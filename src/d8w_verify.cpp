@@ -0,0 +1,290 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_verify.cpp  –  -verify: extent checks + parallel checksums
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_verify.h"
+#include "d8w_io.h"
+#include "d8w_parser.h"
+#include "d8w_platform.h"
+#include "d8w_trace.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+
+using namespace juiced;
+
+namespace
+{
+
+/* one texture body in the .d8t, offsets kept in 64 bits so a
+   wrapped 32-bit absOff shows up instead of aliasing           */
+struct Extent
+{
+    uint64_t off;
+    uint32_t size;
+    uint32_t bank, pack, idx;
+    size_t   uniq;                  /* slot in the distinct-extent list */
+};
+
+struct Sum
+{
+    uint32_t size;
+    uint64_t hash;
+};
+
+typedef std::map<std::string, Sum> Manifest;    /* "<name> <pack> <idx>" */
+
+static void problem(VerifyReport& r, const char* fmt, ...)
+{
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    r.problems.push_back(buf);
+}
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static std::string keyOf(const std::string& name, uint32_t pack, uint32_t idx)
+{
+    std::string k = name;
+    for (size_t i = 0; i < k.size(); ++i)
+        if (k[i] >= 'A' && k[i] <= 'Z') k[i] = char(k[i] + ('a' - 'A'));
+    char tail[32];
+    std::snprintf(tail, sizeof(tail), " %u %u", pack, idx);
+    return k + tail;
+}
+
+static bool readManifest(const std::string& path, Manifest& m)
+{
+    std::vector<BYTE> buf;
+    if (!plat::readFile(path, buf, uint64_t(1) << 30))
+        return setError("cannot read manifest %s", path.c_str());
+
+    const std::string text(buf.begin(), buf.end());
+    size_t line = 0, at = 0;
+    while (at < text.size())
+    {
+        size_t eol = text.find('\n', at);
+        if (eol == std::string::npos) eol = text.size();
+        std::string l = text.substr(at, eol - at);
+        at = eol + 1;
+        ++line;
+
+        if (!l.empty() && l[l.size() - 1] == '\r') l.erase(l.size() - 1);
+        const size_t first = l.find_first_not_of(" \t");
+        if (first == std::string::npos || l[first] == '#') continue;
+
+        char name[260];
+        unsigned pack, idx, size;
+        char hex[32];
+        if (std::sscanf(l.c_str(), "%259s %u %u %u %31s", name, &pack, &idx, &size, hex) != 5)
+            return setError("%s:%u: malformed manifest line", path.c_str(), (unsigned)line);
+
+        char* end = 0;
+        const unsigned long long h = std::strtoull(hex, &end, 16);
+        if (*end) return setError("%s:%u: bad checksum", path.c_str(), (unsigned)line);
+
+        Sum s = { size, (uint64_t)h };
+        m[keyOf(name, pack, idx)] = s;
+    }
+    return true;
+}
+
+} // anon
+
+bool juiced::verifyArchive(const std::string& d8tPath,
+                           const std::vector<std::string>& d8wPaths,
+                           const VerifyOptions& opt, VerifyReport& r)
+{
+    D8W_TRACE_SCOPE("verifyArchive");
+    StatusScope st("verify");
+    r = VerifyReport();
+
+    plat::FileInfo fi;
+    if (!plat::fileInfo(d8tPath, fi)) return setError("cannot stat %s", d8tPath.c_str());
+    r.d8tBytes = fi.size;
+
+    Manifest stored;
+    if (!opt.manifestIn.empty() && !readManifest(opt.manifestIn, stored)) return false;
+
+    /* ── 1. banks, against an empty .d8t buffer (headers only) ── */
+    const std::vector<BYTE> none;
+    D8WContext ctx;                                        /* outlives banks */
+    std::vector< std::unique_ptr<D8WBank> > banks;
+    std::vector<std::string> names;
+    std::vector<Extent> ext;
+
+    for (size_t b = 0; b < d8wPaths.size(); ++b)
+    {
+        const std::string name = baseName(d8wPaths[b]);
+        std::unique_ptr<D8WBank> bank(new D8WBank(ctx));
+        if (!bank->load(d8wPaths[b], none))
+        {
+            problem(r, "%s: %s", name.c_str(), bank->lastError().c_str());
+            continue;
+        }
+
+        /* ── 2. table / texture extents ───────────────────────── */
+        const std::vector<TextureTable>& tbls = bank->tables();
+        uint64_t cursor = 0;
+        for (size_t p = 0; p < tbls.size(); ++p)
+        {
+            const TextureTable& t = tbls[p];
+            cursor += t.skip;
+            const uint64_t tEnd = cursor + t.size;
+
+            if (cursor != t.absOff)
+                problem(r, "%s pack %u: table offset %llu wraps the 32-bit range",
+                        name.c_str(), (unsigned)p, (unsigned long long)cursor);
+            const bool inside = tEnd <= r.d8tBytes;
+            if (!inside)
+                problem(r, "%s pack %u: table [%llu, %llu) past end of .d8t (%llu bytes)",
+                        name.c_str(), (unsigned)p, (unsigned long long)cursor,
+                        (unsigned long long)tEnd, (unsigned long long)r.d8tBytes);
+
+            uint64_t off = cursor;
+            for (size_t i = 0; i < t.tex.size(); ++i)
+            {
+                const uint32_t sz = t.tex[i].size;
+                if (inside && off + sz > r.d8tBytes)
+                    problem(r, "%s pack %u idx %u: body [%llu, %llu) past end of .d8t",
+                            name.c_str(), (unsigned)p, (unsigned)i,
+                            (unsigned long long)off, (unsigned long long)(off + sz));
+                else if (inside)
+                {
+                    Extent e = { off, sz, (uint32_t)names.size(), (uint32_t)p, (uint32_t)i, 0 };
+                    ext.push_back(e);
+                }
+                off += sz;
+                ++r.textures;
+            }
+            if (off > tEnd)
+                problem(r, "%s pack %u: textures need %llu bytes, table holds %u",
+                        name.c_str(), (unsigned)p, (unsigned long long)(off - cursor), t.size);
+
+            cursor = tEnd;
+            ++r.tables;
+        }
+
+        names.push_back(name);
+        banks.push_back(std::move(bank));
+        ++r.banks;
+    }
+
+    /* ── 3. ordering: overlaps across all banks, gap bytes ─────── */
+    std::vector<size_t> order(ext.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        return ext[a].off != ext[b].off ? ext[a].off < ext[b].off : ext[a].size < ext[b].size;
+    });
+
+    std::vector<const Extent*> uniq;                       /* distinct (off, size) */
+    uint64_t hi = 0;                                       /* covered up to here   */
+    const Extent* owner = 0;                               /* … by this extent     */
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        Extent& e = ext[order[k]];
+        const Extent* prev = uniq.empty() ? 0 : uniq.back();
+        if (prev && prev->off == e.off && prev->size == e.size)
+        {
+            e.uniq = uniq.size() - 1;                      /* shared body */
+            continue;
+        }
+        e.uniq = uniq.size();
+        uniq.push_back(&e);
+        if (e.size == 0) continue;
+
+        if (e.off < hi)
+            problem(r, "%s pack %u idx %u [%llu, %llu) overlaps %s pack %u idx %u [%llu, %llu)",
+                    names[e.bank].c_str(), e.pack, e.idx,
+                    (unsigned long long)e.off, (unsigned long long)(e.off + e.size),
+                    names[owner->bank].c_str(), owner->pack, owner->idx,
+                    (unsigned long long)owner->off,
+                    (unsigned long long)(owner->off + owner->size));
+        else
+            r.gapBytes += e.off - hi;
+
+        if (e.off + e.size > hi) { hi = e.off + e.size; owner = &e; }
+    }
+    if (hi < r.d8tBytes) r.gapBytes += r.d8tBytes - hi;
+    r.extents = uniq.size();
+
+    if (!opt.checksums) return true;
+
+    /* ── 4. checksums: offset-ordered reads, hashed on all cores ── */
+    std::vector<uint64_t> sums;
+    std::vector<char>     have;
+    {
+        std::vector<FileExtent> fe(uniq.size());
+        for (size_t u = 0; u < uniq.size(); ++u) fe[u] = FileExtent(uniq[u]->off, uniq[u]->size);
+
+        IoStats     io;
+        std::string why;
+        hashExtents(d8tPath, fe, sums, have, opt.threads, &io, &why);
+        for (size_t u = 0; u < uniq.size(); ++u)
+            if (!have[u])
+                problem(r, "%s pack %u idx %u: read failed (%s)",
+                        names[uniq[u]->bank].c_str(), uniq[u]->pack, uniq[u]->idx, why.c_str());
+        r.bytesHashed = io.bytesWanted;
+    }
+
+    /* ── 5. manifest: compare and / or write, in bank order ─────── */
+    std::vector<size_t> byBank(order);
+    std::sort(byBank.begin(), byBank.end(), [&](size_t a, size_t b)
+    {
+        if (ext[a].bank != ext[b].bank) return ext[a].bank < ext[b].bank;
+        return ext[a].pack != ext[b].pack ? ext[a].pack < ext[b].pack : ext[a].idx < ext[b].idx;
+    });
+
+    std::string out = "# d8w verify manifest 1\n";
+    std::map<std::string, bool> seen;
+    for (size_t k = 0; k < byBank.size(); ++k)
+    {
+        const Extent& e = ext[byBank[k]];
+        if (!have[e.uniq]) continue;
+        const std::string& name = names[e.bank];
+        const uint64_t     h    = sums[e.uniq];
+
+        char line[320];
+        std::snprintf(line, sizeof(line), "%s %u %u %u %016llx\n",
+                      name.c_str(), e.pack, e.idx, e.size, (unsigned long long)h);
+        out += line;
+
+        if (opt.manifestIn.empty()) continue;
+        const std::string key = keyOf(name, e.pack, e.idx);
+        Manifest::const_iterator it = stored.find(key);
+        seen[key] = true;
+        if (it == stored.end())
+            problem(r, "%s pack %u idx %u: not in manifest", name.c_str(), e.pack, e.idx);
+        else if (it->second.size != e.size || it->second.hash != h)
+            problem(r, "%s pack %u idx %u: checksum %016llx (%u bytes), manifest has %016llx (%u bytes)",
+                    name.c_str(), e.pack, e.idx, (unsigned long long)h, e.size,
+                    (unsigned long long)it->second.hash, it->second.size);
+    }
+
+    /* textures the manifest lists but this archive no longer has –
+       banks that failed to load are already reported above        */
+    std::map<std::string, bool> loaded;
+    for (size_t b = 0; b < names.size(); ++b) loaded[keyOf(names[b], 0, 0)] = true;
+    for (Manifest::const_iterator it = stored.begin(); it != stored.end(); ++it)
+    {
+        if (seen.count(it->first)) continue;
+        const std::string bank = it->first.substr(0, it->first.find(' '));
+        if (loaded.count(keyOf(bank, 0, 0)))
+            problem(r, "%s: in manifest, missing from archive", it->first.c_str());
+    }
+
+    if (!opt.manifestOut.empty() && !plat::writeFile(opt.manifestOut, out.data(), out.size()))
+        return setError("cannot write manifest %s", opt.manifestOut.c_str());
+    return true;
+}
@@ -0,0 +1,361 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_imageio_test.cpp  –  PNG / TGA / zlib codecs
+
+   Encode → decode has to give the pixels (bytes) back exactly –
+   ATI2 to within its block error, X and Y in the bytes the
+   preview shows them in; every truncation and every flipped
+   byte of a file has to come back as an error – these decoders see whatever a modder drops
+   into the import folder.
+  ──────────────────────────────────────────────────────────────*/
+#include "BCEncoder.h"
+#include "BlockDecode.h"
+#include "ImageIO.h"
+#include "MipGen.h"
+#include "Zlib.h"
+#include "d8w_test.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace juiced;
+
+namespace
+{
+
+static uint32_t gSeed = 26;
+
+static uint8_t next()
+{
+    gSeed = gSeed * 1664525u + 1013904223u;
+    return uint8_t(gSeed >> 24);
+}
+
+/* noise with a few flat runs, so RLE / filters have something to find */
+static RawImage makeImage(uint32_t w, uint32_t h)
+{
+    RawImage img;
+    img.width  = w;
+    img.height = h;
+    img.bgra.resize(size_t(w) * h * 4);
+    for (size_t k = 0; k < img.bgra.size(); k += 4)
+    {
+        if (k && (k / 4) % 5 < 2) std::memcpy(&img.bgra[k], &img.bgra[k - 4], 4);
+        else for (int c = 0; c < 4; ++c) img.bgra[k + c] = next();
+    }
+    return img;
+}
+
+static bool samePixels(const RawImage& a, const RawImage& b)
+{
+    return a.width == b.width && a.height == b.height && a.bgra == b.bgra;
+}
+
+static void put16(std::vector<uint8_t>& v, unsigned x)
+{
+    v.push_back(uint8_t(x));
+    v.push_back(uint8_t(x >> 8));
+}
+
+static std::vector<uint8_t> tgaHeader(unsigned type, unsigned w, unsigned h,
+                                      unsigned depth, unsigned desc)
+{
+    std::vector<uint8_t> v(12, 0);
+    v[2] = uint8_t(type);
+    put16(v, w);
+    put16(v, h);
+    v.push_back(uint8_t(depth));
+    v.push_back(uint8_t(desc));
+    return v;
+}
+
+/* IHDR field rewritten and its CRC fixed: a well-formed chunk with a bad value */
+static std::vector<uint8_t> withIHDR(std::vector<uint8_t> png, size_t field, uint8_t value)
+{
+    png[16 + field] = value;
+    const uint32_t crc = zlib::crc32(&png[12], 17);
+    for (int i = 0; i < 4; ++i) png[29 + i] = uint8_t(crc >> (24 - 8 * i));
+    return png;
+}
+
+static void zlibRoundTrip()
+{
+    std::vector< std::vector<uint8_t> > inputs(3);
+    for (size_t k = 0; k < 100000; ++k) inputs[1].push_back(next());
+    const char* text = "Tex00003.ddt DXT5 64x64 mips 7 ";
+    while (inputs[2].size() < 200000) inputs[2].insert(inputs[2].end(), text, text + std::strlen(text));
+
+    for (size_t d = 0; d < inputs.size(); ++d)
+        for (int level = 0; level <= 9; ++level)
+        {
+            const std::vector<uint8_t>& in = inputs[d];
+            const uint8_t* src = in.empty() ? 0 : &in[0];
+
+            std::vector<uint8_t> z, back;
+            zlib::deflate(src, in.size(), z, level);
+            CHECK(zlib::inflate(&z[0], z.size(), back, in.size()));
+            CHECK(back == in);
+
+            std::vector<uint8_t> raw, back2;
+            zlib::deflateRaw(src, in.size(), raw, level);
+            CHECK(zlib::inflateRaw(&raw[0], raw.size(), back2));
+            CHECK(back2 == in);
+        }
+
+    /* cut anywhere or trailer wrong → no stream */
+    std::vector<uint8_t> z;
+    zlib::deflate(&inputs[2][0], 5000, z, 6);
+    for (size_t n = 0; n < z.size(); ++n)
+    {
+        std::vector<uint8_t> out;
+        CHECK(!zlib::inflate(&z[0], n, out));
+    }
+    std::vector<uint8_t> out;
+    z.back() ^= 0x01;
+    CHECK(!zlib::inflate(&z[0], z.size(), out));
+}
+
+static void pngRoundTrip()
+{
+    const uint32_t dims[][2] = { { 1, 1 }, { 7, 3 }, { 37, 23 }, { 64, 64 } };
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d)
+        for (int level = 0; level <= 9; level += 3)
+        {
+            const RawImage img = makeImage(dims[d][0], dims[d][1]);
+            std::vector<uint8_t> png;
+            encodePNG(img, png, level);
+            CHECK(isPNG(&png[0], png.size()));
+
+            RawImage    back;
+            std::string err;
+            CHECK(decodePNG(&png[0], png.size(), back, err));
+            CHECK(samePixels(img, back));
+
+            RawImage viaName;
+            CHECK(decodeImage(&png[0], png.size(), "Tex00001.png", viaName, err));
+            CHECK(samePixels(img, viaName));
+        }
+}
+
+static void pngDamaged()
+{
+    const RawImage img = makeImage(37, 23);
+    std::vector<uint8_t> png;
+    encodePNG(img, png, 6);
+
+    RawImage    out;
+    std::string err;
+    for (size_t n = 0; n + 12 < png.size(); ++n)              /* up to IEND */
+    {
+        err.clear();
+        CHECK(!decodePNG(&png[0], n, out, err));
+        CHECK(!err.empty());
+    }
+    for (size_t k = 0; k < png.size(); ++k)
+    {
+        std::vector<uint8_t> bad = png;
+        bad[k] ^= 0x01;
+        if (decodePNG(&bad[0], bad.size(), out, err))
+        {
+            std::fprintf(stderr, "PNG with byte %u flipped decoded\n", (unsigned)k);
+            CHECK(false);
+        }
+    }
+
+    /* well-formed chunks, values the decoder can't take */
+    CHECK(!decodePNG(&withIHDR(png, 0, 0x80)[0], png.size(), out, err));   /* width ≥ 2^31 */
+    CHECK(!decodePNG(&withIHDR(png, 1, 0x01)[0], png.size(), out, err));   /* 65573 wide   */
+    std::vector<uint8_t> zero = withIHDR(withIHDR(png, 2, 0), 3, 0);
+    CHECK(!decodePNG(&zero[0], zero.size(), out, err));                   /* width 0      */
+    CHECK(!decodePNG(&withIHDR(png, 8, 3)[0],    png.size(), out, err));   /* depth 3      */
+    CHECK(!decodePNG(&withIHDR(png, 9, 5)[0],    png.size(), out, err));   /* colour 5     */
+    CHECK(!decodePNG(&withIHDR(png, 12, 2)[0],   png.size(), out, err));   /* interlace 2  */
+}
+
+static void tgaRoundTrip()
+{
+    const uint32_t dims[][2] = { { 1, 1 }, { 7, 3 }, { 37, 23 }, { 64, 64 } };
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); ++d)
+    {
+        const RawImage img = makeImage(dims[d][0], dims[d][1]);
+        std::vector<uint8_t> tga;
+        encodeTGA(img, tga);
+
+        RawImage    back;
+        std::string err;
+        CHECK(decodeTGA(&tga[0], tga.size(), back, err));
+        CHECK(samePixels(img, back));
+
+        RawImage viaName;
+        CHECK(decodeImage(&tga[0], tga.size(), "Tex00001.tga", viaName, err));
+        CHECK(samePixels(img, viaName));
+    }
+
+    /* RLE, 32-bit, top-left: runs and literals, packets across rows */
+    const RawImage img = makeImage(13, 5);
+    std::vector<uint8_t> rle = tgaHeader(10, 13, 5, 32, 0x28);
+    const size_t npx = size_t(img.width) * img.height;
+    for (size_t i = 0; i < npx; )
+    {
+        size_t run = 1;
+        while (i + run < npx && run < 128 &&
+               !std::memcmp(&img.bgra[(i + run) * 4], &img.bgra[i * 4], 4)) ++run;
+        if (run > 1)
+        {
+            rle.push_back(uint8_t(0x80 | (run - 1)));
+            rle.insert(rle.end(), &img.bgra[i * 4], &img.bgra[i * 4] + 4);
+        }
+        else
+        {
+            rle.push_back(0);
+            rle.insert(rle.end(), &img.bgra[i * 4], &img.bgra[i * 4] + 4);
+        }
+        i += run;
+    }
+    RawImage    back;
+    std::string err;
+    CHECK(decodeTGA(&rle[0], rle.size(), back, err));
+    CHECK(samePixels(img, back));
+
+    for (size_t n = 0; n < rle.size(); ++n)
+        CHECK(!decodeTGA(&rle[0], n, back, err));
+}
+
+static void tgaDamaged()
+{
+    const RawImage img = makeImage(37, 23);
+    std::vector<uint8_t> tga;
+    encodeTGA(img, tga);
+
+    RawImage    out;
+    std::string err;
+    for (size_t n = 0; n < tga.size(); ++n)
+    {
+        err.clear();
+        CHECK(!decodeTGA(&tga[0], n, out, err));
+        CHECK(!err.empty());
+    }
+
+    const unsigned badTypes[] = { 0, 4, 8, 12, 255 };
+    for (size_t k = 0; k < sizeof(badTypes) / sizeof(badTypes[0]); ++k)
+    {
+        std::vector<uint8_t> bad = tga;
+        bad[2] = uint8_t(badTypes[k]);
+        CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+    }
+    std::vector<uint8_t> bad = tga;
+    bad[12] = bad[13] = 0;                                    /* width 0      */
+    CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+    bad = tga;
+    bad[16] = 12;                                             /* depth 12     */
+    CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+    bad = tga;
+    bad[2] = 1;                                               /* no colour map */
+    CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+    bad = tga;
+    bad[0] = 255;                                             /* id runs into pixels */
+    CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+    bad = tga;
+    bad[14] = 0xFF; bad[15] = 0xFF;                           /* 65535 rows   */
+    CHECK(!decodeTGA(&bad[0], bad.size(), out, err));
+}
+
+/* largest difference in the X (byte 0) and Y (byte 1) of two images */
+static int xyError(const RawImage& a, const RawImage& b)
+{
+    int worst = 0;
+    for (size_t k = 0; k < a.bgra.size(); k += 4)
+        for (int c = 0; c < 2; ++c)
+        {
+            const int d = (int)a.bgra[k + c] - (int)b.bgra[k + c];
+            worst = std::max(worst, d < 0 ? -d : d);
+        }
+    return worst;
+}
+
+static void ati2Encode(const RawImage& img, std::vector<uint8_t>& body)
+{
+    body.resize(bc::levelBytes(bc::kTypeATI2, img.width, img.height));
+    bc::encodeSurface(&img.bgra[0], img.width, img.height, bc::kTypeATI2, bc::kNormal, &body[0]);
+}
+
+static bool ati2Decode(const std::vector<uint8_t>& body, uint32_t w, uint32_t h, RawImage& out)
+{
+    out.width  = w;
+    out.height = h;
+    out.bgra.assign(size_t(w) * h * 4, 0);
+    return dxt::decodeSurface(bc::kTypeATI2, &body[0], body.size(), w, h, &out.bgra[0]);
+}
+
+/* 64x64 normal map: X in byte 0, Y in byte 1, the rest filler */
+static RawImage normalMap()
+{
+    RawImage img;
+    img.width = img.height = 64;
+    img.bgra.resize(64 * 64 * 4);
+    for (uint32_t y = 0; y < 64; ++y)
+        for (uint32_t x = 0; x < 64; ++x)
+        {
+            uint8_t* p = img.row(y) + x * 4;
+            p[0] = uint8_t(x * 4); p[1] = uint8_t(255 - y * 4); p[2] = 127; p[3] = 255;
+        }
+    return img;
+}
+
+/* the way convertTexture writes it to PNG and an import reads it back */
+static void ati2PngRoundTrip()
+{
+    const RawImage img = normalMap();
+
+    std::vector<uint8_t> png;
+    encodePNG(img, png, 1);
+    RawImage    fromPng, back;
+    std::string err;
+    CHECK(decodePNG(&png[0], png.size(), fromPng, err));
+
+    std::vector<uint8_t> body;
+    ati2Encode(fromPng, body);
+    CHECK(ati2Decode(body, 64, 64, back));
+    CHECK(xyError(img, back) <= 4);
+}
+
+/* FitMipChain: decode the smallest stored level, build the missing
+   ones from it and encode them again                               */
+static void ati2Regenerate()
+{
+    const RawImage src = normalMap();
+    std::vector<uint8_t> body, again, next;
+    ati2Encode(src, body);
+
+    RawImage first, second;
+    CHECK(ati2Decode(body, 64, 64, first));
+    ati2Encode(first, again);
+    CHECK(ati2Decode(again, 64, 64, second));
+    CHECK(xyError(first, second) <= 4);
+    CHECK(xyError(src, second) <= 8);
+
+    std::vector<RawImage> chain;
+    buildMipChain(first, 2, kMipBox, chain);
+    CHECK(chain.size() == 1 && chain[0].width == 32 && chain[0].height == 32);
+    if (chain.size() != 1) return;
+
+    RawImage mip;
+    ati2Encode(chain[0], next);
+    CHECK(ati2Decode(next, 32, 32, mip));
+    CHECK(xyError(chain[0], mip) <= 4);
+}
+
+} // anon
+
+int main()
+{
+    zlibRoundTrip();
+    pngRoundTrip();
+    pngDamaged();
+    tgaRoundTrip();
+    tgaDamaged();
+    ati2PngRoundTrip();
+    ati2Regenerate();
+    return test::result();
+}
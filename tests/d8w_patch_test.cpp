@@ -0,0 +1,225 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_patch_test.cpp  –  .d8p round trip and damaged patches
+
+   usage: d8w_patch_test [<scratch dir>]
+
+   Two identical synthetic archives; a few imports turn the
+   second into the mod.  The patch made between them has to
+   rebuild the mod byte for byte – into a folder and in place –
+   and a truncated or corrupt .d8p has to fail without touching
+   the archive it was pointed at.
+  ──────────────────────────────────────────────────────────────*/
+#include "Zlib.h"
+#include "d8w_archive.h"
+#include "d8w_patch.h"
+#include "d8w_synth.h"
+#include "d8w_test.h"
+
+#include <string>
+#include <vector>
+
+using namespace juiced;
+
+namespace
+{
+
+static synth::Spec spec()
+{
+    synth::Spec s;
+    s.packs      = 4;
+    s.texPerPack = 6;
+    s.minSize    = 16;
+    s.maxSize    = 64;
+    s.banks      = 2;
+    s.shared     = 0.5;
+    s.seed       = 38;
+    return s;
+}
+
+static bool generate(const std::string& dir, synth::Corpus& c)
+{
+    std::string err;
+    if (!test::freshDir(dir)) return false;
+    if (synth::write(spec(), dir, "arc", &c, &err)) return true;
+    std::fprintf(stderr, "synth: %s\n", err.c_str());
+    return false;
+}
+
+/* every file of the archive, by name */
+static std::vector<std::string> files(const synth::Corpus& c)
+{
+    std::vector<std::string> v(1, c.d8t);
+    v.insert(v.end(), c.d8w.begin(), c.d8w.end());
+    return v;
+}
+
+static std::string baseName(const std::string& p)
+{
+    const size_t s = p.find_last_of("\\/");
+    return s == std::string::npos ? p : p.substr(s + 1);
+}
+
+static bool sameFiles(const synth::Corpus& a, const std::string& dirB)
+{
+    const std::vector<std::string> fa = files(a);
+    for (size_t k = 0; k < fa.size(); ++k)
+    {
+        const std::vector<BYTE> x = test::slurp(fa[k]);
+        const std::vector<BYTE> y = test::slurp(plat::join(dirB, baseName(fa[k])));
+        if (x.empty() || x != y)
+        {
+            std::fprintf(stderr, "%s differs\n", baseName(fa[k]).c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/* bodies swapped between slots of every pack – sizes and formats change */
+static bool modify(const synth::Corpus& c, const std::string& scratch)
+{
+    Archive arc;
+    if (!arc.open(c.d8t)) return false;
+
+    for (size_t b = 0; b < arc.bankCount(); ++b)
+    {
+        D8WBank* bank = arc.bankAt(b);
+        for (size_t p = 0; p < bank->texturePackCount(); ++p)
+        {
+            if (bank->textureCount(p) < 4 || (p + b) % 2) continue;
+            const std::string ddt = plat::join(scratch, "swap.ddt");
+            if (!bank->exportTexture(p, 3, ddt) || !bank->importTexture(p, b, ddt))
+                return false;
+        }
+    }
+    return arc.isDirty() && arc.save();
+}
+
+static uint32_t get32(const std::vector<BYTE>& v, size_t at)
+{
+    return (uint32_t)v[at] | (uint32_t)v[at + 1] << 8 | (uint32_t)v[at + 2] << 16 |
+           (uint32_t)v[at + 3] << 24;
+}
+
+static void set32(std::vector<BYTE>& v, size_t at, uint32_t x)
+{
+    for (int i = 0; i < 4; ++i) v[at + i] = BYTE(x >> (8 * i));
+}
+
+/* the patch cut down to its first body, re-flagged as stored with
+   4 payload bytes for a 1 MB body.  The mod's banks go in embedded so
+   nothing before the .d8t pass notices – the parser has to refuse it */
+static std::vector<BYTE> oversized(const std::vector<BYTE>& good, const std::string& modDir)
+{
+    std::vector<BYTE> v(good.begin(), good.begin() + 48);  /* magic … counts */
+    set32(v, 44, 1);                                        /* one body      */
+
+    size_t at = 48;
+    for (uint32_t i = get32(good, 40); i; --i)
+    {
+        if (at + 4 > good.size()) return std::vector<BYTE>();
+        const size_t n = get32(good, at);
+        if (at + 4 + n + 36 > good.size()) return std::vector<BYTE>();
+        const std::string name((const char*)&good[at + 4], n);
+        v.insert(v.end(), good.begin() + at, good.begin() + at + 4 + n + 32);
+        at += 4 + n + 32;
+        at += 4 + get32(good, at);                          /* old embed     */
+
+        const std::vector<BYTE> d8w = test::slurp(plat::join(modDir, name));
+        std::vector<uint8_t> packed;
+        zlib::deflate(d8w.data(), d8w.size(), packed);
+        v.resize(v.size() + 4);
+        set32(v, v.size() - 4, (uint32_t)packed.size());
+        v.insert(v.end(), packed.begin(), packed.end());
+    }
+
+    const size_t rec = 24 + sizeof(TextureHdr);             /* pos … header  */
+    if (at + rec > good.size()) return std::vector<BYTE>();
+    const size_t body = v.size();
+    v.insert(v.end(), good.begin() + at, good.begin() + at + rec);
+    set32(v, body + 8, 1u << 20);                           /* newSize       */
+    set32(v, body + 12, 2);                                 /* kStored       */
+    v.resize(v.size() + 8, 0xAB);
+    set32(v, body + rec, 4);                                /* bytes, payload */
+    return v;
+}
+
+} // anon
+
+int main(int argc, char** argv)
+{
+    const std::string root = argc > 1 ? argv[1] : "d8w_patch_test.tmp";
+    const std::string origDir  = plat::join(root, "orig");
+    const std::string modDir   = plat::join(root, "mod");
+    const std::string outDir   = plat::join(root, "out");
+    const std::string placeDir = plat::join(root, "inplace");
+    const std::string badDir   = plat::join(root, "bad");
+    const std::string patch    = plat::join(root, "mod.d8p");
+    plat::makeDir(root);
+
+    synth::Corpus orig, mod, place, bad;
+    CHECK(generate(origDir, orig));
+    CHECK(generate(modDir, mod));
+    CHECK(modify(mod, root));
+    CHECK(!sameFiles(orig, modDir));
+
+    /* ── make, apply into a folder, apply in place ─────────────── */
+    PatchStats ps;
+    CHECK(makePatch(orig.d8t, mod.d8t, patch, &ps));
+    CHECK(ps.bodies > 0 && ps.banks == orig.d8w.size());
+    CHECK(ps.patchBytes > 0 && ps.patchBytes < mod.d8tBytes);
+
+    CHECK(test::freshDir(outDir));
+    CHECK(applyPatch(patch, orig.d8t, outDir));
+    CHECK(sameFiles(mod, outDir));
+    CHECK(sameFiles(orig, origDir));                       /* source left alone */
+
+    CHECK(generate(placeDir, place));
+    CHECK(applyPatch(patch, place.d8t));
+    CHECK(sameFiles(mod, placeDir));
+
+    /* the mod itself is not what the patch was made from */
+    CHECK(!applyPatch(patch, mod.d8t));
+    CHECK(!lastError().empty());
+    CHECK(sameFiles(mod, modDir));
+
+    /* ── damaged patches: fail, archive untouched, no leftovers ── */
+    const std::vector<BYTE> good = test::slurp(patch);
+    CHECK(good.size() > 64);
+    CHECK(generate(badDir, bad));
+
+    std::vector<std::string> before;
+    plat::listFiles(badDir, before);
+
+    std::vector< std::vector<BYTE> > damaged;
+    damaged.push_back(std::vector<BYTE>());                            /* empty     */
+    damaged.push_back(std::vector<BYTE>(good.begin(), good.begin() + 16));
+    damaged.push_back(std::vector<BYTE>(good.begin(), good.begin() + good.size() / 2));
+    damaged.push_back(std::vector<BYTE>(good.begin(), good.end() - 1));
+    damaged.push_back(good); damaged.back()[0] ^= 0xFF;                 /* magic     */
+    damaged.push_back(good); damaged.back()[4] ^= 0x01;                 /* version   */
+    damaged.push_back(good); damaged.back()[good.size() - 1] ^= 0x5A;   /* payload   */
+    damaged.push_back(good); damaged.back()[good.size() / 2] ^= 0x5A;
+    damaged.push_back(oversized(good, modDir)); CHECK(!damaged.back().empty());
+
+    const std::string broken = plat::join(root, "broken.d8p");
+    for (size_t k = 0; k < damaged.size(); ++k)
+    {
+        const std::vector<BYTE>& d = damaged[k];
+        CHECK(plat::writeFile(broken, d.empty() ? 0 : &d[0], d.size()));
+        if (applyPatch(broken, bad.d8t))
+        {
+            std::fprintf(stderr, "damaged patch #%u applied\n", (unsigned)k);
+            CHECK(false);
+            continue;
+        }
+        CHECK(!lastError().empty());
+        CHECK(sameFiles(bad, origDir));
+
+        std::vector<std::string> after;
+        plat::listFiles(badDir, after);
+        CHECK(after.size() == before.size());                 /* no .d8p-part left */
+    }
+
+    return test::result();
+}
@@ -0,0 +1,54 @@
+#ifndef JUICED_D8W_TEST_H_
+#define JUICED_D8W_TEST_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_test.h  –  bare checks for the ctest programs in tests/
+
+   No framework: a failed CHECK prints file:line and the test
+   keeps going; main returns test::result() so ctest sees every
+   failure of a run, not just the first.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_platform.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+namespace test
+{
+
+inline int& failures() { static int n = 0; return n; }
+
+inline int result()
+{
+    if (failures()) std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return failures() ? 1 : 0;
+}
+
+/* every plain file in dir removed, dir created if missing */
+inline bool freshDir(const std::string& dir)
+{
+    std::vector<std::string> names;
+    if (plat::listFiles(dir, names))
+        for (size_t k = 0; k < names.size(); ++k) plat::removeFile(plat::join(dir, names[k]));
+    return plat::makeDir(dir);
+}
+
+inline std::vector<BYTE> slurp(const std::string& path)
+{
+    std::vector<BYTE> v;
+    plat::readFile(path, v, uint64_t(1) << 32);
+    return v;
+}
+
+}
+}
+
+#define CHECK(c)                                                              \
+    do { if (!(c)) { std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",         \
+                                  __FILE__, __LINE__, #c);                    \
+                     ++juiced::test::failures(); } } while (0)
+
+#endif
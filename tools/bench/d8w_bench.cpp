@@ -0,0 +1,301 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_bench.cpp  –  micro-benchmarks for the parser hot paths
+
+   d8wbench [--packs N] [--tex N] [--size N] [--mips N] [--banks N]
+            [--iters N] [--seed N] [--dir D] [--only <substr>]
+            [--trace <out.json | ->]
+
+   Builds a synthetic bank (tools/common/d8w_synth) in <dir>,
+   then times .d8t read, D8WBank::load, the reference-index
+   rebuild, spliceReplace / importTexture at the head, middle
+   and tail of the .d8t, save, and every block-decode kernel.
+   Each row: p50 / p90 / p99 / max in ms, MB/s and items/s at
+   the median.  --trace also records every instrumented scope
+   (d8w_trace) – expect it to cost a little on the tiny rows.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_parser.h"
+#include "d8w_synth.h"
+#include "d8w_trace.h"
+#include "BCEncoder.h"
+#include "BlockDecode.h"
+#include "d8w_platform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace juiced;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+struct Config
+{
+    synth::Spec spec;
+    uint32_t    banks;
+    uint32_t    iters;
+    std::string dir;
+    std::string only;
+    std::string trace;
+
+    Config() : banks(4), iters(20), dir("d8wbench.tmp") {}
+};
+
+struct Row
+{
+    const char* unit;               /* what items/s counts */
+    double      bytes;              /* per iteration       */
+    double      items;
+    std::vector<double> ms{};       /* one per run()       */
+};
+
+static double pct(const std::vector<double>& sorted, double q)
+{
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(q * sorted.size());
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static void report(const std::string& name, Row& r)
+{
+    std::sort(r.ms.begin(), r.ms.end());
+    const double p50 = pct(r.ms, 0.50);
+    const double sec = p50 > 0 ? p50 / 1000.0 : 1e-9;
+    std::printf("%-24s %5u %9.3f %9.3f %9.3f %9.3f %10.1f %12.1f %s/s\n",
+                name.c_str(), (unsigned)r.ms.size(),
+                p50, pct(r.ms, 0.90), pct(r.ms, 0.99), r.ms.back(),
+                r.bytes / sec / (1024.0 * 1024.0), r.items / sec, r.unit);
+}
+
+/* untimed setup(), timed body(), iters times */
+static void run(const Config& c, const std::string& name, Row r,
+                const std::function<bool()>& setup, const std::function<bool()>& body)
+{
+    if (!c.only.empty() && name.find(c.only) == std::string::npos) return;
+
+    for (uint32_t i = 0; i < c.iters; ++i)
+    {
+        if (setup && !setup()) { std::printf("%-24s setup failed: %s\n", name.c_str(), lastError().c_str()); return; }
+        const Clock::time_point t0 = Clock::now();
+        const bool ok = body();
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        if (!ok) { std::printf("%-24s failed: %s\n", name.c_str(), lastError().c_str()); return; }
+        r.ms.push_back(ms);
+    }
+    report(name, r);
+}
+
+static bool parseArgs(int argc, char** argv, Config& c)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        const unsigned n = (unsigned)std::strtoul(v, 0, 10);
+
+        if      (a == "--packs") c.spec.packs      = n;
+        else if (a == "--tex")   c.spec.texPerPack = n;
+        else if (a == "--size")  c.spec.maxSize    = c.spec.minSize = n;
+        else if (a == "--mips")  c.spec.mips       = n;
+        else if (a == "--seed")  c.spec.seed       = n;
+        else if (a == "--banks") c.banks          = n;
+        else if (a == "--iters") c.iters          = n;
+        else if (a == "--dir")   c.dir            = v;
+        else if (a == "--only")  c.only           = v;
+        else if (a == "--trace") c.trace          = v;
+        else return false;
+    }
+    return c.spec.packs && c.spec.texPerPack && c.spec.maxSize && c.banks && c.iters;
+}
+
+static double fileBytes(const std::string& p)
+{
+    FILE* f = std::fopen(p.c_str(), "rb");
+    if (!f) return 0;
+    std::fseek(f, 0, SEEK_END);
+    const long n = std::ftell(f);
+    std::fclose(f);
+    return n > 0 ? (double)n : 0;
+}
+
+/* .ddt for <slot> at twice the edge: grows the body ~4x */
+static bool writeGrownDdt(const TextureHdr& slot, const std::string& path)
+{
+    TextureHdr h = slot;
+    h.width  *= 2;
+    h.height *= 2;
+    h.size    = synth::bodySize(h.type, h.width, h.height, h.mipCnt);
+
+    std::vector<uint8_t> body(h.size);
+    for (size_t i = 0; i < body.size(); ++i) body[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(body.data(), 1, body.size(), f) == body.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+} // anon
+
+int main(int argc, char** argv)
+{
+    Config c;
+    if (!parseArgs(argc, argv, c))
+    {
+        std::printf("usage: d8wbench [--packs N] [--tex N] [--size N] [--mips N] [--banks N]\n"
+                    "                [--iters N] [--seed N] [--dir D] [--only <substr>]\n"
+                    "                [--trace <out.json | ->]\n");
+        return 1;
+    }
+
+    /* ── corpus ───────────────────────────────────────────────── */
+    plat::makeDir(c.dir);
+    c.spec.banks = c.banks;
+    c.spec.shared = 1.0;                    /* every bank lists every pack */
+    synth::Corpus corpus;
+    std::string   err;
+    if (!synth::write(c.spec, c.dir, "bench", &corpus, &err)) { std::printf("%s\n", err.c_str()); return 2; }
+    const std::string&              d8t = corpus.d8t;
+    const std::vector<std::string>& d8w = corpus.d8w;
+
+    if (!c.trace.empty()) trace::enable(true);
+
+    D8TFile big;
+    if (!big.load(d8t)) { std::printf("cannot read %s\n", d8t.c_str()); return 2; }
+    const double   tSz   = (double)big.buffer().size();
+    const uint32_t nTex  = c.spec.packs * c.spec.texPerPack;
+
+    std::printf("corpus: %u packs x %u textures, %ux%u, %.1f MB .d8t, %u banks\n\n",
+                c.spec.packs, c.spec.texPerPack, c.spec.maxSize, c.spec.maxSize,
+                tSz / (1024.0 * 1024.0), c.banks);
+    std::printf("%-24s %5s %9s %9s %9s %9s %10s %12s\n",
+                "bench", "n", "p50 ms", "p90 ms", "p99 ms", "max ms", "MB/s", "items/s");
+
+    /* ── load ─────────────────────────────────────────────────── */
+    {
+        Row r = { "file", tSz, 1 };
+        run(c, "d8t read", r, 0, [&]{ D8TFile f; return f.load(d8t); });
+    }
+    {
+        std::unique_ptr<D8WBank> bank;
+        Row r = { "tex", fileBytes(d8w[0]), (double)nTex };
+        run(c, "D8WBank::load", r,
+            [&]{ bank.reset(new D8WBank); return true; },
+            [&]{ return bank->load(d8w[0], big.buffer()); });
+    }
+
+    /* ── reference index, every bank resident ─────────────────── */
+    {
+        D8WContext ctx;
+        std::vector< std::unique_ptr<D8WBank> > resident;
+        for (size_t b = 0; b < d8w.size(); ++b)
+        {
+            resident.push_back(std::unique_ptr<D8WBank>(new D8WBank(ctx)));
+            resident.back()->load(d8w[b], big.buffer());
+        }
+        Row r = { "ref", 0, (double)ctx.refCount() };      /* no I/O: MB/s stays 0 */
+        run(c, "rebuildIndex", r, 0, [&]{ ctx.rebuildIndex(); return true; });
+    }
+
+    /* ── spliceReplace: grow one texture by 4 KB, then undo ───── */
+    {
+        std::vector<BYTE> buf = big.buffer();
+        const uint32_t grow = 4096;
+        std::vector<BYTE> payload(grow + 4096, 0xAB);
+        const char*    where[3] = { "head", "mid", "tail" };
+        const uint32_t at[3]    = { 0, (uint32_t)(buf.size() / 2), (uint32_t)(buf.size() - 4096) };
+
+        for (int k = 0; k < 3; ++k)
+        {
+            bool    grown = false;
+            int32_t delta = 0;
+            auto undo = [&]
+            {
+                if (grown) detail::spliceReplace(buf, at[k], 4096 + grow, payload.data(), 4096, delta);
+                grown = false;
+                return true;
+            };
+
+            Row r = { "splice", (double)(buf.size() - at[k]), 1 };
+            run(c, std::string("spliceReplace ") + where[k], r, undo, [&]
+            {
+                return grown = detail::spliceReplace(buf, at[k], 4096, payload.data(), 4096 + grow, delta);
+            });
+            undo();
+        }
+    }
+
+    /* ── importTexture at head / mid / tail, then save ────────── */
+    {
+        const size_t lastPack = c.spec.packs - 1;
+        const size_t pos[3][2] = { { 0, 0 },
+                                   { c.spec.packs / 2, c.spec.texPerPack / 2 },
+                                   { lastPack, c.spec.texPerPack - 1 } };
+        const char* where[3] = { "head", "mid", "tail" };
+
+        std::unique_ptr<D8TFile> t;
+        std::unique_ptr<D8WBank> b;
+        auto fresh = [&]
+        {
+            b.reset();
+            t.reset(new D8TFile);
+            b.reset(new D8WBank);
+            return t->load(d8t) && b->load(d8w[0], t->buffer());
+        };
+
+        if (fresh())
+            for (int k = 0; k < 3; ++k)
+            {
+                const std::string ddt = c.dir + "/grown_" + where[k] + ".ddt";
+                if (!writeGrownDdt(b->texture(pos[k][0], pos[k][1]), ddt)) continue;
+
+                Row r = { "tex", (double)tSz, 1 };
+                run(c, std::string("importTexture ") + where[k], r, fresh,
+                    [&]{ return b->importTexture(pos[k][0], pos[k][1], ddt); });
+            }
+
+        const std::string outW = c.dir + "/saved.d8w", outT = c.dir + "/saved.d8t";
+        Row r = { "bank", tSz, 1 };
+        run(c, "save", r,
+            [&]{ return fresh() && b->importTexture(0, 0, c.dir + "/grown_head.ddt"); },
+            [&]{ return b->save(outW, outT); });
+        b.reset();
+    }
+
+    /* ── decode kernels, 1024x1024 of random blocks ───────────── */
+    {
+        const uint32_t W = 1024, H = 1024;
+        const uint32_t types[5]  = { bc::kTypeDXT1, bc::kTypeDXT3, bc::kTypeDXT5,
+                                     bc::kTypeATI2, bc::kTypeARGB };
+        const char*    names[5]  = { "DXT1", "DXT3", "DXT5", "ATI2", "ARGB" };
+        std::vector<uint8_t> out(size_t(W) * H * 4);
+
+        for (int k = 0; k < 5; ++k)
+        {
+            std::vector<uint8_t> src(bc::levelBytes(types[k], W, H));
+            for (size_t i = 0; i < src.size(); ++i) src[i] = (uint8_t)((i * 2654435761u) >> 13);
+
+            Row r = { "Mpx", (double)src.size(), W * H / 1e6 };
+            run(c, std::string("decode ") + names[k], r, 0,
+                [&]{ return dxt::decodeSurface(types[k], src.data(), src.size(), W, H, out.data()); });
+        }
+    }
+
+    if (!c.trace.empty())
+    {
+        trace::enable(false);
+        if (c.trace == "-") std::printf("\n%s", trace::summary().c_str());
+        else if (!trace::writeChrome(c.trace)) std::printf("cannot write %s\n", c.trace.c_str());
+    }
+    return 0;
+}
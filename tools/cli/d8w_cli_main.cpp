@@ -0,0 +1,12 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_cli_main.cpp  –  headless entry point (d8wcli)
+
+   Same verbs as "d8wTool -verb …" without wxWidgets, for build
+   farms and servers:  d8wcli -exportset a.d8t a.d8w 0 out/
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_cli.h"
+
+int main(int argc, char** argv)
+{
+    return juiced::runCLI(argc, argv);
+}
@@ -0,0 +1,295 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_synth.cpp  –  synthetic corpus builder
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_synth.h"
+#include "d8w_parallel.h"
+#include "BCEncoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+using namespace juiced;
+
+namespace
+{
+
+/* splitmix64 – seeds one stream per (seed, pack, index) */
+static inline uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/* xorshift64* – fast, and identical on every platform */
+struct Rng
+{
+    uint64_t s;
+    explicit Rng(uint64_t seed) : s(mix(seed) | 1) {}
+    Rng(uint64_t seed, uint64_t a, uint64_t b) : s(mix(mix(mix(seed) ^ a) ^ b) | 1) {}
+
+    uint64_t next()
+    {
+        s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+        return s * 0x2545F4914F6CDD1Dull;
+    }
+    uint32_t below(uint32_t n) { return n ? (uint32_t)(next() % n) : 0; }
+};
+
+static void fill(uint8_t* dst, size_t n, Rng& r)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) { const uint64_t x = r.next(); std::memcpy(dst + i, &x, 8); }
+    if (i < n) { const uint64_t x = r.next(); std::memcpy(dst + i, &x, n - i); }
+}
+
+static void put32(std::vector<uint8_t>& v, uint32_t x)
+{
+    const size_t at = v.size();
+    v.resize(at + 4);
+    std::memcpy(&v[at], &x, 4);
+}
+
+static void putF(std::vector<uint8_t>& v, float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, 4);
+    put32(v, x);
+}
+
+struct Tex
+{
+    uint32_t type, w, h, mips, size;
+};
+
+struct Pack
+{
+    uint64_t         off;           /* absolute, after its skip */
+    uint32_t         skip;
+    uint32_t         size;
+    std::vector<Tex> tex;
+};
+
+/* stream tag per role, so changing one knob doesn't reshuffle the rest */
+enum { kTagTex = 1, kTagBody, kTagSkip, kTagSet, kTagTail };
+
+static uint32_t pow2Between(uint32_t lo, uint32_t hi, Rng& r)
+{
+    uint32_t steps = 0;
+    for (uint32_t e = lo; e < hi; e <<= 1) ++steps;
+    return lo << r.below(steps + 1);
+}
+
+static bool writeAll(FILE* f, const uint8_t* p, size_t n)
+{
+    return n == 0 || std::fwrite(p, 1, n, f) == n;
+}
+
+static bool fail(std::string* err, const std::string& msg)
+{
+    if (err) *err = msg;
+    return false;
+}
+
+} // anon
+
+synth::Spec::Spec()
+    : packs(8), texPerPack(128), maxSize(128), minSize(128), mips(0),
+      banks(1), shared(1.0), sets(~0u), stride(4),
+      skip(16), tail(16), seed(1), threads(0)
+{
+    formats.push_back(bc::kTypeDXT1);
+    formats.push_back(bc::kTypeDXT5);
+}
+
+uint32_t synth::bodySize(uint32_t type, uint32_t w, uint32_t h, uint32_t mips)
+{
+    uint32_t sz = 0;
+    for (uint32_t l = 0; l < mips; ++l)
+        sz += bc::levelBytes(type, std::max(1u, w >> l), std::max(1u, h >> l));
+    return sz;
+}
+
+bool synth::parseFormats(const std::string& list, std::vector<uint32_t>& out)
+{
+    static const struct { const char* name; uint32_t type; } kNames[] =
+    {
+        { "dxt1", bc::kTypeDXT1 }, { "dxt3", bc::kTypeDXT3 }, { "dxt5", bc::kTypeDXT5 },
+        { "ati2", bc::kTypeATI2 }, { "argb", bc::kTypeARGB }
+    };
+
+    out.clear();
+    size_t pos = 0;
+    while (pos <= list.size())
+    {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        std::string w = list.substr(pos, comma - pos);
+        std::transform(w.begin(), w.end(), w.begin(), ::tolower);
+        pos = comma + 1;
+        if (w.empty()) continue;
+
+        size_t k = 0;
+        while (k < sizeof(kNames) / sizeof(kNames[0]) && w != kNames[k].name) ++k;
+        if (k == sizeof(kNames) / sizeof(kNames[0])) return false;
+        out.push_back(kNames[k].type);
+    }
+    return !out.empty();
+}
+
+bool synth::write(const Spec& s, const std::string& dir, const std::string& stem,
+                  Corpus* out, std::string* err)
+{
+    if (!s.packs || !s.texPerPack || !s.banks || s.formats.empty() ||
+        !s.minSize || s.minSize > s.maxSize)
+        return fail(err, "bad spec");
+
+    /* ── 1. plan every pack / texture ──────────────────────────── */
+    std::vector<Pack> packs(s.packs);
+    uint64_t cursor = 0;
+    for (uint32_t p = 0; p < s.packs; ++p)
+    {
+        Pack& pk = packs[p];
+        pk.skip = p ? s.skip : 0;
+        pk.off  = cursor + pk.skip;
+        pk.size = 0;
+        pk.tex.resize(s.texPerPack);
+
+        for (uint32_t i = 0; i < s.texPerPack; ++i)
+        {
+            Rng r(s.seed, ((uint64_t)kTagTex << 32) | p, i);
+            Tex& t = pk.tex[i];
+            t.type = s.formats[r.below((uint32_t)s.formats.size())];
+            t.w    = pow2Between(s.minSize, s.maxSize, r);
+            t.h    = (r.next() & 3) == 0 && t.w > s.minSize ? t.w >> 1 : t.w;   /* some 2:1 */
+            t.mips = s.mips ? std::min(s.mips, bc::fullMipCount(t.w, t.h))
+                            : bc::fullMipCount(t.w, t.h);
+            t.size = bodySize(t.type, t.w, t.h, t.mips);
+
+            if ((uint64_t)pk.size + t.size > 0xFFFFFFFFull)
+                return fail(err, "pack exceeds 4 GB");
+            pk.size += t.size;
+        }
+        cursor = pk.off + pk.size;
+    }
+    if (cursor > 0xFFFFFFFFull)
+        return fail(err, ".d8t would exceed 4 GB (offsets are 32-bit)");
+
+    /* ── 2. stream the .d8t ────────────────────────────────────── */
+    const std::string base = dir + "/" + stem;
+    Corpus c;
+    c.d8t      = base + ".d8t";
+    c.d8tBytes = cursor;
+    c.textures = (uint64_t)s.packs * s.texPerPack;
+
+    FILE* f = std::fopen(c.d8t.c_str(), "wb");
+    if (!f) return fail(err, "cannot write " + c.d8t);
+
+    std::vector<uint8_t> buf;
+    bool ok = true;
+    for (uint32_t p = 0; p < s.packs && ok; ++p)
+    {
+        const Pack& pk = packs[p];
+        buf.resize((size_t)pk.skip + pk.size);
+
+        Rng gap(s.seed, ((uint64_t)kTagSkip << 32) | p, 0);
+        fill(buf.data(), pk.skip, gap);
+
+        std::vector<uint32_t> at(pk.tex.size());
+        for (size_t i = 0, o = pk.skip; i < pk.tex.size(); o += pk.tex[i].size, ++i) at[i] = (uint32_t)o;
+
+        parallelFor(pk.tex.size(), [&](size_t i)
+        {
+            Rng r(s.seed, ((uint64_t)kTagBody << 32) | p, i);
+            fill(&buf[at[i]], pk.tex[i].size, r);
+        }, s.threads);
+
+        ok = writeAll(f, buf.data(), buf.size());
+    }
+    if (std::fclose(f) != 0 || !ok) return fail(err, "write failed: " + c.d8t);
+
+    /* ── 3. one .d8w per bank ──────────────────────────────────── */
+    const uint32_t nShared = (uint32_t)(std::min(1.0, std::max(0.0, s.shared)) * s.packs + 0.5);
+    std::vector<uint8_t> isShared(s.packs, 0);
+    {
+        /* spread the shared packs evenly through the file */
+        for (uint32_t k = 0; k < nShared; ++k)
+            isShared[(uint32_t)((uint64_t)k * s.packs / nShared)] = 1;
+    }
+
+    for (uint32_t b = 0; b < s.banks; ++b)
+    {
+        std::vector<uint32_t> mine;
+        uint32_t own = 0;
+        for (uint32_t p = 0; p < s.packs; ++p)
+        {
+            if (isShared[p])                  mine.push_back(p);
+            else if (own++ % s.banks == b)    mine.push_back(p);
+        }
+
+        std::vector<uint8_t> w;
+        uint32_t texCnt = 0, total = 0;
+        for (size_t k = 0; k < mine.size(); ++k)
+        {
+            texCnt += (uint32_t)packs[mine[k]].tex.size();
+            total  += packs[mine[k]].size;
+        }
+        put32(w, texCnt);
+        put32(w, (uint32_t)mine.size());
+        put32(w, total);
+
+        uint64_t cur = 0;
+        for (size_t k = 0; k < mine.size(); ++k)
+        {
+            const Pack& pk = packs[mine[k]];
+            put32(w, (uint32_t)(pk.off - cur));         /* skips unlisted packs too */
+            put32(w, pk.size);
+            put32(w, (uint32_t)pk.tex.size());
+            for (size_t i = 0; i < pk.tex.size(); ++i)
+            {
+                const Tex& t = pk.tex[i];
+                put32(w, t.size); put32(w, t.type);
+                put32(w, t.w);    put32(w, t.h);
+                put32(w, t.mips);
+                put32(w, 2); put32(w, 2); put32(w, 2); put32(w, 1); put32(w, 1);
+                putF (w, -1.5f);
+                putF (w, 0.0f);
+            }
+            cur = pk.off + pk.size;
+        }
+
+        /* sets: names share "SET_" – the loader finds the stride by
+           looking for the first name's leading dword again           */
+        const uint32_t setCnt = s.stride ? (s.sets == ~0u ? (uint32_t)mine.size() : s.sets) : 0;
+        put32(w, setCnt);
+        Rng sr(s.seed, ((uint64_t)kTagSet << 32) | b, 0);
+        for (uint32_t k = 0; k < setCnt; ++k)
+        {
+            char name[32] = {0};
+            std::snprintf(name, sizeof(name), "SET_%04u", k);
+            w.insert(w.end(), name, name + 32);
+            for (uint32_t col = 0; col < s.stride; ++col)
+                put32(w, texCnt && (sr.next() & 7) ? sr.below(texCnt) : 0xFFFFFFFFu);
+        }
+
+        const size_t tailAt = w.size();
+        w.resize(tailAt + s.tail);
+        Rng tr(s.seed, ((uint64_t)kTagTail << 32) | b, 0);
+        fill(w.data() + tailAt, s.tail, tr);
+
+        char sfx[16] = "";
+        if (b) std::snprintf(sfx, sizeof(sfx), "_%u", b);
+        c.d8w.push_back(base + sfx + ".d8w");
+
+        FILE* g = std::fopen(c.d8w.back().c_str(), "wb");
+        if (!g) return fail(err, "cannot write " + c.d8w.back());
+        const bool wok = writeAll(g, w.data(), w.size());
+        if (std::fclose(g) != 0 || !wok) return fail(err, "write failed: " + c.d8w.back());
+    }
+
+    if (out) *out = c;
+    return true;
+}
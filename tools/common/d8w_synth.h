@@ -0,0 +1,74 @@
+#ifndef JUICED_D8W_SYNTH_H_
+#define JUICED_D8W_SYNTH_H_
+
+/*───────────────────────────────────────────────────────────────
+   d8w_synth.h  –  synthetic .d8t + N × .d8w corpora for tools/
+
+   Same layout D8WBank::load parses: 12-byte header, per pack
+   (skip, size, count) + 48-byte TextureHdr each, the texture-set
+   section and an opaque tail.  Bodies are random but valid-sized
+   for their format.
+
+   Every texture is derived from (seed, pack, index) alone, so a
+   corpus is byte-identical across runs and thread counts.  The
+   .d8t is streamed pack by pack; bodies are filled in parallel.
+
+   Banks: packs picked as "shared" (ratio) are listed by every
+   .d8w – the same offsets land in the reference index once per
+   bank – the rest are dealt round-robin.  Bank 0 is <stem>.d8w,
+   then <stem>_1.d8w … so findCompanionBanks picks them all up.
+  ──────────────────────────────────────────────────────────────*/
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace juiced
+{
+namespace synth
+{
+
+struct Spec
+{
+    uint32_t packs;             /* texture tables in the .d8t               */
+    uint32_t texPerPack;
+    uint32_t maxSize;           /* edge range, powers of two                */
+    uint32_t minSize;
+    uint32_t mips;              /* 0 = full chain                           */
+    std::vector<uint32_t> formats;  /* TextureHdr.type, picked uniformly    */
+
+    uint32_t banks;             /* .d8w files                               */
+    double   shared;            /* 0..1 fraction of packs in every bank     */
+    uint32_t sets;              /* per bank; ~0u = one per referenced pack  */
+    uint32_t stride;            /* columns per set                          */
+
+    uint32_t skip;              /* gap before every pack but the first      */
+    uint32_t tail;              /* opaque bytes after the set section       */
+    uint32_t seed;
+    unsigned threads;           /* 0 = all cores                            */
+
+    Spec();
+};
+
+struct Corpus
+{
+    std::string              d8t;
+    std::vector<std::string> d8w;
+    uint64_t                 d8tBytes;
+    uint64_t                 textures;
+
+    Corpus() : d8tBytes(0), textures(0) {}
+};
+
+/* body bytes for one texture (any mip count, any supported type) */
+uint32_t bodySize(uint32_t type, uint32_t w, uint32_t h, uint32_t mips);
+
+/* "dxt1,dxt5,argb" → types; false on an unknown name */
+bool parseFormats(const std::string& list, std::vector<uint32_t>& out);
+
+/* <dir>/<stem>.d8t + banks; false (err filled) on I/O or size limits */
+bool write(const Spec& s, const std::string& dir, const std::string& stem,
+           Corpus* out = 0, std::string* err = 0);
+
+}
+}
+#endif
@@ -0,0 +1,123 @@
+/*───────────────────────────────────────────────────────────────
+   d8w_gen.cpp  –  synthetic corpus generator
+
+   d8wgen <outDir> [options]
+     --stem S          file stem                  (corpus)
+     --packs N         texture tables             (8)
+     --tex N           textures per pack          (128)
+     --size N | A:B    edge, or pow-2 range       (128)
+     --mips N          0 = full chain             (0)
+     --formats LIST    dxt1,dxt3,dxt5,ati2,argb   (dxt1,dxt5)
+     --banks N         .d8w files                 (1)
+     --shared R        0..1 packs in every bank   (1)
+     --sets N          per bank, -1 = per pack    (-1)
+     --stride N        columns per set, 0 = none  (4)
+     --skip N          gap bytes between packs    (16)
+     --tail N          opaque bytes after sets    (16)
+     --seed N          corpus identity            (1)
+     --threads N       fill workers, 0 = all      (0)
+
+   Same seed + options → byte-identical output.
+  ──────────────────────────────────────────────────────────────*/
+#include "d8w_synth.h"
+#include "d8w_platform.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace juiced;
+
+namespace
+{
+
+static bool parseU32(const char* s, uint32_t& out)
+{
+    char* end = 0;
+    const unsigned long v = std::strtoul(s, &end, 10);
+    if (!end || *end || end == s) return false;
+    out = (uint32_t)v;
+    return true;
+}
+
+static void usage()
+{
+    std::printf(
+        "usage: d8wgen <outDir> [--stem S] [--packs N] [--tex N] [--size N|A:B]\n"
+        "              [--mips N] [--formats dxt1,dxt3,dxt5,ati2,argb] [--banks N]\n"
+        "              [--shared 0..1] [--sets N|-1] [--stride N] [--skip N]\n"
+        "              [--tail N] [--seed N] [--threads N]\n");
+}
+
+} // anon
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-') { usage(); return 1; }
+
+    const std::string dir  = argv[1];
+    std::string       stem = "corpus";
+    synth::Spec       s;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (i + 1 >= argc) { usage(); return 1; }
+        const char* v = argv[++i];
+
+        bool ok = true;
+        if      (a == "--stem")    stem = v;
+        else if (a == "--packs")   ok = parseU32(v, s.packs);
+        else if (a == "--tex")     ok = parseU32(v, s.texPerPack);
+        else if (a == "--mips")    ok = parseU32(v, s.mips);
+        else if (a == "--banks")   ok = parseU32(v, s.banks);
+        else if (a == "--stride")  ok = parseU32(v, s.stride);
+        else if (a == "--skip")    ok = parseU32(v, s.skip);
+        else if (a == "--tail")    ok = parseU32(v, s.tail);
+        else if (a == "--seed")    ok = parseU32(v, s.seed);
+        else if (a == "--threads") { uint32_t t; ok = parseU32(v, t); s.threads = t; }
+        else if (a == "--formats") ok = synth::parseFormats(v, s.formats);
+        else if (a == "--shared")  { char* e = 0; s.shared = std::strtod(v, &e); ok = e && !*e; }
+        else if (a == "--sets")
+        {
+            if (std::strcmp(v, "-1") == 0) s.sets = ~0u;
+            else                           ok = parseU32(v, s.sets);
+        }
+        else if (a == "--size")
+        {
+            const char* colon = std::strchr(v, ':');
+            if (!colon) { ok = parseU32(v, s.maxSize); s.minSize = s.maxSize; }
+            else
+            {
+                const std::string lo(v, colon);
+                ok = parseU32(lo.c_str(), s.minSize) && parseU32(colon + 1, s.maxSize);
+            }
+        }
+        else ok = false;
+
+        if (!ok) { std::printf("bad option: %s %s\n", a.c_str(), v); usage(); return 1; }
+    }
+
+    plat::makeDir(dir);
+
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    synth::Corpus c;
+    std::string   err;
+    if (!synth::write(s, dir, stem, &c, &err))
+    {
+        std::printf("d8wgen: %s\n", err.c_str());
+        return 2;
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("%s  %.1f MB  %llu textures  %.2f s  (%.0f MB/s)\n",
+                c.d8t.c_str(), c.d8tBytes / (1024.0 * 1024.0),
+                (unsigned long long)c.textures, sec,
+                sec > 0 ? c.d8tBytes / (1024.0 * 1024.0) / sec : 0.0);
+    for (size_t b = 0; b < c.d8w.size(); ++b) std::printf("%s\n", c.d8w[b].c_str());
+    if (c.d8tBytes > 0x7FFFFFFFull)
+        std::printf("note: over 2 GB – D8TFile::load refuses it, the extent-read paths don't\n");
+    return 0;
+}